@@ -137,6 +137,33 @@ void _ReadWriteBarrier(void);
 { SDL_SpinLock _tmp = 0; SDL_AtomicLock(&_tmp); SDL_AtomicUnlock(&_tmp); }
 #endif
 
+/**
+ * Memory barriers keep the CPU, not just the compiler, from reordering
+ * memory accesses across them.  They come in pairs: a thread that writes
+ * some data and then a flag saying it's ready puts a release barrier
+ * between the two writes, and the thread that reads the flag and then
+ * the data puts an acquire barrier between the two reads.
+ *
+ * SDL_AtomicSet() and SDL_AtomicGet() don't imply either barrier.
+ */
+#if defined(__GNUC__) && (defined(__powerpc__) || defined(__ppc__))
+#define SDL_MemoryBarrierRelease()   __asm__ __volatile__ ("lwsync" : : : "memory")
+#define SDL_MemoryBarrierAcquire()   __asm__ __volatile__ ("lwsync" : : : "memory")
+#elif (defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))) || \
+      (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64)))
+/* x86 never reorders stores with stores or loads with loads */
+#define SDL_MemoryBarrierRelease()   SDL_CompilerBarrier()
+#define SDL_MemoryBarrierAcquire()   SDL_CompilerBarrier()
+#elif defined(HAVE_GCC_ATOMICS)
+#define SDL_MemoryBarrierRelease()   __sync_synchronize()
+#define SDL_MemoryBarrierAcquire()   __sync_synchronize()
+#else
+/* Taking a lock is a full barrier */
+#define SDL_MemoryBarrierRelease()   \
+{ SDL_SpinLock _tmp = 0; SDL_AtomicLock(&_tmp); SDL_AtomicUnlock(&_tmp); }
+#define SDL_MemoryBarrierAcquire()   SDL_MemoryBarrierRelease()
+#endif
+
 /* Platform specific optimized versions of the atomic functions,
  * you can disable these by defining SDL_DISABLE_ATOMIC_INLINE
  */
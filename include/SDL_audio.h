@@ -269,6 +269,8 @@ extern DECLSPEC const char *SDLCALL SDL_GetCurrentAudioDriver(void);
  *      This function usually runs in a separate thread, and so you should
  *      protect data structures that it accesses by calling SDL_LockAudio()
  *      and SDL_UnlockAudio() in your code.
+ *      If the callback is NULL, the device plays data pushed with
+ *      SDL_QueueAudio() instead.
  *    - \c desired->userdata is passed as the first parameter to your callback
  *      function.
  *  
@@ -367,6 +369,63 @@ extern DECLSPEC SDL_AudioStatus SDLCALL
 SDL_GetAudioDeviceStatus(SDL_AudioDeviceID dev);
 /*@}*//*Audio State*/
 
+/**
+ *  Get the time at which a device last played or recorded a buffer.
+ *
+ *  For an output device this is when the last buffer was handed to the
+ *  hardware; for a capture device it is when the buffer most recently
+ *  passed to the callback was recorded. Inside a capture callback it
+ *  refers to the data being delivered.
+ *
+ *  \return A value of SDL_GetPerformanceCounter(), or 0 if the device has
+ *          not played or recorded anything yet.
+ */
+extern DECLSPEC Uint64 SDLCALL SDL_GetAudioDeviceTimestamp(SDL_AudioDeviceID dev);
+
+/**
+ *  \name Audio device statistics
+ *
+ *  Counters kept by the audio thread of each open device, to help pick
+ *  buffer sizes for a host. Times are in microseconds, measured with
+ *  SDL_GetPerformanceCounter().
+ */
+/*@{*/
+#define SDL_AUDIO_HISTOGRAM_BUCKETS 16
+
+typedef struct SDL_AudioDeviceStats
+{
+    Uint32 periods;         /**< Buffers played or recorded */
+    Uint32 callbacks;       /**< Times the callback ran */
+    Uint32 callback_histogram[SDL_AUDIO_HISTOGRAM_BUCKETS];
+                            /**< Callback durations: bucket 0 counts those under
+                                 1 us, bucket n those from 2^(n-1) up to 2^n us,
+                                 and the last bucket everything longer */
+    Uint64 callback_us;     /**< Total time spent in the callback */
+    Uint32 callback_max_us; /**< Longest single callback */
+    Uint32 late_callbacks;  /**< Callbacks that ran longer than their buffer lasts */
+    Uint64 convert_us;      /**< Total time spent converting formats */
+    Uint32 underruns;       /**< Buffers padded with silence because the
+                                 callback fell behind */
+    Uint32 fake_buffers;    /**< Buffers lost because the driver had none free */
+    Uint64 wait_us;         /**< Total time spent waiting on the device */
+    Uint32 wait_min_us;     /**< Shortest wait; close to 0 means no slack */
+    Uint32 queued_frames;   /**< Frames buffered behind the last period */
+} SDL_AudioDeviceStats;
+
+/**
+ *  Get a snapshot of a device's counters.
+ *
+ *  \return 0 on success, or -1 if the device or \c stats is invalid.
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioDeviceStats(SDL_AudioDeviceID dev,
+                                                    SDL_AudioDeviceStats * stats);
+
+/**
+ *  Zero a device's counters, e.g. after changing its buffer size.
+ */
+extern DECLSPEC void SDLCALL SDL_ResetAudioDeviceStats(SDL_AudioDeviceID dev);
+/*@}*//*Audio device statistics*/
+
 /**
  *  \name Pause audio functions
  *  
@@ -400,6 +459,8 @@ extern DECLSPEC void SDLCALL SDL_PauseAudioDevice(SDL_AudioDeviceID dev,
  *  This function returns NULL and sets the SDL error message if the 
  *  wave file cannot be opened, uses an unknown data format, or is 
  *  corrupt.  Currently raw and MS-ADPCM WAVE files are supported.
+ *
+ *  To read a large file a piece at a time instead, see SDL_OpenWAVReader().
  */
 extern DECLSPEC SDL_AudioSpec *SDLCALL SDL_LoadWAV_RW(SDL_RWops * src,
                                                       int freesrc,
@@ -419,6 +480,75 @@ extern DECLSPEC SDL_AudioSpec *SDLCALL SDL_LoadWAV_RW(SDL_RWops * src,
  */
 extern DECLSPEC void SDLCALL SDL_FreeWAV(Uint8 * audio_buf);
 
+/**
+ *  \name Incremental WAVE reading
+ *
+ *  A WAV reader parses the chunk table of a WAVE file once and then hands
+ *  out frames on demand, so a file never has to be held in memory whole.
+ *  ADPCM data is decoded a block at a time into the caller's buffer.
+ *  Frames come out in the format SDL_LoadWAV_RW() would return.
+ */
+/*@{*/
+typedef struct SDL_WAVReader SDL_WAVReader;
+
+/**
+ *  Open a WAVE file for incremental reading.
+ *
+ *  \param src     The data source, positioned at the start of the file.
+ *  \param freesrc Non-zero to close \c src when the reader is closed,
+ *                 or if this function fails.
+ *  \param spec    Filled with the format of the frames handed out.
+ *
+ *  \return A new reader, or NULL on error.
+ */
+extern DECLSPEC SDL_WAVReader *SDLCALL SDL_OpenWAVReader(SDL_RWops * src,
+                                                         int freesrc,
+                                                         SDL_AudioSpec * spec);
+
+/**
+ *  Get the total number of frames in the file.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetWAVFrames(SDL_WAVReader * reader);
+
+/**
+ *  Read up to \c frames frames into \c buf.
+ *
+ *  \return The number of frames read, 0 at the end of the data, or -1 on
+ *          error.
+ */
+extern DECLSPEC int SDLCALL SDL_ReadWAVFrames(SDL_WAVReader * reader,
+                                              void *buf, int frames);
+
+/**
+ *  Consume up to \c *frames frames without copying them.
+ *
+ *  This is only possible for PCM and float data read from a memory stream
+ *  made by SDL_RWFromMem() or SDL_RWFromConstMem(), which may wrap a
+ *  memory mapped file. On return \c *frames holds the number of frames
+ *  available at the returned pointer, which stays valid as long as the
+ *  memory does.
+ *
+ *  \return A pointer into the source's memory, or NULL at the end of the
+ *          data or if the frames must be read with SDL_ReadWAVFrames().
+ */
+extern DECLSPEC const void *SDLCALL SDL_MapWAVFrames(SDL_WAVReader * reader,
+                                                     int *frames);
+
+/**
+ *  Move to \c frame, counted from the start of the data. The source must
+ *  be seekable.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_SeekWAVFrame(SDL_WAVReader * reader,
+                                             Uint32 frame);
+
+/**
+ *  Close a reader, and its source if it was opened with \c freesrc.
+ */
+extern DECLSPEC void SDLCALL SDL_CloseWAVReader(SDL_WAVReader * reader);
+/*@}*//*Incremental WAVE reading*/
+
 /**
  *  This function takes a source format and rate and a destination format
  *  and rate, and initializes the \c cvt structure with information needed
@@ -445,9 +575,112 @@ extern DECLSPEC int SDLCALL SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
  *  The data conversion may expand the size of the audio data, so the buffer
  *  \c cvt->buf should be allocated after the \c cvt structure is initialized by
  *  SDL_BuildAudioCVT(), and should be \c cvt->len*cvt->len_mult bytes long.
+ *
+ *  When the rates differ, every call is resampled as a complete sound: the
+ *  filter starts from silence and is flushed at the end of the buffer, so
+ *  converting a long sound one piece at a time leaves discontinuities at
+ *  the piece boundaries.  Use an SDL_AudioStream for data that arrives in
+ *  pieces; it keeps the filter history between calls.
  */
 extern DECLSPEC int SDLCALL SDL_ConvertAudio(SDL_AudioCVT * cvt);
 
+/**
+ *  \brief A streaming audio converter.
+ *
+ *  Unlike SDL_AudioCVT, a stream accepts data in pieces of any size and
+ *  buffers the converted result until it is read back.  Incomplete sample
+ *  frames and resampler history are kept between calls, so a sound can be
+ *  fed through in chunks without clicks at the chunk boundaries.
+ *
+ *  \sa SDL_NewAudioStream
+ */
+struct SDL_AudioStream;
+typedef struct SDL_AudioStream SDL_AudioStream;
+
+/**
+ *  Create a new audio stream converting from one format, channel count and
+ *  rate to another.
+ *
+ *  \return The new stream, or NULL on error.
+ *
+ *  \sa SDL_AudioStreamPut
+ *  \sa SDL_AudioStreamGet
+ *  \sa SDL_FreeAudioStream
+ */
+extern DECLSPEC SDL_AudioStream *SDLCALL SDL_NewAudioStream(SDL_AudioFormat src_format,
+                                                            Uint8 src_channels,
+                                                            int src_rate,
+                                                            SDL_AudioFormat dst_format,
+                                                            Uint8 dst_channels,
+                                                            int dst_rate);
+
+/**
+ *  Add \c len bytes of audio data in the source format to the stream.
+ *  The length does not have to be a multiple of the sample frame size.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamPut(SDL_AudioStream * stream,
+                                               const void *buf, int len);
+
+/**
+ *  Read up to \c len bytes of converted audio data from the stream.
+ *
+ *  \return The number of bytes read, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamGet(SDL_AudioStream * stream,
+                                               void *buf, int len);
+
+/**
+ *  Get the number of converted bytes that are ready to be read.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamAvailable(SDL_AudioStream * stream);
+
+/**
+ *  Tell the stream that no more data is coming for now, so everything that
+ *  is still held back for the resampler is converted and made available.
+ *  An incomplete sample frame at the end of the input is dropped.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamFlush(SDL_AudioStream * stream);
+
+/**
+ *  Throw away all data in the stream, both converted and pending.
+ */
+extern DECLSPEC void SDLCALL SDL_AudioStreamClear(SDL_AudioStream * stream);
+
+/**
+ *  Free an audio stream.
+ */
+extern DECLSPEC void SDLCALL SDL_FreeAudioStream(SDL_AudioStream * stream);
+
+/**
+ *  Remix \c frames sample frames from one channel count to another with a
+ *  matrix of weights, converting between AUDIO_S16SYS and AUDIO_F32SYS in
+ *  the same pass.  Up to 8 channels are supported.
+ *
+ *  \param matrix \c dst_channels rows of \c src_channels weights each;
+ *                every output channel is the sum of the input channels
+ *                times the weights in its row.  NULL picks the default
+ *                up/downmix between mono, stereo, quad (FL FR BL BR) and
+ *                5.1 (FL FR FC LFE BL BR).
+ *
+ *  \c src and \c dst may be the same buffer, if it's big enough for the
+ *  output.  The weights apply to samples scaled to -1.0 to 1.0; AUDIO_S16SYS
+ *  output is clipped.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_RemixAudio(SDL_AudioFormat src_format,
+                                           Uint8 src_channels,
+                                           const void *src,
+                                           SDL_AudioFormat dst_format,
+                                           Uint8 dst_channels,
+                                           void *dst,
+                                           const float *matrix,
+                                           int frames);
+
 #define SDL_MIX_MAXVOLUME 128
 /**
  *  This takes two audio buffers of the playing audio format and mixes
@@ -469,6 +702,125 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
                                                 SDL_AudioFormat format,
                                                 Uint32 len, int volume);
 
+/**
+ *  \brief A mixing bus for any number of voices.
+ *
+ *  Each voice is converted once to float samples at the bus channel count
+ *  and rate, then summed with its own gain and pan into a float
+ *  accumulator.  Only the final sum is clipped and converted to the bus
+ *  format, so loud voices don't clip each other while they are mixed.
+ *
+ *  A bus is not thread safe; lock it yourself if several threads use it.
+ *
+ *  \sa SDL_NewAudioBus
+ */
+struct SDL_AudioBus;
+typedef struct SDL_AudioBus SDL_AudioBus;
+
+/**
+ *  Create a new mixing bus producing audio in the given format, channel
+ *  count and rate.
+ *
+ *  \return The new bus, or NULL on error.
+ *
+ *  \sa SDL_AudioBusAddVoice
+ *  \sa SDL_AudioBusMix
+ *  \sa SDL_FreeAudioBus
+ */
+extern DECLSPEC SDL_AudioBus *SDLCALL SDL_NewAudioBus(SDL_AudioFormat format,
+                                                      Uint8 channels,
+                                                      int rate);
+
+/**
+ *  Add a voice playing audio in the given format, channel count and rate.
+ *  New voices have a gain of 1.0 and are centered.
+ *
+ *  \return The voice index, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioBusAddVoice(SDL_AudioBus * bus,
+                                                 SDL_AudioFormat format,
+                                                 Uint8 channels, int rate);
+
+/**
+ *  Remove a voice and throw away any audio it still has queued.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioBusRemoveVoice(SDL_AudioBus * bus,
+                                                    int voice);
+
+/**
+ *  Set the gain and pan of a voice.
+ *
+ *  \param gain Linear gain, 1.0 leaves the voice unchanged.
+ *  \param pan  -1.0 is fully left, 0.0 centered and 1.0 fully right.  Pan
+ *              only affects the left/right channel pairs of stereo, quad
+ *              and 5.1 buses.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioBusSetVoiceGain(SDL_AudioBus * bus,
+                                                     int voice,
+                                                     float gain, float pan);
+
+/**
+ *  Queue more audio for a voice, in the format the voice was added with.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioBusPutVoice(SDL_AudioBus * bus,
+                                                 int voice,
+                                                 const void *buf, int len);
+
+/**
+ *  Get the number of bytes of bus format audio a voice has queued.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioBusVoiceAvailable(SDL_AudioBus * bus,
+                                                       int voice);
+
+/**
+ *  Mix \c len bytes of all voices into \c buf, in the bus format.  Voices
+ *  that run out of queued audio contribute silence for the rest.
+ *
+ *  \param dither Add triangular dither before rounding to 8 or 16 bit
+ *                integer formats.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioBusMix(SDL_AudioBus * bus,
+                                            void *buf, int len,
+                                            SDL_bool dither);
+
+/**
+ *  Free a mixing bus and all its voices.
+ */
+extern DECLSPEC void SDLCALL SDL_FreeAudioBus(SDL_AudioBus * bus);
+
+/**
+ *  Queue more audio on a device opened with a NULL callback.
+ *
+ *  The data must be in the format the device was opened with (the
+ *  \c obtained spec, or \c desired when format changes were not allowed)
+ *  and is copied, so the buffer can be reused as soon as this returns.
+ *  Queued data is played in order; if the queue runs dry the device plays
+ *  silence until more arrives.
+ *
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_GetQueuedAudioSize
+ *  \sa SDL_ClearQueuedAudio
+ */
+extern DECLSPEC int SDLCALL SDL_QueueAudio(SDL_AudioDeviceID dev,
+                                           const void *data, Uint32 len);
+
+/**
+ *  Get the number of bytes of audio still queued on a device.
+ *
+ *  This shrinks as the device plays, so it can be used to keep the queue
+ *  (and with it the output latency) at a steady length.  Returns 0 for
+ *  devices that use a callback.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetQueuedAudioSize(SDL_AudioDeviceID dev);
+
+/**
+ *  Drop all audio still queued on a device.
+ */
+extern DECLSPEC void SDLCALL SDL_ClearQueuedAudio(SDL_AudioDeviceID dev);
+
 /**
  *  \name Audio lock functions
  *  
@@ -38,6 +38,7 @@
 #include "SDL_quit.h"
 #include "SDL_gesture.h"
 #include "SDL_touch.h"
+#include "SDL_rwops.h"
 
 #include "begin_code.h"
 /* Set up for C function definitions, even when using C++ */
@@ -123,6 +124,11 @@ typedef enum
 
 /**
  *  \brief Fields shared by every event
+ *
+ *  The timestamp is SDL_GetTicks() when the event was queued.  Keyboard,
+ *  mouse, joystick, game controller and touch events also carry a
+ *  timestamp_ns field, taken from SDL_GetPerformanceCounter() when SDL
+ *  received the input and converted to nanoseconds.
  */
 typedef struct SDL_GenericEvent
 {
@@ -159,6 +165,7 @@ typedef struct SDL_KeyboardEvent
     Uint8 padding2;
     Uint8 padding3;
     SDL_Keysym keysym;  /**< The key that was pressed or released */
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_KeyboardEvent;
 
 #define SDL_TEXTEDITINGEVENT_TEXT_SIZE (32)
@@ -205,6 +212,8 @@ typedef struct SDL_MouseMotionEvent
     Sint32 y;           /**< Y coordinate, relative to window */
     Sint32 xrel;        /**< The relative motion in the X direction */
     Sint32 yrel;        /**< The relative motion in the Y direction */
+    Uint32 coalesced;   /**< How many more motion reports were merged into this one */
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_MouseMotionEvent;
 
 /**
@@ -222,6 +231,7 @@ typedef struct SDL_MouseButtonEvent
     Uint8 padding2;
     Sint32 x;           /**< X coordinate, relative to window */
     Sint32 y;           /**< Y coordinate, relative to window */
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_MouseButtonEvent;
 
 /**
@@ -235,6 +245,7 @@ typedef struct SDL_MouseWheelEvent
     Uint32 which;       /**< The mouse instance id, or SDL_TOUCH_MOUSEID */
     Sint32 x;           /**< The amount scrolled horizontally */
     Sint32 y;           /**< The amount scrolled vertically */
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_MouseWheelEvent;
 
 /**
@@ -251,6 +262,7 @@ typedef struct SDL_JoyAxisEvent
     Uint8 padding3;
     Sint16 value;       /**< The axis value (range: -32768 to 32767) */
     Uint16 padding4;
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_JoyAxisEvent;
 
 /**
@@ -267,6 +279,7 @@ typedef struct SDL_JoyBallEvent
     Uint8 padding3;
     Sint16 xrel;        /**< The relative motion in the X direction */
     Sint16 yrel;        /**< The relative motion in the Y direction */
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_JoyBallEvent;
 
 /**
@@ -287,6 +300,7 @@ typedef struct SDL_JoyHatEvent
                          */
     Uint8 padding1;
     Uint8 padding2;
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_JoyHatEvent;
 
 /**
@@ -301,6 +315,7 @@ typedef struct SDL_JoyButtonEvent
     Uint8 state;        /**< ::SDL_PRESSED or ::SDL_RELEASED */
     Uint8 padding1;
     Uint8 padding2;
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_JoyButtonEvent;
 
 /**
@@ -328,6 +343,7 @@ typedef struct SDL_ControllerAxisEvent
     Uint8 padding3;
     Sint16 value;       /**< The axis value (range: -32768 to 32767) */
     Uint16 padding4;
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_ControllerAxisEvent;
 
 
@@ -343,6 +359,7 @@ typedef struct SDL_ControllerButtonEvent
     Uint8 state;        /**< ::SDL_PRESSED or ::SDL_RELEASED */
     Uint8 padding1;
     Uint8 padding2;
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_ControllerButtonEvent;
 
 
@@ -371,6 +388,8 @@ typedef struct SDL_TouchFingerEvent
     float dx;           /**< Normalized in the range 0...1 */
     float dy;           /**< Normalized in the range 0...1 */
     float pressure;     /**< Normalized in the range 0...1 */
+    Uint32 coalesced;   /**< For ::SDL_FINGERMOTION, how many more motion reports were merged into this one */
+    Uint64 timestamp_ns; /**< When the input arrived, in nanoseconds */
 } SDL_TouchFingerEvent;
 
 
@@ -553,6 +572,51 @@ extern DECLSPEC SDL_bool SDLCALL SDL_HasEvents(Uint32 minType, Uint32 maxType);
 extern DECLSPEC void SDLCALL SDL_FlushEvent(Uint32 type);
 extern DECLSPEC void SDLCALL SDL_FlushEvents(Uint32 minType, Uint32 maxType);
 
+/**
+ *  Returns how many events in the given range of types were dropped
+ *  because the event queue was full, since the event loop started.
+ *
+ *  \sa SDL_HINT_EVENT_QUEUE_SIZE
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetDroppedEvents(Uint32 minType, Uint32 maxType);
+
+/**
+ *  \brief Start writing every event pushed from now on to \c dst, so it can
+ *         be played back later with SDL_ReplayEvents().
+ *
+ *  Events are recorded as an event watch sees them, with the time they
+ *  were pushed to the nanosecond.  Pointers in user events are written as
+ *  they are, and system window manager events aren't recorded.
+ *
+ *  \return 0 on success, or -1 if recording is already in progress or
+ *          \c dst couldn't be written.
+ *
+ *  \sa SDL_StopEventRecording()
+ */
+extern DECLSPEC int SDLCALL SDL_StartEventRecording(SDL_RWops * dst);
+
+/**
+ *  \brief Stop recording events.  The stream is left open.
+ *
+ *  \return 0 on success, or -1 if some events couldn't be written.
+ */
+extern DECLSPEC int SDLCALL SDL_StopEventRecording(void);
+
+/**
+ *  \brief Push the events recorded in \c src with SDL_PushEvent().
+ *
+ *  With \c realtime set, each event is pushed as long after the start as
+ *  it was recorded, otherwise as fast as possible.  Either way this waits
+ *  for room when the queue is full rather than dropping events, so the
+ *  events should be read on another thread.  Replayed input events get a
+ *  new timestamp_ns.
+ *
+ *  \return The number of events pushed, or -1 if \c src isn't an event
+ *          recording this machine can play back, or if the queue stays
+ *          full for a second.  Events pushed before that stay queued.
+ */
+extern DECLSPEC int SDLCALL SDL_ReplayEvents(SDL_RWops * src, SDL_bool realtime);
+
 /**
  *  \brief Polls for currently pending events.
  *  
@@ -637,7 +701,21 @@ extern DECLSPEC void SDLCALL SDL_AddEventWatch(SDL_EventFilter filter,
                                                void *userdata);
 
 /**
- *  Remove an event watch function added with SDL_AddEventWatch()
+ *  Add a function which is called when an event with a type between
+ *  \c minType and \c maxType inclusive is added to the queue.  Other events
+ *  don't cost it anything.
+ *
+ *  Like those added with SDL_AddEventWatch(), the watchers of an event are
+ *  called newest first.
+ */
+extern DECLSPEC void SDLCALL SDL_AddEventWatchRange(SDL_EventFilter filter,
+                                                    void *userdata,
+                                                    Uint32 minType,
+                                                    Uint32 maxType);
+
+/**
+ *  Remove an event watch function added with SDL_AddEventWatch() or
+ *  SDL_AddEventWatchRange()
  */
 extern DECLSPEC void SDLCALL SDL_DelEventWatch(SDL_EventFilter filter,
                                                void *userdata);
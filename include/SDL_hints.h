@@ -228,6 +228,96 @@ extern "C" {
 #define SDL_HINT_ALLOW_TOPMOST "SDL_ALLOW_TOPMOST"
 
 
+/**
+ *  \brief  A variable controlling how many periods the audio callback may run ahead of the device
+ *
+ *  When this is 2 or more, the callback runs on its own thread and feeds a
+ *  lock-free ring buffer holding this many periods, which the device thread
+ *  drains.  A slow callback then eats into the ring instead of causing an
+ *  underrun, at the cost of that much extra latency.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Call the callback in lock-step with the device (the default)
+ *    "N"       - Let the callback run up to N periods ahead
+ *
+ *  This hint must be set before the audio device is opened.
+ */
+#define SDL_HINT_AUDIO_RING_PERIODS "SDL_AUDIO_RING_PERIODS"
+
+
+/**
+ *  \brief  A variable controlling the size of each period in the audio ring, in sample frames
+ *
+ *  This is how many sample frames the callback is asked for at a time when
+ *  SDL_HINT_AUDIO_RING_PERIODS is enabled, and is reported back in the
+ *  obtained audio spec.  It doesn't have to match the device buffer size.
+ *  By default the device buffer size is used.  Values above 65535 are
+ *  clamped to 65535, the largest size an audio spec can hold.
+ *
+ *  This hint must be set before the audio device is opened.
+ */
+#define SDL_HINT_AUDIO_RING_PERIOD_SAMPLES "SDL_AUDIO_RING_PERIOD_SAMPLES"
+
+
+/**
+ *  \brief  A variable controlling how many threads feed the open output devices
+ *
+ *  By default every open device gets a thread of its own.  When this is set,
+ *  output devices whose driver can report when its next buffer is due are
+ *  fed instead by a single scheduler thread, which tracks when each device
+ *  is due and hands due devices to a small pool of helper threads, so a
+ *  slow callback only delays its own device.  With "1" the scheduler mixes
+ *  them itself.  This saves threads and context switches when many devices
+ *  are open at once.  It doesn't combine with
+ *  SDL_HINT_AUDIO_RING_PERIODS; scheduled devices don't use the ring.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Give each device its own thread (the default)
+ *    "N"       - Feed eligible devices from N threads in total (up to 8)
+ *
+ *  This hint must be set before the audio device is opened.
+ */
+#define SDL_HINT_AUDIO_SHARED_THREADS "SDL_AUDIO_SHARED_THREADS"
+
+/**
+ *  \brief  A variable setting how many events the event queue holds.
+ *
+ *  Events pushed while the queue is full are dropped; see
+ *  SDL_GetDroppedEvents().  By default the queue holds 127 events.
+ *
+ *  This hint must be set before the event loop starts, which is when the
+ *  video subsystem is initialized.
+ */
+#define SDL_HINT_EVENT_QUEUE_SIZE "SDL_EVENT_QUEUE_SIZE"
+
+/**
+ *  \brief  A variable letting the event queue grow when it's full.
+ *
+ *  If this is larger than SDL_HINT_EVENT_QUEUE_SIZE, a full queue grows by
+ *  that many events at a time until it holds this many, and keeps the
+ *  memory until the event loop stops.  By default the queue doesn't grow.
+ *
+ *  This hint must be set before the event loop starts.
+ */
+#define SDL_HINT_EVENT_QUEUE_MAX_SIZE "SDL_EVENT_QUEUE_MAX_SIZE"
+
+/**
+ *  \brief  A variable controlling whether mouse and finger motion is merged
+ *          while it waits in the event queue.
+ *
+ *  When this is set, a motion report from a mouse or finger that already
+ *  has motion at the end of the queue updates that event instead of adding
+ *  another: the position becomes the latest one, the relative motion is
+ *  added up, and the event's coalesced field counts the merged reports.
+ *  Event filters and watchers still see every report.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Queue every motion report (the default)
+ *    "1"       - Merge motion reports waiting in the queue
+ */
+#define SDL_HINT_EVENT_COALESCE_MOTION "SDL_EVENT_COALESCE_MOTION"
+
+
 
 /**
  *  \brief  An enumeration of hint priorities
@@ -48,8 +48,19 @@ SDL_RegisterHintChangedCb(const char *name, SDL_HintChangedCb hintCb)
             return SDL_TRUE;
         }
     }
-	
-    return SDL_FALSE;
+
+    /* Not set yet, add an empty hint to hold the callback */
+    hint = (SDL_Hint *)SDL_malloc(sizeof(*hint));
+    if (!hint) {
+        return SDL_FALSE;
+    }
+    hint->name = SDL_strdup(name);
+    hint->value = NULL;
+    hint->priority = SDL_HINT_DEFAULT;
+    hint->callback = hintCb;
+    hint->next = SDL_hints;
+    SDL_hints = hint;
+    return SDL_TRUE;
 }
 
 SDL_bool
@@ -73,7 +84,7 @@ SDL_SetHintWithPriority(const char *name, const char *value,
             if (priority < hint->priority) {
                 return SDL_FALSE;
             }
-            if (SDL_strcmp(hint->value, value) != 0) {
+            if (!hint->value || SDL_strcmp(hint->value, value) != 0) {
                 if (hint->callback != NULL) {
                     (*hint->callback)(name, hint->value, value);
                 }
@@ -114,7 +125,7 @@ SDL_GetHint(const char *name)
     env = SDL_getenv(name);
     for (hint = SDL_hints; hint; hint = hint->next) {
         if (SDL_strcmp(name, hint->name) == 0) {
-            if (!env || hint->priority == SDL_HINT_OVERRIDE) {
+            if (hint->value && (!env || hint->priority == SDL_HINT_OVERRIDE)) {
                 return hint->value;
             }
             break;
@@ -126,11 +137,24 @@ SDL_GetHint(const char *name)
 void SDL_ClearHints(void)
 {
     SDL_Hint *hint;
+    SDL_Hint **prev = &SDL_hints;
+
+    while (*prev) {
+        hint = *prev;
 
-    while (SDL_hints) {
-        hint = SDL_hints;
-        SDL_hints = hint->next;
+        /* Whoever registered a callback is still listening, keep it */
+        if (hint->callback != NULL) {
+            if (hint->value != NULL) {
+                (*hint->callback)(hint->name, hint->value, SDL_getenv(hint->name));
+                SDL_free(hint->value);
+                hint->value = NULL;
+            }
+            hint->priority = SDL_HINT_DEFAULT;
+            prev = &hint->next;
+            continue;
+        }
 
+        *prev = hint->next;
         SDL_free(hint->name);
         SDL_free(hint->value);
         SDL_free(hint);
@@ -27,6 +27,8 @@
  */
 typedef void (*SDL_HintChangedCb)(const char *name, const char *oldValue, const char *newValue);
 
+/* The hint doesn't have to be set yet.  oldValue and newValue are NULL
+   while it isn't, and SDL_ClearHints() keeps the callback. */
 extern SDL_bool SDL_RegisterHintChangedCb(const char *name, SDL_HintChangedCb hintCb);
 
 #endif /* _SDL_hints_c_h */
@@ -61,6 +61,7 @@ extern AudioBootStrap COREAUDIO_bootstrap;
 extern AudioBootStrap SNDMGR_bootstrap;
 extern AudioBootStrap DISKAUD_bootstrap;
 extern AudioBootStrap DUMMYAUD_bootstrap;
+extern AudioBootStrap LOOPBACKAUD_bootstrap;
 extern AudioBootStrap DCAUD_bootstrap;
 extern AudioBootStrap DART_bootstrap;
 extern AudioBootStrap NDSAUD_bootstrap;
@@ -121,6 +122,9 @@ static const AudioBootStrap *const bootstrap[] = {
 #if SDL_AUDIO_DRIVER_DUMMY
     &DUMMYAUD_bootstrap,
 #endif
+#if SDL_AUDIO_DRIVER_LOOPBACK
+    &LOOPBACKAUD_bootstrap,
+#endif
 #if SDL_AUDIO_DRIVER_NDS
     &NDSAUD_bootstrap,
 #endif
@@ -242,72 +246,622 @@ finalize_audio_entry_points(void)
 #undef FILL_STUB
 }
 
-/* Streaming functions (for when the input and output buffer sizes are different) */
-/* Write [length] bytes from buf into the streamer */
+/* Ring buffer functions (for letting the callback run ahead of the device) */
+/*
+ * The ring has exactly one writer (the mixing thread) and one reader (the
+ *  device thread), so the heads can be plain atomics and nobody ever has to
+ *  take a lock to move data. One byte is always left unused, so that
+ *  read_pos == write_pos can only mean "empty". Each side moves its head
+ *  after a release barrier and reads the other head before an acquire
+ *  barrier, so the data is in place before the other side can see it.
+ */
+static int
+SDL_RingLength(SDL_AudioRing * ring)
+{
+    const int read_pos = SDL_AtomicGet(&ring->read_pos);
+    const int write_pos = SDL_AtomicGet(&ring->write_pos);
+    SDL_MemoryBarrierAcquire();
+    return (write_pos - read_pos + ring->max_len) % ring->max_len;
+}
+
+static int
+SDL_RingSpace(SDL_AudioRing * ring)
+{
+    return (ring->max_len - 1) - SDL_RingLength(ring);
+}
+
+/* Write [length] bytes from buf into the ring. Caller checks for space. */
 static void
-SDL_StreamWrite(SDL_AudioStreamer * stream, Uint8 * buf, int length)
+SDL_RingWrite(SDL_AudioRing * ring, const Uint8 * buf, int length)
 {
-    int i;
+    const int write_pos = SDL_AtomicGet(&ring->write_pos);
+    const int cpy = SDL_min(length, ring->max_len - write_pos);
 
-    for (i = 0; i < length; ++i) {
-        stream->buffer[stream->write_pos] = buf[i];
-        ++stream->write_pos;
+    SDL_memcpy(ring->buffer + write_pos, buf, cpy);
+    SDL_memcpy(ring->buffer, buf + cpy, length - cpy);
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring->write_pos, (write_pos + length) % ring->max_len);
+}
+
+/* Read up to [length] bytes out of the ring into buf, returns bytes read */
+static int
+SDL_RingRead(SDL_AudioRing * ring, Uint8 * buf, int length)
+{
+    const int read_pos = SDL_AtomicGet(&ring->read_pos);
+    int cpy;
+
+    length = SDL_min(length, SDL_RingLength(ring));
+    cpy = SDL_min(length, ring->max_len - read_pos);
+    SDL_memcpy(buf, ring->buffer + read_pos, cpy);
+    SDL_memcpy(buf + cpy, ring->buffer, length - cpy);
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring->read_pos, (read_pos + length) % ring->max_len);
+    return length;
+}
+
+/* Initialize the ring by allocating the buffers and setting the read/write heads to the beginning */
+static int
+SDL_RingInit(SDL_AudioRing * ring, int max_len, int period_len)
+{
+    SDL_zerop(ring);
+
+    ring->buffer = (Uint8 *) SDL_AllocAudioMem(max_len + 1);
+    ring->mixbuf = (Uint8 *) SDL_AllocAudioMem(period_len);
+    ring->space = SDL_CreateSemaphore(0);
+    if ((ring->buffer == NULL) || (ring->mixbuf == NULL) ||
+        (ring->space == NULL)) {
+        return -1;
     }
+
+    ring->max_len = max_len + 1;
+    ring->period_len = period_len;
+    return 0;
 }
 
-/* Read [length] bytes out of the streamer into buf */
+/* Deinitialize the ring simply by freeing the buffers */
 static void
-SDL_StreamRead(SDL_AudioStreamer * stream, Uint8 * buf, int length)
+SDL_RingDeinit(SDL_AudioRing * ring)
 {
-    int i;
+    if (ring->buffer != NULL) {
+        SDL_FreeAudioMem(ring->buffer);
+    }
+    if (ring->mixbuf != NULL) {
+        SDL_FreeAudioMem(ring->mixbuf);
+    }
+    if (ring->space != NULL) {
+        SDL_DestroySemaphore(ring->space);
+    }
+    SDL_zerop(ring);
+}
 
-    for (i = 0; i < length; ++i) {
-        buf[i] = stream->buffer[stream->read_pos];
-        ++stream->read_pos;
+/* Buffer queue support, for devices opened without a callback */
+
+static void
+free_audio_queue(SDL_AudioBufferQueue * buffer)
+{
+    while (buffer) {
+        SDL_AudioBufferQueue *next = buffer->next;
+        SDL_free(buffer);
+        buffer = next;
     }
 }
 
-static int
-SDL_StreamLength(SDL_AudioStreamer * stream)
+/* Stands in for the app's callback; the device is locked while it runs */
+static void SDLCALL
+SDL_BufferQueueDrainCallback(void *userdata, Uint8 * stream, int _len)
 {
-    return (stream->write_pos - stream->read_pos) % stream->max_len;
+    SDL_AudioDevice *device = (SDL_AudioDevice *) userdata;
+    SDL_AudioBufferQueue *buffer;
+    Uint32 len = (Uint32) _len;
+    Uint8 silence = device->spec.silence;
+
+    while ((len > 0) && ((buffer = device->buffer_queue_head) != NULL)) {
+        const Uint32 avail = buffer->datalen - buffer->startpos;
+        const Uint32 cpy = SDL_min(len, avail);
+
+        SDL_memcpy(stream, buffer->data + buffer->startpos, cpy);
+        buffer->startpos += cpy;
+        stream += cpy;
+        len -= cpy;
+        device->queued_bytes -= cpy;
+
+        if (buffer->startpos == buffer->datalen) {
+            /* packet is used up, keep it around for the next SDL_QueueAudio */
+            device->buffer_queue_head = buffer->next;
+            buffer->next = device->buffer_queue_pool;
+            device->buffer_queue_pool = buffer;
+        }
+    }
+
+    if (device->buffer_queue_head == NULL) {
+        device->buffer_queue_tail = NULL;
+    }
+
+    /* ran dry, the rest of the period is silence in the callback's format */
+    if (len > 0) {
+        if (device->stream) {
+            silence = (device->callback_format == AUDIO_U8) ? 0x80 : 0x00;
+        }
+        SDL_memset(stream, silence, len);
+    }
 }
 
-/* Initialize the stream by allocating the buffer and setting the read/write heads to the beginning */
-#if 0
-static int
-SDL_StreamInit(SDL_AudioStreamer * stream, int max_len, Uint8 silence)
+int
+SDL_QueueAudio(SDL_AudioDeviceID devid, const void *_data, Uint32 len)
 {
-    /* First try to allocate the buffer */
-    stream->buffer = (Uint8 *) SDL_malloc(max_len);
-    if (stream->buffer == NULL) {
+    SDL_AudioDevice *device = get_audio_device(devid);
+    const Uint8 *data = (const Uint8 *) _data;
+    SDL_AudioBufferQueue *orig_tail;
+    SDL_AudioBufferQueue *packet;
+    Uint32 orig_tail_len;
+    Uint32 orig_queued;
+
+    if (!device) {
+        return -1;              /* get_audio_device() will have set the error state */
+    }
+
+    if (device->spec.callback != SDL_BufferQueueDrainCallback) {
+        SDL_SetError("Audio device has a callback, queueing not allowed");
         return -1;
     }
 
-    stream->max_len = max_len;
-    stream->read_pos = 0;
-    stream->write_pos = 0;
+    if (len == 0) {
+        return 0;
+    }
+
+    current_audio.impl.LockDevice(device);
 
-    /* Zero out the buffer */
-    SDL_memset(stream->buffer, silence, max_len);
+    orig_tail = device->buffer_queue_tail;
+    orig_tail_len = (orig_tail) ? orig_tail->datalen : 0;
+    orig_queued = device->queued_bytes;
+
+    while (len > 0) {
+        packet = device->buffer_queue_tail;
+        if ((packet == NULL) ||
+            (packet->datalen >= SDL_AUDIOBUFFERQUEUE_PACKETLEN)) {
+            /* the tail is full; take a spare packet, or make a new one */
+            packet = device->buffer_queue_pool;
+            if (packet != NULL) {
+                device->buffer_queue_pool = packet->next;
+            } else {
+                packet = (SDL_AudioBufferQueue *) SDL_malloc(sizeof (SDL_AudioBufferQueue));
+                if (packet == NULL) {
+                    /* roll back to where we started, so nothing is half queued */
+                    if (orig_tail == NULL) {
+                        packet = device->buffer_queue_head;
+                        device->buffer_queue_head = NULL;
+                    } else {
+                        packet = orig_tail->next;
+                        orig_tail->next = NULL;
+                        orig_tail->datalen = orig_tail_len;
+                    }
+                    device->buffer_queue_tail = orig_tail;
+                    device->queued_bytes = orig_queued;
+                    /* the new packets are fine to reuse */
+                    while (packet) {
+                        SDL_AudioBufferQueue *next = packet->next;
+                        packet->next = device->buffer_queue_pool;
+                        device->buffer_queue_pool = packet;
+                        packet = next;
+                    }
+                    current_audio.impl.UnlockDevice(device);
+                    SDL_OutOfMemory();
+                    return -1;
+                }
+            }
+
+            packet->datalen = 0;
+            packet->startpos = 0;
+            packet->next = NULL;
+            if (device->buffer_queue_tail == NULL) {
+                device->buffer_queue_head = packet;
+            } else {
+                device->buffer_queue_tail->next = packet;
+            }
+            device->buffer_queue_tail = packet;
+        } else {
+            const Uint32 datalen = SDL_min(len, SDL_AUDIOBUFFERQUEUE_PACKETLEN - packet->datalen);
+            SDL_memcpy(packet->data + packet->datalen, data, datalen);
+            data += datalen;
+            len -= datalen;
+            packet->datalen += datalen;
+            device->queued_bytes += datalen;
+        }
+    }
+
+    current_audio.impl.UnlockDevice(device);
 
     return 0;
 }
-#endif
 
-/* Deinitialize the stream simply by freeing the buffer */
-static void
-SDL_StreamDeinit(SDL_AudioStreamer * stream)
+Uint32
+SDL_GetQueuedAudioSize(SDL_AudioDeviceID devid)
 {
-    if (stream->buffer != NULL) {
-        SDL_free(stream->buffer);
+    Uint32 retval = 0;
+    SDL_AudioDevice *device = get_audio_device(devid);
+
+    /* Nothing to do unless we're set up for queueing. */
+    if (device && (device->spec.callback == SDL_BufferQueueDrainCallback)) {
+        current_audio.impl.LockDevice(device);
+        retval = device->queued_bytes;
+        current_audio.impl.UnlockDevice(device);
+    }
+
+    return retval;
+}
+
+void
+SDL_ClearQueuedAudio(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    SDL_AudioBufferQueue *buffer;
+
+    if (!device) {
+        return;                 /* nothing to do. */
+    }
+
+    /* Blank out the device and release the lock. Free everything else outside the lock. */
+    current_audio.impl.LockDevice(device);
+    buffer = device->buffer_queue_head;
+    device->buffer_queue_tail = NULL;
+    device->buffer_queue_head = NULL;
+    device->queued_bytes = 0;
+
+    /* the packets go back to the pool rather than the heap */
+    while (buffer) {
+        SDL_AudioBufferQueue *next = buffer->next;
+        buffer->next = device->buffer_queue_pool;
+        device->buffer_queue_pool = buffer;
+        buffer = next;
     }
+    current_audio.impl.UnlockDevice(device);
 }
 
 #if defined(ANDROID)
 #include <android/log.h>
 #endif
 
+/*
+ * Statistics for SDL_GetAudioDeviceStats(). The audio threads time things
+ *  with the performance counter and keep the totals in microseconds, under
+ *  mixer_lock so the app gets a consistent snapshot.
+ */
+static void
+SDL_LockAudioStats(SDL_AudioDevice * device)
+{
+    if (device->mixer_lock != NULL) {
+        SDL_LockMutex(device->mixer_lock);
+    }
+}
+
+static void
+SDL_UnlockAudioStats(SDL_AudioDevice * device)
+{
+    if (device->mixer_lock != NULL) {
+        SDL_UnlockMutex(device->mixer_lock);
+    }
+}
+
+static Uint32
+SDL_AudioTicksToMicroseconds(Uint64 ticks)
+{
+    return (Uint32) ((ticks * 1000000) / SDL_GetPerformanceFrequency());
+}
+
+/* Run the callback once and time it. The caller holds mixer_lock. */
+static void
+SDL_AudioRunCallback(SDL_AudioDevice * device, Uint8 * stream, int len)
+{
+    SDL_AudioDeviceStats *stats = &device->stats;
+    const Uint64 start = SDL_GetPerformanceCounter();
+    Uint64 ticks;
+    Uint32 us;
+    int bucket = 0;
+
+    (*device->spec.callback) (device->spec.userdata, stream, len);
+
+    ticks = SDL_GetPerformanceCounter() - start;
+    us = SDL_AudioTicksToMicroseconds(ticks);
+    while ((us >> bucket) && (bucket < SDL_AUDIO_HISTOGRAM_BUCKETS - 1)) {
+        bucket++;
+    }
+    stats->callbacks++;
+    stats->callback_histogram[bucket]++;
+    stats->callback_us += us;
+    if (us > stats->callback_max_us) {
+        stats->callback_max_us = us;
+    }
+    if (ticks > device->callback_period_ticks) {
+        stats->late_callbacks++;
+    }
+}
+
+/* Account for format conversion that started at (start) */
+static void
+SDL_AudioStatsConvert(SDL_AudioDevice * device, Uint64 start)
+{
+    const Uint32 us =
+        SDL_AudioTicksToMicroseconds(SDL_GetPerformanceCounter() - start);
+    SDL_LockAudioStats(device);
+    device->stats.convert_us += us;
+    SDL_UnlockAudioStats(device);
+}
+
+/* Account for one buffer played or recorded, (buffered) bytes in the
+   device format waiting behind it, and (wait) ticks spent on the device */
+static void
+SDL_AudioStatsPeriod(SDL_AudioDevice * device, Uint64 timestamp,
+                     Uint64 wait, int underrun, int buffered)
+{
+    SDL_AudioDeviceStats *stats = &device->stats;
+    const Uint32 wait_us = SDL_AudioTicksToMicroseconds(wait);
+    const int frame_size = (SDL_AUDIO_BITSIZE(device->spec.format) / 8) *
+        device->spec.channels;
+
+    SDL_LockAudioStats(device);
+    if (timestamp) {
+        device->timestamp = timestamp;
+    }
+    stats->periods++;
+    if (underrun) {
+        stats->underruns++;
+    }
+    stats->wait_us += wait_us;
+    if (wait_us < stats->wait_min_us) {
+        stats->wait_min_us = wait_us;
+    }
+    stats->queued_frames = (Uint32) (buffered / frame_size) +
+        (device->queued_bytes / device->callback_frame_size);
+    SDL_UnlockAudioStats(device);
+}
+
+/* The driver had no buffer for us, so a period went to fake_stream */
+static void
+SDL_AudioStatsDropped(SDL_AudioDevice * device)
+{
+    SDL_LockAudioStats(device);
+    device->stats.fake_buffers++;
+    SDL_UnlockAudioStats(device);
+}
+
+/* Block until the device is unpaused or closed */
+static void
+SDL_WaitAudioUnpaused(SDL_AudioDevice * device)
+{
+    SDL_LockMutex(device->state_lock);
+    while (device->enabled && device->paused) {
+        SDL_CondWait(device->state_cond, device->state_lock);
+    }
+    SDL_UnlockMutex(device->state_lock);
+}
+
+/* Change (paused) or (enabled) and wake up any thread waiting on them */
+static void
+SDL_SetAudioDeviceState(SDL_AudioDevice * device, int enabled, int paused)
+{
+    SDL_LockMutex(device->state_lock);
+    device->enabled = enabled;
+    device->paused = paused;
+    SDL_UnlockMutex(device->state_lock);
+    SDL_CondBroadcast(device->state_cond);
+}
+
+/* The mixing thread function, used when the callback runs ahead via the ring */
+static int SDLCALL
+SDL_RunAudioMixer(void *devicep)
+{
+    SDL_AudioDevice *device = (SDL_AudioDevice *) devicep;
+    SDL_AudioRing *ring = &device->ring;
+    const Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
+    Uint8 *stream;
+    Uint64 start;
+    int frame_size;
+    int len;
+
+    /* The callback is as latency sensitive as the device itself */
+    SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
+
+    /* The callback runs on this thread, so the lock is ours to skip */
+    device->threadid = SDL_ThreadID();
+
+    stream = (device->stream) ? device->callback_buf : ring->mixbuf;
+    frame_size = (SDL_AUDIO_BITSIZE(device->spec.format) / 8) *
+        device->spec.channels;
+
+    while (device->enabled) {
+
+        if (device->paused) {
+            SDL_WaitAudioUnpaused(device);
+            continue;
+        }
+
+        if (device->stream) {
+            /* Mix another period once the stream ran dry, then move as
+               much converted data along as fits in the ring. */
+            if (SDL_AudioStreamAvailable(device->stream) < frame_size) {
+                SDL_LockMutex(device->mixer_lock);
+                SDL_AudioRunCallback(device, stream, ring->period_len);
+                SDL_UnlockMutex(device->mixer_lock);
+                start = SDL_GetPerformanceCounter();
+                SDL_AudioStreamPut(device->stream, stream, ring->period_len);
+                SDL_AudioStatsConvert(device, start);
+            }
+
+            len = SDL_min(SDL_AudioStreamAvailable(device->stream),
+                          SDL_RingSpace(ring));
+            len = SDL_min(len, ring->period_len);
+            len -= len % frame_size;
+            if (len == 0) {
+                SDL_SemWaitTimeout(ring->space, delay);
+                continue;
+            }
+            start = SDL_GetPerformanceCounter();
+            SDL_AudioStreamGet(device->stream, ring->mixbuf, len);
+            SDL_AudioStatsConvert(device, start);
+            SDL_RingWrite(ring, ring->mixbuf, len);
+            continue;
+        }
+
+        /* Only mix another period once there's room for all of it */
+        if (SDL_RingSpace(ring) < ring->period_len) {
+            SDL_SemWaitTimeout(ring->space, delay);
+            continue;
+        }
+
+        SDL_LockMutex(device->mixer_lock);
+        SDL_AudioRunCallback(device, stream, ring->period_len);
+        SDL_UnlockMutex(device->mixer_lock);
+
+        SDL_RingWrite(ring, stream, ring->period_len);
+    }
+
+    return (0);
+}
+
+/* The capture side of SDL_RunAudio(): pull a buffer from the device, then
+   feed the callback, converting through the stream if the formats differ. */
+static void
+SDL_RunAudioCapture(SDL_AudioDevice * device)
+{
+    Uint8 *stream = device->fake_stream;
+    const int stream_len = device->spec.size;
+    const Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
+    Uint64 timestamp;
+    Uint64 start;
+    int len;
+
+    while (device->enabled) {
+        start = timestamp = SDL_GetPerformanceCounter();
+        len = current_audio.impl.CaptureFromDevice(device, stream,
+                                                   stream_len, &timestamp);
+        if (len < 0) {
+            device->enabled = 0;    /* the device is gone */
+            break;
+        }
+        SDL_AudioStatsPeriod(device, 0, SDL_GetPerformanceCounter() - start,
+                             0, (device->stream) ?
+                             SDL_AudioStreamAvailable(device->stream) : 0);
+
+        /* Recording continues while paused, but the data is dropped */
+        if (device->paused) {
+            if (len == 0) {
+                SDL_Delay(delay);
+            }
+            continue;
+        }
+
+        if (device->stream) {
+            start = SDL_GetPerformanceCounter();
+            len = SDL_AudioStreamPut(device->stream, stream, len);
+            SDL_AudioStatsConvert(device, start);
+            if (len < 0) {
+                continue;
+            }
+            while (SDL_AudioStreamAvailable(device->stream) >=
+                   device->callback_len) {
+                start = SDL_GetPerformanceCounter();
+                SDL_AudioStreamGet(device->stream, device->callback_buf,
+                                   device->callback_len);
+                SDL_AudioStatsConvert(device, start);
+                SDL_LockMutex(device->mixer_lock);
+                device->timestamp = timestamp;
+                SDL_AudioRunCallback(device, device->callback_buf,
+                                     device->callback_len);
+                SDL_UnlockMutex(device->mixer_lock);
+            }
+        } else if (len > 0) {
+            SDL_LockMutex(device->mixer_lock);
+            device->timestamp = timestamp;
+            SDL_AudioRunCallback(device, stream, len);
+            SDL_UnlockMutex(device->mixer_lock);
+        } else {
+            SDL_Delay(delay);
+        }
+    }
+}
+
+/* Fill one device buffer from the callback, converting through the stream
+   if the formats differ. Returns the bytes of real audio in (stream), and
+   sets (buffered) to the converted bytes left over for the next buffer. */
+static int
+SDL_MixAudioPeriod(SDL_AudioDevice * device, Uint8 * stream, int stream_len,
+                   int *buffered)
+{
+    Uint64 start;
+    int len;
+
+    if (device->stream) {
+        /* Run the callback until there's a whole device buffer */
+        while (SDL_AudioStreamAvailable(device->stream) < stream_len) {
+            SDL_LockMutex(device->mixer_lock);
+            SDL_AudioRunCallback(device, device->callback_buf,
+                                 device->callback_len);
+            SDL_UnlockMutex(device->mixer_lock);
+            start = SDL_GetPerformanceCounter();
+            len = SDL_AudioStreamPut(device->stream, device->callback_buf,
+                                     device->callback_len);
+            SDL_AudioStatsConvert(device, start);
+            if (len < 0) {
+                break;
+            }
+        }
+        start = SDL_GetPerformanceCounter();
+        len = SDL_AudioStreamGet(device->stream, stream, stream_len);
+        SDL_AudioStatsConvert(device, start);
+        if (len < 0) {
+            len = 0;
+        }
+        if (len < stream_len) {
+            SDL_memset(stream + len, device->spec.silence, stream_len - len);
+        }
+        *buffered = SDL_AudioStreamAvailable(device->stream);
+        return len;
+    }
+
+    /* Fill the current buffer with sound */
+    SDL_LockMutex(device->mixer_lock);
+    SDL_AudioRunCallback(device, stream, stream_len);
+    SDL_UnlockMutex(device->mixer_lock);
+    *buffered = 0;
+    return stream_len;
+}
+
+/* Mix and play a single buffer for the shared scheduler, then return the
+   performance counter value at which the device wants the next one. */
+Uint64
+SDL_RunAudioPeriod(SDL_AudioDevice * device)
+{
+    Uint8 *stream;
+    Uint64 played;
+    Uint64 deadline;
+    int stream_len = device->spec.size;
+    int buffered;
+    int len;
+
+    if (!device->enabled || device->paused) {
+        return 0;
+    }
+
+    stream = current_audio.impl.GetDeviceBuf(device);
+    if (stream == NULL) {
+        /* Mix anyway, so the callback keeps time, but drop the result */
+        SDL_MixAudioPeriod(device, device->fake_stream, stream_len, &buffered);
+        SDL_AudioStatsDropped(device);
+        return SDL_GetPerformanceCounter() +
+            ((device->spec.samples * SDL_GetPerformanceFrequency()) /
+             device->spec.freq);
+    }
+
+    len = SDL_MixAudioPeriod(device, stream, stream_len, &buffered);
+    current_audio.impl.PlayDevice(device);
+    played = SDL_GetPerformanceCounter();
+    deadline = current_audio.impl.NextDeadline(device);
+    SDL_AudioStatsPeriod(device, played,
+                         (deadline > played) ? (deadline - played) : 0,
+                         (len < stream_len), buffered);
+    return deadline;
+}
+
 /* The general mixing thread function */
 int SDLCALL
 SDL_RunAudio(void *devicep)
@@ -315,195 +869,101 @@ SDL_RunAudio(void *devicep)
     SDL_AudioDevice *device = (SDL_AudioDevice *) devicep;
     Uint8 *stream;
     int stream_len;
-    void *udata;
-    void (SDLCALL * fill) (void *userdata, Uint8 * stream, int len);
     Uint32 delay;
-    /* For streaming when the buffer sizes don't match up */
-    Uint8 *istream;
-    int istream_len = 0;
+    Uint64 played;
+    int buffered;
+    int len;
 
     /* The audio mixing is always a high priority thread */
     SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
 
     /* Perform any thread setup */
-    device->threadid = SDL_ThreadID();
+    if (!device->use_ring) {
+        device->threadid = SDL_ThreadID();
+    }
     current_audio.impl.ThreadInit(device);
 
-    /* Set up the mixing function */
-    fill = device->spec.callback;
-    udata = device->spec.userdata;
-
-    /* By default do not stream */
-    device->use_streamer = 0;
-
-    if (device->convert.needed) {
-#if 0                           /* !!! FIXME: I took len_div out of the structure. Use rate_incr instead? */
-        /* If the result of the conversion alters the length, i.e. resampling is being used, use the streamer */
-        if (device->convert.len_mult != 1 || device->convert.len_div != 1) {
-            /* The streamer's maximum length should be twice whichever is larger: spec.size or len_cvt */
-            stream_max_len = 2 * device->spec.size;
-            if (device->convert.len_mult > device->convert.len_div) {
-                stream_max_len *= device->convert.len_mult;
-                stream_max_len /= device->convert.len_div;
-            }
-            if (SDL_StreamInit(&device->streamer, stream_max_len, silence) <
-                0)
-                return -1;
-            device->use_streamer = 1;
-
-            /* istream_len should be the length of what we grab from the callback and feed to conversion,
-               so that we get close to spec_size. I.e. we want device.spec_size = istream_len * u / d
-             */
-            istream_len =
-                device->spec.size * device->convert.len_div /
-                device->convert.len_mult;
-        }
-#endif
-
-        /* stream_len = device->convert.len; */
-        stream_len = device->spec.size;
-    } else {
-        stream_len = device->spec.size;
-    }
+    stream_len = device->spec.size;
 
-    /* Calculate the delay while paused */
+    /* Calculate the delay when the device has no buffer for us */
     delay = ((device->spec.samples * 1000) / device->spec.freq);
 
-    /* Determine if the streamer is necessary here */
-    if (device->use_streamer == 1) {
-        /* This code is almost the same as the old code. The difference is, instead of reading
-           directly from the callback into "stream", then converting and sending the audio off,
-           we go: callback -> "istream" -> (conversion) -> streamer -> stream -> device.
-           However, reading and writing with streamer are done separately:
-           - We only call the callback and write to the streamer when the streamer does not
-           contain enough samples to output to the device.
-           - We only read from the streamer and tell the device to play when the streamer
-           does have enough samples to output.
-           This allows us to perform resampling in the conversion step, where the output of the
-           resampling process can be any number. We will have to see what a good size for the
-           stream's maximum length is, but I suspect 2*max(len_cvt, stream_len) is a good figure.
+    /* Capture devices run the other way: record, then hand to the callback */
+    if (device->iscapture && current_audio.impl.CaptureFromDevice) {
+        SDL_RunAudioCapture(device);
+        return (0);
+    }
+
+    /* Determine if the ring is in use here */
+    if (device->use_ring) {
+        /* The callback and any conversion happen on the mixing thread, which
+           stays up to a few periods ahead of us. All that's left to do here
+           is to hand the device one buffer at a time out of the ring. If the
+           mixing thread fell behind, the rest of the buffer is silence.
          */
         while (device->enabled) {
 
             if (device->paused) {
-                SDL_Delay(delay);
+                SDL_WaitAudioUnpaused(device);
                 continue;
             }
 
-            /* Only read in audio if the streamer doesn't have enough already (if it does not have enough samples to output) */
-            if (SDL_StreamLength(&device->streamer) < stream_len) {
-                /* Set up istream */
-                if (device->convert.needed) {
-                    if (device->convert.buf) {
-                        istream = device->convert.buf;
-                    } else {
-                        continue;
-                    }
-                } else {
-/* FIXME: Ryan, this is probably wrong.  I imagine we don't want to get
- * a device buffer both here and below in the stream output.
- */
-                    istream = current_audio.impl.GetDeviceBuf(device);
-                    if (istream == NULL) {
-                        istream = device->fake_stream;
-                    }
-                }
-
-                /* Read from the callback into the _input_ stream */
-                SDL_LockMutex(device->mixer_lock);
-                (*fill) (udata, istream, istream_len);
-                SDL_UnlockMutex(device->mixer_lock);
-
-                /* Convert the audio if necessary and write to the streamer */
-                if (device->convert.needed) {
-                    SDL_ConvertAudio(&device->convert);
-                    if (istream == NULL) {
-                        istream = device->fake_stream;
-                    }
-                    /*SDL_memcpy(istream, device->convert.buf, device->convert.len_cvt); */
-                    SDL_StreamWrite(&device->streamer, device->convert.buf,
-                                    device->convert.len_cvt);
-                } else {
-                    SDL_StreamWrite(&device->streamer, istream, istream_len);
-                }
+            stream = current_audio.impl.GetDeviceBuf(device);
+            if (stream == NULL) {
+                stream = device->fake_stream;
             }
 
-            /* Only output audio if the streamer has enough to output */
-            if (SDL_StreamLength(&device->streamer) >= stream_len) {
-                /* Set up the output stream */
-                if (device->convert.needed) {
-                    if (device->convert.buf) {
-                        stream = device->convert.buf;
-                    } else {
-                        continue;
-                    }
-                } else {
-                    stream = current_audio.impl.GetDeviceBuf(device);
-                    if (stream == NULL) {
-                        stream = device->fake_stream;
-                    }
-                }
-
-                /* Now read from the streamer */
-                SDL_StreamRead(&device->streamer, stream, stream_len);
-
-                /* Ready current buffer for play and change current buffer */
-                if (stream != device->fake_stream) {
-                    current_audio.impl.PlayDevice(device);
-                    /* Wait for an audio buffer to become available */
-                    current_audio.impl.WaitDevice(device);
-                } else {
-                    SDL_Delay(delay);
-                }
+            len = SDL_RingRead(&device->ring, stream, stream_len);
+            if (len < stream_len) {
+                SDL_memset(stream + len, device->spec.silence,
+                           stream_len - len);
             }
+            SDL_SemPost(device->ring.space);
 
+            /* Ready current buffer for play and change current buffer */
+            if (stream != device->fake_stream) {
+                buffered = SDL_RingLength(&device->ring);
+                current_audio.impl.PlayDevice(device);
+                played = SDL_GetPerformanceCounter();
+                /* Wait for an audio buffer to become available */
+                current_audio.impl.WaitDevice(device);
+                SDL_AudioStatsPeriod(device, played,
+                                     SDL_GetPerformanceCounter() - played,
+                                     (len < stream_len), buffered);
+            } else {
+                SDL_AudioStatsDropped(device);
+                SDL_Delay(delay);
+            }
         }
     } else {
-        /* Otherwise, do not use the streamer. This is the old code. */
+        /* Otherwise, do not use the ring. This is the old code. */
 
         /* Loop, filling the audio buffers */
         while (device->enabled) {
 
             if (device->paused) {
-                SDL_Delay(delay);
+                SDL_WaitAudioUnpaused(device);
                 continue;
             }
 
-            /* Fill the current buffer with sound */
-            if (device->convert.needed) {
-                if (device->convert.buf) {
-                    stream = device->convert.buf;
-                } else {
-                    continue;
-                }
-            } else {
-                stream = current_audio.impl.GetDeviceBuf(device);
-                if (stream == NULL) {
-                    stream = device->fake_stream;
-                }
+            stream = current_audio.impl.GetDeviceBuf(device);
+            if (stream == NULL) {
+                stream = device->fake_stream;
             }
 
-            SDL_LockMutex(device->mixer_lock);
-            (*fill) (udata, stream, stream_len);
-            SDL_UnlockMutex(device->mixer_lock);
-
-            /* Convert the audio if necessary */
-            if (device->convert.needed) {
-                SDL_ConvertAudio(&device->convert);
-                stream = current_audio.impl.GetDeviceBuf(device);
-                if (stream == NULL) {
-                    stream = device->fake_stream;
-                }
-                SDL_memcpy(stream, device->convert.buf,
-                           device->convert.len_cvt);
-            }
+            len = SDL_MixAudioPeriod(device, stream, stream_len, &buffered);
 
             /* Ready current buffer for play and change current buffer */
             if (stream != device->fake_stream) {
                 current_audio.impl.PlayDevice(device);
+                played = SDL_GetPerformanceCounter();
                 /* Wait for an audio buffer to become available */
                 current_audio.impl.WaitDevice(device);
+                SDL_AudioStatsPeriod(device, played,
+                                     SDL_GetPerformanceCounter() - played,
+                                     (len < stream_len), buffered);
             } else {
+                SDL_AudioStatsDropped(device);
                 SDL_Delay(delay);
             }
         }
@@ -512,10 +972,6 @@ SDL_RunAudio(void *devicep)
     /* Wait for the audio to drain.. */
     current_audio.impl.WaitDone(device);
 
-    /* If necessary, deinit the streamer */
-    if (device->use_streamer == 1)
-        SDL_StreamDeinit(&device->streamer);
-
     return (0);
 }
 
@@ -755,19 +1211,45 @@ no_such_device:
 static void
 close_audio_device(SDL_AudioDevice * device)
 {
-    device->enabled = 0;
+    if ((device->state_lock != NULL) && (device->state_cond != NULL)) {
+        SDL_SetAudioDeviceState(device, 0, device->paused);
+    } else {
+        device->enabled = 0;
+    }
+    if (device->mixer_thread != NULL) {
+        SDL_SemPost(device->ring.space);
+        SDL_WaitThread(device->mixer_thread, NULL);
+    }
     if (device->thread != NULL) {
         SDL_WaitThread(device->thread, NULL);
     }
+    if (device->scheduled) {
+        SDL_UnscheduleAudioDevice(device);
+        current_audio.impl.WaitDone(device);
+    }
+    if (device->use_ring) {
+        SDL_RingDeinit(&device->ring);
+    }
     if (device->mixer_lock != NULL) {
         SDL_DestroyMutex(device->mixer_lock);
     }
+    if (device->state_cond != NULL) {
+        SDL_DestroyCond(device->state_cond);
+    }
+    if (device->state_lock != NULL) {
+        SDL_DestroyMutex(device->state_lock);
+    }
     if (device->fake_stream != NULL) {
         SDL_FreeAudioMem(device->fake_stream);
     }
-    if (device->convert.needed) {
-        SDL_FreeAudioMem(device->convert.buf);
+    if (device->stream != NULL) {
+        SDL_FreeAudioStream(device->stream);
     }
+    if (device->callback_buf != NULL) {
+        SDL_FreeAudioMem(device->callback_buf);
+    }
+    free_audio_queue(device->buffer_queue_head);
+    free_audio_queue(device->buffer_queue_pool);
     if (device->opened) {
         current_audio.impl.CloseDevice(device);
         device->opened = 0;
@@ -786,11 +1268,6 @@ prepare_audiospec(const SDL_AudioSpec * orig, SDL_AudioSpec * prepared)
 {
     SDL_memcpy(prepared, orig, sizeof(SDL_AudioSpec));
 
-    if (orig->callback == NULL) {
-        SDL_SetError("SDL_OpenAudio() passed a NULL callback");
-        return 0;
-    }
-
     if (orig->freq == 0) {
         const char *env = SDL_getenv("SDL_AUDIO_FREQUENCY");
         if ((!env) || ((prepared->freq = SDL_atoi(env)) == 0)) {
@@ -853,6 +1330,8 @@ open_audio_device(const char *devname, int iscapture,
     SDL_AudioSpec _obtained;
     SDL_AudioDevice *device;
     SDL_bool build_cvt;
+    int ring_periods = 0;
+    int shared_threads = 0;
     int i = 0;
 
     if (!SDL_WasInit(SDL_INIT_AUDIO)) {
@@ -917,6 +1396,12 @@ open_audio_device(const char *devname, int iscapture,
         }
     }
 
+    /* Recorded audio can only be delivered through a callback */
+    if ((iscapture) && (obtained->callback == NULL)) {
+        SDL_SetError("Audio capture requires a callback");
+        return 0;
+    }
+
     device = (SDL_AudioDevice *) SDL_AllocAudioMem(sizeof(SDL_AudioDevice));
     if (device == NULL) {
         SDL_OutOfMemory();
@@ -924,6 +1409,12 @@ open_audio_device(const char *devname, int iscapture,
     }
     SDL_memset(device, '\0', sizeof(SDL_AudioDevice));
     device->spec = *obtained;
+
+    /* No callback means the app pushes data with SDL_QueueAudio() */
+    if (device->spec.callback == NULL) {
+        device->spec.callback = SDL_BufferQueueDrainCallback;
+        device->spec.userdata = device;
+    }
     device->enabled = 1;
     device->paused = 1;
     device->iscapture = iscapture;
@@ -938,6 +1429,15 @@ open_audio_device(const char *devname, int iscapture,
         }
     }
 
+    /* Paused threads sleep on this until they have something to do */
+    device->state_lock = SDL_CreateMutex();
+    device->state_cond = SDL_CreateCond();
+    if ((device->state_lock == NULL) || (device->state_cond == NULL)) {
+        close_audio_device(device);
+        SDL_SetError("Couldn't create device state lock");
+        return 0;
+    }
+
     /* force a device detection if we haven't done one yet. */
     if ( ((iscapture) && (current_audio.inputDevices == NULL)) ||
          ((!iscapture) && (current_audio.outputDevices == NULL)) )
@@ -963,6 +1463,36 @@ open_audio_device(const char *devname, int iscapture,
         SDL_CalculateAudioSpec(obtained);
     }
 
+    /* Feed this device from the shared scheduler instead of its own thread? */
+    if ((!iscapture) && (!current_audio.impl.ProvidesOwnCallbackThread) &&
+        (current_audio.impl.NextDeadline != NULL)) {
+        const char *hint = SDL_GetHint(SDL_HINT_AUDIO_SHARED_THREADS);
+        shared_threads = (hint) ? SDL_atoi(hint) : 0;
+        if (shared_threads > 0) {
+            device->scheduled = 1;
+        }
+    }
+
+    /* Let the callback run ahead of the device by a few periods? */
+    if ((!iscapture) && (!current_audio.impl.ProvidesOwnCallbackThread) &&
+        (!device->scheduled)) {
+        const char *hint = SDL_GetHint(SDL_HINT_AUDIO_RING_PERIODS);
+        ring_periods = (hint) ? SDL_atoi(hint) : 0;
+        if (ring_periods >= 2) {
+            int period_samples = 0;
+            hint = SDL_GetHint(SDL_HINT_AUDIO_RING_PERIOD_SAMPLES);
+            if (hint) {
+                period_samples = SDL_atoi(hint);
+            }
+            if (period_samples > 0) {
+                /* spec.samples is 16 bits, don't let a large value wrap */
+                obtained->samples = (Uint16) SDL_min(period_samples, 0xFFFF);
+                SDL_CalculateAudioSpec(obtained);
+            }
+            device->use_ring = 1;
+        }
+    }
+
     /* See if we need to do any conversion */
     build_cvt = SDL_FALSE;
     if (obtained->freq != device->spec.freq) {
@@ -987,27 +1517,52 @@ open_audio_device(const char *devname, int iscapture,
         }
     }
     if (build_cvt) {
-        /* Build an audio conversion block */
-        if (SDL_BuildAudioCVT(&device->convert,
-                              obtained->format, obtained->channels,
-                              obtained->freq,
-                              device->spec.format, device->spec.channels,
-                              device->spec.freq) < 0) {
+        /* Set up a stream to convert the callback's data for the device,
+           or the device's recording for the callback */
+        if (iscapture) {
+            device->stream = SDL_NewAudioStream(device->spec.format,
+                                                device->spec.channels,
+                                                device->spec.freq,
+                                                obtained->format,
+                                                obtained->channels,
+                                                obtained->freq);
+        } else {
+            device->stream = SDL_NewAudioStream(obtained->format,
+                                                obtained->channels,
+                                                obtained->freq,
+                                                device->spec.format,
+                                                device->spec.channels,
+                                                device->spec.freq);
+        }
+        if (device->stream == NULL) {
             close_audio_device(device);
             return 0;
         }
-        if (device->convert.needed) {
-            device->convert.len = (int) (((double) obtained->size) /
-                                         device->convert.len_ratio);
-
-            device->convert.buf =
-                (Uint8 *) SDL_AllocAudioMem(device->convert.len *
-                                            device->convert.len_mult);
-            if (device->convert.buf == NULL) {
-                close_audio_device(device);
-                SDL_OutOfMemory();
-                return 0;
-            }
+        device->callback_format = obtained->format;
+        device->callback_len = obtained->size;
+        device->callback_buf = (Uint8 *) SDL_AllocAudioMem(obtained->size);
+        if (device->callback_buf == NULL) {
+            close_audio_device(device);
+            SDL_OutOfMemory();
+            return 0;
+        }
+    }
+
+    /* For the statistics: how long one callback buffer lasts, and the size
+       of a frame as the callback sees it */
+    device->callback_period_ticks = (obtained->samples *
+        SDL_GetPerformanceFrequency()) / obtained->freq;
+    device->callback_frame_size = (SDL_AUDIO_BITSIZE(obtained->format) / 8) *
+        obtained->channels;
+    device->stats.wait_min_us = 0xFFFFFFFF;
+
+    if (device->use_ring) {
+        /* Enough room for (ring_periods) of whichever side moves more data */
+        int ring_len = SDL_max(obtained->size, device->spec.size) * ring_periods;
+        if (SDL_RingInit(&device->ring, ring_len, obtained->size) < 0) {
+            close_audio_device(device);
+            SDL_OutOfMemory();
+            return 0;
         }
     }
 
@@ -1025,8 +1580,15 @@ open_audio_device(const char *devname, int iscapture,
         return 0;
     }
 
-    /* Start the audio thread if necessary */
-    if (!current_audio.impl.ProvidesOwnCallbackThread) {
+    /* Hand the device to the shared scheduler, if it's being used */
+    if (device->scheduled) {
+        if (SDL_ScheduleAudioDevice(device, shared_threads) < 0) {
+            device->scheduled = 0;
+            SDL_CloseAudioDevice(id + 1);
+            return 0;
+        }
+    } else if (!current_audio.impl.ProvidesOwnCallbackThread) {
+        /* Start the audio thread if necessary */
         /* Start the audio thread */
         char name[64];
         SDL_snprintf(name, sizeof (name), "SDLAudioDev%d", (int) (id + 1));
@@ -1042,6 +1604,21 @@ open_audio_device(const char *devname, int iscapture,
             SDL_SetError("Couldn't create audio thread");
             return 0;
         }
+
+        /* Start the mixing thread, if the callback runs ahead */
+        if (device->use_ring) {
+            SDL_snprintf(name, sizeof (name), "SDLAudioMix%d", (int) (id + 1));
+#if defined(__WIN32__) && !defined(HAVE_LIBC)
+            device->mixer_thread = SDL_CreateThread(SDL_RunAudioMixer, name, device, NULL, NULL);
+#else
+            device->mixer_thread = SDL_CreateThread(SDL_RunAudioMixer, name, device);
+#endif
+            if (device->mixer_thread == NULL) {
+                SDL_CloseAudioDevice(id + 1);
+                SDL_SetError("Couldn't create audio mixing thread");
+                return 0;
+            }
+        }
     }
 
     return id + 1;
@@ -1102,6 +1679,53 @@ SDL_GetAudioDeviceStatus(SDL_AudioDeviceID devid)
 }
 
 
+Uint64
+SDL_GetAudioDeviceTimestamp(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    Uint64 timestamp = 0;
+    if (device) {
+        SDL_LockAudioStats(device);
+        timestamp = device->timestamp;
+        SDL_UnlockAudioStats(device);
+    }
+    return (timestamp);
+}
+
+
+int
+SDL_GetAudioDeviceStats(SDL_AudioDeviceID devid, SDL_AudioDeviceStats * stats)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    if (!device) {
+        return -1;
+    }
+    if (!stats) {
+        SDL_InvalidParamError("stats");
+        return -1;
+    }
+    SDL_LockAudioStats(device);
+    *stats = device->stats;
+    SDL_UnlockAudioStats(device);
+    if (stats->wait_min_us == 0xFFFFFFFF) {
+        stats->wait_min_us = 0;     /* never waited */
+    }
+    return 0;
+}
+
+void
+SDL_ResetAudioDeviceStats(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    if (device) {
+        SDL_LockAudioStats(device);
+        SDL_zero(device->stats);
+        device->stats.wait_min_us = 0xFFFFFFFF;
+        SDL_UnlockAudioStats(device);
+    }
+}
+
+
 SDL_AudioStatus
 SDL_GetAudioStatus(void)
 {
@@ -1113,7 +1737,10 @@ SDL_PauseAudioDevice(SDL_AudioDeviceID devid, int pause_on)
 {
     SDL_AudioDevice *device = get_audio_device(devid);
     if (device) {
-        device->paused = pause_on;
+        SDL_SetAudioDeviceState(device, device->enabled, pause_on);
+        if (device->scheduled) {
+            SDL_WakeAudioScheduler();
+        }
     }
 }
 
@@ -1179,6 +1806,7 @@ SDL_AudioQuit(void)
     for (i = 0; i < SDL_arraysize(open_devices); i++) {
         SDL_CloseAudioDevice(i);
     }
+    SDL_QuitAudioScheduler();
 
     /* Free the driver data */
     current_audio.impl.Deinitialize();
@@ -1188,6 +1816,8 @@ SDL_AudioQuit(void)
                      &current_audio.inputDeviceCount);
     SDL_memset(&current_audio, '\0', sizeof(current_audio));
     SDL_memset(open_devices, '\0', sizeof(open_devices));
+
+    SDL_QuitAudioResampler();
 }
 
 #define NUM_FORMATS 10
@@ -1265,8 +1895,8 @@ SDL_MixAudio(Uint8 * dst, const Uint8 * src, Uint32 len, int volume)
     SDL_AudioDevice *device = get_audio_device(1);
     if (device != NULL) {
         SDL_AudioFormat format;
-        if (device->convert.needed) {
-            format = device->convert.src_format;
+        if (device->stream) {
+            format = device->callback_format;
         } else {
             format = device->spec.format;
         }
@@ -22,6 +22,8 @@
 
 /* Functions and variables exported from SDL_audio.c for SDL_sysaudio.c */
 
+struct SDL_AudioDevice;
+
 /* Functions to get a list of "close" audio formats */
 extern SDL_AudioFormat SDL_FirstAudioFormat(SDL_AudioFormat format);
 extern SDL_AudioFormat SDL_NextAudioFormat(void);
@@ -32,6 +34,18 @@ extern void SDL_CalculateAudioSpec(SDL_AudioSpec * spec);
 /* The actual mixing thread function */
 extern int SDLCALL SDL_RunAudio(void *audiop);
 
+/* Mix and play one buffer on a scheduled device; returns the performance
+   counter value at which the next one is due, or 0 if it's due right away */
+extern Uint64 SDL_RunAudioPeriod(struct SDL_AudioDevice *device);
+
+/* The shared scheduler (SDL_audioscheduler.c), used for output devices when
+   SDL_HINT_AUDIO_SHARED_THREADS is set. Devices are fed by (threads) threads
+   in total; the first device scheduled decides how many. */
+extern int SDL_ScheduleAudioDevice(struct SDL_AudioDevice *device, int threads);
+extern void SDL_UnscheduleAudioDevice(struct SDL_AudioDevice *device);
+extern void SDL_WakeAudioScheduler(void);
+extern void SDL_QuitAudioScheduler(void);
+
 /* this is used internally to access some autogenerated code. */
 typedef struct
 {
@@ -52,4 +66,59 @@ typedef struct
 } SDL_AudioRateFilters;
 extern const SDL_AudioRateFilters sdl_audio_rate_filters[];
 
+/* AVX2 kernels are built with a per-function target attribute so the rest
+   of the library does not require an AVX2-capable CPU.  They must only be
+   called after SDL_HasAVX2() returned true. */
+#if (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) || defined(__clang__)) && \
+    (defined(__i386__) || defined(__x86_64__)) && !defined(SDL_DISABLE_AVX2)
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGETING_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (_MSC_VER >= 1700) && (defined(_M_IX86) || defined(_M_X64)) && !defined(SDL_DISABLE_AVX2)
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGETING_AVX2
+#endif
+
+/* Windowed-sinc resampler for arbitrary rate ratios (SDL_audioresample.c).
+   The resampler works on interleaved float samples and keeps its filter
+   history between calls, so a stream can be fed in pieces of any size. */
+typedef struct SDL_AudioResampler SDL_AudioResampler;
+
+extern SDL_AudioResampler *SDL_NewAudioResampler(int channels, int src_rate, int dst_rate);
+extern void SDL_FreeAudioResampler(SDL_AudioResampler * resampler);
+extern void SDL_ResetAudioResampler(SDL_AudioResampler * resampler);
+
+/* Like SDL_NewAudioResampler() and SDL_FreeAudioResampler(), but released
+   resamplers are kept in a small pool and handed back out, reset, to the
+   next caller asking for the same channels and rates. */
+extern SDL_AudioResampler *SDL_AcquireAudioResampler(int channels, int src_rate, int dst_rate);
+extern void SDL_ReleaseAudioResampler(SDL_AudioResampler * resampler);
+
+/* Upper bound on the frames produced after feeding `inframes` more frames */
+extern int SDL_AudioResamplerMaxOutput(SDL_AudioResampler * resampler, int inframes);
+
+/* Queue `inframes` frames from `in` (may be NULL if inframes is 0) and write
+   up to `outframes` resampled frames to `out`.  Returns the frames written,
+   or -1 on error.  Input that cannot be consumed yet stays buffered. */
+extern int SDL_AudioResamplerProcess(SDL_AudioResampler * resampler,
+                                     const float *in, int inframes,
+                                     float *out, int outframes);
+
+/* Queue enough silence to push the remaining input through the filter */
+extern int SDL_AudioResamplerFlush(SDL_AudioResampler * resampler);
+
+/* Drop the pooled resamplers and cached filter tables; called from
+   SDL_AudioQuit() */
+extern void SDL_QuitAudioResampler(void);
+
+/* Channel matrix remixer (SDL_audioremix.c).  Works on AUDIO_S16SYS and
+   AUDIO_F32SYS data with up to 8 channels; (matrix) has dst_channels rows
+   of src_channels weights.  (src) and (dst) may be the same buffer. */
+extern void SDL_RemixAudioFrames(SDL_AudioFormat src_fmt, int src_channels,
+                                 const void *src, SDL_AudioFormat dst_fmt,
+                                 int dst_channels, void *dst,
+                                 const float *matrix, int frames);
+
+/* The default up/downmix between mono, stereo, quad and 5.1, or NULL */
+extern const float *SDL_GetDefaultRemixMatrix(int src_channels, int dst_channels);
+
 /* vi: set ts=4 sw=4 expandtab: */
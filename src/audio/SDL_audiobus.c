@@ -0,0 +1,497 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* A float mixing bus.
+
+   Every voice owns an SDL_AudioStream that turns its audio into
+   AUDIO_F32SYS at the bus channel count and rate, so each sample is
+   converted exactly once.  Mixing multiplies by the per-channel voice
+   gains and adds into a float accumulator without any clipping; only the
+   final sum is clipped, optionally dithered, and converted to the bus
+   format. */
+
+#include "SDL_audio.h"
+#include "SDL_cpuinfo.h"
+
+typedef struct SDL_AudioBusVoice
+{
+    SDL_AudioStream *stream;    /* converts to AUDIO_F32SYS, bus layout */
+    float gains[8];             /* one gain per bus channel */
+    float *pattern;             /* gains repeated for 4 frames */
+} SDL_AudioBusVoice;
+
+struct SDL_AudioBus
+{
+    SDL_AudioFormat format;
+    int channels;
+    int rate;
+    int sample_size;            /* bytes per sample in the bus format */
+    SDL_AudioBusVoice **voices;
+    int num_voices;
+    float *accum;
+    float *scratch;
+    int buffer_samples;         /* size of accum and scratch */
+    Uint32 dither_seed;
+};
+
+
+static SDL_AudioBusVoice *
+SDL_GetAudioBusVoice(SDL_AudioBus * bus, int voice)
+{
+    if (bus == NULL) {
+        SDL_InvalidParamError("bus");
+        return NULL;
+    }
+    if ((voice < 0) || (voice >= bus->num_voices) || (bus->voices[voice] == NULL)) {
+        SDL_SetError("Invalid audio bus voice");
+        return NULL;
+    }
+    return bus->voices[voice];
+}
+
+static void
+SDL_FreeAudioBusVoice(SDL_AudioBusVoice * voice)
+{
+    if (voice) {
+        SDL_FreeAudioStream(voice->stream);
+        SDL_free(voice->pattern);
+        SDL_free(voice);
+    }
+}
+
+static void
+SDL_SetAudioBusVoiceGains(const SDL_AudioBus * bus, SDL_AudioBusVoice * voice,
+                          float gain, float pan)
+{
+    const float left = gain * ((pan > 0.0f) ? (1.0f - pan) : 1.0f);
+    const float right = gain * ((pan < 0.0f) ? (1.0f + pan) : 1.0f);
+    int i;
+
+    for (i = 0; i < bus->channels; i++) {
+        if ((bus->channels == 1) || ((bus->channels == 6) && ((i == 2) || (i == 3)))) {
+            voice->gains[i] = gain;     /* mono, or 5.1 center/LFE */
+        } else {
+            voice->gains[i] = (i & 1) ? right : left;
+        }
+    }
+    for (i = 0; i < bus->channels * 4; i++) {
+        voice->pattern[i] = voice->gains[i % bus->channels];
+    }
+}
+
+/* accum[i] += in[i] * gain of channel (i % channels) */
+static void
+SDL_AccumulateAudioBusVoice(float *accum, const float *in, int samples,
+                            const SDL_AudioBusVoice * voice, int channels)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        /* (pattern) holds 4 frames of gains, a whole number of vectors */
+        const int block = channels * 4;
+        int j;
+        for (; (i + block) <= samples; i += block) {
+            for (j = 0; j < block; j += 4) {
+                const __m128 x = _mm_mul_ps(_mm_loadu_ps(in + i + j),
+                                            _mm_loadu_ps(voice->pattern + j));
+                _mm_storeu_ps(accum + i + j, _mm_add_ps(_mm_loadu_ps(accum + i + j), x));
+            }
+        }
+    }
+#endif
+
+    for (; i < samples; i++) {
+        accum[i] += in[i] * voice->gains[i % channels];
+    }
+}
+
+static Uint32
+SDL_AudioBusRandom(Uint32 * seed)
+{
+    Uint32 x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return x;
+}
+
+/* Triangular dither in -1..1 LSB, from the two halves of one draw */
+static float
+SDL_AudioBusDither(Uint32 * seed)
+{
+    const Uint32 r = SDL_AudioBusRandom(seed);
+    return ((float) ((int) (r & 0xFFFF) - (int) (r >> 16))) * (1.0f / 65536.0f);
+}
+
+/* Scale one sample to minval..maxval, rounding and saturating */
+static int
+SDL_AudioBusQuantize(float f, float scale, float dither, int minval, int maxval)
+{
+    const float x = f * scale + dither;
+    int val;
+
+    if (x >= (float) maxval) {
+        return maxval;
+    } else if (x <= (float) minval) {
+        return minval;
+    }
+    val = (int) ((x < 0.0f) ? (x - 0.5f) : (x + 0.5f));
+    return val;
+}
+
+#ifdef __SSE2__
+/* The common case of a 16-bit device, 8 samples at a time */
+static int
+SDL_ConvertAudioBus_S16_SSE2(const float *accum, Sint16 * dst, int samples,
+                             int swap, SDL_bool dither, Uint32 * seed)
+{
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 maxval = _mm_set1_ps(32767.0f);
+    const __m128 minval = _mm_set1_ps(-32768.0f);
+    const __m128 lsb = _mm_set1_ps(1.0f / 65536.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 signbit = _mm_set1_ps(-0.0f);
+    const __m128i lowmask = _mm_set1_epi32(0xFFFF);
+    __m128i state;
+    int i;
+
+    /* four independent xorshift generators, one per lane */
+    state = _mm_setr_epi32((int) SDL_AudioBusRandom(seed) | 1, (int) SDL_AudioBusRandom(seed) | 1,
+                           (int) SDL_AudioBusRandom(seed) | 1, (int) SDL_AudioBusRandom(seed) | 1);
+
+    for (i = 0; (i + 8) <= samples; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(accum + i), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(accum + i + 4), scale);
+        __m128i x;
+        if (dither) {
+            int k;
+            for (k = 0; k < 2; k++) {
+                __m128 d;
+                state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+                state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+                state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+                d = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(state, lowmask),
+                                                             _mm_srli_epi32(state, 16))), lsb);
+                if (k == 0) {
+                    a = _mm_add_ps(a, d);
+                } else {
+                    b = _mm_add_ps(b, d);
+                }
+            }
+        }
+        a = _mm_max_ps(minval, _mm_min_ps(a, maxval));
+        b = _mm_max_ps(minval, _mm_min_ps(b, maxval));
+        /* round half away from zero like SDL_AudioBusQuantize, not to even */
+        a = _mm_add_ps(a, _mm_or_ps(_mm_and_ps(a, signbit), half));
+        b = _mm_add_ps(b, _mm_or_ps(_mm_and_ps(b, signbit), half));
+        x = _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b));
+        if (swap) {
+            x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        }
+        _mm_storeu_si128((__m128i *) (dst + i), x);
+    }
+    return i;
+}
+#endif
+
+/* Clip the accumulator and write it out in the bus format */
+static void
+SDL_ConvertAudioBus(SDL_AudioBus * bus, Uint8 * dst, int samples, SDL_bool dither)
+{
+    const SDL_AudioFormat format = bus->format;
+    const int swap = ((SDL_AUDIO_ISBIGENDIAN(format) != 0) != (SDL_BYTEORDER == SDL_BIG_ENDIAN));
+    const float *accum = bus->accum;
+    int i = 0;
+
+    if (SDL_AUDIO_BITSIZE(format) > 16) {
+        dither = SDL_FALSE;     /* far below the noise floor */
+    }
+
+    switch (SDL_AUDIO_BITSIZE(format)) {
+    case 8:
+        for (i = 0; i < samples; i++) {
+            const float d = dither ? SDL_AudioBusDither(&bus->dither_seed) : 0.0f;
+            const int val = SDL_AudioBusQuantize(accum[i], 127.0f, d, -128, 127);
+            dst[i] = (Uint8) (SDL_AUDIO_ISSIGNED(format) ? val : (val ^ 0x80));
+        }
+        break;
+
+    case 16:
+        {
+            Uint16 *dst16 = (Uint16 *) dst;
+#ifdef __SSE2__
+            if (SDL_AUDIO_ISSIGNED(format) && SDL_HasSSE2()) {
+                i = SDL_ConvertAudioBus_S16_SSE2(accum, (Sint16 *) dst16, samples,
+                                                 swap, dither, &bus->dither_seed);
+            }
+#endif
+            for (; i < samples; i++) {
+                const float d = dither ? SDL_AudioBusDither(&bus->dither_seed) : 0.0f;
+                Uint16 val = (Uint16) SDL_AudioBusQuantize(accum[i], 32767.0f, d, -32768, 32767);
+                if (!SDL_AUDIO_ISSIGNED(format)) {
+                    val ^= 0x8000;
+                }
+                dst16[i] = swap ? SDL_Swap16(val) : val;
+            }
+        }
+        break;
+
+    case 32:
+        {
+            Uint32 *dst32 = (Uint32 *) dst;
+            for (i = 0; i < samples; i++) {
+                Uint32 val;
+                if (SDL_AUDIO_ISFLOAT(format)) {
+                    union { float f; Uint32 u; } cvt;
+                    float f = accum[i];
+                    if (f > 1.0f) {
+                        f = 1.0f;
+                    } else if (f < -1.0f) {
+                        f = -1.0f;
+                    }
+                    cvt.f = f;
+                    val = cvt.u;
+                } else {
+                    const double x = ((double) accum[i]) * 2147483647.0;
+                    if (x >= 2147483647.0) {
+                        val = 0x7FFFFFFF;
+                    } else if (x <= -2147483648.0) {
+                        val = 0x80000000;
+                    } else {
+                        val = (Uint32) (Sint32) ((x < 0.0) ? (x - 0.5) : (x + 0.5));
+                    }
+                }
+                dst32[i] = swap ? SDL_Swap32(val) : val;
+            }
+        }
+        break;
+    }
+}
+
+SDL_AudioBus *
+SDL_NewAudioBus(SDL_AudioFormat format, Uint8 channels, int rate)
+{
+    SDL_AudioBus *bus;
+
+    switch (format) {
+    case AUDIO_U8: case AUDIO_S8:
+    case AUDIO_U16LSB: case AUDIO_S16LSB: case AUDIO_U16MSB: case AUDIO_S16MSB:
+    case AUDIO_S32LSB: case AUDIO_S32MSB: case AUDIO_F32LSB: case AUDIO_F32MSB:
+        break;
+    default:
+        SDL_InvalidParamError("format");
+        return NULL;
+    }
+    if ((channels != 1) && (channels != 2) && (channels != 4) && (channels != 6)) {
+        SDL_InvalidParamError("channels");
+        return NULL;
+    }
+    if (rate <= 0) {
+        SDL_InvalidParamError("rate");
+        return NULL;
+    }
+
+    bus = (SDL_AudioBus *) SDL_calloc(1, sizeof (SDL_AudioBus));
+    if (bus == NULL) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    bus->format = format;
+    bus->channels = channels;
+    bus->rate = rate;
+    bus->sample_size = SDL_AUDIO_BITSIZE(format) / 8;
+    bus->dither_seed = 0x2545F491;
+    return bus;
+}
+
+int
+SDL_AudioBusAddVoice(SDL_AudioBus * bus, SDL_AudioFormat format,
+                     Uint8 channels, int rate)
+{
+    SDL_AudioBusVoice *voice;
+    int i;
+
+    if (bus == NULL) {
+        SDL_InvalidParamError("bus");
+        return -1;
+    }
+
+    voice = (SDL_AudioBusVoice *) SDL_calloc(1, sizeof (SDL_AudioBusVoice));
+    if (voice == NULL) {
+        SDL_OutOfMemory();
+        return -1;
+    }
+    voice->pattern = (float *) SDL_malloc(bus->channels * 4 * sizeof (float));
+    if (voice->pattern == NULL) {
+        SDL_FreeAudioBusVoice(voice);
+        SDL_OutOfMemory();
+        return -1;
+    }
+    voice->stream = SDL_NewAudioStream(format, channels, rate, AUDIO_F32SYS,
+                                       (Uint8) bus->channels, bus->rate);
+    if (voice->stream == NULL) {
+        SDL_FreeAudioBusVoice(voice);
+        return -1;
+    }
+    SDL_SetAudioBusVoiceGains(bus, voice, 1.0f, 0.0f);
+
+    /* reuse a free slot if there is one */
+    for (i = 0; i < bus->num_voices; i++) {
+        if (bus->voices[i] == NULL) {
+            bus->voices[i] = voice;
+            return i;
+        }
+    }
+
+    {
+        SDL_AudioBusVoice **voices = (SDL_AudioBusVoice **)
+            SDL_realloc(bus->voices, (bus->num_voices + 1) * sizeof (SDL_AudioBusVoice *));
+        if (voices == NULL) {
+            SDL_FreeAudioBusVoice(voice);
+            SDL_OutOfMemory();
+            return -1;
+        }
+        bus->voices = voices;
+    }
+    bus->voices[bus->num_voices] = voice;
+    return bus->num_voices++;
+}
+
+int
+SDL_AudioBusRemoveVoice(SDL_AudioBus * bus, int voice)
+{
+    SDL_AudioBusVoice *v = SDL_GetAudioBusVoice(bus, voice);
+    if (v == NULL) {
+        return -1;
+    }
+    SDL_FreeAudioBusVoice(v);
+    bus->voices[voice] = NULL;
+    return 0;
+}
+
+int
+SDL_AudioBusSetVoiceGain(SDL_AudioBus * bus, int voice, float gain, float pan)
+{
+    SDL_AudioBusVoice *v = SDL_GetAudioBusVoice(bus, voice);
+    if (v == NULL) {
+        return -1;
+    }
+    if (pan < -1.0f) {
+        pan = -1.0f;
+    } else if (pan > 1.0f) {
+        pan = 1.0f;
+    }
+    SDL_SetAudioBusVoiceGains(bus, v, gain, pan);
+    return 0;
+}
+
+int
+SDL_AudioBusPutVoice(SDL_AudioBus * bus, int voice, const void *buf, int len)
+{
+    SDL_AudioBusVoice *v = SDL_GetAudioBusVoice(bus, voice);
+    if (v == NULL) {
+        return -1;
+    }
+    return SDL_AudioStreamPut(v->stream, buf, len);
+}
+
+int
+SDL_AudioBusVoiceAvailable(SDL_AudioBus * bus, int voice)
+{
+    SDL_AudioBusVoice *v = SDL_GetAudioBusVoice(bus, voice);
+    if (v == NULL) {
+        return -1;
+    }
+    return (SDL_AudioStreamAvailable(v->stream) / sizeof (float)) * bus->sample_size;
+}
+
+int
+SDL_AudioBusMix(SDL_AudioBus * bus, void *buf, int len, SDL_bool dither)
+{
+    const int framesize = (bus) ? (bus->sample_size * bus->channels) : 1;
+    int samples, i;
+
+    if (bus == NULL) {
+        SDL_InvalidParamError("bus");
+        return -1;
+    }
+    if ((buf == NULL) || (len < 0) || ((len % framesize) != 0)) {
+        SDL_InvalidParamError("buf");
+        return -1;
+    }
+
+    samples = len / bus->sample_size;
+    if (samples > bus->buffer_samples) {
+        float *accum = (float *) SDL_realloc(bus->accum, samples * sizeof (float));
+        float *scratch;
+        if (accum == NULL) {
+            SDL_OutOfMemory();
+            return -1;
+        }
+        bus->accum = accum;
+        scratch = (float *) SDL_realloc(bus->scratch, samples * sizeof (float));
+        if (scratch == NULL) {
+            SDL_OutOfMemory();
+            return -1;
+        }
+        bus->scratch = scratch;
+        bus->buffer_samples = samples;
+    }
+
+    SDL_memset(bus->accum, 0, samples * sizeof (float));
+    for (i = 0; i < bus->num_voices; i++) {
+        SDL_AudioBusVoice *voice = bus->voices[i];
+        int got;
+        if (voice == NULL) {
+            continue;
+        }
+        got = SDL_AudioStreamGet(voice->stream, bus->scratch, samples * sizeof (float));
+        if (got > 0) {
+            SDL_AccumulateAudioBusVoice(bus->accum, bus->scratch, got / sizeof (float),
+                                        voice, bus->channels);
+        }
+    }
+
+    SDL_ConvertAudioBus(bus, (Uint8 *) buf, samples, dither);
+    return 0;
+}
+
+void
+SDL_FreeAudioBus(SDL_AudioBus * bus)
+{
+    int i;
+
+    if (bus == NULL) {
+        return;
+    }
+    for (i = 0; i < bus->num_voices; i++) {
+        SDL_FreeAudioBusVoice(bus->voices[i]);
+    }
+    SDL_free(bus->voices);
+    SDL_free(bus->accum);
+    SDL_free(bus->scratch);
+    SDL_free(bus);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -24,9 +24,15 @@
 
 #include "SDL_audio.h"
 #include "SDL_audio_c.h"
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
 
 #include "SDL_assert.h"
 
+#ifdef HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+#endif
+
 /* #define DEBUG_CONVERT */
 
 /* Effectively mix right and left channels into a single channel */
@@ -39,7 +45,7 @@ SDL_ConvertMono(SDL_AudioCVT * cvt, SDL_AudioFormat format)
 #ifdef DEBUG_CONVERT
     fprintf(stderr, "Converting to mono\n");
 #endif
-    switch (format & (SDL_AUDIO_MASK_SIGNED | SDL_AUDIO_MASK_BITSIZE)) {
+    switch (format & (SDL_AUDIO_MASK_DATATYPE | SDL_AUDIO_MASK_SIGNED | SDL_AUDIO_MASK_BITSIZE)) {
     case AUDIO_U8:
         {
             Uint8 *src, *dst;
@@ -293,10 +299,9 @@ SDL_ConvertStereo(SDL_AudioCVT * cvt, SDL_AudioFormat format)
         const type *src = (const type *) (cvt->buf + cvt->len_cvt); \
         type *dst = (type *) (cvt->buf + cvt->len_cvt * 2); \
         for (i = cvt->len_cvt / sizeof(type); i; --i) { \
-            const type val = *src; \
             src -= 1; \
             dst -= 2; \
-            dst[0] = dst[1] = val; \
+            dst[0] = dst[1] = *src; \
         } \
     }
 
@@ -332,14 +337,14 @@ SDL_ConvertSurround(SDL_AudioCVT * cvt, SDL_AudioFormat format)
     fprintf(stderr, "Converting stereo to surround\n");
 #endif
 
-    switch (format & (SDL_AUDIO_MASK_SIGNED | SDL_AUDIO_MASK_BITSIZE)) {
+    switch (format & (SDL_AUDIO_MASK_DATATYPE | SDL_AUDIO_MASK_SIGNED | SDL_AUDIO_MASK_BITSIZE)) {
     case AUDIO_U8:
         {
             Uint8 *src, *dst, lf, rf, ce;
 
             src = (Uint8 *) (cvt->buf + cvt->len_cvt);
             dst = (Uint8 *) (cvt->buf + cvt->len_cvt * 3);
-            for (i = cvt->len_cvt; i; --i) {
+            for (i = cvt->len_cvt / 2; i; --i) {
                 dst -= 6;
                 src -= 2;
                 lf = src[0];
@@ -361,7 +366,7 @@ SDL_ConvertSurround(SDL_AudioCVT * cvt, SDL_AudioFormat format)
 
             src = (Sint8 *) cvt->buf + cvt->len_cvt;
             dst = (Sint8 *) cvt->buf + cvt->len_cvt * 3;
-            for (i = cvt->len_cvt; i; --i) {
+            for (i = cvt->len_cvt / 2; i; --i) {
                 dst -= 6;
                 src -= 2;
                 lf = src[0];
@@ -500,8 +505,8 @@ SDL_ConvertSurround(SDL_AudioCVT * cvt, SDL_AudioFormat format)
     case AUDIO_S32:
         {
             Sint32 lf, rf, ce;
-            const Uint32 *src = (const Uint32 *) cvt->buf + cvt->len_cvt;
-            Uint32 *dst = (Uint32 *) cvt->buf + cvt->len_cvt * 3;
+            const Uint32 *src = (const Uint32 *) (cvt->buf + cvt->len_cvt);
+            Uint32 *dst = (Uint32 *) (cvt->buf + cvt->len_cvt * 3);
 
             if (SDL_AUDIO_ISBIGENDIAN(format)) {
                 for (i = cvt->len_cvt / 8; i; --i) {
@@ -538,8 +543,8 @@ SDL_ConvertSurround(SDL_AudioCVT * cvt, SDL_AudioFormat format)
     case AUDIO_F32:
         {
             float lf, rf, ce;
-            const float *src = (const float *) cvt->buf + cvt->len_cvt;
-            float *dst = (float *) cvt->buf + cvt->len_cvt * 3;
+            const float *src = (const float *) (cvt->buf + cvt->len_cvt);
+            float *dst = (float *) (cvt->buf + cvt->len_cvt * 3);
 
             if (SDL_AUDIO_ISBIGENDIAN(format)) {
                 for (i = cvt->len_cvt / 8; i; --i) {
@@ -589,14 +594,14 @@ SDL_ConvertSurround_4(SDL_AudioCVT * cvt, SDL_AudioFormat format)
     fprintf(stderr, "Converting stereo to quad\n");
 #endif
 
-    switch (format & (SDL_AUDIO_MASK_SIGNED | SDL_AUDIO_MASK_BITSIZE)) {
+    switch (format & (SDL_AUDIO_MASK_DATATYPE | SDL_AUDIO_MASK_SIGNED | SDL_AUDIO_MASK_BITSIZE)) {
     case AUDIO_U8:
         {
             Uint8 *src, *dst, lf, rf, ce;
 
             src = (Uint8 *) (cvt->buf + cvt->len_cvt);
             dst = (Uint8 *) (cvt->buf + cvt->len_cvt * 2);
-            for (i = cvt->len_cvt; i; --i) {
+            for (i = cvt->len_cvt / 2; i; --i) {
                 dst -= 4;
                 src -= 2;
                 lf = src[0];
@@ -616,7 +621,7 @@ SDL_ConvertSurround_4(SDL_AudioCVT * cvt, SDL_AudioFormat format)
 
             src = (Sint8 *) cvt->buf + cvt->len_cvt;
             dst = (Sint8 *) cvt->buf + cvt->len_cvt * 2;
-            for (i = cvt->len_cvt; i; --i) {
+            for (i = cvt->len_cvt / 2; i; --i) {
                 dst -= 4;
                 src -= 2;
                 lf = src[0];
@@ -795,6 +800,644 @@ SDL_ConvertAudio(SDL_AudioCVT * cvt)
 }
 
 
+/*
+ * Vectorized converters for the most common type pairs.  These work in
+ *  place on cvt->buf just like the generated ones: widening conversions
+ *  walk the buffer from the end, everything else from the start.  They
+ *  read the source byte order from the (format) they get called with, so
+ *  one filter serves both source endiannesses.  Results match the
+ *  generated converters, except that out-of-range floats saturate.
+ */
+
+#define DIVBY32767 3.05185094759972e-05f
+#define DIVBY2147483647 4.6566128752458e-10f
+
+#ifdef __SSE2__
+
+static int typecvt_simd = 0;    /* 1 = SSE2, 2 = AVX2 */
+
+static __m128i
+SDL_TypeSwap16_SSE2(__m128i x)
+{
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+static __m128i
+SDL_TypeSwap32_SSE2(__m128i x)
+{
+    x = SDL_TypeSwap16_SSE2(x);
+    x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+static __m256i SDL_TARGETING_AVX2
+SDL_TypeSwap16_AVX2(__m256i x)
+{
+    return _mm256_shuffle_epi8(x, _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                   1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+}
+
+static __m256i SDL_TARGETING_AVX2
+SDL_TypeSwap32_AVX2(__m256i x)
+{
+    return _mm256_shuffle_epi8(x, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                   3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+}
+
+static int SDL_TARGETING_AVX2
+SDL_TypeCVT_S16_to_F32_AVX2(Uint8 * buf, int i, int srcswap, int dstswap)
+{
+    const __m256 divby = _mm256_set1_ps(DIVBY32767);
+    while (i >= 16) {
+        __m256i x, lo, hi;
+        i -= 16;
+        x = _mm256_loadu_si256((const __m256i *) (buf + i * 2));
+        if (srcswap) {
+            x = SDL_TypeSwap16_AVX2(x);
+        }
+        lo = _mm256_castps_si256(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(x))), divby));
+        hi = _mm256_castps_si256(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1))), divby));
+        if (dstswap) {
+            lo = SDL_TypeSwap32_AVX2(lo);
+            hi = SDL_TypeSwap32_AVX2(hi);
+        }
+        _mm256_storeu_si256((__m256i *) (buf + i * 4 + 32), hi);
+        _mm256_storeu_si256((__m256i *) (buf + i * 4), lo);
+    }
+    return i;
+}
+
+static int SDL_TARGETING_AVX2
+SDL_TypeCVT_F32_to_S16_AVX2(Uint8 * buf, int n, int srcswap, int dstswap)
+{
+    const __m256 mult = _mm256_set1_ps(32767.0f);
+    const __m256 maxval = _mm256_set1_ps(32767.0f);
+    const __m256 minval = _mm256_set1_ps(-32768.0f);
+    int i;
+    for (i = 0; (i + 16) <= n; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (buf + i * 4));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (buf + i * 4 + 32));
+        __m256i x;
+        if (srcswap) {
+            a = SDL_TypeSwap32_AVX2(a);
+            b = SDL_TypeSwap32_AVX2(b);
+        }
+        a = _mm256_cvttps_epi32(_mm256_max_ps(minval, _mm256_min_ps(_mm256_mul_ps(_mm256_castsi256_ps(a), mult), maxval)));
+        b = _mm256_cvttps_epi32(_mm256_max_ps(minval, _mm256_min_ps(_mm256_mul_ps(_mm256_castsi256_ps(b), mult), maxval)));
+        x = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        if (dstswap) {
+            x = SDL_TypeSwap16_AVX2(x);
+        }
+        _mm256_storeu_si256((__m256i *) (buf + i * 2), x);
+    }
+    return i;
+}
+
+static int SDL_TARGETING_AVX2
+SDL_TypeCVT_S32_to_F32_AVX2(Uint8 * buf, int n, int srcswap, int dstswap)
+{
+    const __m256 divby = _mm256_set1_ps(DIVBY2147483647);
+    int i;
+    for (i = 0; (i + 8) <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (buf + i * 4));
+        if (srcswap) {
+            x = SDL_TypeSwap32_AVX2(x);
+        }
+        x = _mm256_castps_si256(_mm256_mul_ps(_mm256_cvtepi32_ps(x), divby));
+        if (dstswap) {
+            x = SDL_TypeSwap32_AVX2(x);
+        }
+        _mm256_storeu_si256((__m256i *) (buf + i * 4), x);
+    }
+    return i;
+}
+
+static int SDL_TARGETING_AVX2
+SDL_TypeCVT_F32_to_S32_AVX2(Uint8 * buf, int n, int srcswap, int dstswap)
+{
+    const __m256d mult = _mm256_set1_pd(2147483647.0);
+    const __m256d maxval = _mm256_set1_pd(2147483647.0);
+    const __m256d minval = _mm256_set1_pd(-2147483648.0);
+    int i;
+    for (i = 0; (i + 8) <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (buf + i * 4));
+        __m256d lo, hi;
+        if (srcswap) {
+            x = SDL_TypeSwap32_AVX2(x);
+        }
+        lo = _mm256_cvtps_pd(_mm_castsi128_ps(_mm256_castsi256_si128(x)));
+        hi = _mm256_cvtps_pd(_mm_castsi128_ps(_mm256_extracti128_si256(x, 1)));
+        lo = _mm256_max_pd(minval, _mm256_min_pd(_mm256_mul_pd(lo, mult), maxval));
+        hi = _mm256_max_pd(minval, _mm256_min_pd(_mm256_mul_pd(hi, mult), maxval));
+        x = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(lo)), _mm256_cvttpd_epi32(hi), 1);
+        if (dstswap) {
+            x = SDL_TypeSwap32_AVX2(x);
+        }
+        _mm256_storeu_si256((__m256i *) (buf + i * 4), x);
+    }
+    return i;
+}
+
+static int SDL_TARGETING_AVX2
+SDL_TypeCVT_U8_to_S16_AVX2(Uint8 * buf, int i, int dstswap)
+{
+    const __m256i bias = _mm256_set1_epi16((short) 0x8000);
+    while (i >= 16) {
+        __m256i x;
+        i -= 16;
+        x = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (buf + i)));
+        x = _mm256_xor_si256(_mm256_slli_epi16(x, 8), bias);
+        if (dstswap) {
+            x = SDL_TypeSwap16_AVX2(x);
+        }
+        _mm256_storeu_si256((__m256i *) (buf + i * 2), x);
+    }
+    return i;
+}
+
+static int SDL_TARGETING_AVX2
+SDL_TypeCVT_S16_to_U8_AVX2(Uint8 * buf, int n, int srcswap)
+{
+    const __m256i bias = _mm256_set1_epi8((char) 0x80);
+    int i;
+    for (i = 0; (i + 32) <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (buf + i * 2));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (buf + i * 2 + 32));
+        __m256i x;
+        if (srcswap) {
+            a = SDL_TypeSwap16_AVX2(a);
+            b = SDL_TypeSwap16_AVX2(b);
+        }
+        x = _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+        x = _mm256_xor_si256(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 1, 2, 0)), bias);
+        _mm256_storeu_si256((__m256i *) (buf + i), x);
+    }
+    return i;
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
+/* (n) samples, converted back to front */
+static void
+SDL_TypeCVT_S16_to_F32(Uint8 * buf, int n, int srcswap, int dstswap)
+{
+    const __m128 divby = _mm_set1_ps(DIVBY32767);
+    int i = n;
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if (typecvt_simd == 2) {
+        i = SDL_TypeCVT_S16_to_F32_AVX2(buf, i, srcswap, dstswap);
+    }
+#endif
+    while (i >= 8) {
+        __m128i x, lo, hi;
+        i -= 8;
+        x = _mm_loadu_si128((const __m128i *) (buf + i * 2));
+        if (srcswap) {
+            x = SDL_TypeSwap16_SSE2(x);
+        }
+        lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        lo = _mm_castps_si128(_mm_mul_ps(_mm_cvtepi32_ps(lo), divby));
+        hi = _mm_castps_si128(_mm_mul_ps(_mm_cvtepi32_ps(hi), divby));
+        if (dstswap) {
+            lo = SDL_TypeSwap32_SSE2(lo);
+            hi = SDL_TypeSwap32_SSE2(hi);
+        }
+        _mm_storeu_si128((__m128i *) (buf + i * 4 + 16), hi);
+        _mm_storeu_si128((__m128i *) (buf + i * 4), lo);
+    }
+    while (i > 0) {
+        Uint16 sample;
+        float val;
+        i--;
+        sample = ((const Uint16 *) buf)[i];
+        val = ((float) ((Sint16) (srcswap ? SDL_Swap16(sample) : sample))) * DIVBY32767;
+        ((float *) buf)[i] = dstswap ? SDL_SwapFloat(val) : val;
+    }
+}
+
+static void
+SDL_TypeCVT_F32_to_S16(Uint8 * buf, int n, int srcswap, int dstswap)
+{
+    const __m128 mult = _mm_set1_ps(32767.0f);
+    const __m128 maxval = _mm_set1_ps(32767.0f);
+    const __m128 minval = _mm_set1_ps(-32768.0f);
+    int i = 0;
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if (typecvt_simd == 2) {
+        i = SDL_TypeCVT_F32_to_S16_AVX2(buf, n, srcswap, dstswap);
+    }
+#endif
+    for (; (i + 8) <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (buf + i * 4));
+        __m128i b = _mm_loadu_si128((const __m128i *) (buf + i * 4 + 16));
+        __m128i x;
+        if (srcswap) {
+            a = SDL_TypeSwap32_SSE2(a);
+            b = SDL_TypeSwap32_SSE2(b);
+        }
+        a = _mm_cvttps_epi32(_mm_max_ps(minval, _mm_min_ps(_mm_mul_ps(_mm_castsi128_ps(a), mult), maxval)));
+        b = _mm_cvttps_epi32(_mm_max_ps(minval, _mm_min_ps(_mm_mul_ps(_mm_castsi128_ps(b), mult), maxval)));
+        x = _mm_packs_epi32(a, b);
+        if (dstswap) {
+            x = SDL_TypeSwap16_SSE2(x);
+        }
+        _mm_storeu_si128((__m128i *) (buf + i * 2), x);
+    }
+    for (; i < n; i++) {
+        const float sample = ((const float *) buf)[i];
+        float f = (srcswap ? SDL_SwapFloat(sample) : sample) * 32767.0f;
+        Sint16 val;
+        /* saturate like the min/max above, NaN included */
+        f = (f < 32767.0f) ? f : 32767.0f;
+        f = (f > -32768.0f) ? f : -32768.0f;
+        val = (Sint16) f;
+        ((Uint16 *) buf)[i] = dstswap ? SDL_Swap16((Uint16) val) : (Uint16) val;
+    }
+}
+
+static void
+SDL_TypeCVT_S32_to_F32(Uint8 * buf, int n, int srcswap, int dstswap)
+{
+    const __m128 divby = _mm_set1_ps(DIVBY2147483647);
+    int i = 0;
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if (typecvt_simd == 2) {
+        i = SDL_TypeCVT_S32_to_F32_AVX2(buf, n, srcswap, dstswap);
+    }
+#endif
+    for (; (i + 4) <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (buf + i * 4));
+        if (srcswap) {
+            x = SDL_TypeSwap32_SSE2(x);
+        }
+        x = _mm_castps_si128(_mm_mul_ps(_mm_cvtepi32_ps(x), divby));
+        if (dstswap) {
+            x = SDL_TypeSwap32_SSE2(x);
+        }
+        _mm_storeu_si128((__m128i *) (buf + i * 4), x);
+    }
+    for (; i < n; i++) {
+        const Uint32 sample = ((const Uint32 *) buf)[i];
+        const float val = ((float) ((Sint32) (srcswap ? SDL_Swap32(sample) : sample))) * DIVBY2147483647;
+        ((float *) buf)[i] = dstswap ? SDL_SwapFloat(val) : val;
+    }
+}
+
+static void
+SDL_TypeCVT_F32_to_S32(Uint8 * buf, int n, int srcswap, int dstswap)
+{
+    const __m128d mult = _mm_set1_pd(2147483647.0);
+    const __m128d maxval = _mm_set1_pd(2147483647.0);
+    const __m128d minval = _mm_set1_pd(-2147483648.0);
+    int i = 0;
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if (typecvt_simd == 2) {
+        i = SDL_TypeCVT_F32_to_S32_AVX2(buf, n, srcswap, dstswap);
+    }
+#endif
+    for (; (i + 4) <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (buf + i * 4));
+        __m128d lo, hi;
+        if (srcswap) {
+            x = SDL_TypeSwap32_SSE2(x);
+        }
+        /* the scalar code scales in double precision */
+        lo = _mm_cvtps_pd(_mm_castsi128_ps(x));
+        hi = _mm_cvtps_pd(_mm_castsi128_ps(_mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2))));
+        lo = _mm_max_pd(minval, _mm_min_pd(_mm_mul_pd(lo, mult), maxval));
+        hi = _mm_max_pd(minval, _mm_min_pd(_mm_mul_pd(hi, mult), maxval));
+        x = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+        if (dstswap) {
+            x = SDL_TypeSwap32_SSE2(x);
+        }
+        _mm_storeu_si128((__m128i *) (buf + i * 4), x);
+    }
+    for (; i < n; i++) {
+        const float sample = ((const float *) buf)[i];
+        double d = (srcswap ? SDL_SwapFloat(sample) : sample) * 2147483647.0;
+        Sint32 val;
+        /* saturate like the min/max above, NaN included */
+        d = (d < 2147483647.0) ? d : 2147483647.0;
+        d = (d > -2147483648.0) ? d : -2147483648.0;
+        val = (Sint32) d;
+        ((Uint32 *) buf)[i] = dstswap ? SDL_Swap32((Uint32) val) : (Uint32) val;
+    }
+}
+
+/* (n) samples, converted back to front */
+static void
+SDL_TypeCVT_U8_to_S16(Uint8 * buf, int n, int dstswap)
+{
+    const __m128i bias = _mm_set1_epi8((char) 0x80);
+    const __m128i zero = _mm_setzero_si128();
+    int i = n;
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if (typecvt_simd == 2) {
+        i = SDL_TypeCVT_U8_to_S16_AVX2(buf, i, dstswap);
+    }
+#endif
+    while (i >= 16) {
+        __m128i x, lo, hi;
+        i -= 16;
+        x = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (buf + i)), bias);
+        if (dstswap) {
+            lo = _mm_unpacklo_epi8(x, zero);
+            hi = _mm_unpackhi_epi8(x, zero);
+        } else {
+            lo = _mm_unpacklo_epi8(zero, x);
+            hi = _mm_unpackhi_epi8(zero, x);
+        }
+        _mm_storeu_si128((__m128i *) (buf + i * 2 + 16), hi);
+        _mm_storeu_si128((__m128i *) (buf + i * 2), lo);
+    }
+    while (i > 0) {
+        Uint16 val;
+        i--;
+        val = (Uint16) ((buf[i] ^ 0x80) << 8);
+        ((Uint16 *) buf)[i] = dstswap ? SDL_Swap16(val) : val;
+    }
+}
+
+static void
+SDL_TypeCVT_S16_to_U8(Uint8 * buf, int n, int srcswap)
+{
+    const __m128i bias = _mm_set1_epi8((char) 0x80);
+    int i = 0;
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if (typecvt_simd == 2) {
+        i = SDL_TypeCVT_S16_to_U8_AVX2(buf, n, srcswap);
+    }
+#endif
+    for (; (i + 16) <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (buf + i * 2));
+        __m128i b = _mm_loadu_si128((const __m128i *) (buf + i * 2 + 16));
+        if (srcswap) {
+            /* the high byte is already where the low byte would be */
+            a = _mm_and_si128(a, _mm_set1_epi16(0xFF));
+            b = _mm_and_si128(b, _mm_set1_epi16(0xFF));
+        } else {
+            a = _mm_srli_epi16(a, 8);
+            b = _mm_srli_epi16(b, 8);
+        }
+        _mm_storeu_si128((__m128i *) (buf + i), _mm_xor_si128(_mm_packus_epi16(a, b), bias));
+    }
+    for (; i < n; i++) {
+        const Uint16 sample = ((const Uint16 *) buf)[i];
+        buf[i] = (Uint8) (((srcswap ? SDL_Swap16(sample) : sample) >> 8) ^ 0x80);
+    }
+}
+
+/* Update (cvt) and hand the buffer to the next filter */
+static void
+SDL_FinishTypeCVT(SDL_AudioCVT * cvt, int len, SDL_AudioFormat format)
+{
+    cvt->len_cvt = len;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index] (cvt, format);
+    }
+}
+
+#define SWAPPED(fmt) ((SDL_AUDIO_ISBIGENDIAN(fmt) != 0) != (SDL_BYTEORDER == SDL_BIG_ENDIAN))
+
+static void SDLCALL
+SDL_Convert_S16_to_F32LSB_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt / sizeof (Sint16);
+    SDL_TypeCVT_S16_to_F32(cvt->buf, samples, SWAPPED(format), SWAPPED(AUDIO_F32LSB));
+    SDL_FinishTypeCVT(cvt, samples * sizeof (float), AUDIO_F32LSB);
+}
+
+static void SDLCALL
+SDL_Convert_S16_to_F32MSB_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt / sizeof (Sint16);
+    SDL_TypeCVT_S16_to_F32(cvt->buf, samples, SWAPPED(format), SWAPPED(AUDIO_F32MSB));
+    SDL_FinishTypeCVT(cvt, samples * sizeof (float), AUDIO_F32MSB);
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S16LSB_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt / sizeof (float);
+    SDL_TypeCVT_F32_to_S16(cvt->buf, samples, SWAPPED(format), SWAPPED(AUDIO_S16LSB));
+    SDL_FinishTypeCVT(cvt, samples * sizeof (Sint16), AUDIO_S16LSB);
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S16MSB_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt / sizeof (float);
+    SDL_TypeCVT_F32_to_S16(cvt->buf, samples, SWAPPED(format), SWAPPED(AUDIO_S16MSB));
+    SDL_FinishTypeCVT(cvt, samples * sizeof (Sint16), AUDIO_S16MSB);
+}
+
+static void SDLCALL
+SDL_Convert_S32_to_F32LSB_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt / sizeof (Sint32);
+    SDL_TypeCVT_S32_to_F32(cvt->buf, samples, SWAPPED(format), SWAPPED(AUDIO_F32LSB));
+    SDL_FinishTypeCVT(cvt, samples * sizeof (float), AUDIO_F32LSB);
+}
+
+static void SDLCALL
+SDL_Convert_S32_to_F32MSB_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt / sizeof (Sint32);
+    SDL_TypeCVT_S32_to_F32(cvt->buf, samples, SWAPPED(format), SWAPPED(AUDIO_F32MSB));
+    SDL_FinishTypeCVT(cvt, samples * sizeof (float), AUDIO_F32MSB);
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S32LSB_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt / sizeof (float);
+    SDL_TypeCVT_F32_to_S32(cvt->buf, samples, SWAPPED(format), SWAPPED(AUDIO_S32LSB));
+    SDL_FinishTypeCVT(cvt, samples * sizeof (Sint32), AUDIO_S32LSB);
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S32MSB_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt / sizeof (float);
+    SDL_TypeCVT_F32_to_S32(cvt->buf, samples, SWAPPED(format), SWAPPED(AUDIO_S32MSB));
+    SDL_FinishTypeCVT(cvt, samples * sizeof (Sint32), AUDIO_S32MSB);
+}
+
+static void SDLCALL
+SDL_Convert_U8_to_S16LSB_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt;
+    SDL_TypeCVT_U8_to_S16(cvt->buf, samples, SWAPPED(AUDIO_S16LSB));
+    SDL_FinishTypeCVT(cvt, samples * sizeof (Sint16), AUDIO_S16LSB);
+}
+
+static void SDLCALL
+SDL_Convert_U8_to_S16MSB_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt;
+    SDL_TypeCVT_U8_to_S16(cvt->buf, samples, SWAPPED(AUDIO_S16MSB));
+    SDL_FinishTypeCVT(cvt, samples * sizeof (Sint16), AUDIO_S16MSB);
+}
+
+static void SDLCALL
+SDL_Convert_S16_to_U8_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const int samples = cvt->len_cvt / sizeof (Sint16);
+    SDL_TypeCVT_S16_to_U8(cvt->buf, samples, SWAPPED(format));
+    SDL_FinishTypeCVT(cvt, samples, AUDIO_U8);
+}
+
+#undef SWAPPED
+
+/*
+ * Fused converters: a type conversion and a mono/stereo channel conversion
+ *  in a single pass over the buffer, for native byte order S16 and F32.
+ *  They give the same results as the type converter followed by
+ *  SDL_ConvertStereo() or SDL_ConvertMono() in the order SDL_BuildAudioCVT()
+ *  would chain them.
+ */
+
+/* F32 samples in (a), scaled and saturated to S16 range, as 32-bit ints */
+static __m128i
+SDL_FusedF32_to_S32_SSE2(__m128 a)
+{
+    const __m128 mult = _mm_set1_ps(32767.0f);
+    const __m128 maxval = _mm_set1_ps(32767.0f);
+    const __m128 minval = _mm_set1_ps(-32768.0f);
+    return _mm_cvttps_epi32(_mm_max_ps(minval, _mm_min_ps(_mm_mul_ps(a, mult), maxval)));
+}
+
+static Sint32
+SDL_FusedF32_to_S32(float sample)
+{
+    sample *= 32767.0f;
+    if (sample >= 32767.0f) {
+        return 32767;
+    } else if (sample <= -32768.0f) {
+        return -32768;
+    }
+    return (Sint32) sample;
+}
+
+static void SDLCALL
+SDL_Convert_S16_1_to_F32_2_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const __m128 divby = _mm_set1_ps(DIVBY32767);
+    const Sint16 *src = (const Sint16 *) cvt->buf;
+    float *dst = (float *) cvt->buf;
+    int i = cvt->len_cvt / sizeof (Sint16);
+
+    /* Back to front, since the output is four times the size of the input */
+    while (i >= 8) {
+        __m128i x;
+        __m128 lo, hi;
+        i -= 8;
+        x = _mm_loadu_si128((const __m128i *) (src + i));
+        lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)), divby);
+        hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)), divby);
+        _mm_storeu_ps(dst + i * 2 + 12, _mm_unpackhi_ps(hi, hi));
+        _mm_storeu_ps(dst + i * 2 + 8, _mm_unpacklo_ps(hi, hi));
+        _mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(lo, lo));
+        _mm_storeu_ps(dst + i * 2, _mm_unpacklo_ps(lo, lo));
+    }
+    while (i > 0) {
+        float val;
+        i--;
+        val = ((float) src[i]) * DIVBY32767;
+        dst[i * 2] = dst[i * 2 + 1] = val;
+    }
+    SDL_FinishTypeCVT(cvt, cvt->len_cvt * 4, AUDIO_F32SYS);
+}
+
+static void SDLCALL
+SDL_Convert_S16_2_to_F32_1_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const __m128 divby = _mm_set1_ps(DIVBY32767);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const Sint16 *src = (const Sint16 *) cvt->buf;
+    float *dst = (float *) cvt->buf;
+    const int frames = cvt->len_cvt / (2 * sizeof (Sint16));
+    int i;
+
+    /* Input and output frames are the same size, so go front to back */
+    for (i = 0; (i + 4) <= frames; i += 4) {
+        const __m128i x = _mm_loadu_si128((const __m128i *) (src + i * 2));
+        const __m128 left = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(x, 16), 16));
+        const __m128 right = _mm_cvtepi32_ps(_mm_srai_epi32(x, 16));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_add_ps(_mm_mul_ps(left, divby),
+                                                     _mm_mul_ps(right, divby)), half));
+    }
+    /* Scalar SSE for the rest too, so every step rounds to float just
+       like the two pass version does */
+    for (; i < frames; i++) {
+        const __m128 left = _mm_cvtsi32_ss(_mm_setzero_ps(), src[i * 2]);
+        const __m128 right = _mm_cvtsi32_ss(_mm_setzero_ps(), src[i * 2 + 1]);
+        _mm_store_ss(dst + i, _mm_mul_ss(_mm_add_ss(_mm_mul_ss(left, divby),
+                                                    _mm_mul_ss(right, divby)), half));
+    }
+    SDL_FinishTypeCVT(cvt, frames * sizeof (float), AUDIO_F32SYS);
+}
+
+static void SDLCALL
+SDL_Convert_F32_1_to_S16_2_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const float *src = (const float *) cvt->buf;
+    Sint16 *dst = (Sint16 *) cvt->buf;
+    const int frames = cvt->len_cvt / sizeof (float);
+    int i;
+
+    /* Input and output frames are the same size, so go front to back */
+    for (i = 0; (i + 4) <= frames; i += 4) {
+        __m128i x = SDL_FusedF32_to_S32_SSE2(_mm_loadu_ps(src + i));
+        x = _mm_packs_epi32(x, x);
+        _mm_storeu_si128((__m128i *) (dst + i * 2), _mm_unpacklo_epi16(x, x));
+    }
+    for (; i < frames; i++) {
+        const Sint16 val = (Sint16) SDL_FusedF32_to_S32(src[i]);
+        dst[i * 2] = dst[i * 2 + 1] = val;
+    }
+    SDL_FinishTypeCVT(cvt, frames * 2 * sizeof (Sint16), AUDIO_S16SYS);
+}
+
+static void SDLCALL
+SDL_Convert_F32_2_to_S16_1_SIMD(SDL_AudioCVT * cvt, SDL_AudioFormat format)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    const float *src = (const float *) cvt->buf;
+    Sint16 *dst = (Sint16 *) cvt->buf;
+    const int frames = cvt->len_cvt / (2 * sizeof (float));
+    int i;
+
+    for (i = 0; (i + 8) <= frames; i += 8) {
+        const __m128i a = SDL_FusedF32_to_S32_SSE2(_mm_loadu_ps(src + i * 2));
+        const __m128i b = SDL_FusedF32_to_S32_SSE2(_mm_loadu_ps(src + i * 2 + 4));
+        const __m128i c = SDL_FusedF32_to_S32_SSE2(_mm_loadu_ps(src + i * 2 + 8));
+        const __m128i d = SDL_FusedF32_to_S32_SSE2(_mm_loadu_ps(src + i * 2 + 12));
+        /* Sum each left/right pair, then halve rounding toward zero */
+        __m128i lo = _mm_madd_epi16(_mm_packs_epi32(a, b), ones);
+        __m128i hi = _mm_madd_epi16(_mm_packs_epi32(c, d), ones);
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, _mm_srli_epi32(lo, 31)), 1);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, _mm_srli_epi32(hi, 31)), 1);
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(lo, hi));
+    }
+    for (; i < frames; i++) {
+        const Sint32 left = SDL_FusedF32_to_S32(src[i * 2]);
+        const Sint32 right = SDL_FusedF32_to_S32(src[i * 2 + 1]);
+        dst[i] = (Sint16) ((left + right) / 2);
+    }
+    SDL_FinishTypeCVT(cvt, frames * sizeof (Sint16), AUDIO_S16SYS);
+}
+
+#endif /* __SSE2__ */
+
+
 static SDL_AudioFilter
 SDL_HandTunedTypeCVT(SDL_AudioFormat src_fmt, SDL_AudioFormat dst_fmt)
 {
@@ -803,10 +1446,202 @@ SDL_HandTunedTypeCVT(SDL_AudioFormat src_fmt, SDL_AudioFormat dst_fmt)
      *  processor, platform, compiler, or library here.
      */
 
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        const SDL_AudioFormat src = (src_fmt & ~SDL_AUDIO_MASK_ENDIAN);
+        const SDL_AudioFormat dst = (dst_fmt & ~SDL_AUDIO_MASK_ENDIAN);
+        const int dst_be = (SDL_AUDIO_ISBIGENDIAN(dst_fmt) != 0);
+
+        typecvt_simd = 1;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (SDL_HasAVX2()) {
+            typecvt_simd = 2;
+        }
+#endif
+
+        if ((src == AUDIO_S16LSB) && (dst == AUDIO_F32LSB)) {
+            return dst_be ? SDL_Convert_S16_to_F32MSB_SIMD : SDL_Convert_S16_to_F32LSB_SIMD;
+        } else if ((src == AUDIO_F32LSB) && (dst == AUDIO_S16LSB)) {
+            return dst_be ? SDL_Convert_F32_to_S16MSB_SIMD : SDL_Convert_F32_to_S16LSB_SIMD;
+        } else if ((src == AUDIO_S32LSB) && (dst == AUDIO_F32LSB)) {
+            return dst_be ? SDL_Convert_S32_to_F32MSB_SIMD : SDL_Convert_S32_to_F32LSB_SIMD;
+        } else if ((src == AUDIO_F32LSB) && (dst == AUDIO_S32LSB)) {
+            return dst_be ? SDL_Convert_F32_to_S32MSB_SIMD : SDL_Convert_F32_to_S32LSB_SIMD;
+        } else if ((src_fmt == AUDIO_U8) && (dst == AUDIO_S16LSB)) {
+            return dst_be ? SDL_Convert_U8_to_S16MSB_SIMD : SDL_Convert_U8_to_S16LSB_SIMD;
+        } else if ((src == AUDIO_S16LSB) && (dst_fmt == AUDIO_U8)) {
+            return SDL_Convert_S16_to_U8_SIMD;
+        }
+    }
+#endif
+
     return NULL;                /* no specialized converter code available. */
 }
 
 
+static SDL_AudioFilter
+SDL_HandTunedFusedCVT(SDL_AudioFormat src_fmt, int src_channels,
+                      SDL_AudioFormat dst_fmt, int dst_channels)
+{
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        if ((src_fmt == AUDIO_S16SYS) && (dst_fmt == AUDIO_F32SYS)) {
+            if ((src_channels == 1) && (dst_channels == 2)) {
+                return SDL_Convert_S16_1_to_F32_2_SIMD;
+            } else if ((src_channels == 2) && (dst_channels == 1)) {
+                return SDL_Convert_S16_2_to_F32_1_SIMD;
+            }
+        } else if ((src_fmt == AUDIO_F32SYS) && (dst_fmt == AUDIO_S16SYS)) {
+            if ((src_channels == 1) && (dst_channels == 2)) {
+                return SDL_Convert_F32_1_to_S16_2_SIMD;
+            } else if ((src_channels == 2) && (dst_channels == 1)) {
+                return SDL_Convert_F32_2_to_S16_1_SIMD;
+            }
+        }
+    }
+#endif
+
+    return NULL;                /* no fused converter for this pair. */
+}
+
+
+/*
+ * Do the type and channel conversion in one filter, if there's a fused
+ *  converter for the pair; saves a pass over the buffer.
+ */
+static int
+SDL_BuildAudioFusedCVT(SDL_AudioCVT * cvt,
+                       SDL_AudioFormat src_fmt, int src_channels,
+                       SDL_AudioFormat dst_fmt, int dst_channels)
+{
+    const int src_size = (SDL_AUDIO_BITSIZE(src_fmt) / 8) * src_channels;
+    const int dst_size = (SDL_AUDIO_BITSIZE(dst_fmt) / 8) * dst_channels;
+    SDL_AudioFilter filter = SDL_HandTunedFusedCVT(src_fmt, src_channels,
+                                                   dst_fmt, dst_channels);
+
+    if (filter == NULL) {
+        return 0;
+    }
+
+    /* Update (cvt) with filter details... */
+    cvt->filters[cvt->filter_index++] = filter;
+    if (src_size < dst_size) {
+        const int mult = (dst_size / src_size);
+        cvt->len_mult *= mult;
+        cvt->len_ratio *= mult;
+    } else if (src_size > dst_size) {
+        cvt->len_ratio /= (src_size / dst_size);
+    }
+
+    return 1;                   /* added a converter. */
+}
+
+
+/*
+ * Channel conversions with the default matrix go through the channel
+ *  remixer when the data is S16 or F32, which converts between the two in
+ *  the same pass.
+ */
+static void
+SDL_RemixCVT(SDL_AudioCVT * cvt, SDL_AudioFormat format,
+             int src_channels, int dst_channels, SDL_AudioFormat dst_fmt)
+{
+    const int frames = cvt->len_cvt /
+        ((SDL_AUDIO_BITSIZE(format) / 8) * src_channels);
+
+    SDL_assert((format == AUDIO_S16SYS) || (format == AUDIO_F32SYS));
+
+    SDL_RemixAudioFrames(format, src_channels, cvt->buf,
+                         dst_fmt, dst_channels, cvt->buf,
+                         SDL_GetDefaultRemixMatrix(src_channels, dst_channels),
+                         frames);
+
+    cvt->len_cvt = frames * (SDL_AUDIO_BITSIZE(dst_fmt) / 8) * dst_channels;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index] (cvt, dst_fmt);
+    }
+}
+
+#define REMIX_CVT(from, to) \
+    static void SDLCALL \
+    SDL_RemixCVT_##from##_to_##to##_S16(SDL_AudioCVT * cvt, SDL_AudioFormat format) { \
+        SDL_RemixCVT(cvt, format, from, to, AUDIO_S16SYS); \
+    } \
+    static void SDLCALL \
+    SDL_RemixCVT_##from##_to_##to##_F32(SDL_AudioCVT * cvt, SDL_AudioFormat format) { \
+        SDL_RemixCVT(cvt, format, from, to, AUDIO_F32SYS); \
+    }
+REMIX_CVT(1, 2)
+REMIX_CVT(1, 4)
+REMIX_CVT(1, 6)
+REMIX_CVT(2, 1)
+REMIX_CVT(2, 4)
+REMIX_CVT(2, 6)
+REMIX_CVT(4, 1)
+REMIX_CVT(4, 2)
+REMIX_CVT(4, 6)
+REMIX_CVT(6, 1)
+REMIX_CVT(6, 2)
+REMIX_CVT(6, 4)
+#undef REMIX_CVT
+
+static SDL_AudioFilter
+SDL_HandTunedRemixCVT(int src_channels, SDL_AudioFormat dst_fmt,
+                      int dst_channels)
+{
+#define REMIX_CASE(from, to) \
+    if ((src_channels == from) && (dst_channels == to)) { \
+        return (dst_fmt == AUDIO_S16SYS) ? SDL_RemixCVT_##from##_to_##to##_S16 : \
+                                           SDL_RemixCVT_##from##_to_##to##_F32; \
+    }
+    REMIX_CASE(1, 2);
+    REMIX_CASE(1, 4);
+    REMIX_CASE(1, 6);
+    REMIX_CASE(2, 1);
+    REMIX_CASE(2, 4);
+    REMIX_CASE(2, 6);
+    REMIX_CASE(4, 1);
+    REMIX_CASE(4, 2);
+    REMIX_CASE(4, 6);
+    REMIX_CASE(6, 1);
+    REMIX_CASE(6, 2);
+    REMIX_CASE(6, 4);
+#undef REMIX_CASE
+
+    return NULL;                /* no default matrix for this pair. */
+}
+
+static int
+SDL_BuildAudioRemixCVT(SDL_AudioCVT * cvt,
+                       SDL_AudioFormat src_fmt, int src_channels,
+                       SDL_AudioFormat dst_fmt, int dst_channels)
+{
+    const int src_size = (SDL_AUDIO_BITSIZE(src_fmt) / 8) * src_channels;
+    const int dst_size = (SDL_AUDIO_BITSIZE(dst_fmt) / 8) * dst_channels;
+    SDL_AudioFilter filter;
+
+    if ((src_channels == dst_channels) ||
+        ((src_fmt != AUDIO_S16SYS) && (src_fmt != AUDIO_F32SYS)) ||
+        ((dst_fmt != AUDIO_S16SYS) && (dst_fmt != AUDIO_F32SYS))) {
+        return 0;
+    }
+
+    filter = SDL_HandTunedRemixCVT(src_channels, dst_fmt, dst_channels);
+    if (filter == NULL) {
+        return 0;
+    }
+
+    /* Update (cvt) with filter details... */
+    cvt->filters[cvt->filter_index++] = filter;
+    if (src_size < dst_size) {
+        cvt->len_mult *= (dst_size + src_size - 1) / src_size;
+    }
+    cvt->len_ratio = (cvt->len_ratio * dst_size) / src_size;
+
+    return 1;                   /* added a converter. */
+}
+
+
 /*
  * Find a converter between two data types. We try to select a hand-tuned
  *  asm/vectorized/optimized function first, and then fallback to an
@@ -856,15 +1691,115 @@ SDL_BuildAudioTypeCVT(SDL_AudioCVT * cvt,
 }
 
 
+/* Recover the reduced rate pair from cvt->rate_incr (dst_rate / src_rate),
+   since that is all a filter gets to see. */
+static void
+SDL_GetResampleRates(const SDL_AudioCVT * cvt, int *src_rate, int *dst_rate)
+{
+    double x = cvt->rate_incr;
+    Sint64 p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    int i;
+
+    for (i = 0; i < 32; i++) {
+        const double a = SDL_floor(x);
+        const Sint64 p2 = (Sint64) a * p1 + p0;
+        const Sint64 q2 = (Sint64) a * q1 + q0;
+        if ((q2 > (1 << 20)) || (p2 > (1 << 20))) {
+            break;
+        }
+        p0 = p1;
+        q0 = q1;
+        p1 = p2;
+        q1 = q2;
+        if ((x - a) < 1e-9) {
+            break;
+        }
+        x = 1.0 / (x - a);
+    }
+
+    *dst_rate = (int) p1;
+    *src_rate = (int) q1;
+}
+
+/* Windowed-sinc rate conversion of a whole AUDIO_F32SYS buffer.  The
+   resampler is flushed at the end, so every call is treated as a complete
+   clip and produces ceil(frames * rate_incr) frames.  The CVT has nowhere
+   to keep filter history between calls; SDL_AudioStream is the streaming
+   interface. */
+static void
+SDL_ResampleCVT(SDL_AudioCVT * cvt, SDL_AudioFormat format, int channels)
+{
+    const int frames = cvt->len_cvt / (channels * sizeof (float));
+    float *buf = (float *) cvt->buf;
+    SDL_AudioResampler *resampler;
+    int src_rate, dst_rate;
+    int produced, more;
+
+    SDL_assert(format == AUDIO_F32SYS);
+
+    SDL_GetResampleRates(cvt, &src_rate, &dst_rate);
+    resampler = SDL_AcquireAudioResampler(channels, src_rate, dst_rate);
+    if (resampler == NULL) {
+        return;  /* !!! FIXME: filters can't report errors. */
+    }
+
+    /* The resampler copies its input before writing any output, so the
+       conversion can happen in place. */
+    produced = SDL_AudioResamplerProcess(resampler, buf, frames, buf, 0x7FFFFFFF);
+    if (produced >= 0 && SDL_AudioResamplerFlush(resampler) == 0) {
+        more = SDL_AudioResamplerProcess(resampler, NULL, 0,
+                                         buf + produced * channels,
+                                         0x7FFFFFFF);
+        if (more > 0) {
+            produced += more;
+        }
+    }
+    SDL_ReleaseAudioResampler(resampler);
+
+    cvt->len_cvt = (produced > 0) ? (produced * channels * sizeof (float)) : 0;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index] (cvt, format);
+    }
+}
+
+#define RESAMPLE_CVT(chans) \
+    static void SDLCALL \
+    SDL_ResampleCVT_c##chans(SDL_AudioCVT * cvt, SDL_AudioFormat format) { \
+        SDL_ResampleCVT(cvt, format, chans); \
+    }
+RESAMPLE_CVT(1)
+RESAMPLE_CVT(2)
+RESAMPLE_CVT(3)
+RESAMPLE_CVT(4)
+RESAMPLE_CVT(5)
+RESAMPLE_CVT(6)
+RESAMPLE_CVT(7)
+RESAMPLE_CVT(8)
+#undef RESAMPLE_CVT
+
 static SDL_AudioFilter
-SDL_HandTunedResampleCVT(SDL_AudioCVT * cvt, int dst_channels,
-                         int src_rate, int dst_rate)
+SDL_HandTunedResampleCVT(SDL_AudioCVT * cvt, SDL_AudioFormat format,
+                         int dst_channels, int src_rate, int dst_rate)
 {
     /*
      * Fill in any future conversions that are specialized to a
      *  processor, platform, compiler, or library here.
      */
 
+    if (format == AUDIO_F32SYS) {
+        switch (dst_channels) {
+        case 1: return SDL_ResampleCVT_c1;
+        case 2: return SDL_ResampleCVT_c2;
+        case 3: return SDL_ResampleCVT_c3;
+        case 4: return SDL_ResampleCVT_c4;
+        case 5: return SDL_ResampleCVT_c5;
+        case 6: return SDL_ResampleCVT_c6;
+        case 7: return SDL_ResampleCVT_c7;
+        case 8: return SDL_ResampleCVT_c8;
+        default: break;
+        }
+    }
+
     return NULL;                /* no specialized converter code available. */
 }
 
@@ -902,11 +1837,12 @@ SDL_FindFrequencyMultiple(const int src_rate, const int dst_rate)
 }
 
 static int
-SDL_BuildAudioResampleCVT(SDL_AudioCVT * cvt, int dst_channels,
-                          int src_rate, int dst_rate)
+SDL_BuildAudioResampleCVT(SDL_AudioCVT * cvt, SDL_AudioFormat format,
+                          int dst_channels, int src_rate, int dst_rate)
 {
     if (src_rate != dst_rate) {
-        SDL_AudioFilter filter = SDL_HandTunedResampleCVT(cvt, dst_channels,
+        SDL_AudioFilter filter = SDL_HandTunedResampleCVT(cvt, format,
+                                                          dst_channels,
                                                           src_rate, dst_rate);
 
         /* No hand-tuned converter? Try the autogenerated ones. */
@@ -918,7 +1854,7 @@ SDL_BuildAudioResampleCVT(SDL_AudioCVT * cvt, int dst_channels,
 
             for (i = 0; sdl_audio_rate_filters[i].filter != NULL; i++) {
                 const SDL_AudioRateFilters *filt = &sdl_audio_rate_filters[i];
-                if ((filt->fmt == cvt->dst_format) &&
+                if ((filt->fmt == format) &&
                     (filt->channels == dst_channels) &&
                     (filt->upsample == upsample) &&
                     (filt->multiple == multiple)) {
@@ -950,6 +1886,81 @@ SDL_BuildAudioResampleCVT(SDL_AudioCVT * cvt, int dst_channels,
 }
 
 
+/* Built conversions, keyed by both specs. Streams for short sounds get
+   opened and closed all the time, and a built SDL_AudioCVT is nothing but
+   filter pointers and sizes that depend only on the key, so a copy of one
+   is as good as building it again. */
+#define SDL_AUDIOCVT_CACHE_SIZE 16
+
+typedef struct
+{
+    SDL_AudioFormat src_fmt;
+    Uint8 src_channels;
+    int src_rate;
+    SDL_AudioFormat dst_fmt;
+    Uint8 dst_channels;
+    int dst_rate;
+    Uint32 last_used;
+    SDL_AudioCVT cvt;           /* as SDL_BuildAudioCVT() left it */
+} SDL_AudioCVTCacheEntry;
+
+static SDL_AudioCVTCacheEntry audiocvt_cache[SDL_AUDIOCVT_CACHE_SIZE];
+static int audiocvt_cache_len = 0;
+static Uint32 audiocvt_cache_clock = 0;
+static SDL_SpinLock audiocvt_cache_lock = 0;
+
+static SDL_AudioCVTCacheEntry *
+SDL_FindCachedAudioCVT(SDL_AudioFormat src_fmt, Uint8 src_channels, int src_rate,
+                       SDL_AudioFormat dst_fmt, Uint8 dst_channels, int dst_rate)
+{
+    int i;
+    for (i = 0; i < audiocvt_cache_len; i++) {
+        SDL_AudioCVTCacheEntry *entry = &audiocvt_cache[i];
+        if ((entry->src_fmt == src_fmt) && (entry->src_channels == src_channels) &&
+            (entry->src_rate == src_rate) && (entry->dst_fmt == dst_fmt) &&
+            (entry->dst_channels == dst_channels) && (entry->dst_rate == dst_rate)) {
+            entry->last_used = ++audiocvt_cache_clock;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void
+SDL_CacheAudioCVT(const SDL_AudioCVT * cvt,
+                  SDL_AudioFormat src_fmt, Uint8 src_channels, int src_rate,
+                  SDL_AudioFormat dst_fmt, Uint8 dst_channels, int dst_rate)
+{
+    SDL_AudioCVTCacheEntry *entry;
+    int i;
+
+    SDL_AtomicLock(&audiocvt_cache_lock);
+    entry = SDL_FindCachedAudioCVT(src_fmt, src_channels, src_rate,
+                                   dst_fmt, dst_channels, dst_rate);
+    if (entry == NULL) {
+        if (audiocvt_cache_len < SDL_AUDIOCVT_CACHE_SIZE) {
+            entry = &audiocvt_cache[audiocvt_cache_len++];
+        } else {
+            /* replace the least recently used one */
+            entry = &audiocvt_cache[0];
+            for (i = 1; i < SDL_AUDIOCVT_CACHE_SIZE; i++) {
+                if (audiocvt_cache[i].last_used < entry->last_used) {
+                    entry = &audiocvt_cache[i];
+                }
+            }
+        }
+        entry->src_fmt = src_fmt;
+        entry->src_channels = src_channels;
+        entry->src_rate = src_rate;
+        entry->dst_fmt = dst_fmt;
+        entry->dst_channels = dst_channels;
+        entry->dst_rate = dst_rate;
+        entry->last_used = ++audiocvt_cache_clock;
+        entry->cvt = *cvt;
+    }
+    SDL_AtomicUnlock(&audiocvt_cache_lock);
+}
+
 /* Creates a set of audio filters to convert from one format to another.
    Returns -1 if the format conversion is not supported, 0 if there's
    no conversion needed, or 1 if the audio filter is set up.
@@ -960,6 +1971,11 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
                   SDL_AudioFormat src_fmt, Uint8 src_channels, int src_rate,
                   SDL_AudioFormat dst_fmt, Uint8 dst_channels, int dst_rate)
 {
+    const Uint8 orig_src_channels = src_channels;
+    SDL_AudioCVTCacheEntry *cached;
+    SDL_AudioFormat work_fmt;
+    int fused;
+
     /*
      * !!! FIXME: reorder filters based on which grow/shrink the buffer.
      * !!! FIXME: ideally, we should do everything that shrinks the buffer
@@ -998,6 +2014,18 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
            src_fmt, dst_fmt, src_channels, dst_channels, src_rate, dst_rate);
 #endif
 
+    /* Built this one before? */
+    SDL_AtomicLock(&audiocvt_cache_lock);
+    cached = SDL_FindCachedAudioCVT(src_fmt, src_channels, src_rate,
+                                    dst_fmt, dst_channels, dst_rate);
+    if (cached != NULL) {
+        *cvt = cached->cvt;
+    }
+    SDL_AtomicUnlock(&audiocvt_cache_lock);
+    if (cached != NULL) {
+        return (cvt->needed);
+    }
+
     /* Start off with no conversion necessary */
     SDL_zerop(cvt);
     cvt->src_format = src_fmt;
@@ -1009,11 +2037,36 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
     cvt->len_ratio = 1.0;
     cvt->rate_incr = ((double) dst_rate) / ((double) src_rate);
 
+    /* Rate conversion is done on floats by the windowed-sinc resampler, so
+       convert to AUDIO_F32SYS first and to the real target at the end. */
+    if ((src_rate != dst_rate) && (dst_channels <= 8)) {
+        work_fmt = AUDIO_F32SYS;
+    } else {
+        work_fmt = dst_fmt;
+    }
+
+    /* Convert data types and channels in one go, if we can. */
+    fused = SDL_BuildAudioFusedCVT(cvt, src_fmt, src_channels,
+                                   work_fmt, dst_channels);
+    if (!fused) {
+        fused = SDL_BuildAudioRemixCVT(cvt, src_fmt, src_channels,
+                                       work_fmt, dst_channels);
+    }
+    if (fused) {
+        src_channels = dst_channels;
+    }
+
     /* Convert data types, if necessary. Updates (cvt). */
-    if (SDL_BuildAudioTypeCVT(cvt, src_fmt, dst_fmt) == -1) {
+    if (!fused && (SDL_BuildAudioTypeCVT(cvt, src_fmt, work_fmt) == -1)) {
         return -1;              /* shouldn't happen, but just in case... */
     }
 
+    /* Remix in the working format, if the remixer handles that. */
+    if (SDL_BuildAudioRemixCVT(cvt, work_fmt, src_channels,
+                               work_fmt, dst_channels)) {
+        src_channels = dst_channels;
+    }
+
     /* Channel conversion */
     if (src_channels != dst_channels) {
         if ((src_channels == 1) && (dst_channels > 1)) {
@@ -1066,8 +2119,13 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
     }
 
     /* Do rate conversion, if necessary. Updates (cvt). */
-    if (SDL_BuildAudioResampleCVT(cvt, dst_channels, src_rate, dst_rate) ==
-        -1) {
+    if (SDL_BuildAudioResampleCVT(cvt, work_fmt, dst_channels,
+                                  src_rate, dst_rate) == -1) {
+        return -1;              /* shouldn't happen, but just in case... */
+    }
+
+    /* Back from the working format, if necessary. Updates (cvt). */
+    if (SDL_BuildAudioTypeCVT(cvt, work_fmt, dst_fmt) == -1) {
         return -1;              /* shouldn't happen, but just in case... */
     }
 
@@ -1080,8 +2138,296 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
         cvt->buf = NULL;
         cvt->filters[cvt->filter_index] = NULL;
     }
+    SDL_CacheAudioCVT(cvt, src_fmt, orig_src_channels, src_rate,
+                      dst_fmt, dst_channels, dst_rate);
     return (cvt->needed);
 }
 
 
+
+/* Audio streams.  Input is converted to the destination channel layout
+   as 32-bit floats at the source rate, run through the resampler, and
+   converted to the destination format on the way into the queue.  Without
+   a rate change, one SDL_AudioCVT does the whole job. */
+
+#define SDL_AUDIOSTREAM_MAX_FRAME (255 * 4)
+
+struct SDL_AudioStream
+{
+    SDL_AudioCVT cvt_before;    /* source -> working format */
+    SDL_AudioCVT cvt_after;     /* working format -> destination, after resampling */
+    SDL_AudioResampler *resampler;
+    int src_frame_size;
+    int dst_channels;
+
+    /* the start of a sample frame that was cut off by the caller */
+    Uint8 partial[SDL_AUDIOSTREAM_MAX_FRAME];
+    int partial_len;
+
+    /* scratch space, kept between calls */
+    Uint8 *work;
+    int work_len;
+    Uint8 *resampled;
+    int resampled_len;
+
+    /* converted data waiting to be read */
+    Uint8 *queue;
+    int queue_head;
+    int queue_len;
+    int queue_max;
+};
+
+static int
+SDL_GrowAudioStreamBuffer(Uint8 ** buf, int *buflen, int needed)
+{
+    if (needed > *buflen) {
+        Uint8 *ptr = (Uint8 *) SDL_realloc(*buf, needed);
+        if (ptr == NULL) {
+            SDL_OutOfMemory();
+            return -1;
+        }
+        *buf = ptr;
+        *buflen = needed;
+    }
+    return 0;
+}
+
+static int
+SDL_QueueAudioStreamData(SDL_AudioStream * stream, const Uint8 * buf, int len)
+{
+    if (len <= 0) {
+        return 0;
+    }
+
+    if ((stream->queue_head + stream->queue_len + len) > stream->queue_max) {
+        /* slide the unread data down first, then grow if that's not enough */
+        if (stream->queue_head > 0) {
+            SDL_memmove(stream->queue, stream->queue + stream->queue_head,
+                        stream->queue_len);
+            stream->queue_head = 0;
+        }
+        if ((stream->queue_len + len) > stream->queue_max) {
+            int newmax = (stream->queue_max > 0) ? stream->queue_max : 4096;
+            while (newmax < (stream->queue_len + len)) {
+                newmax *= 2;
+            }
+            if (SDL_GrowAudioStreamBuffer(&stream->queue, &stream->queue_max, newmax) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    SDL_memcpy(stream->queue + stream->queue_head + stream->queue_len, buf, len);
+    stream->queue_len += len;
+    return 0;
+}
+
+/* Run (inframes) working format frames, or a flush if in is NULL, through
+   the resampler and queue the result. */
+static int
+SDL_ResampleAudioStream(SDL_AudioStream * stream, const float *in, int inframes)
+{
+    const int framelen = stream->dst_channels * sizeof (float);
+    int outframes, produced;
+
+    if (in == NULL) {
+        if (SDL_AudioResamplerFlush(stream->resampler) < 0) {
+            return -1;
+        }
+    }
+
+    outframes = SDL_AudioResamplerMaxOutput(stream->resampler, inframes);
+    if (SDL_GrowAudioStreamBuffer(&stream->resampled, &stream->resampled_len,
+                                  outframes * framelen * stream->cvt_after.len_mult) < 0) {
+        return -1;
+    }
+
+    produced = SDL_AudioResamplerProcess(stream->resampler, in, inframes,
+                                         (float *) stream->resampled, outframes);
+    if (produced < 0) {
+        return -1;
+    }
+
+    stream->cvt_after.buf = stream->resampled;
+    stream->cvt_after.len = produced * framelen;
+    if (stream->cvt_after.needed) {
+        SDL_ConvertAudio(&stream->cvt_after);
+    } else {
+        stream->cvt_after.len_cvt = stream->cvt_after.len;
+    }
+    return SDL_QueueAudioStreamData(stream, stream->resampled, stream->cvt_after.len_cvt);
+}
+
+SDL_AudioStream *
+SDL_NewAudioStream(SDL_AudioFormat src_format, Uint8 src_channels, int src_rate,
+                   SDL_AudioFormat dst_format, Uint8 dst_channels, int dst_rate)
+{
+    SDL_AudioStream *stream;
+    int result;
+
+    stream = (SDL_AudioStream *) SDL_calloc(1, sizeof (SDL_AudioStream));
+    if (stream == NULL) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    if (src_rate != dst_rate) {
+        result = SDL_BuildAudioCVT(&stream->cvt_before,
+                                   src_format, src_channels, src_rate,
+                                   AUDIO_F32SYS, dst_channels, src_rate);
+        if (result >= 0) {
+            result = SDL_BuildAudioCVT(&stream->cvt_after,
+                                       AUDIO_F32SYS, dst_channels, dst_rate,
+                                       dst_format, dst_channels, dst_rate);
+        }
+        if (result >= 0) {
+            stream->resampler = SDL_NewAudioResampler(dst_channels, src_rate, dst_rate);
+            if (stream->resampler == NULL) {
+                result = -1;
+            }
+        }
+    } else {
+        result = SDL_BuildAudioCVT(&stream->cvt_before,
+                                   src_format, src_channels, src_rate,
+                                   dst_format, dst_channels, dst_rate);
+    }
+
+    if (result < 0) {
+        SDL_FreeAudioStream(stream);
+        return NULL;
+    }
+
+    stream->src_frame_size = SDL_AUDIO_BITSIZE(src_format) / 8 * src_channels;
+    stream->dst_channels = dst_channels;
+    return stream;
+}
+
+int
+SDL_AudioStreamPut(SDL_AudioStream * stream, const void *buf, int len)
+{
+    const Uint8 *src = (const Uint8 *) buf;
+    int total, bytes, copied;
+
+    if (stream == NULL) {
+        SDL_InvalidParamError("stream");
+        return -1;
+    }
+    if ((buf == NULL) || (len < 0)) {
+        SDL_InvalidParamError("buf");
+        return -1;
+    }
+
+    total = stream->partial_len + len;
+    bytes = total - (total % stream->src_frame_size);
+    if (bytes == 0) {
+        /* still not a whole frame */
+        SDL_memcpy(stream->partial + stream->partial_len, src, len);
+        stream->partial_len = total;
+        return 0;
+    }
+
+    /* The conversion happens in place, so everything goes through the
+       work buffer; put the saved partial frame in front of the new data. */
+    if (SDL_GrowAudioStreamBuffer(&stream->work, &stream->work_len,
+                                  bytes * stream->cvt_before.len_mult) < 0) {
+        return -1;
+    }
+    copied = bytes - stream->partial_len;
+    SDL_memcpy(stream->work, stream->partial, stream->partial_len);
+    SDL_memcpy(stream->work + stream->partial_len, src, copied);
+    stream->partial_len = len - copied;
+    SDL_memcpy(stream->partial, src + copied, stream->partial_len);
+
+    stream->cvt_before.buf = stream->work;
+    stream->cvt_before.len = bytes;
+    if (stream->cvt_before.needed) {
+        SDL_ConvertAudio(&stream->cvt_before);
+    } else {
+        stream->cvt_before.len_cvt = bytes;
+    }
+
+    if (stream->resampler) {
+        const int inframes = stream->cvt_before.len_cvt /
+            (stream->dst_channels * sizeof (float));
+        return SDL_ResampleAudioStream(stream, (const float *) stream->work, inframes);
+    }
+    return SDL_QueueAudioStreamData(stream, stream->work, stream->cvt_before.len_cvt);
+}
+
+int
+SDL_AudioStreamGet(SDL_AudioStream * stream, void *buf, int len)
+{
+    if (stream == NULL) {
+        SDL_InvalidParamError("stream");
+        return -1;
+    }
+    if ((buf == NULL) || (len < 0)) {
+        SDL_InvalidParamError("buf");
+        return -1;
+    }
+
+    if (len > stream->queue_len) {
+        len = stream->queue_len;
+    }
+    SDL_memcpy(buf, stream->queue + stream->queue_head, len);
+    stream->queue_head += len;
+    stream->queue_len -= len;
+    if (stream->queue_len == 0) {
+        stream->queue_head = 0;
+    }
+    return len;
+}
+
+int
+SDL_AudioStreamAvailable(SDL_AudioStream * stream)
+{
+    return (stream) ? stream->queue_len : 0;
+}
+
+int
+SDL_AudioStreamFlush(SDL_AudioStream * stream)
+{
+    int result = 0;
+
+    if (stream == NULL) {
+        SDL_InvalidParamError("stream");
+        return -1;
+    }
+
+    stream->partial_len = 0;
+    if (stream->resampler) {
+        result = SDL_ResampleAudioStream(stream, NULL, 0);
+        /* the tail went out with the flush, start over clean */
+        SDL_ResetAudioResampler(stream->resampler);
+    }
+    return result;
+}
+
+void
+SDL_AudioStreamClear(SDL_AudioStream * stream)
+{
+    if (stream == NULL) {
+        return;
+    }
+    stream->partial_len = 0;
+    stream->queue_head = 0;
+    stream->queue_len = 0;
+    if (stream->resampler) {
+        SDL_ResetAudioResampler(stream->resampler);
+    }
+}
+
+void
+SDL_FreeAudioStream(SDL_AudioStream * stream)
+{
+    if (stream == NULL) {
+        return;
+    }
+    SDL_FreeAudioResampler(stream->resampler);
+    SDL_free(stream->work);
+    SDL_free(stream->resampled);
+    SDL_free(stream->queue);
+    SDL_free(stream);
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
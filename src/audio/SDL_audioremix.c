@@ -0,0 +1,633 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* Channel matrix remixing.
+
+   Every output channel is a weighted sum of the input channels, using one
+   row of a dst_channels by src_channels matrix.  Frames are remixed a
+   block at a time: the block is split into one plane per input channel,
+   each output plane is summed from the input planes with nonzero weights,
+   several frames per vector, and the output planes are interleaved again.
+   The S16 scale factors are folded into the matrix, so converting from or
+   to AUDIO_S16SYS only needs exact int/float conversions around the mix,
+   all in the same pass. */
+
+#include "SDL_audio.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_audio_c.h"
+
+#ifdef HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+#endif
+
+#define REMIX_BLOCK         64      /* frames per pass, a multiple of 8 */
+#define REMIX_MAX_CHANNELS  8
+
+typedef struct SDL_RemixPlan
+{
+    int src_channels;
+    int dst_channels;
+    /* output m is the sum of weight[m][i] * input[m][i], for i < terms[m] */
+    int terms[REMIX_MAX_CHANNELS];
+    int input[REMIX_MAX_CHANNELS][REMIX_MAX_CHANNELS];
+    float weight[REMIX_MAX_CHANNELS][REMIX_MAX_CHANNELS];
+} SDL_RemixPlan;
+
+typedef float SDL_RemixPlanes[REMIX_MAX_CHANNELS][REMIX_BLOCK];
+
+typedef void (*SDL_RemixMixFunc) (const SDL_RemixPlan * plan,
+                                  SDL_RemixPlanes in, SDL_RemixPlanes out,
+                                  int frames);
+typedef void (*SDL_RemixFromS16Func) (const Sint16 * src, float *dst, int n);
+typedef void (*SDL_RemixToS16Func) (const float *src, Sint16 * dst, int n);
+
+static SDL_RemixMixFunc SDL_RemixMix = NULL;
+static SDL_RemixFromS16Func SDL_RemixFromS16 = NULL;
+static SDL_RemixToS16Func SDL_RemixToS16 = NULL;
+
+
+/* Default matrices for mono, stereo (FL FR), quad (FL FR BL BR) and 5.1
+   (FL FR FC LFE BL BR).  Upmixes don't invent center, rear or LFE signal.
+   Downmixes fold center and rear into the front at -3dB and drop the LFE,
+   scaled so that full scale input can't clip. */
+#define ITU_A 0.41421356f   /* 1 / (1 + 2 * sqrt(0.5)) */
+#define ITU_B 0.29289322f   /* sqrt(0.5) * ITU_A */
+#define ITU_C 0.58578644f   /* 1 / (1 + sqrt(0.5)) */
+#define ITU_D 0.41421356f   /* sqrt(0.5) * ITU_C */
+
+static const float remix_1_to_2[] = { 1.0f, 1.0f };
+static const float remix_1_to_4[] = { 1.0f, 1.0f, 0.0f, 0.0f };
+static const float remix_1_to_6[] = { 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+static const float remix_2_to_1[] = { 0.5f, 0.5f };
+static const float remix_2_to_4[] = {
+    1.0f, 0.0f,
+    0.0f, 1.0f,
+    0.0f, 0.0f,
+    0.0f, 0.0f
+};
+static const float remix_2_to_6[] = {
+    1.0f, 0.0f,
+    0.0f, 1.0f,
+    0.0f, 0.0f,
+    0.0f, 0.0f,
+    0.0f, 0.0f,
+    0.0f, 0.0f
+};
+static const float remix_4_to_1[] = { 0.25f, 0.25f, 0.25f, 0.25f };
+static const float remix_4_to_2[] = {
+    0.5f, 0.0f, 0.5f, 0.0f,
+    0.0f, 0.5f, 0.0f, 0.5f
+};
+static const float remix_4_to_6[] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+};
+static const float remix_6_to_1[] = {
+    ITU_A * 0.5f, ITU_A * 0.5f, ITU_B, 0.0f, ITU_B * 0.5f, ITU_B * 0.5f
+};
+static const float remix_6_to_2[] = {
+    ITU_A, 0.0f, ITU_B, 0.0f, ITU_B, 0.0f,
+    0.0f, ITU_A, ITU_B, 0.0f, 0.0f, ITU_B
+};
+static const float remix_6_to_4[] = {
+    ITU_C, 0.0f, ITU_D, 0.0f, 0.0f, 0.0f,
+    0.0f, ITU_C, ITU_D, 0.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f
+};
+
+#undef ITU_A
+#undef ITU_B
+#undef ITU_C
+#undef ITU_D
+
+const float *
+SDL_GetDefaultRemixMatrix(int src_channels, int dst_channels)
+{
+#define REMIX_CASE(from, to) \
+    if ((src_channels == from) && (dst_channels == to)) { \
+        return remix_##from##_to_##to; \
+    }
+    REMIX_CASE(1, 2);
+    REMIX_CASE(1, 4);
+    REMIX_CASE(1, 6);
+    REMIX_CASE(2, 1);
+    REMIX_CASE(2, 4);
+    REMIX_CASE(2, 6);
+    REMIX_CASE(4, 1);
+    REMIX_CASE(4, 2);
+    REMIX_CASE(4, 6);
+    REMIX_CASE(6, 1);
+    REMIX_CASE(6, 2);
+    REMIX_CASE(6, 4);
+#undef REMIX_CASE
+
+    return NULL;    /* no default for this pair. */
+}
+
+
+/* Split (frames) interleaved frames into one plane per channel */
+static void
+SDL_RemixSplit_Scalar(const float *in, int channels, SDL_RemixPlanes planes,
+                      int start, int frames)
+{
+    int i, n;
+    in += start * channels;
+    for (i = start; i < frames; i++) {
+        for (n = 0; n < channels; n++) {
+            planes[n][i] = *(in++);
+        }
+    }
+}
+
+static void
+SDL_RemixJoin_Scalar(SDL_RemixPlanes planes, int channels, float *out,
+                     int start, int frames)
+{
+    int i, m;
+    out += start * channels;
+    for (i = start; i < frames; i++) {
+        for (m = 0; m < channels; m++) {
+            *(out++) = planes[m][i];
+        }
+    }
+}
+
+static void
+SDL_RemixMix_Scalar(const SDL_RemixPlan * plan, SDL_RemixPlanes in,
+                    SDL_RemixPlanes out, int frames)
+{
+    int i, m, t;
+
+    for (m = 0; m < plan->dst_channels; m++) {
+        const int terms = plan->terms[m];
+        float *dst = out[m];
+        if (terms == 0) {
+            SDL_memset(dst, '\0', frames * sizeof (float));
+            continue;
+        }
+        for (i = 0; i < frames; i++) {
+            float sum = in[plan->input[m][0]][i] * plan->weight[m][0];
+            for (t = 1; t < terms; t++) {
+                sum += in[plan->input[m][t]][i] * plan->weight[m][t];
+            }
+            dst[i] = sum;
+        }
+    }
+}
+
+static void
+SDL_RemixFromS16_Scalar(const Sint16 * src, float *dst, int n)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+        dst[i] = (float) src[i];
+    }
+}
+
+static void
+SDL_RemixToS16_Scalar(const float *src, Sint16 * dst, int n)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+        const float sample = src[i];
+        if (sample >= 32767.0f) {
+            dst[i] = 32767;
+        } else if (sample <= -32768.0f) {
+            dst[i] = -32768;
+        } else {
+            dst[i] = (Sint16) sample;
+        }
+    }
+}
+
+#ifdef __SSE2__
+/* Splitting and joining work on four frames at a time, transposing them
+   with shuffles for the common channel counts. */
+static void
+SDL_RemixSplit_SSE2(const float *in, int channels, SDL_RemixPlanes planes,
+                    int frames)
+{
+    int i;
+
+    switch (channels) {
+    case 1:
+        SDL_memcpy(planes[0], in, frames * sizeof (float));
+        return;
+    case 2:
+        for (i = 0; (i + 4) <= frames; i += 4) {
+            const __m128 a = _mm_loadu_ps(in + i * 2);
+            const __m128 b = _mm_loadu_ps(in + i * 2 + 4);
+            _mm_storeu_ps(planes[0] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(planes[1] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        break;
+    case 4:
+    case 6:
+    case 8:
+        for (i = 0; (i + 4) <= frames; i += 4) {
+            const float *f = in + i * channels;
+            __m128 r0 = _mm_loadu_ps(f);
+            __m128 r1 = _mm_loadu_ps(f + channels);
+            __m128 r2 = _mm_loadu_ps(f + channels * 2);
+            __m128 r3 = _mm_loadu_ps(f + channels * 3);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(planes[0] + i, r0);
+            _mm_storeu_ps(planes[1] + i, r1);
+            _mm_storeu_ps(planes[2] + i, r2);
+            _mm_storeu_ps(planes[3] + i, r3);
+            if (channels == 6) {
+                /* [c4 c5] of each frame, paired up and split */
+                const __m128 a = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) (f + 4)), (const __m64 *) (f + 10));
+                const __m128 b = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) (f + 16)), (const __m64 *) (f + 22));
+                _mm_storeu_ps(planes[4] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(planes[5] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            } else if (channels == 8) {
+                r0 = _mm_loadu_ps(f + 4);
+                r1 = _mm_loadu_ps(f + 12);
+                r2 = _mm_loadu_ps(f + 20);
+                r3 = _mm_loadu_ps(f + 28);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(planes[4] + i, r0);
+                _mm_storeu_ps(planes[5] + i, r1);
+                _mm_storeu_ps(planes[6] + i, r2);
+                _mm_storeu_ps(planes[7] + i, r3);
+            }
+        }
+        break;
+    default:
+        i = 0;
+        break;
+    }
+    SDL_RemixSplit_Scalar(in, channels, planes, i, frames);
+}
+
+static void
+SDL_RemixJoin_SSE2(SDL_RemixPlanes planes, int channels, float *out,
+                   int frames)
+{
+    int i;
+
+    switch (channels) {
+    case 1:
+        SDL_memcpy(out, planes[0], frames * sizeof (float));
+        return;
+    case 2:
+        for (i = 0; (i + 4) <= frames; i += 4) {
+            const __m128 l = _mm_loadu_ps(planes[0] + i);
+            const __m128 r = _mm_loadu_ps(planes[1] + i);
+            _mm_storeu_ps(out + i * 2, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(out + i * 2 + 4, _mm_unpackhi_ps(l, r));
+        }
+        break;
+    case 4:
+    case 6:
+    case 8:
+        for (i = 0; (i + 4) <= frames; i += 4) {
+            float *f = out + i * channels;
+            __m128 r0 = _mm_loadu_ps(planes[0] + i);
+            __m128 r1 = _mm_loadu_ps(planes[1] + i);
+            __m128 r2 = _mm_loadu_ps(planes[2] + i);
+            __m128 r3 = _mm_loadu_ps(planes[3] + i);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(f, r0);
+            _mm_storeu_ps(f + channels, r1);
+            _mm_storeu_ps(f + channels * 2, r2);
+            _mm_storeu_ps(f + channels * 3, r3);
+            if (channels == 6) {
+                const __m128 c4 = _mm_loadu_ps(planes[4] + i);
+                const __m128 c5 = _mm_loadu_ps(planes[5] + i);
+                const __m128 a = _mm_unpacklo_ps(c4, c5);
+                const __m128 b = _mm_unpackhi_ps(c4, c5);
+                _mm_storel_pi((__m64 *) (f + 4), a);
+                _mm_storeh_pi((__m64 *) (f + 10), a);
+                _mm_storel_pi((__m64 *) (f + 16), b);
+                _mm_storeh_pi((__m64 *) (f + 22), b);
+            } else if (channels == 8) {
+                r0 = _mm_loadu_ps(planes[4] + i);
+                r1 = _mm_loadu_ps(planes[5] + i);
+                r2 = _mm_loadu_ps(planes[6] + i);
+                r3 = _mm_loadu_ps(planes[7] + i);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(f + 4, r0);
+                _mm_storeu_ps(f + 12, r1);
+                _mm_storeu_ps(f + 20, r2);
+                _mm_storeu_ps(f + 28, r3);
+            }
+        }
+        break;
+    default:
+        i = 0;
+        break;
+    }
+    SDL_RemixJoin_Scalar(planes, channels, out, i, frames);
+}
+
+/* The planes hold whole vectors, so there's no tail to take care of */
+static void
+SDL_RemixMix_SSE2(const SDL_RemixPlan * plan, SDL_RemixPlanes in,
+                  SDL_RemixPlanes out, int frames)
+{
+    int i, m, t;
+
+    frames = (frames + 3) & ~3;
+    for (m = 0; m < plan->dst_channels; m++) {
+        const int terms = plan->terms[m];
+        const float *src0 = in[plan->input[m][0]];
+        const __m128 w0 = _mm_set1_ps(plan->weight[m][0]);
+        float *dst = out[m];
+        if (terms == 0) {
+            SDL_memset(dst, '\0', frames * sizeof (float));
+            continue;
+        }
+        for (i = 0; i < frames; i += 4) {
+            __m128 sum = _mm_mul_ps(_mm_loadu_ps(src0 + i), w0);
+            for (t = 1; t < terms; t++) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in[plan->input[m][t]] + i),
+                                                 _mm_set1_ps(plan->weight[m][t])));
+            }
+            _mm_storeu_ps(dst + i, sum);
+        }
+    }
+}
+
+static void
+SDL_RemixFromS16_SSE2(const Sint16 * src, float *dst, int n)
+{
+    int i;
+    for (i = 0; (i + 8) <= n; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)));
+    }
+    SDL_RemixFromS16_Scalar(src + i, dst + i, n - i);
+}
+
+static void
+SDL_RemixToS16_SSE2(const float *src, Sint16 * dst, int n)
+{
+    const __m128 maxval = _mm_set1_ps(32767.0f);
+    const __m128 minval = _mm_set1_ps(-32768.0f);
+    int i;
+    for (i = 0; (i + 8) <= n; i += 8) {
+        const __m128i a = _mm_cvttps_epi32(_mm_max_ps(minval, _mm_min_ps(_mm_loadu_ps(src + i), maxval)));
+        const __m128i b = _mm_cvttps_epi32(_mm_max_ps(minval, _mm_min_ps(_mm_loadu_ps(src + i + 4), maxval)));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(a, b));
+    }
+    SDL_RemixToS16_Scalar(src + i, dst + i, n - i);
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+static void SDL_TARGETING_AVX2
+SDL_RemixMix_AVX2(const SDL_RemixPlan * plan, SDL_RemixPlanes in,
+                  SDL_RemixPlanes out, int frames)
+{
+    int i, m, t;
+
+    frames = (frames + 7) & ~7;
+    for (m = 0; m < plan->dst_channels; m++) {
+        const int terms = plan->terms[m];
+        const float *src0 = in[plan->input[m][0]];
+        const __m256 w0 = _mm256_set1_ps(plan->weight[m][0]);
+        float *dst = out[m];
+        if (terms == 0) {
+            SDL_memset(dst, '\0', frames * sizeof (float));
+            continue;
+        }
+        for (i = 0; i < frames; i += 8) {
+            __m256 sum = _mm256_mul_ps(_mm256_loadu_ps(src0 + i), w0);
+            for (t = 1; t < terms; t++) {
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(in[plan->input[m][t]] + i),
+                                                       _mm256_set1_ps(plan->weight[m][t])));
+            }
+            _mm256_storeu_ps(dst + i, sum);
+        }
+    }
+}
+
+static void SDL_TARGETING_AVX2
+SDL_RemixFromS16_AVX2(const Sint16 * src, float *dst, int n)
+{
+    int i;
+    for (i = 0; (i + 16) <= n; i += 16) {
+        const __m256i x = _mm256_loadu_si256((const __m256i *) (src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(x))));
+        _mm256_storeu_ps(dst + i + 8, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1))));
+    }
+    SDL_RemixFromS16_Scalar(src + i, dst + i, n - i);
+}
+#endif
+
+static void
+SDL_ChooseRemixFuncs(void)
+{
+    if (SDL_RemixMix) {
+        return;
+    }
+    SDL_RemixFromS16 = SDL_RemixFromS16_Scalar;
+    SDL_RemixToS16 = SDL_RemixToS16_Scalar;
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        SDL_RemixFromS16 = SDL_RemixFromS16_SSE2;
+        SDL_RemixToS16 = SDL_RemixToS16_SSE2;
+    }
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        SDL_RemixFromS16 = SDL_RemixFromS16_AVX2;
+        SDL_RemixMix = SDL_RemixMix_AVX2;
+        return;
+    }
+#endif
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        SDL_RemixMix = SDL_RemixMix_SSE2;
+        return;
+    }
+#endif
+    SDL_RemixMix = SDL_RemixMix_Scalar;
+}
+
+static void
+SDL_RemixSplit(const float *in, int channels, SDL_RemixPlanes planes,
+               int frames)
+{
+#ifdef __SSE2__
+    if (SDL_RemixMix != SDL_RemixMix_Scalar) {
+        SDL_RemixSplit_SSE2(in, channels, planes, frames);
+        return;
+    }
+#endif
+    SDL_RemixSplit_Scalar(in, channels, planes, 0, frames);
+}
+
+static void
+SDL_RemixJoin(SDL_RemixPlanes planes, int channels, float *out, int frames)
+{
+#ifdef __SSE2__
+    if (SDL_RemixMix != SDL_RemixMix_Scalar) {
+        SDL_RemixJoin_SSE2(planes, channels, out, frames);
+        return;
+    }
+#endif
+    SDL_RemixJoin_Scalar(planes, channels, out, 0, frames);
+}
+
+/* The arguments have been checked by the caller */
+void
+SDL_RemixAudioFrames(SDL_AudioFormat src_fmt, int src_channels,
+                     const void *src, SDL_AudioFormat dst_fmt,
+                     int dst_channels, void *dst, const float *matrix,
+                     int frames)
+{
+    const int src_s16 = (src_fmt == AUDIO_S16SYS);
+    const int dst_s16 = (dst_fmt == AUDIO_S16SYS);
+    const int src_frame = (src_s16 ? 2 : 4) * src_channels;
+    const int dst_frame = (dst_s16 ? 2 : 4) * dst_channels;
+    float scale = 1.0f;
+    float scratch[REMIX_BLOCK * REMIX_MAX_CHANNELS];
+    SDL_RemixPlanes inplanes, outplanes;
+    SDL_RemixPlan plan;
+    int first, last, step;
+    int block, count;
+    int m, n;
+
+    if (frames <= 0) {
+        return;
+    }
+
+    SDL_ChooseRemixFuncs();
+
+    if (src_s16 && !dst_s16) {
+        scale = 1.0f / 32767.0f;
+    } else if (dst_s16 && !src_s16) {
+        scale = 32767.0f;
+    }
+    SDL_zero(plan);
+    plan.src_channels = src_channels;
+    plan.dst_channels = dst_channels;
+    for (m = 0; m < dst_channels; m++) {
+        for (n = 0; n < src_channels; n++) {
+            const float weight = matrix[m * src_channels + n];
+            if (weight != 0.0f) {
+                plan.input[m][plan.terms[m]] = n;
+                plan.weight[m][plan.terms[m]] = weight * scale;
+                plan.terms[m]++;
+            }
+        }
+    }
+
+    /* The mix runs over whole vectors, so keep the planes past a short
+       last block from holding garbage */
+    SDL_zero(inplanes);
+
+    /* A whole block is read before any of it is written, so when frames
+       grow, going back to front keeps the input ahead of the output. */
+    last = (frames - 1) / REMIX_BLOCK;
+    if (dst_frame > src_frame) {
+        first = last;
+        last = -1;
+        step = -1;
+    } else {
+        first = 0;
+        last = last + 1;
+        step = 1;
+    }
+
+    for (block = first; block != last; block += step) {
+        const int start = block * REMIX_BLOCK;
+        const Uint8 *in = (const Uint8 *) src + start * src_frame;
+        Uint8 *out = (Uint8 *) dst + start * dst_frame;
+        count = SDL_min(REMIX_BLOCK, frames - start);
+
+        if (src_s16) {
+            SDL_RemixFromS16((const Sint16 *) in, scratch, count * src_channels);
+            SDL_RemixSplit(scratch, src_channels, inplanes, count);
+        } else {
+            SDL_RemixSplit((const float *) in, src_channels, inplanes, count);
+        }
+
+        SDL_RemixMix(&plan, inplanes, outplanes, count);
+
+        if (dst_s16) {
+            SDL_RemixJoin(outplanes, dst_channels, scratch, count);
+            SDL_RemixToS16(scratch, (Sint16 *) out, count * dst_channels);
+        } else {
+            SDL_RemixJoin(outplanes, dst_channels, (float *) out, count);
+        }
+    }
+}
+
+int
+SDL_RemixAudio(SDL_AudioFormat src_format, Uint8 src_channels,
+               const void *src, SDL_AudioFormat dst_format,
+               Uint8 dst_channels, void *dst, const float *matrix, int frames)
+{
+    if ((src_format != AUDIO_S16SYS) && (src_format != AUDIO_F32SYS)) {
+        SDL_SetError("Unsupported source format");
+        return -1;
+    }
+    if ((dst_format != AUDIO_S16SYS) && (dst_format != AUDIO_F32SYS)) {
+        SDL_SetError("Unsupported destination format");
+        return -1;
+    }
+    if ((src_channels == 0) || (src_channels > REMIX_MAX_CHANNELS)) {
+        SDL_InvalidParamError("src_channels");
+        return -1;
+    }
+    if ((dst_channels == 0) || (dst_channels > REMIX_MAX_CHANNELS)) {
+        SDL_InvalidParamError("dst_channels");
+        return -1;
+    }
+    if (frames < 0) {
+        SDL_InvalidParamError("frames");
+        return -1;
+    }
+    if (frames > 0) {
+        if (src == NULL) {
+            SDL_InvalidParamError("src");
+            return -1;
+        }
+        if (dst == NULL) {
+            SDL_InvalidParamError("dst");
+            return -1;
+        }
+    }
+    if (matrix == NULL) {
+        matrix = SDL_GetDefaultRemixMatrix(src_channels, dst_channels);
+        if (matrix == NULL) {
+            SDL_SetError("No default remix for these channel counts");
+            return -1;
+        }
+    }
+
+    SDL_RemixAudioFrames(src_format, src_channels, src, dst_format,
+                         dst_channels, dst, matrix, frames);
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,719 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* Band-limited resampling for arbitrary rate ratios.
+
+   Every output sample is the dot product of the input history around the
+   output position with one row of a windowed-sinc filter table.  The
+   table holds one row per fractional phase; if the reduced output rate is
+   small enough every phase gets its own row, otherwise neighbouring rows
+   are linearly interpolated.  Tables only depend on the rate pair, so
+   they are shared between resamplers through a small reference counted
+   cache.  SDL_ConvertAudio() also parks its resamplers in a small pool
+   between calls instead of building a new one for every buffer. */
+
+#include "SDL_audio.h"
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_audio_c.h"
+
+#ifdef HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+#endif
+
+#define RESAMPLER_MAX_PHASES        512
+#define RESAMPLER_ZERO_CROSSINGS    32
+#define RESAMPLER_MAX_HALF          1024
+#define RESAMPLER_KAISER_BETA       8.0
+#define RESAMPLER_CACHE_SIZE        8
+#define RESAMPLER_ALIGN             32
+#define RESAMPLER_IDLE_SIZE         4
+#define RESAMPLER_IDLE_FRAMES       4096
+
+typedef struct SDL_ResampleTable
+{
+    int in_rate;                /* reduced input rate */
+    int out_rate;               /* reduced output rate */
+    int refcount;               /* protected by resample_cache_lock */
+    int phases;                 /* the table holds phases+1 rows */
+    int half;                   /* taps on each side of the output position */
+    int taps;                   /* 2*half, a multiple of 8 */
+    float *coeffs;              /* (phases+1)*taps, RESAMPLER_ALIGN aligned */
+    void *alloc;
+} SDL_ResampleTable;
+
+struct SDL_AudioResampler
+{
+    int channels;
+    SDL_ResampleTable *table;
+    float **planes;             /* per-channel input history */
+    int plane_len;              /* frames currently buffered */
+    int plane_max;              /* frames allocated per plane */
+    int ipos;                   /* integer part of the output position */
+    int frac;                   /* fractional part, in 1/out_rate units */
+    float *row;                 /* scratch row for interpolated tables */
+    void *row_alloc;
+};
+
+typedef float (*SDL_ResampleDotFunc) (const float *coeffs, const float *src, int taps);
+
+static SDL_ResampleDotFunc SDL_ResampleDot = NULL;
+static SDL_ResampleTable *resample_cache[RESAMPLER_CACHE_SIZE];
+static SDL_SpinLock resample_cache_lock = 0;
+
+static SDL_AudioResampler *resampler_idle[RESAMPLER_IDLE_SIZE];
+static SDL_SpinLock resampler_idle_lock = 0;
+
+
+static float
+SDL_ResampleDot_Scalar(const float *coeffs, const float *src, int taps)
+{
+    float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    int i;
+
+    for (i = 0; i < taps; i += 4) {
+        sum0 += coeffs[i] * src[i];
+        sum1 += coeffs[i + 1] * src[i + 1];
+        sum2 += coeffs[i + 2] * src[i + 2];
+        sum3 += coeffs[i + 3] * src[i + 3];
+    }
+    return (sum0 + sum2) + (sum1 + sum3);
+}
+
+#ifdef __SSE2__
+static float
+SDL_ResampleDot_SSE2(const float *coeffs, const float *src, int taps)
+{
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    float result[4];
+    int i;
+
+    for (i = 0; i < taps; i += 8) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_load_ps(coeffs + i),
+                                           _mm_loadu_ps(src + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_load_ps(coeffs + i + 4),
+                                           _mm_loadu_ps(src + i + 4)));
+    }
+    _mm_storeu_ps(result, _mm_add_ps(sum0, sum1));
+    return (result[0] + result[2]) + (result[1] + result[3]);
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+static float SDL_TARGETING_AVX2
+SDL_ResampleDot_AVX2(const float *coeffs, const float *src, int taps)
+{
+    __m256 sum = _mm256_setzero_ps();
+    __m128 half;
+    float result[4];
+    int i;
+
+    for (i = 0; i < taps; i += 8) {
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_load_ps(coeffs + i),
+                                               _mm256_loadu_ps(src + i)));
+    }
+    half = _mm_add_ps(_mm256_castps256_ps128(sum),
+                      _mm256_extractf128_ps(sum, 1));
+    _mm_storeu_ps(result, half);
+    return (result[0] + result[2]) + (result[1] + result[3]);
+}
+#endif
+
+static void
+SDL_ChooseResampleDot(void)
+{
+    if (SDL_ResampleDot) {
+        return;
+    }
+#ifdef HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        SDL_ResampleDot = SDL_ResampleDot_AVX2;
+        return;
+    }
+#endif
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        SDL_ResampleDot = SDL_ResampleDot_SSE2;
+        return;
+    }
+#endif
+    SDL_ResampleDot = SDL_ResampleDot_Scalar;
+}
+
+static void *
+SDL_AlignPointer(void *ptr)
+{
+    return (void *) (((size_t) ptr + (RESAMPLER_ALIGN - 1)) &
+                     ~(size_t) (RESAMPLER_ALIGN - 1));
+}
+
+static int
+SDL_ResampleGCD(int a, int b)
+{
+    while (b != 0) {
+        const int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Zeroth order modified Bessel function of the first kind */
+static double
+SDL_BesselI0(double x)
+{
+    const double xx = (x * x) / 4.0;
+    double sum = 1.0, term = 1.0;
+    int k;
+
+    for (k = 1; k < 64; k++) {
+        term *= xx / ((double) k * (double) k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+static SDL_ResampleTable *
+SDL_BuildResampleTable(int in_rate, int out_rate)
+{
+    const double pi = 3.14159265358979323846;
+    const double inv_i0_beta = 1.0 / SDL_BesselI0(RESAMPLER_KAISER_BETA);
+    SDL_ResampleTable *table;
+    double cutoff;
+    int half, row;
+
+    /* Cutoff in cycles per input sample.  Equal rates get a pure delta so
+       the filter is exactly transparent. */
+    if (in_rate == out_rate) {
+        cutoff = 0.5;
+    } else if (out_rate < in_rate) {
+        cutoff = 0.45 * (double) out_rate / (double) in_rate;
+    } else {
+        cutoff = 0.45;
+    }
+
+    half = (int) SDL_ceil(RESAMPLER_ZERO_CROSSINGS / (2.0 * cutoff));
+    half = (half + 3) & ~3;
+    if (half > RESAMPLER_MAX_HALF) {
+        half = RESAMPLER_MAX_HALF;
+    }
+
+    table = (SDL_ResampleTable *) SDL_calloc(1, sizeof (SDL_ResampleTable));
+    if (table == NULL) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    table->in_rate = in_rate;
+    table->out_rate = out_rate;
+    table->refcount = 1;
+    table->phases = (out_rate <= RESAMPLER_MAX_PHASES) ? out_rate : RESAMPLER_MAX_PHASES;
+    table->half = half;
+    table->taps = half * 2;
+    table->alloc = SDL_malloc((table->phases + 1) * table->taps * sizeof (float) + RESAMPLER_ALIGN);
+    if (table->alloc == NULL) {
+        SDL_free(table);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    table->coeffs = (float *) SDL_AlignPointer(table->alloc);
+
+    /* Row `row` is the filter for an output position row/phases of the
+       way between two input samples.  Tap j multiplies input sample
+       (ipos - half + 1 + j), which lies `d` samples before the output. */
+    for (row = 0; row <= table->phases; row++) {
+        float *coeffs = table->coeffs + row * table->taps;
+        const double phase = (double) row / (double) table->phases;
+        double sum = 0.0;
+        int j;
+
+        for (j = 0; j < table->taps; j++) {
+            const double d = phase + (double) (half - 1 - j);
+            const double x = d / (double) half;
+            double h, w;
+
+            if (x <= -1.0 || x >= 1.0) {
+                h = 0.0;
+            } else {
+                const double arg = 2.0 * pi * cutoff * d;
+                h = (d == 0.0) ? 2.0 * cutoff : SDL_sin(arg) / (pi * d);
+                w = SDL_BesselI0(RESAMPLER_KAISER_BETA * SDL_sqrt(1.0 - x * x));
+                h *= w * inv_i0_beta;
+            }
+            coeffs[j] = (float) h;
+            sum += h;
+        }
+
+        /* unity gain at DC for every phase */
+        if (sum != 0.0) {
+            for (j = 0; j < table->taps; j++) {
+                coeffs[j] = (float) (coeffs[j] / sum);
+            }
+        }
+    }
+
+    return table;
+}
+
+static void
+SDL_ReleaseResampleTable(SDL_ResampleTable * table)
+{
+    int refcount;
+
+    SDL_AtomicLock(&resample_cache_lock);
+    refcount = --table->refcount;
+    SDL_AtomicUnlock(&resample_cache_lock);
+
+    if (refcount == 0) {
+        SDL_free(table->alloc);
+        SDL_free(table);
+    }
+}
+
+static SDL_ResampleTable *
+SDL_GetResampleTable(int in_rate, int out_rate)
+{
+    SDL_ResampleTable *table = NULL;
+    SDL_ResampleTable *evicted = NULL;
+    SDL_ResampleTable *built;
+    int i, slot = -1;
+
+    SDL_AtomicLock(&resample_cache_lock);
+    for (i = 0; i < RESAMPLER_CACHE_SIZE; i++) {
+        table = resample_cache[i];
+        if (table && table->in_rate == in_rate && table->out_rate == out_rate) {
+            table->refcount++;
+            break;
+        }
+        table = NULL;
+    }
+    SDL_AtomicUnlock(&resample_cache_lock);
+
+    if (table) {
+        return table;
+    }
+
+    /* Build outside the lock, this can take a moment for steep filters */
+    built = SDL_BuildResampleTable(in_rate, out_rate);
+    if (built == NULL) {
+        return NULL;
+    }
+
+    SDL_AtomicLock(&resample_cache_lock);
+    for (i = 0; i < RESAMPLER_CACHE_SIZE; i++) {
+        table = resample_cache[i];
+        if (table && table->in_rate == in_rate && table->out_rate == out_rate) {
+            /* someone else got here first */
+            table->refcount++;
+            break;
+        }
+        table = NULL;
+        if (slot < 0 && resample_cache[i] == NULL) {
+            slot = i;
+        }
+    }
+    if (table == NULL) {
+        table = built;
+        built = NULL;
+        if (slot < 0) {
+            /* evict an entry that only the cache is holding on to */
+            for (i = 0; i < RESAMPLER_CACHE_SIZE; i++) {
+                if (resample_cache[i]->refcount == 1) {
+                    evicted = resample_cache[i];
+                    resample_cache[i] = NULL;
+                    slot = i;
+                    break;
+                }
+            }
+        }
+        if (slot >= 0) {
+            table->refcount++;  /* the cache's reference */
+            resample_cache[slot] = table;
+        }
+    }
+    SDL_AtomicUnlock(&resample_cache_lock);
+
+    if (built) {
+        SDL_free(built->alloc);
+        SDL_free(built);
+    }
+    if (evicted) {
+        SDL_ReleaseResampleTable(evicted);
+    }
+    return table;
+}
+
+void
+SDL_QuitAudioResampler(void)
+{
+    int i;
+    for (i = 0; i < RESAMPLER_IDLE_SIZE; i++) {
+        SDL_AudioResampler *resampler;
+
+        SDL_AtomicLock(&resampler_idle_lock);
+        resampler = resampler_idle[i];
+        resampler_idle[i] = NULL;
+        SDL_AtomicUnlock(&resampler_idle_lock);
+
+        SDL_FreeAudioResampler(resampler);
+    }
+    for (i = 0; i < RESAMPLER_CACHE_SIZE; i++) {
+        SDL_ResampleTable *table;
+
+        SDL_AtomicLock(&resample_cache_lock);
+        table = resample_cache[i];
+        resample_cache[i] = NULL;
+        SDL_AtomicUnlock(&resample_cache_lock);
+
+        if (table) {
+            SDL_ReleaseResampleTable(table);
+        }
+    }
+}
+
+SDL_AudioResampler *
+SDL_NewAudioResampler(int channels, int src_rate, int dst_rate)
+{
+    SDL_AudioResampler *resampler;
+    int gcd, i;
+
+    if (channels <= 0 || src_rate <= 0 || dst_rate <= 0) {
+        SDL_InvalidParamError("channels/rate");
+        return NULL;
+    }
+
+    SDL_ChooseResampleDot();
+
+    resampler = (SDL_AudioResampler *) SDL_calloc(1, sizeof (SDL_AudioResampler));
+    if (resampler == NULL) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    resampler->channels = channels;
+    resampler->planes = (float **) SDL_calloc(channels, sizeof (float *));
+    if (resampler->planes == NULL) {
+        SDL_free(resampler);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    gcd = SDL_ResampleGCD(src_rate, dst_rate);
+    resampler->table = SDL_GetResampleTable(src_rate / gcd, dst_rate / gcd);
+    if (resampler->table == NULL) {
+        SDL_FreeAudioResampler(resampler);
+        return NULL;
+    }
+
+    if (resampler->table->phases != resampler->table->out_rate) {
+        resampler->row_alloc = SDL_malloc(resampler->table->taps * sizeof (float) + RESAMPLER_ALIGN);
+        if (resampler->row_alloc == NULL) {
+            SDL_FreeAudioResampler(resampler);
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        resampler->row = (float *) SDL_AlignPointer(resampler->row_alloc);
+    }
+
+    /* room for the initial history plus a typical buffer */
+    resampler->plane_max = resampler->table->taps + 4096;
+    for (i = 0; i < channels; i++) {
+        resampler->planes[i] = (float *) SDL_malloc(resampler->plane_max * sizeof (float));
+        if (resampler->planes[i] == NULL) {
+            SDL_FreeAudioResampler(resampler);
+            SDL_OutOfMemory();
+            return NULL;
+        }
+    }
+
+    SDL_ResetAudioResampler(resampler);
+    return resampler;
+}
+
+void
+SDL_FreeAudioResampler(SDL_AudioResampler * resampler)
+{
+    int i;
+
+    if (resampler == NULL) {
+        return;
+    }
+    if (resampler->planes) {
+        for (i = 0; i < resampler->channels; i++) {
+            SDL_free(resampler->planes[i]);
+        }
+        SDL_free(resampler->planes);
+    }
+    if (resampler->table) {
+        SDL_ReleaseResampleTable(resampler->table);
+    }
+    SDL_free(resampler->row_alloc);
+    SDL_free(resampler);
+}
+
+void
+SDL_ResetAudioResampler(SDL_AudioResampler * resampler)
+{
+    /* Start with half-1 frames of silence so the first output lines up
+       with the first input frame. */
+    const int history = resampler->table->half - 1;
+    int i;
+
+    for (i = 0; i < resampler->channels; i++) {
+        SDL_memset(resampler->planes[i], '\0', history * sizeof (float));
+    }
+    resampler->plane_len = history;
+    resampler->ipos = history;
+    resampler->frac = 0;
+}
+
+SDL_AudioResampler *
+SDL_AcquireAudioResampler(int channels, int src_rate, int dst_rate)
+{
+    SDL_AudioResampler *resampler = NULL;
+    int gcd, i;
+
+    if (channels > 0 && src_rate > 0 && dst_rate > 0) {
+        gcd = SDL_ResampleGCD(src_rate, dst_rate);
+        SDL_AtomicLock(&resampler_idle_lock);
+        for (i = 0; i < RESAMPLER_IDLE_SIZE; i++) {
+            SDL_AudioResampler *idle = resampler_idle[i];
+            if (idle && idle->channels == channels &&
+                idle->table->in_rate == src_rate / gcd &&
+                idle->table->out_rate == dst_rate / gcd) {
+                resampler_idle[i] = NULL;
+                resampler = idle;
+                break;
+            }
+        }
+        SDL_AtomicUnlock(&resampler_idle_lock);
+    }
+
+    if (resampler == NULL) {
+        return SDL_NewAudioResampler(channels, src_rate, dst_rate);
+    }
+    SDL_ResetAudioResampler(resampler);
+    return resampler;
+}
+
+void
+SDL_ReleaseAudioResampler(SDL_AudioResampler * resampler)
+{
+    SDL_AudioResampler *evicted;
+    int frames, i, slot = RESAMPLER_IDLE_SIZE - 1;
+
+    if (resampler == NULL) {
+        return;
+    }
+    frames = resampler->table->taps + RESAMPLER_IDLE_FRAMES;
+
+    /* Don't hold on to the history of a long clip while idle */
+    if (resampler->plane_max > frames) {
+        for (i = 0; i < resampler->channels; i++) {
+            float *ptr = (float *) SDL_realloc(resampler->planes[i], frames * sizeof (float));
+            if (ptr == NULL) {
+                SDL_FreeAudioResampler(resampler);
+                return;
+            }
+            resampler->planes[i] = ptr;
+        }
+        resampler->plane_max = frames;
+    }
+
+    SDL_AtomicLock(&resampler_idle_lock);
+    for (i = 0; i < RESAMPLER_IDLE_SIZE; i++) {
+        if (resampler_idle[i] == NULL) {
+            slot = i;
+            break;
+        }
+    }
+    /* newest first; if the pool is full the oldest one makes room */
+    evicted = resampler_idle[slot];
+    for (i = slot; i > 0; i--) {
+        resampler_idle[i] = resampler_idle[i - 1];
+    }
+    resampler_idle[0] = resampler;
+    SDL_AtomicUnlock(&resampler_idle_lock);
+
+    SDL_FreeAudioResampler(evicted);
+}
+
+int
+SDL_AudioResamplerMaxOutput(SDL_AudioResampler * resampler, int inframes)
+{
+    const SDL_ResampleTable *table = resampler->table;
+    const Sint64 limit = (Sint64) resampler->plane_len + inframes -
+        table->half - 1 - resampler->ipos;
+    Sint64 count;
+
+    if (limit < 0) {
+        return 0;
+    }
+    /* number of steps n with ipos + (frac + n*in_rate) / out_rate <= ipos + limit */
+    count = ((limit + 1) * table->out_rate - resampler->frac +
+             table->in_rate - 1) / table->in_rate;
+    return (count > 0x7FFFFFFF) ? 0x7FFFFFFF : (int) count;
+}
+
+static int
+SDL_GrowResamplerPlanes(SDL_AudioResampler * resampler, int frames)
+{
+    int i, newmax = resampler->plane_max;
+
+    if (frames <= newmax) {
+        return 0;
+    }
+    while (newmax < frames) {
+        newmax *= 2;
+    }
+    for (i = 0; i < resampler->channels; i++) {
+        float *ptr = (float *) SDL_realloc(resampler->planes[i], newmax * sizeof (float));
+        if (ptr == NULL) {
+            SDL_OutOfMemory();
+            return -1;
+        }
+        resampler->planes[i] = ptr;
+    }
+    resampler->plane_max = newmax;
+    return 0;
+}
+
+static int
+SDL_AppendResamplerInput(SDL_AudioResampler * resampler, const float *in, int inframes)
+{
+    const int channels = resampler->channels;
+    int i, c;
+
+    if (inframes <= 0) {
+        return 0;
+    }
+    if (SDL_GrowResamplerPlanes(resampler, resampler->plane_len + inframes) < 0) {
+        return -1;
+    }
+
+    if (in == NULL) {
+        for (c = 0; c < channels; c++) {
+            SDL_memset(resampler->planes[c] + resampler->plane_len, '\0',
+                       inframes * sizeof (float));
+        }
+    } else if (channels == 1) {
+        SDL_memcpy(resampler->planes[0] + resampler->plane_len, in,
+                   inframes * sizeof (float));
+    } else {
+        for (c = 0; c < channels; c++) {
+            float *dst = resampler->planes[c] + resampler->plane_len;
+            const float *src = in + c;
+            for (i = 0; i < inframes; i++) {
+                dst[i] = *src;
+                src += channels;
+            }
+        }
+    }
+    resampler->plane_len += inframes;
+    return 0;
+}
+
+int
+SDL_AudioResamplerFlush(SDL_AudioResampler * resampler)
+{
+    return SDL_AppendResamplerInput(resampler, NULL, resampler->table->half);
+}
+
+int
+SDL_AudioResamplerProcess(SDL_AudioResampler * resampler,
+                          const float *in, int inframes,
+                          float *out, int outframes)
+{
+    const SDL_ResampleTable *table = resampler->table;
+    const SDL_ResampleDotFunc dot = SDL_ResampleDot;
+    const int channels = resampler->channels;
+    const int half = table->half;
+    const int taps = table->taps;
+    const int in_rate = table->in_rate;
+    const int out_rate = table->out_rate;
+    const int exact = (table->phases == out_rate);
+    float **planes = resampler->planes;
+    int ipos = resampler->ipos;
+    int frac = resampler->frac;
+    int produced = 0;
+    int drop, c;
+
+    if (SDL_AppendResamplerInput(resampler, in, inframes) < 0) {
+        return -1;
+    }
+
+    while ((produced < outframes) && (ipos + half < resampler->plane_len)) {
+        const int first = ipos - half + 1;
+        const float *row;
+
+        if (exact) {
+            row = table->coeffs + frac * taps;
+        } else {
+            /* blend the two nearest rows */
+            const Sint64 scaled = (Sint64) frac * table->phases;
+            const int idx = (int) (scaled / out_rate);
+            const float mu = (float) (scaled % out_rate) / (float) out_rate;
+            const float *row0 = table->coeffs + idx * taps;
+            const float *row1 = row0 + taps;
+            float *tmp = resampler->row;
+            int j;
+            for (j = 0; j < taps; j++) {
+                tmp[j] = row0[j] + mu * (row1[j] - row0[j]);
+            }
+            row = tmp;
+        }
+
+        for (c = 0; c < channels; c++) {
+            out[c] = dot(row, planes[c] + first, taps);
+        }
+        out += channels;
+        produced++;
+
+        frac += in_rate;
+        if (frac >= out_rate) {
+            ipos += frac / out_rate;
+            frac %= out_rate;
+        }
+    }
+
+    /* discard history that no future output can reach */
+    drop = ipos - (half - 1);
+    if (drop > resampler->plane_len) {
+        drop = resampler->plane_len;
+    }
+    if (drop > 0) {
+        const int remain = resampler->plane_len - drop;
+        for (c = 0; c < channels; c++) {
+            SDL_memmove(planes[c], planes[c] + drop, remain * sizeof (float));
+        }
+        resampler->plane_len = remain;
+        ipos -= drop;
+    }
+
+    resampler->ipos = ipos;
+    resampler->frac = frac;
+    return produced;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
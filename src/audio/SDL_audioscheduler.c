@@ -0,0 +1,310 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* The shared audio scheduler.
+
+   Instead of one thread per device, a single scheduler thread keeps the
+   deadline at which each scheduled device wants its next buffer.  Devices
+   that are due go on a queue for a small pool of worker threads; each
+   worker mixes a device, sets its next deadline and wakes the scheduler,
+   so one slow callback only delays its own device.  In between the
+   scheduler sleeps until the earliest deadline, or until a device is
+   added, removed, unpaused or mixed.  Without workers the scheduler mixes
+   the queue itself. */
+
+#include "SDL_audio.h"
+#include "SDL_atomic.h"
+#include "SDL_timer.h"
+#include "SDL_thread.h"
+#include "SDL_audio_c.h"
+#include "SDL_sysaudio.h"
+
+#define SDL_AUDIO_MAX_SCHEDULED 16
+#define SDL_AUDIO_MAX_SCHEDULER_THREADS 8
+
+static SDL_SpinLock scheduler_start_lock = 0;
+
+static struct
+{
+    SDL_mutex *lock;
+    SDL_cond *wake;     /* devices were added, removed, unpaused or mixed */
+    SDL_cond *work;     /* devices are waiting on the queue */
+    SDL_cond *done;     /* a device was mixed */
+    SDL_Thread *thread;
+    SDL_Thread *workers[SDL_AUDIO_MAX_SCHEDULER_THREADS - 1];
+    int numworkers;
+    int quit;
+
+    SDL_AudioDevice *devices[SDL_AUDIO_MAX_SCHEDULED];
+    int numdevices;
+
+    /* Due devices waiting for a worker.  A device is busy from when it's
+       queued until it's mixed, so it's never on the queue twice. */
+    SDL_AudioDevice *queue[SDL_AUDIO_MAX_SCHEDULED];
+    int queue_head;
+    int queue_len;
+} scheduler;
+
+/* Mix devices off the queue until it's empty.  Called with the scheduler
+   lock held, which is dropped while mixing. */
+static void
+SDL_RunAudioQueue(void)
+{
+    SDL_AudioDevice *device;
+    Uint64 deadline;
+
+    while (scheduler.queue_len > 0) {
+        device = scheduler.queue[scheduler.queue_head];
+        scheduler.queue_head = (scheduler.queue_head + 1) % SDL_AUDIO_MAX_SCHEDULED;
+        scheduler.queue_len--;
+        SDL_UnlockMutex(scheduler.lock);
+        deadline = SDL_RunAudioPeriod(device);
+        SDL_LockMutex(scheduler.lock);
+        device->deadline = deadline;
+        device->busy = 0;
+        SDL_CondBroadcast(scheduler.done);
+        SDL_CondSignal(scheduler.wake);
+    }
+}
+
+static int SDLCALL
+SDL_RunAudioWorker(void *unused)
+{
+    SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
+
+    SDL_LockMutex(scheduler.lock);
+    while (!scheduler.quit) {
+        if (scheduler.queue_len > 0) {
+            SDL_RunAudioQueue();
+        } else {
+            SDL_CondWait(scheduler.work, scheduler.lock);
+        }
+    }
+    SDL_UnlockMutex(scheduler.lock);
+
+    return (0);
+}
+
+static int SDLCALL
+SDL_RunAudioScheduler(void *unused)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    SDL_AudioDevice *device;
+    Uint64 now;
+    Uint64 next;
+    int queued;
+    int i;
+
+    /* The audio mixing is always a high priority thread */
+    SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
+
+    SDL_LockMutex(scheduler.lock);
+    while (!scheduler.quit) {
+        /* Queue every idle device that's due, and find the next deadline.
+           Busy devices get a new deadline when they're done. */
+        now = SDL_GetPerformanceCounter();
+        next = 0;
+        queued = 0;
+        for (i = 0; i < scheduler.numdevices; i++) {
+            device = scheduler.devices[i];
+            if (device->busy) {
+                continue;
+            } else if (!device->enabled || device->paused) {
+                device->deadline = 0;   /* due as soon as it's unpaused */
+            } else if (device->deadline <= now) {
+                device->busy = 1;
+                scheduler.queue[(scheduler.queue_head + scheduler.queue_len) %
+                                SDL_AUDIO_MAX_SCHEDULED] = device;
+                scheduler.queue_len++;
+                queued++;
+            } else if ((next == 0) || (device->deadline < next)) {
+                next = device->deadline;
+            }
+        }
+
+        if (queued > 0) {
+            if (scheduler.numworkers == 0) {
+                SDL_RunAudioQueue();
+                continue;
+            }
+            SDL_CondBroadcast(scheduler.work);
+        }
+
+        if (next != 0) {
+            /* Round up, so we don't wake up just before the deadline */
+            SDL_CondWaitTimeout(scheduler.wake, scheduler.lock,
+                                (Uint32) ((((next - now) * 1000) + freq - 1) /
+                                          freq));
+        } else {
+            SDL_CondWait(scheduler.wake, scheduler.lock);
+        }
+    }
+    SDL_UnlockMutex(scheduler.lock);
+
+    return (0);
+}
+
+static int
+SDL_StartAudioScheduler(int threads)
+{
+    char name[64];
+    int i;
+
+    scheduler.lock = SDL_CreateMutex();
+    scheduler.wake = SDL_CreateCond();
+    scheduler.work = SDL_CreateCond();
+    scheduler.done = SDL_CreateCond();
+    if (!scheduler.lock || !scheduler.wake ||
+        !scheduler.work || !scheduler.done) {
+        SDL_QuitAudioScheduler();
+        SDL_SetError("Couldn't create audio scheduler lock");
+        return -1;
+    }
+
+/* !!! FIXME: this is nasty. */
+#if defined(__WIN32__) && !defined(HAVE_LIBC)
+#undef SDL_CreateThread
+    scheduler.thread = SDL_CreateThread(SDL_RunAudioScheduler, "SDLAudioSched", NULL, NULL, NULL);
+#else
+    scheduler.thread = SDL_CreateThread(SDL_RunAudioScheduler, "SDLAudioSched", NULL);
+#endif
+    if (scheduler.thread == NULL) {
+        SDL_QuitAudioScheduler();
+        SDL_SetError("Couldn't create audio scheduler thread");
+        return -1;
+    }
+
+    threads = SDL_min(threads, SDL_AUDIO_MAX_SCHEDULER_THREADS);
+    for (i = 0; i < threads - 1; i++) {
+        SDL_snprintf(name, sizeof (name), "SDLAudioSched%d", i + 1);
+#if defined(__WIN32__) && !defined(HAVE_LIBC)
+        scheduler.workers[i] = SDL_CreateThread(SDL_RunAudioWorker, name, NULL, NULL, NULL);
+#else
+        scheduler.workers[i] = SDL_CreateThread(SDL_RunAudioWorker, name, NULL);
+#endif
+        if (scheduler.workers[i] == NULL) {
+            break;  /* the scheduler copes with fewer workers */
+        }
+        scheduler.numworkers++;
+    }
+
+    return 0;
+}
+
+int
+SDL_ScheduleAudioDevice(SDL_AudioDevice * device, int threads)
+{
+    int retval = 0;
+
+    /* Two devices opened at once mustn't both start a scheduler */
+    SDL_AtomicLock(&scheduler_start_lock);
+    if (!scheduler.thread) {
+        retval = SDL_StartAudioScheduler(threads);
+    }
+    SDL_AtomicUnlock(&scheduler_start_lock);
+    if (retval < 0) {
+        return -1;
+    }
+
+    SDL_LockMutex(scheduler.lock);
+    if (scheduler.numdevices == SDL_AUDIO_MAX_SCHEDULED) {
+        SDL_UnlockMutex(scheduler.lock);
+        SDL_SetError("Too many scheduled audio devices");
+        return -1;
+    }
+    device->deadline = 0;
+    device->busy = 0;
+    scheduler.devices[scheduler.numdevices++] = device;
+    SDL_UnlockMutex(scheduler.lock);
+    SDL_CondSignal(scheduler.wake);
+
+    return 0;
+}
+
+void
+SDL_UnscheduleAudioDevice(SDL_AudioDevice * device)
+{
+    int i;
+
+    if (!scheduler.lock) {
+        return;
+    }
+
+    SDL_LockMutex(scheduler.lock);
+    for (i = 0; i < scheduler.numdevices; i++) {
+        if (scheduler.devices[i] == device) {
+            scheduler.devices[i] = scheduler.devices[--scheduler.numdevices];
+            break;
+        }
+    }
+    /* It might be getting mixed right now; wait for that to finish */
+    while (device->busy) {
+        SDL_CondWait(scheduler.done, scheduler.lock);
+    }
+    SDL_UnlockMutex(scheduler.lock);
+    SDL_CondSignal(scheduler.wake);
+}
+
+void
+SDL_WakeAudioScheduler(void)
+{
+    if (scheduler.lock) {
+        SDL_LockMutex(scheduler.lock);
+        SDL_CondSignal(scheduler.wake);
+        SDL_UnlockMutex(scheduler.lock);
+    }
+}
+
+void
+SDL_QuitAudioScheduler(void)
+{
+    int i;
+
+    if (scheduler.thread || scheduler.numworkers) {
+        SDL_LockMutex(scheduler.lock);
+        scheduler.quit = 1;
+        SDL_UnlockMutex(scheduler.lock);
+        SDL_CondSignal(scheduler.wake);
+        SDL_CondBroadcast(scheduler.work);
+        for (i = 0; i < scheduler.numworkers; i++) {
+            SDL_WaitThread(scheduler.workers[i], NULL);
+        }
+        if (scheduler.thread) {
+            SDL_WaitThread(scheduler.thread, NULL);
+        }
+    }
+    if (scheduler.done) {
+        SDL_DestroyCond(scheduler.done);
+    }
+    if (scheduler.work) {
+        SDL_DestroyCond(scheduler.work);
+    }
+    if (scheduler.wake) {
+        SDL_DestroyCond(scheduler.wake);
+    }
+    if (scheduler.lock) {
+        SDL_DestroyMutex(scheduler.lock);
+    }
+    SDL_memset(&scheduler, '\0', sizeof (scheduler));
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
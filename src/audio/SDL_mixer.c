@@ -26,6 +26,11 @@
 #include "SDL_timer.h"
 #include "SDL_audio.h"
 #include "SDL_sysaudio.h"
+#include "SDL_audio_c.h"
+
+#ifdef HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+#endif
 
 /* This table is used to add two sound values together and pin
  * the value to avoid overflow.  (used with permission from ARDI)
@@ -85,6 +90,418 @@ static const Uint8 mix8[] = {
 #define ADJUST_VOLUME(s, v)	(s = (s*v)/SDL_MIX_MAXVOLUME)
 #define ADJUST_VOLUME_U8(s, v)	(s = (((s-128)*v)/SDL_MIX_MAXVOLUME)+128)
 
+/* Vector kernels.  Each one mixes as many whole vectors as fit in (len)
+   and returns the number of bytes it handled; the scalar code below does
+   the rest.  They only run for volumes in 1..SDL_MIX_MAXVOLUME and give
+   bit-identical results to the scalar code, including its rounding of
+   the volume division toward zero and the 0xFE ceiling of mix8[]. */
+
+#ifdef __SSE2__
+/* (x * volume) / SDL_MIX_MAXVOLUME for 16-bit lanes where the product fits */
+static __m128i
+SDL_MixScale8_SSE2(__m128i x, __m128i vol)
+{
+    const __m128i p = _mm_mullo_epi16(x, vol);
+    const __m128i bias = _mm_and_si128(_mm_srai_epi16(p, 15), _mm_set1_epi16(127));
+    return _mm_srai_epi16(_mm_add_epi16(p, bias), 7);
+}
+
+/* (x * volume) / SDL_MIX_MAXVOLUME for signed 16-bit lanes */
+static __m128i
+SDL_MixScale16_SSE2(__m128i x, __m128i vol)
+{
+    const __m128i lo = _mm_mullo_epi16(x, vol);
+    const __m128i hi = _mm_mulhi_epi16(x, vol);
+    const __m128i round = _mm_set1_epi32(127);
+    __m128i p0 = _mm_unpacklo_epi16(lo, hi);
+    __m128i p1 = _mm_unpackhi_epi16(lo, hi);
+    p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), round)), 7);
+    p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), round)), 7);
+    return _mm_packs_epi32(p0, p1);
+}
+
+/* (x * volume) / SDL_MIX_MAXVOLUME for signed 32-bit lanes.  x*volume
+   can need 39 bits, so split x into (x >> 7) and (x & 127). */
+static __m128i
+SDL_MixScale32_SSE2(__m128i x, __m128i vol)
+{
+    const __m128i a = _mm_srai_epi32(x, 7);
+    const __m128i b = _mm_and_si128(x, _mm_set1_epi32(127));
+    const __m128i bv = _mm_mullo_epi16(b, vol);     /* < 2^14, fits a lane */
+    const __m128i even = _mm_mul_epu32(a, vol);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), vol);
+    const __m128i av = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                          _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    const __m128i floor = _mm_add_epi32(av, _mm_srli_epi32(bv, 7));
+    /* round toward zero: negative results with a remainder go up by one */
+    const __m128i inexact = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(bv, _mm_set1_epi32(127)),
+                                                             _mm_setzero_si128()),
+                                             _mm_srai_epi32(x, 31));
+    return _mm_sub_epi32(floor, inexact);
+}
+
+/* Saturating signed 32-bit add */
+static __m128i
+SDL_MixAdds32_SSE2(__m128i x, __m128i y)
+{
+    const __m128i sum = _mm_add_epi32(x, y);
+    const __m128i overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(x, sum),
+                                                          _mm_xor_si128(y, sum)), 31);
+    const __m128i pinned = _mm_xor_si128(_mm_srai_epi32(x, 31), _mm_set1_epi32(0x7FFFFFFF));
+    return _mm_or_si128(_mm_andnot_si128(overflow, sum), _mm_and_si128(overflow, pinned));
+}
+
+static __m128i
+SDL_MixSwap16_SSE2(__m128i x)
+{
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+static __m128i
+SDL_MixSwap32_SSE2(__m128i x)
+{
+    x = SDL_MixSwap16_SSE2(x);
+    x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+static Uint32
+SDL_MixAudio_U8_SSE2(Uint8 * dst, const Uint8 * src, Uint32 len, int volume)
+{
+    const __m128i vol = _mm_set1_epi16((short) volume);
+    const __m128i bias = _mm_set1_epi8((char) 0x80);
+    const __m128i ceiling = _mm_set1_epi8((char) 0xFE);
+    const __m128i zero = _mm_setzero_si128();
+    Uint32 i;
+
+    for (i = 0; (i + 16) <= len; i += 16) {
+        /* make the source signed around silence, then widen */
+        const __m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (src + i)), bias);
+        const __m128i d = _mm_loadu_si128((const __m128i *) (dst + i));
+        const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(d, zero),
+                                         SDL_MixScale8_SSE2(_mm_srai_epi16(_mm_unpacklo_epi8(s, s), 8), vol));
+        const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(d, zero),
+                                         SDL_MixScale8_SSE2(_mm_srai_epi16(_mm_unpackhi_epi8(s, s), 8), vol));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_min_epu8(_mm_packus_epi16(lo, hi), ceiling));
+    }
+    return i;
+}
+
+static Uint32
+SDL_MixAudio_S8_SSE2(Uint8 * dst, const Uint8 * src, Uint32 len, int volume)
+{
+    const __m128i vol = _mm_set1_epi16((short) volume);
+    Uint32 i;
+
+    for (i = 0; (i + 16) <= len; i += 16) {
+        const __m128i s = _mm_loadu_si128((const __m128i *) (src + i));
+        const __m128i d = _mm_loadu_si128((const __m128i *) (dst + i));
+        const __m128i lo = _mm_add_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(d, d), 8),
+                                         SDL_MixScale8_SSE2(_mm_srai_epi16(_mm_unpacklo_epi8(s, s), 8), vol));
+        const __m128i hi = _mm_add_epi16(_mm_srai_epi16(_mm_unpackhi_epi8(d, d), 8),
+                                         SDL_MixScale8_SSE2(_mm_srai_epi16(_mm_unpackhi_epi8(s, s), 8), vol));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi16(lo, hi));
+    }
+    return i;
+}
+
+static Uint32
+SDL_MixAudio_S16_SSE2(Uint8 * dst, const Uint8 * src, Uint32 len, int volume, int swap)
+{
+    const __m128i vol = _mm_set1_epi16((short) volume);
+    Uint32 i;
+
+    for (i = 0; (i + 16) <= len; i += 16) {
+        __m128i s = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i d = _mm_loadu_si128((const __m128i *) (dst + i));
+        if (swap) {
+            s = SDL_MixSwap16_SSE2(s);
+            d = SDL_MixSwap16_SSE2(d);
+        }
+        d = _mm_adds_epi16(d, SDL_MixScale16_SSE2(s, vol));
+        if (swap) {
+            d = SDL_MixSwap16_SSE2(d);
+        }
+        _mm_storeu_si128((__m128i *) (dst + i), d);
+    }
+    return i;
+}
+
+static Uint32
+SDL_MixAudio_S32_SSE2(Uint8 * dst, const Uint8 * src, Uint32 len, int volume, int swap)
+{
+    const __m128i vol = _mm_set1_epi32(volume);
+    Uint32 i;
+
+    for (i = 0; (i + 16) <= len; i += 16) {
+        __m128i s = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i d = _mm_loadu_si128((const __m128i *) (dst + i));
+        if (swap) {
+            s = SDL_MixSwap32_SSE2(s);
+            d = SDL_MixSwap32_SSE2(d);
+        }
+        d = SDL_MixAdds32_SSE2(d, SDL_MixScale32_SSE2(s, vol));
+        if (swap) {
+            d = SDL_MixSwap32_SSE2(d);
+        }
+        _mm_storeu_si128((__m128i *) (dst + i), d);
+    }
+    return i;
+}
+
+static Uint32
+SDL_MixAudio_F32_SSE2(Uint8 * dst, const Uint8 * src, Uint32 len, int volume, int swap)
+{
+    const __m128 fvolume = _mm_set1_ps((float) volume);
+    const __m128 fmaxvolume = _mm_set1_ps(1.0f / ((float) SDL_MIX_MAXVOLUME));
+    const __m128 max_audioval = _mm_set1_ps(3.402823466e+38F);
+    const __m128 min_audioval = _mm_set1_ps(-3.402823466e+38F);
+    Uint32 i;
+
+    for (i = 0; (i + 16) <= len; i += 16) {
+        __m128i s = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i d = _mm_loadu_si128((const __m128i *) (dst + i));
+        __m128 sum;
+        if (swap) {
+            s = SDL_MixSwap32_SSE2(s);
+            d = SDL_MixSwap32_SSE2(d);
+        }
+        sum = _mm_mul_ps(_mm_mul_ps(_mm_castsi128_ps(s), fvolume), fmaxvolume);
+        sum = _mm_add_ps(sum, _mm_castsi128_ps(d));
+        /* operand order keeps NaNs like the scalar compares do */
+        sum = _mm_max_ps(min_audioval, _mm_min_ps(max_audioval, sum));
+        d = _mm_castps_si128(sum);
+        if (swap) {
+            d = SDL_MixSwap32_SSE2(d);
+        }
+        _mm_storeu_si128((__m128i *) (dst + i), d);
+    }
+    return i;
+}
+#endif /* __SSE2__ */
+
+#ifdef HAVE_AVX2_INTRINSICS
+static __m256i SDL_TARGETING_AVX2
+SDL_MixScale8_AVX2(__m256i x, __m256i vol)
+{
+    const __m256i p = _mm256_mullo_epi16(x, vol);
+    const __m256i bias = _mm256_and_si256(_mm256_srai_epi16(p, 15), _mm256_set1_epi16(127));
+    return _mm256_srai_epi16(_mm256_add_epi16(p, bias), 7);
+}
+
+static __m256i SDL_TARGETING_AVX2
+SDL_MixScale16_AVX2(__m256i x, __m256i vol)
+{
+    const __m256i lo = _mm256_mullo_epi16(x, vol);
+    const __m256i hi = _mm256_mulhi_epi16(x, vol);
+    const __m256i round = _mm256_set1_epi32(127);
+    __m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+    __m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+    p0 = _mm256_srai_epi32(_mm256_add_epi32(p0, _mm256_and_si256(_mm256_srai_epi32(p0, 31), round)), 7);
+    p1 = _mm256_srai_epi32(_mm256_add_epi32(p1, _mm256_and_si256(_mm256_srai_epi32(p1, 31), round)), 7);
+    return _mm256_packs_epi32(p0, p1);
+}
+
+static __m256i SDL_TARGETING_AVX2
+SDL_MixScale32_AVX2(__m256i x, __m256i vol)
+{
+    const __m256i a = _mm256_srai_epi32(x, 7);
+    const __m256i bv = _mm256_mullo_epi32(_mm256_and_si256(x, _mm256_set1_epi32(127)), vol);
+    const __m256i floor = _mm256_add_epi32(_mm256_mullo_epi32(a, vol), _mm256_srli_epi32(bv, 7));
+    const __m256i inexact = _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(bv, _mm256_set1_epi32(127)),
+                                                                   _mm256_setzero_si256()),
+                                                _mm256_srai_epi32(x, 31));
+    return _mm256_sub_epi32(floor, inexact);
+}
+
+static __m256i SDL_TARGETING_AVX2
+SDL_MixAdds32_AVX2(__m256i x, __m256i y)
+{
+    const __m256i sum = _mm256_add_epi32(x, y);
+    const __m256i overflow = _mm256_srai_epi32(_mm256_and_si256(_mm256_xor_si256(x, sum),
+                                                                _mm256_xor_si256(y, sum)), 31);
+    const __m256i pinned = _mm256_xor_si256(_mm256_srai_epi32(x, 31), _mm256_set1_epi32(0x7FFFFFFF));
+    return _mm256_blendv_epi8(sum, pinned, overflow);
+}
+
+static Uint32 SDL_TARGETING_AVX2
+SDL_MixAudio_U8_AVX2(Uint8 * dst, const Uint8 * src, Uint32 len, int volume)
+{
+    const __m256i vol = _mm256_set1_epi16((short) volume);
+    const __m256i bias = _mm256_set1_epi8((char) 0x80);
+    const __m256i ceiling = _mm256_set1_epi8((char) 0xFE);
+    const __m256i zero = _mm256_setzero_si256();
+    Uint32 i;
+
+    for (i = 0; (i + 32) <= len; i += 32) {
+        const __m256i s = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) (src + i)), bias);
+        const __m256i d = _mm256_loadu_si256((const __m256i *) (dst + i));
+        const __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(d, zero),
+                                            SDL_MixScale8_AVX2(_mm256_srai_epi16(_mm256_unpacklo_epi8(s, s), 8), vol));
+        const __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(d, zero),
+                                            SDL_MixScale8_AVX2(_mm256_srai_epi16(_mm256_unpackhi_epi8(s, s), 8), vol));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_min_epu8(_mm256_packus_epi16(lo, hi), ceiling));
+    }
+    return i;
+}
+
+static Uint32 SDL_TARGETING_AVX2
+SDL_MixAudio_S8_AVX2(Uint8 * dst, const Uint8 * src, Uint32 len, int volume)
+{
+    const __m256i vol = _mm256_set1_epi16((short) volume);
+    Uint32 i;
+
+    for (i = 0; (i + 32) <= len; i += 32) {
+        const __m256i s = _mm256_loadu_si256((const __m256i *) (src + i));
+        const __m256i d = _mm256_loadu_si256((const __m256i *) (dst + i));
+        const __m256i lo = _mm256_add_epi16(_mm256_srai_epi16(_mm256_unpacklo_epi8(d, d), 8),
+                                            SDL_MixScale8_AVX2(_mm256_srai_epi16(_mm256_unpacklo_epi8(s, s), 8), vol));
+        const __m256i hi = _mm256_add_epi16(_mm256_srai_epi16(_mm256_unpackhi_epi8(d, d), 8),
+                                            SDL_MixScale8_AVX2(_mm256_srai_epi16(_mm256_unpackhi_epi8(s, s), 8), vol));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_packs_epi16(lo, hi));
+    }
+    return i;
+}
+
+static Uint32 SDL_TARGETING_AVX2
+SDL_MixAudio_S16_AVX2(Uint8 * dst, const Uint8 * src, Uint32 len, int volume, int swap)
+{
+    const __m256i vol = _mm256_set1_epi16((short) volume);
+    const __m256i swap16 = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    Uint32 i;
+
+    for (i = 0; (i + 32) <= len; i += 32) {
+        __m256i s = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i *) (dst + i));
+        if (swap) {
+            s = _mm256_shuffle_epi8(s, swap16);
+            d = _mm256_shuffle_epi8(d, swap16);
+        }
+        d = _mm256_adds_epi16(d, SDL_MixScale16_AVX2(s, vol));
+        if (swap) {
+            d = _mm256_shuffle_epi8(d, swap16);
+        }
+        _mm256_storeu_si256((__m256i *) (dst + i), d);
+    }
+    return i;
+}
+
+static Uint32 SDL_TARGETING_AVX2
+SDL_MixAudio_S32_AVX2(Uint8 * dst, const Uint8 * src, Uint32 len, int volume, int swap)
+{
+    const __m256i vol = _mm256_set1_epi32(volume);
+    const __m256i swap32 = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    Uint32 i;
+
+    for (i = 0; (i + 32) <= len; i += 32) {
+        __m256i s = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i *) (dst + i));
+        if (swap) {
+            s = _mm256_shuffle_epi8(s, swap32);
+            d = _mm256_shuffle_epi8(d, swap32);
+        }
+        d = SDL_MixAdds32_AVX2(d, SDL_MixScale32_AVX2(s, vol));
+        if (swap) {
+            d = _mm256_shuffle_epi8(d, swap32);
+        }
+        _mm256_storeu_si256((__m256i *) (dst + i), d);
+    }
+    return i;
+}
+
+static Uint32 SDL_TARGETING_AVX2
+SDL_MixAudio_F32_AVX2(Uint8 * dst, const Uint8 * src, Uint32 len, int volume, int swap)
+{
+    const __m256 fvolume = _mm256_set1_ps((float) volume);
+    const __m256 fmaxvolume = _mm256_set1_ps(1.0f / ((float) SDL_MIX_MAXVOLUME));
+    const __m256 max_audioval = _mm256_set1_ps(3.402823466e+38F);
+    const __m256 min_audioval = _mm256_set1_ps(-3.402823466e+38F);
+    const __m256i swap32 = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    Uint32 i;
+
+    for (i = 0; (i + 32) <= len; i += 32) {
+        __m256i s = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i *) (dst + i));
+        __m256 sum;
+        if (swap) {
+            s = _mm256_shuffle_epi8(s, swap32);
+            d = _mm256_shuffle_epi8(d, swap32);
+        }
+        sum = _mm256_mul_ps(_mm256_mul_ps(_mm256_castsi256_ps(s), fvolume), fmaxvolume);
+        sum = _mm256_add_ps(sum, _mm256_castsi256_ps(d));
+        sum = _mm256_max_ps(min_audioval, _mm256_min_ps(max_audioval, sum));
+        d = _mm256_castps_si256(sum);
+        if (swap) {
+            d = _mm256_shuffle_epi8(d, swap32);
+        }
+        _mm256_storeu_si256((__m256i *) (dst + i), d);
+    }
+    return i;
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
+/* Mix what the vector kernels can handle, returns the bytes done */
+static Uint32
+SDL_MixAudioFormat_Vector(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
+                          Uint32 len, int volume)
+{
+    static int simd = -1;       /* 0 = none, 1 = SSE2, 2 = AVX2 */
+
+    if (simd < 0) {
+        int level = 0;
+#ifdef __SSE2__
+        if (SDL_HasSSE2()) {
+            level = 1;
+        }
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+        if (SDL_HasAVX2()) {
+            level = 2;
+        }
+#endif
+        simd = level;
+    }
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#ifdef HAVE_AVX2_INTRINSICS
+    if (simd == 2) {
+        switch (format) {
+        case AUDIO_U8: return SDL_MixAudio_U8_AVX2(dst, src, len, volume);
+        case AUDIO_S8: return SDL_MixAudio_S8_AVX2(dst, src, len, volume);
+        case AUDIO_S16LSB: return SDL_MixAudio_S16_AVX2(dst, src, len, volume, 0);
+        case AUDIO_S16MSB: return SDL_MixAudio_S16_AVX2(dst, src, len, volume, 1);
+        case AUDIO_S32LSB: return SDL_MixAudio_S32_AVX2(dst, src, len, volume, 0);
+        case AUDIO_S32MSB: return SDL_MixAudio_S32_AVX2(dst, src, len, volume, 1);
+        case AUDIO_F32LSB: return SDL_MixAudio_F32_AVX2(dst, src, len, volume, 0);
+        case AUDIO_F32MSB: return SDL_MixAudio_F32_AVX2(dst, src, len, volume, 1);
+        default: break;
+        }
+    }
+#endif
+#ifdef __SSE2__
+    if (simd >= 1) {
+        switch (format) {
+        case AUDIO_U8: return SDL_MixAudio_U8_SSE2(dst, src, len, volume);
+        case AUDIO_S8: return SDL_MixAudio_S8_SSE2(dst, src, len, volume);
+        case AUDIO_S16LSB: return SDL_MixAudio_S16_SSE2(dst, src, len, volume, 0);
+        case AUDIO_S16MSB: return SDL_MixAudio_S16_SSE2(dst, src, len, volume, 1);
+        case AUDIO_S32LSB: return SDL_MixAudio_S32_SSE2(dst, src, len, volume, 0);
+        case AUDIO_S32MSB: return SDL_MixAudio_S32_SSE2(dst, src, len, volume, 1);
+        case AUDIO_F32LSB: return SDL_MixAudio_F32_SSE2(dst, src, len, volume, 0);
+        case AUDIO_F32MSB: return SDL_MixAudio_F32_SSE2(dst, src, len, volume, 1);
+        default: break;
+        }
+    }
+#endif
+#endif /* SDL_BYTEORDER == SDL_LIL_ENDIAN */
+
+    return 0;
+}
+
+
 
 void
 SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
@@ -94,6 +511,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
         return;
     }
 
+    /* Let the vector kernels take as much as they can */
+    if ((volume > 0) && (volume <= SDL_MIX_MAXVOLUME)) {
+        const Uint32 done = SDL_MixAudioFormat_Vector(dst, src, format, len, volume);
+        dst += done;
+        src += done;
+        len -= done;
+    }
+
     switch (format) {
 
     case AUDIO_U8:
@@ -23,6 +23,7 @@
 #ifndef _SDL_sysaudio_h
 #define _SDL_sysaudio_h
 
+#include "SDL_atomic.h"
 #include "SDL_mutex.h"
 #include "SDL_thread.h"
 
@@ -47,6 +48,19 @@ typedef struct SDL_AudioDriverImpl
     void (*UnlockDevice) (_THIS);
     void (*Deinitialize) (void);
 
+    /* Fills (buffer) with recorded audio and the performance counter value
+       at which it was captured. Returns bytes written, or -1 on error. May
+       be NULL for capture devices that don't go through the core thread. */
+    int (*CaptureFromDevice) (_THIS, void *buffer, int buflen,
+                              Uint64 *timestamp);
+
+    /* Advances the device clock by one buffer and returns the performance
+       counter value at which the next buffer is due, or 0 if it's due right
+       away. Drivers that provide this can be driven by the shared scheduler
+       instead of a thread of their own, in which case ThreadInit() is never
+       called for the device. May be NULL. */
+    Uint64 (*NextDeadline) (_THIS);
+
     /* !!! FIXME: add pause(), so we can optimize instead of mixing silence. */
 
     /* Some flags to push duplicate code into the core and reduce #ifdefs. */
@@ -78,13 +92,29 @@ typedef struct SDL_AudioDriver
 } SDL_AudioDriver;
 
 
-/* Streamer */
+/* Ring buffer between the mixing thread and the device thread */
 typedef struct
 {
     Uint8 *buffer;
-    int max_len;                /* the maximum length in bytes */
-    int read_pos, write_pos;    /* the position of the write and read heads in bytes */
-} SDL_AudioStreamer;
+    int max_len;                /* the size of buffer in bytes */
+    SDL_atomic_t read_pos;      /* only advanced by the device thread */
+    SDL_atomic_t write_pos;     /* only advanced by the mixing thread */
+    SDL_sem *space;             /* posted by the device thread after a read */
+    Uint8 *mixbuf;              /* staging for the next write, period_len bytes */
+    int period_len;             /* bytes handed to the callback per period */
+} SDL_AudioRing;
+
+
+/* Fixed size chunk of queued audio, for devices without a callback */
+#define SDL_AUDIOBUFFERQUEUE_PACKETLEN (8 * 1024)
+
+typedef struct SDL_AudioBufferQueue
+{
+    Uint8 data[SDL_AUDIOBUFFERQUEUE_PACKETLEN];
+    Uint32 datalen;             /* bytes currently in use in this packet. */
+    Uint32 startpos;            /* bytes currently consumed in this packet. */
+    struct SDL_AudioBufferQueue *next;
+} SDL_AudioBufferQueue;
 
 
 /* Define the SDL audio driver structure */
@@ -96,12 +126,31 @@ struct SDL_AudioDevice
     /* The current audio specification (shared with audio thread) */
     SDL_AudioSpec spec;
 
-    /* An audio conversion block for audio format emulation */
-    SDL_AudioCVT convert;
+    /* Audio format emulation: the callback fills callback_buf in its own
+       format and the stream converts that for the device */
+    SDL_AudioStream *stream;
+    SDL_AudioFormat callback_format;
+    Uint8 *callback_buf;
+    int callback_len;
+    int callback_frame_size;
+    Uint64 callback_period_ticks;   /* how long callback_len lasts */
 
-    /* The streamer, if sample rate conversion necessitates it */
-    int use_streamer;
-    SDL_AudioStreamer streamer;
+    /* The ring, if the callback is allowed to run ahead of the device */
+    int use_ring;
+    SDL_AudioRing ring;
+
+    /* Queued audio, used instead of a callback (protected by the device lock) */
+    SDL_AudioBufferQueue *buffer_queue_head;    /* device drains from here */
+    SDL_AudioBufferQueue *buffer_queue_tail;    /* queue fills to here */
+    SDL_AudioBufferQueue *buffer_queue_pool;    /* spare packets */
+    Uint32 queued_bytes;
+
+    /* Performance counter when the last buffer was played or captured
+       (protected by mixer_lock) */
+    Uint64 timestamp;
+
+    /* Counters for SDL_GetAudioDeviceStats() (protected by mixer_lock) */
+    SDL_AudioDeviceStats stats;
 
     /* Current state flags */
     int iscapture;
@@ -115,10 +164,22 @@ struct SDL_AudioDevice
     /* A semaphore for locking the mixing buffers */
     SDL_mutex *mixer_lock;
 
+    /* Signalled when (paused) or (enabled) change, so paused threads sleep */
+    SDL_mutex *state_lock;
+    SDL_cond *state_cond;
+
     /* A thread to feed the audio device */
     SDL_Thread *thread;
     SDL_threadID threadid;
 
+    /* A thread to run the callback, if using the ring */
+    SDL_Thread *mixer_thread;
+
+    /* Set if the shared scheduler feeds this device instead of (thread) */
+    int scheduled;
+    Uint64 deadline;    /* protected by the scheduler lock */
+    int busy;           /* protected by the scheduler lock */
+
     /* * * */
     /* Data private to this driver */
     struct SDL_PrivateAudioData *hidden;
@@ -23,10 +23,16 @@
 /* Microsoft WAVE file loading routines */
 
 #include "SDL_audio.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_thread.h"
 #include "SDL_wave.h"
 
+/* ADPCM reads of at least this many whole blocks are split across threads */
+#define WAVE_PARALLEL_BLOCKS    64
+/* ...and go through at most this many blocks at a time, to bound memory */
+#define WAVE_BATCH_BLOCKS       1024
+#define WAVE_MAX_THREADS        8
 
-static int ReadChunk(SDL_RWops * src, Chunk * chunk);
 
 struct MS_ADPCM_decodestate
 {
@@ -35,49 +41,100 @@ struct MS_ADPCM_decodestate
     Sint16 iSamp1;
     Sint16 iSamp2;
 };
-static struct MS_ADPCM_decoder
+struct MS_ADPCM_decoder
 {
     WaveFMT wavefmt;
     Uint16 wSamplesPerBlock;
     Uint16 wNumCoef;
     Sint16 aCoeff[7][2];
-    /* * * */
-    struct MS_ADPCM_decodestate state[2];
-} MS_ADPCM_state;
+};
+
+struct IMA_ADPCM_decodestate
+{
+    Sint32 sample;
+    Sint8 index;
+};
+struct IMA_ADPCM_decoder
+{
+    WaveFMT wavefmt;
+    Uint16 wSamplesPerBlock;
+};
+
+struct SDL_WAVReader
+{
+    SDL_RWops *src;
+    int freesrc;
+    Uint16 encoding;
+    int frame_size;             /* bytes per decoded frame */
+    Sint64 data_start;          /* offset of the data in src, -1 if unknown */
+    Uint32 data_len;            /* bytes of data, as stored */
+    Uint32 frames;              /* frames of data, as decoded */
+    Uint32 position;            /* the next frame to hand out */
+    Sint64 riff_end;            /* offset just past the RIFF chunk */
+
+    /* ADPCM data is decoded one block at a time */
+    Uint16 blockalign;
+    Uint16 samples_per_block;
+    Uint32 next_block;          /* the block src is positioned at */
+    Uint32 decoded_block;       /* the block in (decoded), or ~0 */
+    Uint8 *block;
+    Uint8 *decoded;
+    Uint8 *batch;               /* WAVE_BATCH_BLOCKS blocks, for big reads */
+    struct SDL_WAVDecodePool *pool;     /* threads for big reads, or NULL */
+    struct MS_ADPCM_decoder ms;
+    struct IMA_ADPCM_decoder ima;
+};
 
 static int
-InitMS_ADPCM(WaveFMT * format)
+InitMS_ADPCM(struct MS_ADPCM_decoder *decoder, WaveFMT * format,
+             Uint32 format_len)
 {
     Uint8 *rogue_feel;
     int i;
 
+    /* The coefficient table follows the format, after the extra size */
+    if (format_len < sizeof(*format) + 3 * sizeof(Uint16) +
+        (7 * 2 * sizeof(Sint16))) {
+        SDL_SetError("MS ADPCM format chunk is too short");
+        return (-1);
+    }
+
     /* Set the rogue pointer to the MS_ADPCM specific data */
-    MS_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-    MS_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-    MS_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-    MS_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-    MS_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-    MS_ADPCM_state.wavefmt.bitspersample =
-        SDL_SwapLE16(format->bitspersample);
+    decoder->wavefmt.encoding = SDL_SwapLE16(format->encoding);
+    decoder->wavefmt.channels = SDL_SwapLE16(format->channels);
+    decoder->wavefmt.frequency = SDL_SwapLE32(format->frequency);
+    decoder->wavefmt.byterate = SDL_SwapLE32(format->byterate);
+    decoder->wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
+    decoder->wavefmt.bitspersample = SDL_SwapLE16(format->bitspersample);
     rogue_feel = (Uint8 *) format + sizeof(*format);
     if (sizeof(*format) == 16) {
         /*const Uint16 extra_info = ((rogue_feel[1] << 8) | rogue_feel[0]);*/
         rogue_feel += sizeof(Uint16);
     }
-    MS_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    decoder->wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
     rogue_feel += sizeof(Uint16);
-    MS_ADPCM_state.wNumCoef = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    decoder->wNumCoef = ((rogue_feel[1] << 8) | rogue_feel[0]);
     rogue_feel += sizeof(Uint16);
-    if (MS_ADPCM_state.wNumCoef != 7) {
+    if (decoder->wNumCoef != 7) {
         SDL_SetError("Unknown set of MS_ADPCM coefficients");
         return (-1);
     }
-    for (i = 0; i < MS_ADPCM_state.wNumCoef; ++i) {
-        MS_ADPCM_state.aCoeff[i][0] = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    for (i = 0; i < decoder->wNumCoef; ++i) {
+        decoder->aCoeff[i][0] = ((rogue_feel[1] << 8) | rogue_feel[0]);
         rogue_feel += sizeof(Uint16);
-        MS_ADPCM_state.aCoeff[i][1] = ((rogue_feel[1] << 8) | rogue_feel[0]);
+        decoder->aCoeff[i][1] = ((rogue_feel[1] << 8) | rogue_feel[0]);
         rogue_feel += sizeof(Uint16);
     }
+
+    /* Make sure a whole block of samples fits in a block of data */
+    if ((decoder->wavefmt.channels < 1) || (decoder->wavefmt.channels > 2) ||
+        (decoder->wSamplesPerBlock < 2) ||
+        ((7 * decoder->wavefmt.channels) +
+         ((decoder->wSamplesPerBlock - 2) * decoder->wavefmt.channels + 1) / 2 >
+         decoder->wavefmt.blockalign)) {
+        SDL_SetError("Invalid MS ADPCM block layout");
+        return (-1);
+    }
     return (0);
 }
 
@@ -115,138 +172,138 @@ MS_ADPCM_nibble(struct MS_ADPCM_decodestate *state,
     return (new_sample);
 }
 
+/* Decode one block of MS ADPCM into wSamplesPerBlock frames */
 static int
-MS_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
+MS_ADPCM_decode_block(const struct MS_ADPCM_decoder *decoder,
+                      const Uint8 * encoded, Uint8 * decoded)
 {
+    struct MS_ADPCM_decodestate states[2];
     struct MS_ADPCM_decodestate *state[2];
-    Uint8 *freeable, *encoded, *decoded;
-    Sint32 encoded_len, samplesleft;
+    Sint32 samplesleft;
     Sint8 nybble, stereo;
     Sint16 *coeff[2];
     Sint32 new_sample;
 
-    /* Allocate the proper sized output buffer */
-    encoded_len = *audio_len;
-    encoded = *audio_buf;
-    freeable = *audio_buf;
-    *audio_len = (encoded_len / MS_ADPCM_state.wavefmt.blockalign) *
-        MS_ADPCM_state.wSamplesPerBlock *
-        MS_ADPCM_state.wavefmt.channels * sizeof(Sint16);
-    *audio_buf = (Uint8 *) SDL_malloc(*audio_len);
-    if (*audio_buf == NULL) {
-        SDL_Error(SDL_ENOMEM);
-        return (-1);
-    }
-    decoded = *audio_buf;
-
     /* Get ready... Go! */
-    stereo = (MS_ADPCM_state.wavefmt.channels == 2);
-    state[0] = &MS_ADPCM_state.state[0];
-    state[1] = &MS_ADPCM_state.state[stereo];
-    while (encoded_len >= MS_ADPCM_state.wavefmt.blockalign) {
-        /* Grab the initial information for this block */
-        state[0]->hPredictor = *encoded++;
-        if (stereo) {
-            state[1]->hPredictor = *encoded++;
-        }
-        state[0]->iDelta = ((encoded[1] << 8) | encoded[0]);
+    stereo = (decoder->wavefmt.channels == 2);
+    state[0] = &states[0];
+    state[1] = &states[stereo];
+
+    /* Grab the initial information for this block */
+    state[0]->hPredictor = *encoded++;
+    if (stereo) {
+        state[1]->hPredictor = *encoded++;
+    }
+    state[0]->iDelta = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iDelta = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iDelta = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        state[0]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
+    }
+    state[0]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        state[0]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
+    }
+    state[0]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        coeff[0] = MS_ADPCM_state.aCoeff[state[0]->hPredictor];
-        coeff[1] = MS_ADPCM_state.aCoeff[state[1]->hPredictor];
+    }
+    if ((state[0]->hPredictor >= decoder->wNumCoef) ||
+        (state[1]->hPredictor >= decoder->wNumCoef)) {
+        return (-1);            /* the caller reports it */
+    }
+    coeff[0] = (Sint16 *) decoder->aCoeff[state[0]->hPredictor];
+    coeff[1] = (Sint16 *) decoder->aCoeff[state[1]->hPredictor];
 
-        /* Store the two initial samples we start with */
-        decoded[0] = state[0]->iSamp2 & 0xFF;
-        decoded[1] = state[0]->iSamp2 >> 8;
+    /* Store the two initial samples we start with */
+    decoded[0] = state[0]->iSamp2 & 0xFF;
+    decoded[1] = state[0]->iSamp2 >> 8;
+    decoded += 2;
+    if (stereo) {
+        decoded[0] = state[1]->iSamp2 & 0xFF;
+        decoded[1] = state[1]->iSamp2 >> 8;
         decoded += 2;
-        if (stereo) {
-            decoded[0] = state[1]->iSamp2 & 0xFF;
-            decoded[1] = state[1]->iSamp2 >> 8;
-            decoded += 2;
-        }
-        decoded[0] = state[0]->iSamp1 & 0xFF;
-        decoded[1] = state[0]->iSamp1 >> 8;
+    }
+    decoded[0] = state[0]->iSamp1 & 0xFF;
+    decoded[1] = state[0]->iSamp1 >> 8;
+    decoded += 2;
+    if (stereo) {
+        decoded[0] = state[1]->iSamp1 & 0xFF;
+        decoded[1] = state[1]->iSamp1 >> 8;
         decoded += 2;
-        if (stereo) {
-            decoded[0] = state[1]->iSamp1 & 0xFF;
-            decoded[1] = state[1]->iSamp1 >> 8;
-            decoded += 2;
-        }
+    }
 
-        /* Decode and store the other samples in this block */
-        samplesleft = (MS_ADPCM_state.wSamplesPerBlock - 2) *
-            MS_ADPCM_state.wavefmt.channels;
-        while (samplesleft > 0) {
-            nybble = (*encoded) >> 4;
-            new_sample = MS_ADPCM_nibble(state[0], nybble, coeff[0]);
-            decoded[0] = new_sample & 0xFF;
-            new_sample >>= 8;
-            decoded[1] = new_sample & 0xFF;
-            decoded += 2;
+    /* Decode and store the other samples in this block */
+    samplesleft = (decoder->wSamplesPerBlock - 2) *
+        decoder->wavefmt.channels;
+    while (samplesleft > 0) {
+        nybble = (*encoded) >> 4;
+        new_sample = MS_ADPCM_nibble(state[0], nybble, coeff[0]);
+        decoded[0] = new_sample & 0xFF;
+        new_sample >>= 8;
+        decoded[1] = new_sample & 0xFF;
+        decoded += 2;
 
+        /* An odd sample count ends on half a byte */
+        if (samplesleft > 1) {
             nybble = (*encoded) & 0x0F;
             new_sample = MS_ADPCM_nibble(state[1], nybble, coeff[1]);
             decoded[0] = new_sample & 0xFF;
             new_sample >>= 8;
             decoded[1] = new_sample & 0xFF;
             decoded += 2;
-
-            ++encoded;
-            samplesleft -= 2;
         }
-        encoded_len -= MS_ADPCM_state.wavefmt.blockalign;
+
+        ++encoded;
+        samplesleft -= 2;
     }
-    SDL_free(freeable);
     return (0);
 }
 
-struct IMA_ADPCM_decodestate
-{
-    Sint32 sample;
-    Sint8 index;
-};
-static struct IMA_ADPCM_decoder
-{
-    WaveFMT wavefmt;
-    Uint16 wSamplesPerBlock;
-    /* * * */
-    struct IMA_ADPCM_decodestate state[2];
-} IMA_ADPCM_state;
-
 static int
-InitIMA_ADPCM(WaveFMT * format)
+InitIMA_ADPCM(struct IMA_ADPCM_decoder *decoder, WaveFMT * format,
+              Uint32 format_len)
 {
     Uint8 *rogue_feel;
 
+    if (format_len < sizeof(*format) + 2 * sizeof(Uint16)) {
+        SDL_SetError("IMA ADPCM format chunk is too short");
+        return (-1);
+    }
+
     /* Set the rogue pointer to the IMA_ADPCM specific data */
-    IMA_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-    IMA_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-    IMA_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-    IMA_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-    IMA_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-    IMA_ADPCM_state.wavefmt.bitspersample =
-        SDL_SwapLE16(format->bitspersample);
+    decoder->wavefmt.encoding = SDL_SwapLE16(format->encoding);
+    decoder->wavefmt.channels = SDL_SwapLE16(format->channels);
+    decoder->wavefmt.frequency = SDL_SwapLE32(format->frequency);
+    decoder->wavefmt.byterate = SDL_SwapLE32(format->byterate);
+    decoder->wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
+    decoder->wavefmt.bitspersample = SDL_SwapLE16(format->bitspersample);
     rogue_feel = (Uint8 *) format + sizeof(*format);
     if (sizeof(*format) == 16) {
         /*const Uint16 extra_info = ((rogue_feel[1] << 8) | rogue_feel[0]);*/
         rogue_feel += sizeof(Uint16);
     }
-    IMA_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    decoder->wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
+
+    /* Check to make sure we have enough variables in the state array */
+    if ((decoder->wavefmt.channels < 1) || (decoder->wavefmt.channels > 2)) {
+        SDL_SetError("IMA ADPCM decoder can only handle %d channels", 2);
+        return (-1);
+    }
+
+    /* Samples come in runs of 8 per channel after the header sample */
+    if ((decoder->wSamplesPerBlock < 1) ||
+        (((decoder->wSamplesPerBlock - 1) % 8) != 0) ||
+        ((4 * decoder->wavefmt.channels) +
+         ((decoder->wSamplesPerBlock - 1) / 2) * decoder->wavefmt.channels >
+         decoder->wavefmt.blockalign)) {
+        SDL_SetError("Invalid IMA ADPCM block layout");
+        return (-1);
+    }
     return (0);
 }
 
@@ -255,13 +312,13 @@ IMA_ADPCM_nibble(struct IMA_ADPCM_decodestate *state, Uint8 nybble)
 {
     const Sint32 max_audioval = ((1 << (16 - 1)) - 1);
     const Sint32 min_audioval = -(1 << (16 - 1));
-    const int index_table[16] = {
+    static const int index_table[16] = {
         -1, -1, -1, -1,
         2, 4, 6, 8,
         -1, -1, -1, -1,
         2, 4, 6, 8
     };
-    const Sint32 step_table[89] = {
+    static const Sint32 step_table[89] = {
         7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
         34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130,
         143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408,
@@ -305,7 +362,7 @@ IMA_ADPCM_nibble(struct IMA_ADPCM_decodestate *state, Uint8 nybble)
 
 /* Fill the decode buffer with a channel block of data (8 samples) */
 static void
-Fill_IMA_ADPCM_block(Uint8 * decoded, Uint8 * encoded,
+Fill_IMA_ADPCM_block(Uint8 * decoded, const Uint8 * encoded,
                      int channel, int numchannels,
                      struct IMA_ADPCM_decodestate *state)
 {
@@ -333,103 +390,537 @@ Fill_IMA_ADPCM_block(Uint8 * decoded, Uint8 * encoded,
     }
 }
 
+/* Decode one block of IMA ADPCM into wSamplesPerBlock frames */
 static int
-IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
+IMA_ADPCM_decode_block(const struct IMA_ADPCM_decoder *decoder,
+                       const Uint8 * encoded, Uint8 * decoded)
 {
-    struct IMA_ADPCM_decodestate *state;
-    Uint8 *freeable, *encoded, *decoded;
-    Sint32 encoded_len, samplesleft;
+    struct IMA_ADPCM_decodestate state[2];
+    Sint32 samplesleft;
     unsigned int c, channels;
 
-    /* Check to make sure we have enough variables in the state array */
-    channels = IMA_ADPCM_state.wavefmt.channels;
-    if (channels > SDL_arraysize(IMA_ADPCM_state.state)) {
-        SDL_SetError("IMA ADPCM decoder can only handle %d channels",
-                     SDL_arraysize(IMA_ADPCM_state.state));
-        return (-1);
-    }
-    state = IMA_ADPCM_state.state;
+    channels = decoder->wavefmt.channels;
 
-    /* Allocate the proper sized output buffer */
-    encoded_len = *audio_len;
-    encoded = *audio_buf;
-    freeable = *audio_buf;
-    *audio_len = (encoded_len / IMA_ADPCM_state.wavefmt.blockalign) *
-        IMA_ADPCM_state.wSamplesPerBlock *
-        IMA_ADPCM_state.wavefmt.channels * sizeof(Sint16);
-    *audio_buf = (Uint8 *) SDL_malloc(*audio_len);
-    if (*audio_buf == NULL) {
-        SDL_Error(SDL_ENOMEM);
-        return (-1);
+    /* Grab the initial information for this block */
+    for (c = 0; c < channels; ++c) {
+        /* Fill the state information for this block */
+        state[c].sample = ((encoded[1] << 8) | encoded[0]);
+        encoded += 2;
+        if (state[c].sample & 0x8000) {
+            state[c].sample -= 0x10000;
+        }
+        state[c].index = (Sint8) SDL_min(*encoded, 88);
+        encoded++;
+        /* Reserved byte in buffer header, should be 0 */
+        if (*encoded++ != 0) {
+            /* Uh oh, corrupt data?  Buggy code? */ ;
+        }
+
+        /* Store the initial sample we start with */
+        decoded[0] = (Uint8) (state[c].sample & 0xFF);
+        decoded[1] = (Uint8) (state[c].sample >> 8);
+        decoded += 2;
     }
-    decoded = *audio_buf;
 
-    /* Get ready... Go! */
-    while (encoded_len >= IMA_ADPCM_state.wavefmt.blockalign) {
-        /* Grab the initial information for this block */
+    /* Decode and store the other samples in this block */
+    samplesleft = (decoder->wSamplesPerBlock - 1) * channels;
+    while (samplesleft > 0) {
         for (c = 0; c < channels; ++c) {
-            /* Fill the state information for this block */
-            state[c].sample = ((encoded[1] << 8) | encoded[0]);
-            encoded += 2;
-            if (state[c].sample & 0x8000) {
-                state[c].sample -= 0x10000;
-            }
-            state[c].index = *encoded++;
-            /* Reserved byte in buffer header, should be 0 */
-            if (*encoded++ != 0) {
-                /* Uh oh, corrupt data?  Buggy code? */ ;
+            Fill_IMA_ADPCM_block(decoded, encoded, c, channels, &state[c]);
+            encoded += 4;
+            samplesleft -= 8;
+        }
+        decoded += (channels * 8 * 2);
+    }
+    return (0);
+}
+
+#ifdef __SSE2__
+/* Decode IMA ADPCM blocks four channels at a time, one per SSE2 lane. The
+   channels of a block are independent and so are blocks, so a pass takes
+   four mono blocks or two stereo ones. Returns how many blocks it did; the
+   caller finishes any that are left over. */
+static Uint32
+IMA_ADPCM_decode_blocks_SSE2(const struct IMA_ADPCM_decoder *decoder,
+                             const Uint8 * encoded, Uint8 * decoded,
+                             Uint32 blocks)
+{
+    static const Sint32 step_table[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+        34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130,
+        143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408,
+        449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282,
+        1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+        3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+        9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
+        22385, 24623, 27086, 29794, 32767
+    };
+    const int channels = decoder->wavefmt.channels;
+    const int blockalign = decoder->wavefmt.blockalign;
+    const int decoded_len = decoder->wSamplesPerBlock * channels * 2;
+    const int per_pass = 4 / channels;
+    const int groups = (decoder->wSamplesPerBlock - 1) / 8;
+    const __m128i max_audioval = _mm_set1_epi32(32767);
+    const __m128i min_audioval = _mm_set1_epi32(-32768);
+    const __m128i max_index = _mm_set1_epi32(88);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    const __m128i three = _mm_set1_epi32(3);
+    const __m128i four = _mm_set1_epi32(4);
+    const __m128i seven = _mm_set1_epi32(7);
+    const __m128i eight = _mm_set1_epi32(8);
+    const __m128i fifteen = _mm_set1_epi32(15);
+    const Uint8 *src[4];
+    Uint8 *dst[4];
+    Sint32 sample[4], index[4];
+    Uint32 done;
+    int lane, b, c, g, j, k;
+
+    for (done = 0; done + per_pass <= blocks; done += per_pass) {
+        __m128i vsample, vindex;
+
+        /* Each lane starts from its channel's header in its block */
+        lane = 0;
+        for (b = 0; b < per_pass; ++b) {
+            const Uint8 *block = encoded + ((done + b) * blockalign);
+            Uint8 *out = decoded + ((done + b) * decoded_len);
+            for (c = 0; c < channels; ++c, ++lane) {
+                const Uint8 *header = block + (4 * c);
+                sample[lane] = (header[1] << 8) | header[0];
+                if (sample[lane] & 0x8000) {
+                    sample[lane] -= 0x10000;
+                }
+                index[lane] = SDL_min(header[2], 88);
+                out[2 * c] = (Uint8) (sample[lane] & 0xFF);
+                out[2 * c + 1] = (Uint8) (sample[lane] >> 8);
+                src[lane] = block + (4 * channels) + (4 * c);
+                dst[lane] = out + (2 * channels) + (2 * c);
             }
+        }
+        vsample = _mm_setr_epi32(sample[0], sample[1], sample[2], sample[3]);
+        vindex = _mm_setr_epi32(index[0], index[1], index[2], index[3]);
 
-            /* Store the initial sample we start with */
-            decoded[0] = (Uint8) (state[c].sample & 0xFF);
-            decoded[1] = (Uint8) (state[c].sample >> 8);
-            decoded += 2;
+        for (g = 0; g < groups; ++g) {
+            const int offset = g * 4 * channels;
+            __m128i nibbles = _mm_setr_epi32(
+                src[0][offset] | (src[0][offset + 1] << 8) |
+                (src[0][offset + 2] << 16) | (src[0][offset + 3] << 24),
+                src[1][offset] | (src[1][offset + 1] << 8) |
+                (src[1][offset + 2] << 16) | (src[1][offset + 3] << 24),
+                src[2][offset] | (src[2][offset + 1] << 8) |
+                (src[2][offset + 2] << 16) | (src[2][offset + 3] << 24),
+                src[3][offset] | (src[3][offset + 1] << 8) |
+                (src[3][offset + 2] << 16) | (src[3][offset + 3] << 24));
+
+            /* Low nibble first, as in Fill_IMA_ADPCM_block() */
+            for (j = 0; j < 8; ++j) {
+                const __m128i nybble = _mm_and_si128(nibbles, fifteen);
+                const __m128i magnitude = _mm_and_si128(nybble, seven);
+                __m128i step, delta, mask, adjust;
+
+                _mm_storeu_si128((__m128i *) index, vindex);
+                step = _mm_setr_epi32(step_table[index[0]], step_table[index[1]],
+                                      step_table[index[2]], step_table[index[3]]);
+
+                /* Compute difference and new sample value */
+                delta = _mm_srli_epi32(step, 3);
+                mask = _mm_cmpeq_epi32(_mm_and_si128(nybble, four), four);
+                delta = _mm_add_epi32(delta, _mm_and_si128(mask, step));
+                mask = _mm_cmpeq_epi32(_mm_and_si128(nybble, two), two);
+                delta = _mm_add_epi32(delta, _mm_and_si128(mask, _mm_srli_epi32(step, 1)));
+                mask = _mm_cmpeq_epi32(_mm_and_si128(nybble, one), one);
+                delta = _mm_add_epi32(delta, _mm_and_si128(mask, _mm_srli_epi32(step, 2)));
+                mask = _mm_cmpeq_epi32(_mm_and_si128(nybble, eight), eight);
+                delta = _mm_sub_epi32(_mm_xor_si128(delta, mask), mask);
+                vsample = _mm_add_epi32(vsample, delta);
+
+                /* Update index value: -1 for magnitudes below 4, else 2..8 */
+                adjust = _mm_slli_epi32(_mm_sub_epi32(magnitude, three), 1);
+                mask = _mm_cmplt_epi32(magnitude, four);
+                adjust = _mm_or_si128(mask, _mm_andnot_si128(mask, adjust));
+                vindex = _mm_add_epi32(vindex, adjust);
+                mask = _mm_cmpgt_epi32(vindex, max_index);
+                vindex = _mm_or_si128(_mm_and_si128(mask, max_index),
+                                      _mm_andnot_si128(mask, vindex));
+                vindex = _mm_andnot_si128(_mm_cmplt_epi32(vindex, zero), vindex);
+
+                /* Clamp output sample */
+                mask = _mm_cmpgt_epi32(vsample, max_audioval);
+                vsample = _mm_or_si128(_mm_and_si128(mask, max_audioval),
+                                       _mm_andnot_si128(mask, vsample));
+                mask = _mm_cmplt_epi32(vsample, min_audioval);
+                vsample = _mm_or_si128(_mm_and_si128(mask, min_audioval),
+                                       _mm_andnot_si128(mask, vsample));
+
+                _mm_storeu_si128((__m128i *) sample, vsample);
+                k = ((g * 8) + j) * 2 * channels;
+                for (lane = 0; lane < 4; ++lane) {
+                    dst[lane][k] = (Uint8) (sample[lane] & 0xFF);
+                    dst[lane][k + 1] = (Uint8) (sample[lane] >> 8);
+                }
+                nibbles = _mm_srli_epi32(nibbles, 4);
+            }
         }
+    }
+    return done;
+}
+#endif /* __SSE2__ */
+
+/* Decode (blocks) consecutive ADPCM blocks */
+static int
+SDL_DecodeWAVBlocks(const SDL_WAVReader * reader, const Uint8 * encoded,
+                    Uint8 * decoded, Uint32 blocks)
+{
+    const size_t decoded_len = reader->samples_per_block * reader->frame_size;
+    Uint32 i = 0;
 
-        /* Decode and store the other samples in this block */
-        samplesleft = (IMA_ADPCM_state.wSamplesPerBlock - 1) * channels;
-        while (samplesleft > 0) {
-            for (c = 0; c < channels; ++c) {
-                Fill_IMA_ADPCM_block(decoded, encoded,
-                                     c, channels, &state[c]);
-                encoded += 4;
-                samplesleft -= 8;
+    if (reader->encoding == MS_ADPCM_CODE) {
+        for (; i < blocks; ++i) {
+            if (MS_ADPCM_decode_block(&reader->ms, encoded, decoded) < 0) {
+                return (-1);
             }
-            decoded += (channels * 8 * 2);
+            encoded += reader->blockalign;
+            decoded += decoded_len;
         }
-        encoded_len -= IMA_ADPCM_state.wavefmt.blockalign;
+        return (0);
+    }
+
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        i = IMA_ADPCM_decode_blocks_SSE2(&reader->ima, encoded, decoded, blocks);
+        encoded += i * reader->blockalign;
+        decoded += i * decoded_len;
+    }
+#endif
+    for (; i < blocks; ++i) {
+        IMA_ADPCM_decode_block(&reader->ima, encoded, decoded);
+        encoded += reader->blockalign;
+        decoded += decoded_len;
     }
-    SDL_free(freeable);
     return (0);
 }
 
-SDL_AudioSpec *
-SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
-               SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len)
+typedef struct
+{
+    const SDL_WAVReader *reader;
+    const Uint8 *encoded;
+    Uint8 *decoded;
+    Uint32 blocks;
+    int retval;
+} SDL_WAVDecodeJob;
+
+static int SDLCALL
+SDL_RunWAVDecodeJob(void *data)
+{
+    SDL_WAVDecodeJob *job = (SDL_WAVDecodeJob *) data;
+    job->retval = SDL_DecodeWAVBlocks(job->reader, job->encoded,
+                                      job->decoded, job->blocks);
+    return 0;
+}
+
+/* Threads kept for the life of a reader, each decoding its own job of
+   every batch.  The thread handing out a batch decodes the last job. */
+typedef struct SDL_WAVDecodeWorker
+{
+    struct SDL_WAVDecodePool *pool;
+    int index;
+    SDL_Thread *thread;
+} SDL_WAVDecodeWorker;
+
+typedef struct SDL_WAVDecodePool
+{
+    SDL_mutex *lock;
+    SDL_cond *work;             /* signalled when a batch is handed out */
+    SDL_cond *done;             /* signalled when the last worker finishes */
+    Uint32 generation;          /* counts the batches handed out */
+    int busy;                   /* workers still on the current batch */
+    SDL_bool quit;
+    int numworkers;
+    SDL_WAVDecodeJob jobs[WAVE_MAX_THREADS];
+    SDL_WAVDecodeWorker workers[WAVE_MAX_THREADS - 1];
+} SDL_WAVDecodePool;
+
+static int SDLCALL
+SDL_RunWAVDecodeWorker(void *data)
+{
+    SDL_WAVDecodeWorker *worker = (SDL_WAVDecodeWorker *) data;
+    SDL_WAVDecodePool *pool = worker->pool;
+    Uint32 generation = 0;
+
+    SDL_LockMutex(pool->lock);
+    for (;;) {
+        while (!pool->quit && (pool->generation == generation)) {
+            SDL_CondWait(pool->work, pool->lock);
+        }
+        if (pool->quit) {
+            break;
+        }
+        generation = pool->generation;
+        SDL_UnlockMutex(pool->lock);
+
+        SDL_RunWAVDecodeJob(&pool->jobs[worker->index]);
+
+        SDL_LockMutex(pool->lock);
+        if (--pool->busy == 0) {
+            SDL_CondSignal(pool->done);
+        }
+    }
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
+
+static void
+SDL_FreeWAVDecodePool(SDL_WAVDecodePool * pool)
 {
+    int i;
+
+    if (pool->lock != NULL) {
+        SDL_LockMutex(pool->lock);
+        pool->quit = SDL_TRUE;
+        SDL_CondBroadcast(pool->work);
+        SDL_UnlockMutex(pool->lock);
+    }
+    for (i = 0; i < pool->numworkers; ++i) {
+        SDL_WaitThread(pool->workers[i].thread, NULL);
+    }
+    if (pool->done != NULL) {
+        SDL_DestroyCond(pool->done);
+    }
+    if (pool->work != NULL) {
+        SDL_DestroyCond(pool->work);
+    }
+    if (pool->lock != NULL) {
+        SDL_DestroyMutex(pool->lock);
+    }
+    SDL_free(pool);
+}
+
+/* Start up to (numworkers) threads for a reader, or return NULL if not even
+   one would start */
+static SDL_WAVDecodePool *
+SDL_CreateWAVDecodePool(int numworkers)
+{
+    SDL_WAVDecodePool *pool;
+    SDL_WAVDecodeWorker *worker;
+
+    pool = (SDL_WAVDecodePool *) SDL_calloc(1, sizeof(*pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->lock = SDL_CreateMutex();
+    pool->work = SDL_CreateCond();
+    pool->done = SDL_CreateCond();
+    if (!pool->lock || !pool->work || !pool->done) {
+        SDL_FreeWAVDecodePool(pool);
+        return NULL;
+    }
+
+    while (pool->numworkers < numworkers) {
+        worker = &pool->workers[pool->numworkers];
+        worker->pool = pool;
+        worker->index = pool->numworkers;
+/* !!! FIXME: this is nasty. */
+#if defined(__WIN32__) && !defined(HAVE_LIBC)
+#undef SDL_CreateThread
+        worker->thread = SDL_CreateThread(SDL_RunWAVDecodeWorker, "SDLWaveDecode", worker, NULL, NULL);
+#else
+        worker->thread = SDL_CreateThread(SDL_RunWAVDecodeWorker, "SDLWaveDecode", worker);
+#endif
+        if (worker->thread == NULL) {
+            break;
+        }
+        pool->numworkers++;
+    }
+    if (pool->numworkers == 0) {
+        SDL_FreeWAVDecodePool(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/* Decode (blocks) ADPCM blocks, splitting the work across the reader's
+   threads when there's enough of it. Blocks don't depend on each other, so
+   each thread gets a contiguous run of them. */
+static int
+SDL_DecodeWAVBlocksParallel(SDL_WAVReader * reader,
+                            const Uint8 * encoded, Uint8 * decoded,
+                            Uint32 blocks)
+{
+    const size_t decoded_len = reader->samples_per_block * reader->frame_size;
+    SDL_WAVDecodePool *pool;
+    SDL_WAVDecodeJob *job;
+    Uint32 per_thread, first;
+    int numthreads, i;
+    int retval = 0;
+
+    numthreads = SDL_min(SDL_GetCPUCount(), WAVE_MAX_THREADS);
+    numthreads = SDL_min((Uint32) numthreads, blocks / (WAVE_PARALLEL_BLOCKS / 4));
+    if (numthreads <= 1) {
+        return SDL_DecodeWAVBlocks(reader, encoded, decoded, blocks);
+    }
+
+    if (reader->pool == NULL) {
+        reader->pool = SDL_CreateWAVDecodePool(numthreads - 1);
+        if (reader->pool == NULL) {
+            /* just do it here */
+            return SDL_DecodeWAVBlocks(reader, encoded, decoded, blocks);
+        }
+    }
+    pool = reader->pool;
+    numthreads = SDL_min(numthreads, pool->numworkers + 1);
+
+    /* Workers past the last share get nothing this time, and this thread
+       takes the last share itself */
+    for (i = 0; i <= pool->numworkers; ++i) {
+        pool->jobs[i].reader = reader;
+        pool->jobs[i].blocks = 0;
+        pool->jobs[i].retval = 0;
+    }
+    per_thread = blocks / numthreads;
+    first = 0;
+    for (i = 0; i < numthreads; ++i) {
+        job = &pool->jobs[(i == numthreads - 1) ? pool->numworkers : i];
+        job->encoded = encoded + (first * reader->blockalign);
+        job->decoded = decoded + (first * decoded_len);
+        job->blocks = (i == numthreads - 1) ? (blocks - first) : per_thread;
+        first += job->blocks;
+    }
+
+    SDL_LockMutex(pool->lock);
+    pool->generation++;
+    pool->busy = pool->numworkers;
+    SDL_CondBroadcast(pool->work);
+    SDL_UnlockMutex(pool->lock);
+
+    SDL_RunWAVDecodeJob(&pool->jobs[pool->numworkers]);
+
+    SDL_LockMutex(pool->lock);
+    while (pool->busy > 0) {
+        SDL_CondWait(pool->done, pool->lock);
+    }
+    SDL_UnlockMutex(pool->lock);
+
+    for (i = 0; i <= pool->numworkers; ++i) {
+        if (pool->jobs[i].retval < 0) {
+            retval = -1;
+        }
+    }
+    return retval;
+}
+
+/* Skip (length) bytes of src, reading them if it can't seek */
+static int
+SkipChunk(SDL_RWops * src, Uint32 length)
+{
+    Uint8 scratch[256];
+    size_t want;
+
+    if (SDL_RWseek(src, length, RW_SEEK_CUR) >= 0) {
+        return (0);
+    }
+    while (length > 0) {
+        want = SDL_min(length, sizeof(scratch));
+        if (SDL_RWread(src, scratch, want, 1) != 1) {
+            SDL_Error(SDL_EFREAD);
+            return (-1);
+        }
+        length -= (Uint32) want;
+    }
+    return (0);
+}
+
+static int
+ReadChunk(SDL_RWops * src, Chunk * chunk)
+{
+    chunk->magic = SDL_ReadLE32(src);
+    chunk->length = SDL_ReadLE32(src);
+    chunk->data = (Uint8 *) SDL_malloc(chunk->length);
+    if (chunk->data == NULL) {
+        SDL_Error(SDL_ENOMEM);
+        return (-1);
+    }
+    if (SDL_RWread(src, chunk->data, chunk->length, 1) != 1) {
+        SDL_Error(SDL_EFREAD);
+        SDL_free(chunk->data);
+        chunk->data = NULL;
+        return (-1);
+    }
+    return (chunk->length);
+}
+
+void
+SDL_CloseWAVReader(SDL_WAVReader * reader)
+{
+    if (reader == NULL) {
+        return;
+    }
+    if (reader->freesrc && reader->src) {
+        SDL_RWclose(reader->src);
+    }
+    if (reader->block != NULL) {
+        SDL_free(reader->block);
+    }
+    if (reader->decoded != NULL) {
+        SDL_free(reader->decoded);
+    }
+    if (reader->batch != NULL) {
+        SDL_free(reader->batch);
+    }
+    if (reader->pool != NULL) {
+        SDL_FreeWAVDecodePool(reader->pool);
+    }
+    SDL_free(reader);
+}
+
+SDL_WAVReader *
+SDL_OpenWAVReader(SDL_RWops * src, int freesrc, SDL_AudioSpec * spec)
+{
+    SDL_WAVReader *reader;
     int was_error;
     Chunk chunk;
     int lenread;
     int IEEE_float_encoded, MS_ADPCM_encoded, IMA_ADPCM_encoded;
-    int samplesize;
+    Sint64 start;
 
     /* WAV magic header */
     Uint32 RIFFchunk;
     Uint32 wavelen = 0;
     Uint32 WAVEmagic;
-    Uint32 headerDiff = 0;
 
     /* FMT chunk */
     WaveFMT *format = NULL;
+    Uint32 format_len = 0;
 
     SDL_zero(chunk);
 
     /* Make sure we are passed a valid data source */
-    was_error = 0;
     if (src == NULL) {
-        was_error = 1;
-        goto done;
+        SDL_InvalidParamError("src");
+        return NULL;
     }
+    if (spec == NULL) {
+        if (freesrc) {
+            SDL_RWclose(src);
+        }
+        SDL_InvalidParamError("spec");
+        return NULL;
+    }
+    reader = (SDL_WAVReader *) SDL_malloc(sizeof(*reader));
+    if (reader == NULL) {
+        if (freesrc) {
+            SDL_RWclose(src);
+        }
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    SDL_zerop(reader);
+    reader->src = src;
+    reader->freesrc = freesrc;
+    reader->decoded_block = ~0u;
+    reader->riff_end = -1;
+    was_error = 0;
+    start = SDL_RWtell(src);
 
     /* Check the magic header */
     RIFFchunk = SDL_ReadLE32(src);
@@ -438,6 +929,7 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
         WAVEmagic = wavelen;
         wavelen = RIFFchunk;
         RIFFchunk = RIFF;
+        start -= sizeof(Uint32);
     } else {
         WAVEmagic = SDL_ReadLE32(src);
     }
@@ -446,7 +938,9 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
         was_error = 1;
         goto done;
     }
-    headerDiff += sizeof(Uint32);       /* for WAVE */
+    if (start >= 0) {
+        reader->riff_end = start + 2 * sizeof(Uint32) + wavelen;
+    }
 
     /* Read the audio data format chunk */
     chunk.data = NULL;
@@ -460,19 +954,19 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
             was_error = 1;
             goto done;
         }
-        /* 2 Uint32's for chunk header+len, plus the lenread */
-        headerDiff += lenread + 2 * sizeof(Uint32);
     } while ((chunk.magic == FACT) || (chunk.magic == LIST));
 
     /* Decode the audio data format */
     format = (WaveFMT *) chunk.data;
-    if (chunk.magic != FMT) {
+    format_len = chunk.length;
+    if ((chunk.magic != FMT) || (format_len < sizeof(*format))) {
         SDL_SetError("Complex WAVE files not supported");
         was_error = 1;
         goto done;
     }
     IEEE_float_encoded = MS_ADPCM_encoded = IMA_ADPCM_encoded = 0;
-    switch (SDL_SwapLE16(format->encoding)) {
+    reader->encoding = SDL_SwapLE16(format->encoding);
+    switch (reader->encoding) {
     case PCM_CODE:
         /* We can understand this */
         break;
@@ -482,18 +976,22 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
         break;
     case MS_ADPCM_CODE:
         /* Try to understand this */
-        if (InitMS_ADPCM(format) < 0) {
+        if (InitMS_ADPCM(&reader->ms, format, format_len) < 0) {
             was_error = 1;
             goto done;
         }
+        reader->blockalign = reader->ms.wavefmt.blockalign;
+        reader->samples_per_block = reader->ms.wSamplesPerBlock;
         MS_ADPCM_encoded = 1;
         break;
     case IMA_ADPCM_CODE:
         /* Try to understand this */
-        if (InitIMA_ADPCM(format) < 0) {
+        if (InitIMA_ADPCM(&reader->ima, format, format_len) < 0) {
             was_error = 1;
             goto done;
         }
+        reader->blockalign = reader->ima.wavefmt.blockalign;
+        reader->samples_per_block = reader->ima.wSamplesPerBlock;
         IMA_ADPCM_encoded = 1;
         break;
     case MP3_CODE:
@@ -547,58 +1045,322 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     }
     spec->channels = (Uint8) SDL_SwapLE16(format->channels);
     spec->samples = 4096;       /* Good default buffer size */
+    if (spec->channels == 0) {
+        SDL_SetError("WAVE file has no channels");
+        was_error = 1;
+        goto done;
+    }
+    reader->frame_size = ((SDL_AUDIO_BITSIZE(spec->format)) / 8) *
+        spec->channels;
 
-    /* Read the audio data chunk */
-    *audio_buf = NULL;
-    do {
-        if (*audio_buf != NULL) {
-            SDL_free(*audio_buf);
-            *audio_buf = NULL;
+    /* Find the audio data chunk, skipping over anything else */
+    for (;;) {
+        chunk.magic = SDL_ReadLE32(src);
+        chunk.length = SDL_ReadLE32(src);
+        if (chunk.magic == DATA) {
+            break;
         }
-        lenread = ReadChunk(src, &chunk);
-        if (lenread < 0) {
+        if ((chunk.magic == 0) && (chunk.length == 0)) {
+            SDL_SetError("WAVE file has no data chunk");
             was_error = 1;
             goto done;
         }
-        *audio_len = lenread;
-        *audio_buf = chunk.data;
-        if (chunk.magic != DATA)
-            headerDiff += lenread + 2 * sizeof(Uint32);
-    } while (chunk.magic != DATA);
-    headerDiff += 2 * sizeof(Uint32);   /* for the data chunk and len */
-
-    if (MS_ADPCM_encoded) {
-        if (MS_ADPCM_decode(audio_buf, audio_len) < 0) {
+        if (SkipChunk(src, chunk.length) < 0) {
             was_error = 1;
             goto done;
         }
     }
-    if (IMA_ADPCM_encoded) {
-        if (IMA_ADPCM_decode(audio_buf, audio_len) < 0) {
+    reader->data_start = SDL_RWtell(src);
+    reader->data_len = chunk.length;
+
+    if (MS_ADPCM_encoded || IMA_ADPCM_encoded) {
+        /* Trailing partial blocks are dropped, as they always were */
+        reader->frames = (reader->data_len / reader->blockalign) *
+            reader->samples_per_block;
+        reader->block = (Uint8 *) SDL_malloc(reader->blockalign);
+        reader->decoded = (Uint8 *)
+            SDL_malloc(reader->samples_per_block * reader->frame_size);
+        if ((reader->block == NULL) || (reader->decoded == NULL)) {
+            SDL_OutOfMemory();
             was_error = 1;
             goto done;
         }
+    } else {
+        reader->frames = reader->data_len / reader->frame_size;
     }
 
-    /* Don't return a buffer that isn't a multiple of samplesize */
-    samplesize = ((SDL_AUDIO_BITSIZE(spec->format)) / 8) * spec->channels;
-    *audio_len &= ~(samplesize - 1);
-
   done:
     if (format != NULL) {
         SDL_free(format);
     }
-    if (src) {
-        if (freesrc) {
-            SDL_RWclose(src);
+    if (was_error) {
+        SDL_CloseWAVReader(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+Uint32
+SDL_GetWAVFrames(SDL_WAVReader * reader)
+{
+    if (reader == NULL) {
+        SDL_InvalidParamError("reader");
+        return 0;
+    }
+    return reader->frames;
+}
+
+/* Read (count) encoded ADPCM blocks, starting at block (index) */
+static int
+SDL_ReadWAVBlocks(SDL_WAVReader * reader, Uint32 index, Uint32 count,
+                  Uint8 * encoded)
+{
+    SDL_RWops *src = reader->src;
+
+    if (reader->next_block != index) {
+        if ((reader->data_start < 0) ||
+            (SDL_RWseek(src, reader->data_start +
+                        ((Sint64) index * reader->blockalign),
+                        RW_SEEK_SET) < 0)) {
+            SDL_SetError("Can't seek in this WAVE file");
+            return (-1);
+        }
+        reader->next_block = index;
+    }
+    if (SDL_RWread(src, encoded, reader->blockalign, count) != count) {
+        /* Where the source is now is anyone's guess */
+        reader->next_block = ~0u;
+        SDL_Error(SDL_EFREAD);
+        return (-1);
+    }
+    reader->next_block += count;
+    return (0);
+}
+
+/* Decode ADPCM block (index) into (dst), which is either the caller's
+   buffer or reader->decoded. The latter keeps the block for next time. */
+static int
+SDL_DecodeWAVBlock(SDL_WAVReader * reader, Uint32 index, Uint8 * dst)
+{
+    if ((dst == reader->decoded) && (reader->decoded_block == index)) {
+        return (0);
+    }
+    if (dst == reader->decoded) {
+        reader->decoded_block = ~0u;
+    }
+    if (SDL_ReadWAVBlocks(reader, index, 1, reader->block) < 0) {
+        return (-1);
+    }
+    if (SDL_DecodeWAVBlocks(reader, reader->block, dst, 1) < 0) {
+        SDL_SetError("Corrupt ADPCM block");
+        return (-1);
+    }
+    if (dst == reader->decoded) {
+        reader->decoded_block = index;
+    }
+    return (0);
+}
+
+/* Decode (count) whole ADPCM blocks from block (index) straight into (dst),
+   a batch at a time, spreading each batch across threads */
+static int
+SDL_DecodeWAVBatch(SDL_WAVReader * reader, Uint32 index, Uint32 count,
+                   Uint8 * dst)
+{
+    const size_t decoded_len = reader->samples_per_block * reader->frame_size;
+    Uint32 batch;
+
+    if (reader->batch == NULL) {
+        reader->batch = (Uint8 *)
+            SDL_malloc((size_t) reader->blockalign * WAVE_BATCH_BLOCKS);
+        if (reader->batch == NULL) {
+            SDL_OutOfMemory();
+            return (-1);
+        }
+    }
+    while (count > 0) {
+        batch = SDL_min(count, WAVE_BATCH_BLOCKS);
+        if (SDL_ReadWAVBlocks(reader, index, batch, reader->batch) < 0) {
+            return (-1);
+        }
+        if (SDL_DecodeWAVBlocksParallel(reader, reader->batch, dst, batch) < 0) {
+            SDL_SetError("Corrupt ADPCM block");
+            return (-1);
+        }
+        dst += batch * decoded_len;
+        index += batch;
+        count -= batch;
+    }
+    return (0);
+}
+
+int
+SDL_ReadWAVFrames(SDL_WAVReader * reader, void *buf, int frames)
+{
+    Uint8 *dst = (Uint8 *) buf;
+    Uint32 index, offset, count;
+    size_t got;
+    int total = 0;
+
+    if (reader == NULL) {
+        SDL_InvalidParamError("reader");
+        return -1;
+    }
+    if ((buf == NULL) || (frames < 0)) {
+        SDL_InvalidParamError("buf");
+        return -1;
+    }
+    frames = (int) SDL_min((Uint32) frames, reader->frames - reader->position);
+
+    if (reader->decoded == NULL) {
+        /* PCM comes straight from the source */
+        got = SDL_RWread(reader->src, dst, reader->frame_size, frames);
+        reader->position += (Uint32) got;
+        return (int) got;
+    }
+
+    /* ADPCM is decoded a block at a time, into the caller's buffer when
+       a whole block is wanted, so large reads make no extra copy */
+    while (total < frames) {
+        index = reader->position / reader->samples_per_block;
+        offset = reader->position % reader->samples_per_block;
+        count = SDL_min((Uint32) (frames - total),
+                        reader->samples_per_block - offset);
+        if ((offset == 0) && ((Uint32) (frames - total) >=
+                              WAVE_PARALLEL_BLOCKS * reader->samples_per_block)) {
+            /* Lots of whole blocks: decode them in parallel */
+            count = (Uint32) (frames - total) / reader->samples_per_block;
+            if (SDL_DecodeWAVBatch(reader, index, count, dst) < 0) {
+                return (total > 0) ? total : -1;
+            }
+            count *= reader->samples_per_block;
+        } else if (count == reader->samples_per_block) {
+            if (SDL_DecodeWAVBlock(reader, index, dst) < 0) {
+                return (total > 0) ? total : -1;
+            }
         } else {
-            /* seek to the end of the file (given by the RIFF chunk) */
-            SDL_RWseek(src, wavelen - chunk.length - headerDiff, RW_SEEK_CUR);
+            if (SDL_DecodeWAVBlock(reader, index, reader->decoded) < 0) {
+                return (total > 0) ? total : -1;
+            }
+            SDL_memcpy(dst, reader->decoded + (offset * reader->frame_size),
+                       count * reader->frame_size);
         }
+        dst += count * reader->frame_size;
+        total += (int) count;
+        reader->position += count;
     }
-    if (was_error) {
-        spec = NULL;
+    return total;
+}
+
+const void *
+SDL_MapWAVFrames(SDL_WAVReader * reader, int *frames)
+{
+    SDL_RWops *src;
+    const Uint8 *data;
+    Uint32 count;
+
+    if ((reader == NULL) || (frames == NULL) || (*frames < 0)) {
+        SDL_InvalidParamError("reader");
+        return NULL;
+    }
+    src = reader->src;
+    if ((reader->decoded != NULL) || (reader->data_start < 0) ||
+        ((src->type != SDL_RWOPS_MEMORY) &&
+         (src->type != SDL_RWOPS_MEMORY_RO))) {
+        *frames = 0;
+        return NULL;
+    }
+
+    /* Don't hand out more than the memory holds, if the file lied */
+    data = src->hidden.mem.base + reader->data_start +
+        ((size_t) reader->position * reader->frame_size);
+    count = SDL_min((Uint32) * frames, reader->frames - reader->position);
+    if (data + ((size_t) count * reader->frame_size) > src->hidden.mem.stop) {
+        count = (data < src->hidden.mem.stop) ?
+            (Uint32) ((src->hidden.mem.stop - data) / reader->frame_size) : 0;
     }
+    *frames = (int) count;
+    if (count == 0) {
+        return NULL;
+    }
+
+    /* Keep the stream where SDL_ReadWAVFrames() would have left it */
+    SDL_RWseek(src, (Sint64) count * reader->frame_size, RW_SEEK_CUR);
+    reader->position += count;
+    return data;
+}
+
+int
+SDL_SeekWAVFrame(SDL_WAVReader * reader, Uint32 frame)
+{
+    if (reader == NULL) {
+        SDL_InvalidParamError("reader");
+        return -1;
+    }
+    if (frame > reader->frames) {
+        SDL_SetError("Seek past the end of the WAVE data");
+        return -1;
+    }
+    if (reader->decoded == NULL) {
+        /* ADPCM seeks lazily, when the block is decoded */
+        if ((reader->data_start < 0) ||
+            (SDL_RWseek(reader->src, reader->data_start +
+                        ((Sint64) frame * reader->frame_size),
+                        RW_SEEK_SET) < 0)) {
+            SDL_SetError("Can't seek in this WAVE file");
+            return -1;
+        }
+    }
+    reader->position = frame;
+    return 0;
+}
+
+SDL_AudioSpec *
+SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
+               SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len)
+{
+    SDL_WAVReader *reader;
+    Uint32 frames, done;
+    int got;
+
+    /* Keep whatever error made the source fail to open */
+    if (src == NULL) {
+        return NULL;
+    }
+
+    /* The reader decodes into the one buffer, so there's never a second
+       full size copy of the data around */
+    reader = SDL_OpenWAVReader(src, freesrc, spec);
+    if (reader == NULL) {
+        return NULL;
+    }
+    frames = reader->frames;
+    *audio_len = frames * reader->frame_size;
+    *audio_buf = (Uint8 *) SDL_malloc(*audio_len ? *audio_len : 1);
+    if (*audio_buf == NULL) {
+        SDL_Error(SDL_ENOMEM);
+        SDL_CloseWAVReader(reader);
+        return NULL;
+    }
+    for (done = 0; done < frames; done += got) {
+        got = SDL_ReadWAVFrames(reader, *audio_buf + (done * reader->frame_size),
+                                (int) SDL_min(frames - done, 0x10000000));
+        if (got <= 0) {
+            if (got == 0) {
+                SDL_Error(SDL_EFREAD);
+            }
+            SDL_free(*audio_buf);
+            *audio_buf = NULL;
+            SDL_CloseWAVReader(reader);
+            return NULL;
+        }
+    }
+
+    if (!freesrc && (reader->riff_end >= 0)) {
+        /* seek to the end of the file (given by the RIFF chunk) */
+        SDL_RWseek(src, reader->riff_end, RW_SEEK_SET);
+    }
+    SDL_CloseWAVReader(reader);
     return (spec);
 }
 
@@ -613,23 +1375,4 @@ SDL_FreeWAV(Uint8 * audio_buf)
     }
 }
 
-static int
-ReadChunk(SDL_RWops * src, Chunk * chunk)
-{
-    chunk->magic = SDL_ReadLE32(src);
-    chunk->length = SDL_ReadLE32(src);
-    chunk->data = (Uint8 *) SDL_malloc(chunk->length);
-    if (chunk->data == NULL) {
-        SDL_Error(SDL_ENOMEM);
-        return (-1);
-    }
-    if (SDL_RWread(src, chunk->data, chunk->length, 1) != 1) {
-        SDL_Error(SDL_EFREAD);
-        SDL_free(chunk->data);
-        chunk->data = NULL;
-        return (-1);
-    }
-    return (chunk->length);
-}
-
 /* vi: set ts=4 sw=4 expandtab: */
@@ -53,14 +53,27 @@ FillSound(void *device, void *stream, size_t len,
         return;
 
     if (!audio->paused) {
-        if (audio->convert.needed) {
-            SDL_LockMutex(audio->mixer_lock);
-            (*audio->spec.callback) (audio->spec.userdata,
-                                     (Uint8 *) audio->convert.buf,
-                                     audio->convert.len);
-            SDL_UnlockMutex(audio->mixer_lock);
-            SDL_ConvertAudio(&audio->convert);
-            SDL_memcpy(stream, audio->convert.buf, audio->convert.len_cvt);
+        if (audio->stream) {
+            int got;
+            while (SDL_AudioStreamAvailable(audio->stream) < (int) len) {
+                SDL_LockMutex(audio->mixer_lock);
+                (*audio->spec.callback) (audio->spec.userdata,
+                                         audio->callback_buf,
+                                         audio->callback_len);
+                SDL_UnlockMutex(audio->mixer_lock);
+                if (SDL_AudioStreamPut(audio->stream, audio->callback_buf,
+                                       audio->callback_len) < 0) {
+                    break;
+                }
+            }
+            got = SDL_AudioStreamGet(audio->stream, stream, (int) len);
+            if (got < 0) {
+                got = 0;
+            }
+            if (got < (int) len) {
+                SDL_memset((Uint8 *) stream + got, audio->spec.silence,
+                           len - got);
+            }
         } else {
             SDL_LockMutex(audio->mixer_lock);
             (*audio->spec.callback) (audio->spec.userdata,
@@ -269,7 +269,7 @@ outputCallback(void *inRefCon,
        any input format in OpenAudio, and leave the conversion to CoreAudio.
      */
     /*
-       SDL_assert(!this->convert.needed);
+       SDL_assert(this->stream == NULL);
        SDL_assert(this->spec.channels == ioData->mNumberChannels);
      */
 
@@ -22,7 +22,10 @@
 
 #if SDL_AUDIO_DRIVER_DISK
 
-/* Output raw audio data to a file. */
+/* Output raw audio data, or a WAV file if the name ends in ".wav", to a
+   file.  Writes are paced to real time by the performance counter unless
+   SDL_DISKAUDIODELAY asks for the old fixed delay, or SDL_DISKAUDIOFREEWHEEL
+   asks to run as fast as possible for offline rendering. */
 
 #if HAVE_STDIO_H
 #include <stdio.h>
@@ -39,7 +42,10 @@
 #define DISKENVR_OUTFILE         "SDL_DISKAUDIOFILE"
 #define DISKDEFAULT_OUTFILE      "sdlaudio.raw"
 #define DISKENVR_WRITEDELAY      "SDL_DISKAUDIODELAY"
-#define DISKDEFAULT_WRITEDELAY   150
+#define DISKENVR_FREEWHEEL       "SDL_DISKAUDIOFREEWHEEL"
+
+/* Size of the RIFF header written in front of WAV data */
+#define DISK_WAVHEADER_SIZE      44
 
 static const char *
 DISKAUD_GetOutputFilename(const char *devname)
@@ -53,11 +59,48 @@ DISKAUD_GetOutputFilename(const char *devname)
     return devname;
 }
 
+/* Move the deadline along by one buffer and return it; 0 means right away */
+static Uint64
+DISKAUD_NextDeadline(_THIS)
+{
+    struct SDL_PrivateAudioData *h = this->hidden;
+    Uint64 now;
+
+    if (h->freewheel) {
+        return 0;
+    }
+    now = SDL_GetPerformanceCounter();
+    if (h->write_delay) {
+        return now + ((h->write_delay * SDL_GetPerformanceFrequency()) / 1000);
+    }
+
+    /* The deadline moves by exactly one buffer per write, carrying the
+       remainder along, so the file keeps pace with the clock forever. */
+    h->next_tick += h->period_ticks;
+    h->tick_remainder += h->period_remainder;
+    if (h->tick_remainder >= (Uint64) this->spec.freq) {
+        h->tick_remainder -= this->spec.freq;
+        h->next_tick++;
+    }
+
+    /* If we stalled for longer than a buffer, don't try to catch up */
+    if ((now > h->next_tick) && ((now - h->next_tick) > h->period_ticks)) {
+        h->next_tick = now;
+    }
+    return h->next_tick;
+}
+
 /* This function waits until it is possible to write a full sound buffer */
 static void
 DISKAUD_WaitDevice(_THIS)
 {
-    SDL_Delay(this->hidden->write_delay);
+    const Uint64 deadline = DISKAUD_NextDeadline(this);
+    const Uint64 now = SDL_GetPerformanceCounter();
+
+    if (now < deadline) {
+        SDL_Delay((Uint32) (((deadline - now) * 1000) /
+                            SDL_GetPerformanceFrequency()));
+    }
 }
 
 static void
@@ -72,6 +115,8 @@ DISKAUD_PlayDevice(_THIS)
     /* If we couldn't write, assume fatal error for now */
     if (written != this->hidden->mixlen) {
         this->enabled = 0;
+    } else {
+        this->hidden->data_bytes += (Uint32) written;
     }
 #ifdef DEBUG_AUDIO
     fprintf(stderr, "Wrote %d bytes of audio data\n", written);
@@ -84,6 +129,33 @@ DISKAUD_GetDeviceBuf(_THIS)
     return (this->hidden->mixbuf);
 }
 
+/* Write a canonical 44 byte RIFF/WAVE header for (data_bytes) of audio */
+static int
+DISKAUD_WriteWaveHeader(_THIS)
+{
+    SDL_RWops *dst = this->hidden->output;
+    const Uint16 bits = SDL_AUDIO_BITSIZE(this->spec.format);
+    const Uint16 blockalign = (bits / 8) * this->spec.channels;
+    const Uint32 data_bytes = this->hidden->data_bytes;
+    size_t written = 0;
+
+    written += SDL_WriteLE32(dst, 0x46464952);  /* "RIFF" */
+    written += SDL_WriteLE32(dst, DISK_WAVHEADER_SIZE - 8 + data_bytes);
+    written += SDL_WriteLE32(dst, 0x45564157);  /* "WAVE" */
+    written += SDL_WriteLE32(dst, 0x20746D66);  /* "fmt " */
+    written += SDL_WriteLE32(dst, 16);
+    /* WAVE_FORMAT_IEEE_FLOAT or WAVE_FORMAT_PCM */
+    written += SDL_WriteLE16(dst, SDL_AUDIO_ISFLOAT(this->spec.format) ? 3 : 1);
+    written += SDL_WriteLE16(dst, this->spec.channels);
+    written += SDL_WriteLE32(dst, this->spec.freq);
+    written += SDL_WriteLE32(dst, this->spec.freq * blockalign);
+    written += SDL_WriteLE16(dst, blockalign);
+    written += SDL_WriteLE16(dst, bits);
+    written += SDL_WriteLE32(dst, 0x61746164);  /* "data" */
+    written += SDL_WriteLE32(dst, data_bytes);
+    return (written == 13) ? 0 : -1;
+}
+
 static void
 DISKAUD_CloseDevice(_THIS)
 {
@@ -93,6 +165,11 @@ DISKAUD_CloseDevice(_THIS)
             this->hidden->mixbuf = NULL;
         }
         if (this->hidden->output != NULL) {
+            /* Now that the data size is known, fix up the header */
+            if (this->hidden->wave &&
+                (SDL_RWseek(this->hidden->output, 0, RW_SEEK_SET) == 0)) {
+                DISKAUD_WriteWaveHeader(this);
+            }
             SDL_RWclose(this->hidden->output);
             this->hidden->output = NULL;
         }
@@ -105,7 +182,10 @@ static int
 DISKAUD_OpenDevice(_THIS, const char *devname, int iscapture)
 {
     const char *envr = SDL_getenv(DISKENVR_WRITEDELAY);
+    const char *freewheel = SDL_getenv(DISKENVR_FREEWHEEL);
     const char *fname = DISKAUD_GetOutputFilename(devname);
+    const size_t fnamelen = SDL_strlen(fname);
+    Uint64 frequency;
 
     this->hidden = (struct SDL_PrivateAudioData *)
         SDL_malloc(sizeof(*this->hidden));
@@ -122,7 +202,32 @@ DISKAUD_OpenDevice(_THIS, const char *devname, int iscapture)
         return 0;
     }
 
+    /* WAV data is little endian, and unsigned only at 8 bits */
+    if ((fnamelen >= 4) && (SDL_strcasecmp(fname + fnamelen - 4, ".wav") == 0)) {
+        this->hidden->wave = 1;
+        switch (SDL_AUDIO_BITSIZE(this->spec.format)) {
+        case 8:
+            this->spec.format = AUDIO_U8;
+            break;
+        case 16:
+            this->spec.format = AUDIO_S16LSB;
+            break;
+        default:
+            this->spec.format = SDL_AUDIO_ISFLOAT(this->spec.format) ?
+                AUDIO_F32LSB : AUDIO_S32LSB;
+            break;
+        }
+        SDL_CalculateAudioSpec(&this->spec);
+
+        /* Placeholder sizes, patched when the device is closed */
+        if (DISKAUD_WriteWaveHeader(this) < 0) {
+            DISKAUD_CloseDevice(this);
+            return 0;
+        }
+    }
+
     /* Allocate mixing buffer */
+    this->hidden->mixlen = this->spec.size;
     this->hidden->mixbuf = (Uint8 *) SDL_AllocAudioMem(this->hidden->mixlen);
     if (this->hidden->mixbuf == NULL) {
         DISKAUD_CloseDevice(this);
@@ -130,9 +235,20 @@ DISKAUD_OpenDevice(_THIS, const char *devname, int iscapture)
     }
     SDL_memset(this->hidden->mixbuf, this->spec.silence, this->spec.size);
 
-    this->hidden->mixlen = this->spec.size;
-    this->hidden->write_delay =
-        (envr) ? SDL_atoi(envr) : DISKDEFAULT_WRITEDELAY;
+    this->hidden->write_delay = (envr) ? SDL_atoi(envr) : 0;
+    this->hidden->freewheel = (freewheel) ? SDL_atoi(freewheel) : 0;
+    if (envr && (this->hidden->write_delay == 0)) {
+        this->hidden->freewheel = 1;    /* a zero delay always meant this */
+    }
+
+    /* One buffer worth of performance counter ticks, as a whole part and
+       a remainder in units of 1/freq, so pacing never drifts */
+    frequency = SDL_GetPerformanceFrequency();
+    this->hidden->period_ticks =
+        (this->spec.samples * frequency) / this->spec.freq;
+    this->hidden->period_remainder =
+        (this->spec.samples * frequency) % this->spec.freq;
+    this->hidden->next_tick = SDL_GetPerformanceCounter();
 
 #if HAVE_STDIO_H
     fprintf(stderr,
@@ -150,6 +266,7 @@ DISKAUD_Init(SDL_AudioDriverImpl * impl)
     /* Set the function pointers */
     impl->OpenDevice = DISKAUD_OpenDevice;
     impl->WaitDevice = DISKAUD_WaitDevice;
+    impl->NextDeadline = DISKAUD_NextDeadline;
     impl->PlayDevice = DISKAUD_PlayDevice;
     impl->GetDeviceBuf = DISKAUD_GetDeviceBuf;
     impl->CloseDevice = DISKAUD_CloseDevice;
@@ -35,7 +35,14 @@ struct SDL_PrivateAudioData
     SDL_RWops *output;
     Uint8 *mixbuf;
     Uint32 mixlen;
-    Uint32 write_delay;
+    Uint32 write_delay;         /* fixed delay in ms, 0 to pace by the clock */
+    int freewheel;              /* don't wait at all */
+    int wave;                   /* writing a WAV file */
+    Uint32 data_bytes;          /* audio written so far */
+    Uint64 next_tick;           /* performance counter at the next deadline */
+    Uint64 period_ticks;
+    Uint64 period_remainder;    /* in 1/freq ticks */
+    Uint64 tick_remainder;
 };
 
 #endif /* _SDL_diskaudio_h */
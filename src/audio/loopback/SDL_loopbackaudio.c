@@ -0,0 +1,364 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+#if SDL_AUDIO_DRIVER_LOOPBACK
+
+/* An in-process output and capture device pair. Whatever is played on the
+   output device comes back on the capture device, stamped with the
+   performance counter at the time it was played, so round-trip latency can
+   be measured. If SDL_LOOPBACKAUDIOFILE names a file, the capture device
+   reads that instead: a WAV file in its own format, or raw data in the
+   format the device was opened with. */
+
+#include "SDL_rwops.h"
+#include "SDL_timer.h"
+#include "SDL_mutex.h"
+#include "SDL_audio.h"
+#include "../SDL_audiomem.h"
+#include "../SDL_audio_c.h"
+#include "SDL_loopbackaudio.h"
+
+/* environment variables */
+#define LOOPBACKENVR_INFILE      "SDL_LOOPBACKAUDIOFILE"
+
+/* Buffers the capture side may fall behind before the oldest is dropped */
+#define LOOPBACK_CHUNKS          8
+
+/* State shared by the two halves of the loopback */
+static struct
+{
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    int users;                  /* devices sharing the format below */
+    int has_output;
+    SDL_AudioSpec spec;
+    Uint8 *chunks;              /* LOOPBACK_CHUNKS buffers of spec.size */
+    Uint64 stamps[LOOPBACK_CHUNKS];
+    int head;                   /* oldest buffer not yet captured */
+    int count;
+} loopback;
+
+/* Move the deadline along by exactly one buffer and return it */
+static Uint64
+LOOPBACKAUD_NextDeadline(_THIS)
+{
+    struct SDL_PrivateAudioData *h = this->hidden;
+    Uint64 now;
+
+    h->next_tick += h->period_ticks;
+    h->tick_remainder += h->period_remainder;
+    if (h->tick_remainder >= (Uint64) this->spec.freq) {
+        h->tick_remainder -= this->spec.freq;
+        h->next_tick++;
+    }
+
+    /* If we stalled for longer than a buffer, don't try to catch up */
+    now = SDL_GetPerformanceCounter();
+    if ((now > h->next_tick) && ((now - h->next_tick) > h->period_ticks)) {
+        h->next_tick = now;
+    }
+    return h->next_tick;
+}
+
+/* Sleep until the next buffer is due, keeping exact pace with the clock */
+static void
+LOOPBACKAUD_WaitPeriod(_THIS)
+{
+    const Uint64 deadline = LOOPBACKAUD_NextDeadline(this);
+    const Uint64 now = SDL_GetPerformanceCounter();
+
+    if (now < deadline) {
+        SDL_Delay((Uint32) (((deadline - now) * 1000) /
+                            SDL_GetPerformanceFrequency()));
+    }
+}
+
+static void
+LOOPBACKAUD_WaitDevice(_THIS)
+{
+    LOOPBACKAUD_WaitPeriod(this);
+}
+
+static void
+LOOPBACKAUD_PlayDevice(_THIS)
+{
+    const Uint64 now = SDL_GetPerformanceCounter();
+    int tail;
+
+    SDL_LockMutex(loopback.lock);
+    if (loopback.count == LOOPBACK_CHUNKS) {
+        /* Nobody is listening, or they fell behind; drop the oldest */
+        loopback.head = (loopback.head + 1) % LOOPBACK_CHUNKS;
+        loopback.count--;
+    }
+    tail = (loopback.head + loopback.count) % LOOPBACK_CHUNKS;
+    SDL_memcpy(loopback.chunks + (tail * loopback.spec.size),
+               this->hidden->mixbuf, this->hidden->mixlen);
+    loopback.stamps[tail] = now;
+    loopback.count++;
+    SDL_CondSignal(loopback.cond);
+    SDL_UnlockMutex(loopback.lock);
+}
+
+static Uint8 *
+LOOPBACKAUD_GetDeviceBuf(_THIS)
+{
+    return (this->hidden->mixbuf);
+}
+
+static int
+LOOPBACKAUD_CaptureFromFile(_THIS, Uint8 *buffer, int buflen,
+                            Uint64 *timestamp)
+{
+    size_t got;
+
+    LOOPBACKAUD_WaitPeriod(this);
+    *timestamp = SDL_GetPerformanceCounter();
+
+    /* Silence once the file runs out */
+    got = SDL_RWread(this->hidden->input, buffer, 1, buflen);
+    if (got < (size_t) buflen) {
+        SDL_memset(buffer + got, this->spec.silence, buflen - got);
+    }
+    return buflen;
+}
+
+static int
+LOOPBACKAUD_CaptureFromDevice(_THIS, void *buffer, int buflen,
+                              Uint64 *timestamp)
+{
+    Uint32 timeout;
+    int len;
+
+    if (this->hidden->input != NULL) {
+        return LOOPBACKAUD_CaptureFromFile(this, (Uint8 *) buffer, buflen,
+                                           timestamp);
+    }
+
+    SDL_LockMutex(loopback.lock);
+    if (!loopback.has_output) {
+        /* Nothing is playing; record silence in real time */
+        SDL_UnlockMutex(loopback.lock);
+        LOOPBACKAUD_WaitPeriod(this);
+        *timestamp = SDL_GetPerformanceCounter();
+        SDL_memset(buffer, this->spec.silence, buflen);
+        return buflen;
+    }
+
+    /* Give the output side two buffers' time before calling it an underrun */
+    if (loopback.count == 0) {
+        timeout = ((this->spec.samples * 2000) / this->spec.freq) + 1;
+        SDL_CondWaitTimeout(loopback.cond, loopback.lock, timeout);
+    }
+
+    len = SDL_min(buflen, (int) loopback.spec.size);
+    if (loopback.count > 0) {
+        SDL_memcpy(buffer, loopback.chunks + (loopback.head * loopback.spec.size),
+                   len);
+        *timestamp = loopback.stamps[loopback.head];
+        loopback.head = (loopback.head + 1) % LOOPBACK_CHUNKS;
+        loopback.count--;
+    } else {
+        SDL_memset(buffer, this->spec.silence, len);
+        *timestamp = SDL_GetPerformanceCounter();
+    }
+    SDL_UnlockMutex(loopback.lock);
+
+    return len;
+}
+
+static void
+LOOPBACKAUD_CloseDevice(_THIS)
+{
+    if (this->hidden != NULL) {
+        if (this->hidden->mixbuf != NULL) {
+            SDL_FreeAudioMem(this->hidden->mixbuf);
+            this->hidden->mixbuf = NULL;
+        }
+        if (this->hidden->input != NULL) {
+            SDL_RWclose(this->hidden->input);
+            this->hidden->input = NULL;
+        }
+        if (this->hidden->shared) {
+            SDL_LockMutex(loopback.lock);
+            if (!this->iscapture) {
+                loopback.has_output = 0;
+            }
+            if (--loopback.users == 0) {
+                SDL_free(loopback.chunks);
+                loopback.chunks = NULL;
+            }
+            SDL_UnlockMutex(loopback.lock);
+        }
+        if (this->hidden->wavbuf != NULL) {
+            SDL_FreeWAV(this->hidden->wavbuf);
+            this->hidden->wavbuf = NULL;
+        }
+        SDL_free(this->hidden);
+        this->hidden = NULL;
+    }
+}
+
+/* Point the capture device at a file instead of the output device */
+static int
+LOOPBACKAUD_OpenFile(_THIS, const char *fname)
+{
+    const size_t fnamelen = SDL_strlen(fname);
+    SDL_AudioSpec wavspec;
+    Uint32 wavlen = 0;
+
+    if ((fnamelen >= 4) && (SDL_strcasecmp(fname + fnamelen - 4, ".wav") == 0)) {
+        if (SDL_LoadWAV(fname, &wavspec, &this->hidden->wavbuf, &wavlen) == NULL) {
+            return -1;
+        }
+        this->spec.format = wavspec.format;
+        this->spec.channels = wavspec.channels;
+        this->spec.freq = wavspec.freq;
+        SDL_CalculateAudioSpec(&this->spec);
+        this->hidden->input = SDL_RWFromConstMem(this->hidden->wavbuf, wavlen);
+    } else {
+        this->hidden->input = SDL_RWFromFile(fname, "rb");
+    }
+    return (this->hidden->input != NULL) ? 0 : -1;
+}
+
+static int
+LOOPBACKAUD_OpenDevice(_THIS, const char *devname, int iscapture)
+{
+    const char *fname = (iscapture) ? SDL_getenv(LOOPBACKENVR_INFILE) : NULL;
+    Uint64 frequency;
+
+    this->hidden = (struct SDL_PrivateAudioData *)
+        SDL_malloc(sizeof(*this->hidden));
+    if (this->hidden == NULL) {
+        SDL_OutOfMemory();
+        return 0;
+    }
+    SDL_memset(this->hidden, 0, sizeof(*this->hidden));
+
+    if (fname != NULL) {
+        if (LOOPBACKAUD_OpenFile(this, fname) < 0) {
+            LOOPBACKAUD_CloseDevice(this);
+            return 0;
+        }
+    } else {
+        /* Whichever half opens first picks the format for both */
+        SDL_LockMutex(loopback.lock);
+        if (loopback.users == 0) {
+            loopback.chunks = (Uint8 *)
+                SDL_malloc(this->spec.size * LOOPBACK_CHUNKS);
+            if (loopback.chunks == NULL) {
+                SDL_UnlockMutex(loopback.lock);
+                LOOPBACKAUD_CloseDevice(this);
+                SDL_OutOfMemory();
+                return 0;
+            }
+            loopback.spec = this->spec;
+        } else {
+            this->spec.format = loopback.spec.format;
+            this->spec.channels = loopback.spec.channels;
+            this->spec.freq = loopback.spec.freq;
+            this->spec.samples = loopback.spec.samples;
+            SDL_CalculateAudioSpec(&this->spec);
+        }
+        loopback.users++;
+        this->hidden->shared = 1;
+        if (iscapture) {
+            /* Start listening from now, not from whatever was dropped */
+            loopback.head = 0;
+            loopback.count = 0;
+        } else {
+            loopback.has_output = 1;
+        }
+        SDL_UnlockMutex(loopback.lock);
+    }
+
+    if (!iscapture) {
+        this->hidden->mixlen = this->spec.size;
+        this->hidden->mixbuf = (Uint8 *) SDL_AllocAudioMem(this->hidden->mixlen);
+        if (this->hidden->mixbuf == NULL) {
+            LOOPBACKAUD_CloseDevice(this);
+            SDL_OutOfMemory();
+            return 0;
+        }
+        SDL_memset(this->hidden->mixbuf, this->spec.silence, this->spec.size);
+    }
+
+    /* One buffer worth of performance counter ticks, as a whole part and
+       a remainder in units of 1/freq */
+    frequency = SDL_GetPerformanceFrequency();
+    this->hidden->period_ticks =
+        (this->spec.samples * frequency) / this->spec.freq;
+    this->hidden->period_remainder =
+        (this->spec.samples * frequency) % this->spec.freq;
+    this->hidden->next_tick = SDL_GetPerformanceCounter();
+
+    /* We're ready to rock and roll. :-) */
+    return 1;
+}
+
+static void
+LOOPBACKAUD_Deinitialize(void)
+{
+    if (loopback.cond != NULL) {
+        SDL_DestroyCond(loopback.cond);
+    }
+    if (loopback.lock != NULL) {
+        SDL_DestroyMutex(loopback.lock);
+    }
+    SDL_memset(&loopback, 0, sizeof(loopback));
+}
+
+static int
+LOOPBACKAUD_Init(SDL_AudioDriverImpl * impl)
+{
+    SDL_memset(&loopback, 0, sizeof(loopback));
+    loopback.lock = SDL_CreateMutex();
+    loopback.cond = SDL_CreateCond();
+    if ((loopback.lock == NULL) || (loopback.cond == NULL)) {
+        LOOPBACKAUD_Deinitialize();
+        return 0;
+    }
+
+    /* Set the function pointers */
+    impl->OpenDevice = LOOPBACKAUD_OpenDevice;
+    impl->WaitDevice = LOOPBACKAUD_WaitDevice;
+    impl->NextDeadline = LOOPBACKAUD_NextDeadline;
+    impl->PlayDevice = LOOPBACKAUD_PlayDevice;
+    impl->GetDeviceBuf = LOOPBACKAUD_GetDeviceBuf;
+    impl->CaptureFromDevice = LOOPBACKAUD_CaptureFromDevice;
+    impl->CloseDevice = LOOPBACKAUD_CloseDevice;
+    impl->Deinitialize = LOOPBACKAUD_Deinitialize;
+    impl->HasCaptureSupport = 1;
+    impl->OnlyHasDefaultOutputDevice = 1;
+    impl->OnlyHasDefaultInputDevice = 1;
+
+    return 1;   /* this audio target is available. */
+}
+
+AudioBootStrap LOOPBACKAUD_bootstrap = {
+    "loopback", "in-process loopback audio", LOOPBACKAUD_Init, 1
+};
+
+#endif /* SDL_AUDIO_DRIVER_LOOPBACK */
+
+/* vi: set ts=4 sw=4 expandtab: */
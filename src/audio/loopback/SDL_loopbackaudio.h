@@ -0,0 +1,46 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_loopbackaudio_h
+#define _SDL_loopbackaudio_h
+
+#include "SDL_rwops.h"
+#include "../SDL_sysaudio.h"
+
+/* Hidden "this" pointer for the audio functions */
+#define _THIS	SDL_AudioDevice *this
+
+struct SDL_PrivateAudioData
+{
+    Uint8 *mixbuf;
+    Uint32 mixlen;
+    SDL_RWops *input;           /* file source for the capture device */
+    Uint8 *wavbuf;              /* decoded WAV data behind (input) */
+    int shared;                 /* counted in the loopback's users */
+    Uint64 next_tick;           /* performance counter at the next deadline */
+    Uint64 period_ticks;
+    Uint64 period_remainder;    /* in 1/freq ticks */
+    Uint64 tick_remainder;
+};
+
+#endif /* _SDL_loopbackaudio_h */
+/* vi: set ts=4 sw=4 expandtab: */
@@ -44,6 +44,9 @@
 #ifdef __WIN32__
 #include "../core/windows/SDL_windows.h"
 #endif
+#if defined(_MSC_VER) && (_MSC_VER >= 1500) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>             /* __cpuidex(), _xgetbv() */
+#endif
 
 #define CPU_HAS_RDTSC   0x00000001
 #define CPU_HAS_ALTIVEC 0x00000002
@@ -54,6 +57,8 @@
 #define CPU_HAS_SSE3    0x00000040
 #define CPU_HAS_SSE41   0x00000100
 #define CPU_HAS_SSE42   0x00000200
+#define CPU_HAS_AVX     0x00000400
+#define CPU_HAS_AVX2    0x00000800
 
 #if SDL_ALTIVEC_BLITTERS && HAVE_SETJMP && !__MACOSX__ && !__OpenBSD__
 /* This is the brute force way of detecting instruction sets...
@@ -155,6 +160,8 @@ done:
 "       movl    $1,-8(%rbp)    \n"
 "1:                            \n"
     );
+#elif defined(_MSC_VER) && defined(_M_X64)
+    has_CPUID = 1;             /* every x86_64 CPU has CPUID */
 #endif
 /* *INDENT-ON* */
     return has_CPUID;
@@ -167,7 +174,7 @@ done:
 "        cpuid              \n" \
 "        movl %%ebx, %%esi  \n" \
 "        popl %%ebx         \n" : \
-            "=a" (a), "=S" (b), "=c" (c), "=d" (d) : "a" (func))
+            "=a" (a), "=S" (b), "=c" (c), "=d" (d) : "a" (func), "c" (0))
 #elif defined(__GNUC__) && defined(__x86_64__)
 #define cpuid(func, a, b, c, d) \
     __asm__ __volatile__ ( \
@@ -175,17 +182,28 @@ done:
 "        cpuid              \n" \
 "        movq %%rbx, %%rsi  \n" \
 "        popq %%rbx         \n" : \
-            "=a" (a), "=S" (b), "=c" (c), "=d" (d) : "a" (func))
+            "=a" (a), "=S" (b), "=c" (c), "=d" (d) : "a" (func), "c" (0))
 #elif (defined(_MSC_VER) && defined(_M_IX86)) || defined(__WATCOMC__)
 #define cpuid(func, a, b, c, d) \
     __asm { \
         __asm mov eax, func \
+        __asm xor ecx, ecx \
         __asm cpuid \
         __asm mov a, eax \
         __asm mov b, ebx \
         __asm mov c, ecx \
         __asm mov d, edx \
     }
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define cpuid(func, a, b, c, d) \
+    { \
+        int CPUInfo[4]; \
+        __cpuidex(CPUInfo, func, 0); \
+        a = CPUInfo[0]; \
+        b = CPUInfo[1]; \
+        c = CPUInfo[2]; \
+        d = CPUInfo[3]; \
+    }
 #else
 #define cpuid(func, a, b, c, d) \
     a = b = c = d = 0
@@ -328,6 +346,63 @@ CPU_haveSSE42(void)
     return 0;
 }
 
+/* The OS has to save the YMM registers too, or AVX isn't usable at all */
+static __inline__ int
+CPU_OSSavesYMM(void)
+{
+    int a = 0, d = 0;
+/* *INDENT-OFF* */
+#if defined(__GNUC__) && (defined(i386) || defined(__x86_64__))
+    __asm__ (".byte 0x0f, 0x01, 0xd0" : "=a" (a), "=d" (d) : "c" (0));
+#elif defined(_MSC_FULL_VER) && (_MSC_FULL_VER >= 160040219) && (defined(_M_IX86) || defined(_M_X64))
+    a = (int) _xgetbv(0);   /* VS2010 SP1 and later; x64 has no inline asm */
+#elif (defined(_MSC_VER) && defined(_M_IX86)) || defined(__WATCOMC__)
+    __asm {
+        xor ecx, ecx
+        _emit 0x0f
+        _emit 0x01
+        _emit 0xd0
+        mov a, eax
+        mov d, edx
+    }
+#endif
+/* *INDENT-ON* */
+    return ((a & 6) == 6);
+}
+
+static __inline__ int
+CPU_haveAVX(void)
+{
+    if (CPU_haveCPUID()) {
+        int a, b, c, d;
+
+        cpuid(0, a, b, c, d);
+        if (a >= 1) {
+            cpuid(1, a, b, c, d);
+            /* AVX and OSXSAVE */
+            if ((c & 0x18000000) == 0x18000000) {
+                return CPU_OSSavesYMM();
+            }
+        }
+    }
+    return 0;
+}
+
+static __inline__ int
+CPU_haveAVX2(void)
+{
+    if (CPU_haveAVX()) {
+        int a, b, c, d;
+
+        cpuid(0, a, b, c, d);
+        if (a >= 7) {
+            cpuid(7, a, b, c, d);
+            return (b & 0x00000020);
+        }
+    }
+    return 0;
+}
+
 static int SDL_CPUCount = 0;
 
 int
@@ -522,6 +597,12 @@ SDL_GetCPUFeatures(void)
         if (CPU_haveSSE42()) {
             SDL_CPUFeatures |= CPU_HAS_SSE42;
         }
+        if (CPU_haveAVX()) {
+            SDL_CPUFeatures |= CPU_HAS_AVX;
+        }
+        if (CPU_haveAVX2()) {
+            SDL_CPUFeatures |= CPU_HAS_AVX2;
+        }
     }
     return SDL_CPUFeatures;
 }
@@ -607,6 +688,24 @@ SDL_HasSSE42(void)
     return SDL_FALSE;
 }
 
+SDL_bool
+SDL_HasAVX(void)
+{
+    if (SDL_GetCPUFeatures() & CPU_HAS_AVX) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+SDL_bool
+SDL_HasAVX2(void)
+{
+    if (SDL_GetCPUFeatures() & CPU_HAS_AVX2) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
 #ifdef TEST_MAIN
 
 #include <stdio.h>
@@ -627,6 +726,8 @@ main()
     printf("SSE3: %d\n", SDL_HasSSE3());
     printf("SSE4.1: %d\n", SDL_HasSSE41());
     printf("SSE4.2: %d\n", SDL_HasSSE42());
+    printf("AVX: %d\n", SDL_HasAVX());
+    printf("AVX2: %d\n", SDL_HasAVX2());
     return 0;
 }
 
@@ -0,0 +1,418 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* Event recording and replay
+
+   A recording starts with an 8 byte magic string, then the format version,
+   the byte order and sizeof(SDL_Event), each as a little endian Uint16.
+   Every event follows as a little endian Uint64 of nanoseconds since the
+   recording started, a little endian Uint16 length, and that many bytes of
+   the event as it is in memory -- just its own structure, not the whole
+   union.  A drop event is followed by the length of its file name as a
+   little endian Uint32, and the name itself.
+
+   The events are stored in the byte order of the machine that recorded
+   them, so a recording only replays on a machine with the same layout. */
+
+#include "SDL_atomic.h"
+#include "SDL_events.h"
+#include "SDL_endian.h"
+#include "SDL_rwops.h"
+#include "SDL_timer.h"
+#include "SDL_thread.h"
+#include "SDL_events_c.h"
+#include "../timer/SDL_timer_c.h"
+
+#define EVENT_RECORDING_MAGIC   "SDLEVREC"
+#define EVENT_RECORDING_VERSION 1
+
+/* How long replay waits for room in a full queue before it gives up */
+#define EVENT_REPLAY_FULL_TIMEOUT   1000
+
+static struct
+{
+    SDL_mutex *lock;
+    SDL_RWops *dst;
+    Uint64 start;
+    SDL_bool failed;
+} SDL_recording;
+
+/* How many bytes of an event of (type) to store */
+static size_t
+SDL_RecordedEventSize(Uint32 type)
+{
+    if (type >= SDL_USEREVENT) {
+        return sizeof(SDL_UserEvent);
+    }
+    switch (type) {
+    case SDL_QUIT:
+        return sizeof(SDL_QuitEvent);
+    case SDL_WINDOWEVENT:
+        return sizeof(SDL_WindowEvent);
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        return sizeof(SDL_KeyboardEvent);
+    case SDL_TEXTEDITING:
+        return sizeof(SDL_TextEditingEvent);
+    case SDL_TEXTINPUT:
+        return sizeof(SDL_TextInputEvent);
+    case SDL_MOUSEMOTION:
+        return sizeof(SDL_MouseMotionEvent);
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        return sizeof(SDL_MouseButtonEvent);
+    case SDL_MOUSEWHEEL:
+        return sizeof(SDL_MouseWheelEvent);
+    case SDL_JOYAXISMOTION:
+        return sizeof(SDL_JoyAxisEvent);
+    case SDL_JOYBALLMOTION:
+        return sizeof(SDL_JoyBallEvent);
+    case SDL_JOYHATMOTION:
+        return sizeof(SDL_JoyHatEvent);
+    case SDL_JOYBUTTONDOWN:
+    case SDL_JOYBUTTONUP:
+        return sizeof(SDL_JoyButtonEvent);
+    case SDL_JOYDEVICEADDED:
+    case SDL_JOYDEVICEREMOVED:
+        return sizeof(SDL_JoyDeviceEvent);
+    case SDL_CONTROLLERAXISMOTION:
+        return sizeof(SDL_ControllerAxisEvent);
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP:
+        return sizeof(SDL_ControllerButtonEvent);
+    case SDL_CONTROLLERDEVICEADDED:
+    case SDL_CONTROLLERDEVICEREMOVED:
+    case SDL_CONTROLLERDEVICEREMAPPED:
+        return sizeof(SDL_ControllerDeviceEvent);
+    case SDL_FINGERDOWN:
+    case SDL_FINGERUP:
+    case SDL_FINGERMOTION:
+        return sizeof(SDL_TouchFingerEvent);
+    case SDL_DOLLARGESTURE:
+    case SDL_DOLLARRECORD:
+        return sizeof(SDL_DollarGestureEvent);
+    case SDL_MULTIGESTURE:
+        return sizeof(SDL_MultiGestureEvent);
+    case SDL_DROPFILE:
+        return sizeof(SDL_DropEvent);
+    default:
+        return sizeof(SDL_Event);
+    }
+}
+
+/* Where an input event keeps its nanosecond timestamp, or NULL */
+static Uint64 *
+SDL_EventTimestampNS(SDL_Event * event)
+{
+    switch (event->type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        return &event->key.timestamp_ns;
+    case SDL_MOUSEMOTION:
+        return &event->motion.timestamp_ns;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        return &event->button.timestamp_ns;
+    case SDL_MOUSEWHEEL:
+        return &event->wheel.timestamp_ns;
+    case SDL_JOYAXISMOTION:
+        return &event->jaxis.timestamp_ns;
+    case SDL_JOYBALLMOTION:
+        return &event->jball.timestamp_ns;
+    case SDL_JOYHATMOTION:
+        return &event->jhat.timestamp_ns;
+    case SDL_JOYBUTTONDOWN:
+    case SDL_JOYBUTTONUP:
+        return &event->jbutton.timestamp_ns;
+    case SDL_CONTROLLERAXISMOTION:
+        return &event->caxis.timestamp_ns;
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP:
+        return &event->cbutton.timestamp_ns;
+    case SDL_FINGERDOWN:
+    case SDL_FINGERUP:
+    case SDL_FINGERMOTION:
+        return &event->tfinger.timestamp_ns;
+    default:
+        return NULL;
+    }
+}
+
+/* Create the recording lock the first time it's needed */
+static int
+SDL_LockEventRecording(void)
+{
+#if !SDL_THREADS_DISABLED
+    static SDL_SpinLock create_lock = 0;
+
+    /* The lock lives until the event loop stops, see SDL_QuitEventRecording() */
+    SDL_AtomicLock(&create_lock);
+    if (!SDL_recording.lock) {
+        SDL_recording.lock = SDL_CreateMutex();
+    }
+    SDL_AtomicUnlock(&create_lock);
+    if (!SDL_recording.lock) {
+        return -1;
+    }
+    return SDL_LockMutex(SDL_recording.lock);
+#else
+    return 0;
+#endif
+}
+
+static void
+SDL_UnlockEventRecording(void)
+{
+    if (SDL_recording.lock) {
+        SDL_UnlockMutex(SDL_recording.lock);
+    }
+}
+
+/* The event watch that writes the recording */
+static int
+SDL_RecordEvent(void *userdata, SDL_Event * event)
+{
+    SDL_RWops *dst;
+    size_t size;
+    Uint32 length;
+
+    if (event->type == SDL_SYSWMEVENT) {
+        /* The message only means something to this process */
+        return 0;
+    }
+    size = SDL_RecordedEventSize(event->type);
+
+    if (SDL_recording.lock && SDL_LockMutex(SDL_recording.lock) < 0) {
+        return 0;
+    }
+    dst = SDL_recording.dst;
+    if (dst && !SDL_recording.failed) {
+        if (!SDL_WriteLE64(dst, SDL_GetPerformanceNS() - SDL_recording.start) ||
+            !SDL_WriteLE16(dst, (Uint16) size) ||
+            SDL_RWwrite(dst, event, size, 1) != 1) {
+            SDL_recording.failed = SDL_TRUE;
+        } else if (event->type == SDL_DROPFILE) {
+            length = event->drop.file ? (Uint32) SDL_strlen(event->drop.file) : 0;
+            if (!SDL_WriteLE32(dst, length) ||
+                (length && SDL_RWwrite(dst, event->drop.file, length, 1) != 1)) {
+                SDL_recording.failed = SDL_TRUE;
+            }
+        }
+    }
+    SDL_UnlockEventRecording();
+
+    return 0;
+}
+
+int
+SDL_StartEventRecording(SDL_RWops * dst)
+{
+    if (!dst) {
+        SDL_InvalidParamError("dst");
+        return -1;
+    }
+    if (SDL_LockEventRecording() < 0) {
+        return -1;
+    }
+    if (SDL_recording.dst) {
+        SDL_UnlockEventRecording();
+        SDL_SetError("Events are already being recorded");
+        return -1;
+    }
+
+    if (SDL_RWwrite(dst, EVENT_RECORDING_MAGIC, 8, 1) != 1 ||
+        !SDL_WriteLE16(dst, EVENT_RECORDING_VERSION) ||
+        !SDL_WriteLE16(dst, SDL_BYTEORDER) ||
+        !SDL_WriteLE16(dst, sizeof(SDL_Event))) {
+        SDL_UnlockEventRecording();
+        SDL_SetError("Couldn't write the event recording header");
+        return -1;
+    }
+
+    SDL_recording.dst = dst;
+    SDL_recording.start = SDL_GetPerformanceNS();
+    SDL_recording.failed = SDL_FALSE;
+    SDL_UnlockEventRecording();
+    SDL_AddEventWatch(SDL_RecordEvent, NULL);
+
+    return 0;
+}
+
+int
+SDL_StopEventRecording(void)
+{
+    SDL_bool failed;
+
+    /* Wait for anyone still writing an event; a watch that is already
+       running sees no stream and writes nothing */
+    if (SDL_recording.lock) {
+        SDL_LockMutex(SDL_recording.lock);
+    }
+    if (!SDL_recording.dst) {
+        SDL_UnlockEventRecording();
+        return 0;
+    }
+    failed = SDL_recording.failed;
+    SDL_recording.dst = NULL;
+    SDL_UnlockEventRecording();
+
+    SDL_DelEventWatch(SDL_RecordEvent, NULL);
+
+    if (failed) {
+        SDL_SetError("Couldn't write every event to the recording");
+        return -1;
+    }
+    return 0;
+}
+
+/* Stop recording and free the lock -- called when the event loop stops */
+void
+SDL_QuitEventRecording(void)
+{
+    SDL_StopEventRecording();
+    if (SDL_recording.lock) {
+        SDL_DestroyMutex(SDL_recording.lock);
+        SDL_recording.lock = NULL;
+    }
+}
+
+/* Sleep until the performance counter reaches (when) nanoseconds */
+static void
+SDL_WaitUntilNS(Uint64 when)
+{
+    Uint64 now;
+
+    while ((now = SDL_GetPerformanceNS()) < when) {
+        if (when - now > 2000000) {
+            SDL_Delay((Uint32) ((when - now) / 1000000) - 1);
+        }
+        /* and spin through the last millisecond or so */
+    }
+}
+
+/* Wait for room in the queue, or give up if nobody seems to be reading it */
+static SDL_bool
+SDL_WaitForQueueRoom(void)
+{
+    const Uint32 start = SDL_GetTicks();
+
+    while (!SDL_EventQueueHasRoom()) {
+        if ((SDL_GetTicks() - start) >= EVENT_REPLAY_FULL_TIMEOUT) {
+            return SDL_FALSE;
+        }
+        SDL_Delay(0);
+    }
+    return SDL_TRUE;
+}
+
+int
+SDL_ReplayEvents(SDL_RWops * src, SDL_bool realtime)
+{
+    char magic[8];
+    SDL_Event event;
+    Uint64 start, when;
+    Uint64 *timestamp_ns;
+    Uint16 size;
+    Uint32 length;
+    char *file;
+    int pushed = 0;
+
+    if (!src) {
+        SDL_InvalidParamError("src");
+        return -1;
+    }
+    if (SDL_RWread(src, magic, sizeof(magic), 1) != 1 ||
+        SDL_memcmp(magic, EVENT_RECORDING_MAGIC, sizeof(magic)) != 0) {
+        SDL_SetError("Not an event recording");
+        return -1;
+    }
+    if (SDL_ReadLE16(src) != EVENT_RECORDING_VERSION ||
+        SDL_ReadLE16(src) != SDL_BYTEORDER ||
+        SDL_ReadLE16(src) != sizeof(SDL_Event)) {
+        SDL_SetError("Event recording is from an incompatible version or machine");
+        return -1;
+    }
+
+    start = SDL_GetPerformanceNS();
+    for (;;) {
+        /* A truncated event ends the recording like the end of the file */
+        if (SDL_RWread(src, &when, sizeof(when), 1) != 1 ||
+            SDL_RWread(src, &size, sizeof(size), 1) != 1) {
+            break;
+        }
+        when = SDL_SwapLE64(when);
+        size = SDL_SwapLE16(size);
+        if (size > sizeof(event)) {
+            SDL_SetError("Corrupt event recording");
+            return -1;
+        }
+        SDL_zero(event);
+        if (SDL_RWread(src, &event, size, 1) != 1) {
+            break;
+        }
+
+        if (event.type == SDL_DROPFILE) {
+            if (SDL_RWread(src, &length, sizeof(length), 1) != 1) {
+                break;
+            }
+            length = SDL_SwapLE32(length);
+            file = (char *) SDL_malloc(length + 1);
+            if (!file) {
+                SDL_OutOfMemory();
+                return -1;
+            }
+            if (length && SDL_RWread(src, file, length, 1) != 1) {
+                SDL_free(file);
+                break;
+            }
+            file[length] = '\0';
+            event.drop.file = file;
+        }
+
+        if (realtime) {
+            SDL_WaitUntilNS(start + when);
+        }
+        /* Don't drop events just because we're faster than the reader,
+           but don't wait forever when this thread is the reader */
+        if (!SDL_WaitForQueueRoom()) {
+            if (event.type == SDL_DROPFILE) {
+                SDL_free(event.drop.file);
+            }
+            SDL_SetError("Event queue stayed full, replay stopped after %d events", pushed);
+            return -1;
+        }
+
+        /* Replayed input arrives now, as far as the application knows */
+        timestamp_ns = SDL_EventTimestampNS(&event);
+        if (timestamp_ns) {
+            *timestamp_ns = SDL_GetPerformanceNS();
+        }
+        if (SDL_PushEvent(&event) == 1) {
+            pushed++;
+        } else if (event.type == SDL_DROPFILE) {
+            SDL_free(event.drop.file);
+        }
+    }
+    return pushed;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
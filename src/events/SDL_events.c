@@ -27,6 +27,7 @@
 #include "SDL_syswm.h"
 #include "SDL_thread.h"
 #include "SDL_events_c.h"
+#include "../SDL_hints_c.h"
 #include "../timer/SDL_timer_c.h"
 #if !SDL_JOYSTICK_DISABLED
 #include "../joystick/SDL_joystick_c.h"
@@ -40,37 +41,173 @@ void *SDL_EventOKParam;
 typedef struct SDL_EventWatcher {
     SDL_EventFilter callback;
     void *userdata;
+    Uint32 minType;
+    Uint32 maxType;
     struct SDL_EventWatcher *next;
 } SDL_EventWatcher;
 
 static SDL_EventWatcher *SDL_event_watchers = NULL;
 
-typedef struct {
-    Uint32 bits[8];
-} SDL_DisabledEventBlock;
-
-static SDL_DisabledEventBlock *SDL_disabled_events[256];
+/* The watchers to call for an event type, newest first, copied so that a
+   list stays valid after its watchers are removed.  Types with the same
+   watchers share a list. */
+typedef struct SDL_EventDispatch {
+    struct SDL_EventDispatch *next;     /* every list of the table */
+    int count;
+    SDL_EventWatcher watchers[1];
+} SDL_EventDispatch;
+
+/* The list for each event type, 256 types a block.  Types nobody watches in
+   particular have no list and call the watchers of every type. */
+typedef struct SDL_EventDispatchTable {
+    SDL_EventDispatch *all;
+    SDL_EventDispatch **types[256];
+    SDL_EventDispatch *lists;               /* owned by this table */
+    struct SDL_EventDispatchTable *next;    /* retired tables */
+} SDL_EventDispatchTable;
+
+/* A published table is never changed.  Adding or removing a watcher builds
+   a new table and swaps it in; the old one is retired, and freed as soon
+   as no SDL_DispatchEvent() call is running, since any call that starts
+   after the swap sees the new table. */
+static struct
+{
+    SDL_EventDispatchTable *table;
+    SDL_EventDispatchTable *retired;
+    SDL_atomic_t dispatching;   /* SDL_DispatchEvent() calls in progress */
+    SDL_SpinLock lock;          /* held to change the watchers */
+} SDL_event_dispatch;
+
+/* One bit for each event type, set while it's disabled */
+static Uint32 SDL_disabled_events[(SDL_LASTEVENT + 1) / 32];
 static Uint32 SDL_userevents = SDL_USEREVENT;
 
-/* Private data -- event queue */
-#define MAXEVENTS	128
+/* SDL_HINT_EVENT_COALESCE_MOTION, kept up to date by a hint callback */
+static SDL_bool SDL_coalesce_motion = SDL_FALSE;
+
+/* Events dropped because the queue was full, allocated on the first drop */
+static SDL_atomic_t *volatile SDL_dropped_events[256];
+
+/* Private data -- event queue
+
+   Events are added without taking the lock: producers claim a slot in the
+   lock-free inbox, so threads pushing events don't contend with the thread
+   reading them.  Anything that reads the queue takes the lock and first
+   moves whatever has arrived in the inbox onto the end of the ordered
+   queue, where events can still be cut from the middle.
+
+   The ordered queue is a list of entries, and each entry is also on a list
+   of the queued events of its type, so reading or flushing a narrow range
+   of types only visits the events of those types, merged back into order
+   by their serial numbers.  Cutting an event just unlinks it.
+
+   The queue holds MAXEVENTS-1 events unless SDL_HINT_EVENT_QUEUE_SIZE
+   says otherwise, and may grow up to SDL_HINT_EVENT_QUEUE_MAX_SIZE.  When
+   more events are waiting than the inbox has room for, producers take the
+   lock and move them to the queue themselves. */
+#define MAXEVENTS	128     /* must be a power of 2 */
+#define INBOX_MASK	(MAXEVENTS-1)
+
+/* The most per-type lists merged when reading a range of types; wider
+   ranges walk the whole queue instead */
+#define MAX_MERGED_TYPES	16
+
+typedef struct SDL_EventEntry
+{
+    SDL_Event event;
+    Uint32 serial;
+    struct SDL_EventTypeList *list;     /* NULL for types past SDL_LASTEVENT */
+    struct SDL_EventEntry *prev;        /* the queue, or the free list */
+    struct SDL_EventEntry *next;
+    struct SDL_EventEntry *type_prev;   /* the queued events of this type */
+    struct SDL_EventEntry *type_next;
+} SDL_EventEntry;
+
+typedef struct SDL_EventTypeList
+{
+    Uint32 type;
+    SDL_EventEntry *head;
+    SDL_EventEntry *tail;
+    struct SDL_EventTypeList *prev;     /* the types with events queued */
+    struct SDL_EventTypeList *next;
+} SDL_EventTypeList;
+
+typedef struct SDL_EventChunk
+{
+    struct SDL_EventChunk *next;
+    SDL_EventEntry entries[1];
+} SDL_EventChunk;
+
+static SDL_EventEntry SDL_default_entries[MAXEVENTS];
+
+/* The per-type lists, allocated the first time a type is queued */
+static SDL_EventTypeList *SDL_event_types[256];
+
+typedef struct
+{
+    /* Counts in steps of MAXEVENTS starting at zero, so the static
+       initialization is an empty inbox: the slot is free for queue
+       position (pos) when this is (pos & ~INBOX_MASK), and holds that
+       position's event when it's one more than that.  It's always set
+       after a release barrier.  The drain reads it before an acquire
+       barrier, and a producer's claiming CAS is a full barrier. */
+    SDL_atomic_t sequence;
+    SDL_Event event;
+    struct SDL_SysWMmsg wmmsg;
+} SDL_EventInboxEntry;
+
 static struct
 {
     SDL_mutex *lock;
-    int active;
-    int head;
-    int tail;
-    SDL_Event event[MAXEVENTS];
+    volatile int active;
+    SDL_EventEntry *head;
+    SDL_EventEntry *tail;
+    SDL_EventEntry *free;
+    SDL_EventTypeList *types;   /* the types with events queued */
+    int untyped;                /* queued events that aren't on a type list */
+    Uint32 serial;              /* of the next event queued */
+    int allocated;              /* entries in the queue and the free list */
+    int max_events;             /* most events the queue may hold */
+    int chunk;                  /* entries added each time it grows */
+    SDL_EventChunk *chunks;     /* entries beyond the default ones */
     int wmmsg_next;
     struct SDL_SysWMmsg wmmsg[MAXEVENTS];
-} SDL_EventQ = { NULL, 1 };
+
+    unsigned dequeue_pos;       /* protected by lock */
+    SDL_atomic_t count;         /* events in the inbox and the queue */
+
+    /* Threads blocked in SDL_WaitEventTimeout(), and what wakes them when
+       the video driver can't wait for events itself */
+    SDL_atomic_t waiters;
+    SDL_sem *wakeup;
+
+    char cache_pad1[SDL_CACHELINE_SIZE];
+
+    SDL_atomic_t enqueue_pos;
+
+    char cache_pad2[SDL_CACHELINE_SIZE-sizeof(SDL_atomic_t)];
+
+    SDL_EventInboxEntry inbox[MAXEVENTS];
+} SDL_EventQ = {
+    NULL, 1, NULL, NULL, NULL, NULL, 0, 0, 0, MAXEVENTS - 1, MAXEVENTS
+};
+
+/* Walks the queued events of a range of types, oldest first */
+typedef struct
+{
+    Uint32 minType;
+    Uint32 maxType;
+    int numlists;               /* -1 walks the whole queue from next[0] */
+    SDL_EventEntry *next[MAX_MERGED_TYPES];
+} SDL_EventCursor;
 
 
 static __inline__ SDL_bool
 SDL_ShouldPollJoystick()
 {
 #if !SDL_JOYSTICK_DISABLED
-    if ((!SDL_disabled_events[SDL_JOYAXISMOTION >> 8] ||
+    /* The joystick events all share a word of the bitmap */
+    if ((!SDL_disabled_events[SDL_JOYAXISMOTION / 32] ||
          SDL_JoystickEventState(SDL_QUERY)) &&
         SDL_PrivateJoystickNeedsPolling()) {
         return SDL_TRUE;
@@ -79,6 +216,311 @@ SDL_ShouldPollJoystick()
     return SDL_FALSE;
 }
 
+/* Add (count) entries to the free list -- called with the queue locked */
+static int
+SDL_GrowEventQueue(int count)
+{
+    SDL_EventEntry *entries;
+    SDL_EventChunk *chunk;
+    int i;
+
+    if (SDL_EventQ.allocated == 0 && count <= MAXEVENTS) {
+        entries = SDL_default_entries;
+        count = MAXEVENTS;
+    } else {
+        chunk = (SDL_EventChunk *) SDL_malloc(sizeof(*chunk) +
+                                    (count - 1) * sizeof(SDL_EventEntry));
+        if (!chunk) {
+            SDL_OutOfMemory();
+            return (-1);
+        }
+        chunk->next = SDL_EventQ.chunks;
+        SDL_EventQ.chunks = chunk;
+        entries = chunk->entries;
+    }
+
+    for (i = 0; i < count; ++i) {
+        entries[i].next = SDL_EventQ.free;
+        SDL_EventQ.free = &entries[i];
+    }
+    SDL_EventQ.allocated += count;
+    return (0);
+}
+
+/* Size the queue from the hints -- called from SDL_StartEventLoop() */
+static void
+SDL_SetEventQueueSize(void)
+{
+    const char *hint;
+    int size = MAXEVENTS - 1;
+    int max_size;
+
+    hint = SDL_GetHint(SDL_HINT_EVENT_QUEUE_SIZE);
+    if (hint && SDL_atoi(hint) > 0) {
+        size = SDL_atoi(hint);
+    }
+    max_size = size;
+    hint = SDL_GetHint(SDL_HINT_EVENT_QUEUE_MAX_SIZE);
+    if (hint && SDL_atoi(hint) > size) {
+        max_size = SDL_atoi(hint);
+    }
+
+    if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
+        /* Any events we got at launch stay queued */
+        if (SDL_EventQ.allocated < size) {
+            SDL_GrowEventQueue(size - SDL_EventQ.allocated);
+        }
+        SDL_EventQ.chunk = SDL_max(SDL_EventQ.allocated, 1);
+        SDL_EventQ.max_events = max_size;
+        SDL_UnlockMutex(SDL_EventQ.lock);
+    }
+}
+
+static void
+SDL_CoalesceMotionChanged(const char *name, const char *oldValue, const char *newValue)
+{
+    SDL_coalesce_motion = (newValue && *newValue != '0') ? SDL_TRUE : SDL_FALSE;
+}
+
+static void
+SDL_CountDroppedEvent(Uint32 type)
+{
+    Uint8 hi = ((type >> 8) & 0xff);
+    Uint8 lo = (type & 0xff);
+    SDL_atomic_t *block = SDL_dropped_events[hi];
+
+    if (!block) {
+        block = (SDL_atomic_t *) SDL_calloc(256, sizeof(*block));
+        if (!block) {
+            /* Out of memory, nothing we can do... */
+            return;
+        }
+        if (!SDL_AtomicCASPtr((void **) &SDL_dropped_events[hi], NULL, block)) {
+            /* Another thread got there first */
+            SDL_free(block);
+            block = SDL_dropped_events[hi];
+        }
+    }
+    SDL_AtomicAdd(&block[lo], 1);
+}
+
+/* Free a dispatch table and its lists */
+static void
+SDL_FreeEventDispatchTable(SDL_EventDispatchTable * table)
+{
+    int i;
+
+    for (i = 0; i < SDL_arraysize(table->types); ++i) {
+        if (table->types[i]) {
+            SDL_free(table->types[i]);
+        }
+    }
+    while (table->lists) {
+        SDL_EventDispatch *tmp = table->lists;
+        table->lists = tmp->next;
+        SDL_free(tmp);
+    }
+    SDL_free(table);
+}
+
+/* Free the retired tables if nobody can be calling them any more.
+   Call with SDL_event_dispatch.lock held. */
+static void
+SDL_ReclaimEventDispatch(void)
+{
+    if (SDL_AtomicGet(&SDL_event_dispatch.dispatching) != 0) {
+        return;
+    }
+    while (SDL_event_dispatch.retired) {
+        SDL_EventDispatchTable *tmp = SDL_event_dispatch.retired;
+        SDL_event_dispatch.retired = tmp->next;
+        SDL_FreeEventDispatchTable(tmp);
+    }
+}
+
+/* Throw away every dispatch table, once the event loop is stopped */
+static void
+SDL_FreeEventDispatch(void)
+{
+    if (SDL_event_dispatch.table) {
+        SDL_FreeEventDispatchTable(SDL_event_dispatch.table);
+        SDL_event_dispatch.table = NULL;
+    }
+    SDL_ReclaimEventDispatch();
+}
+
+/* A new list in (table) with (watcher) followed by the watchers of (list) */
+static SDL_EventDispatch *
+SDL_PrependEventDispatch(SDL_EventDispatchTable * table,
+                         SDL_EventDispatch * list,
+                         const SDL_EventWatcher * watcher)
+{
+    SDL_EventDispatch *newlist;
+    const int count = list ? list->count : 0;
+
+    newlist = (SDL_EventDispatch *)
+        SDL_malloc(sizeof(*newlist) + count * sizeof(newlist->watchers[0]));
+    if (!newlist) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    newlist->watchers[0] = *watcher;
+    if (count) {
+        SDL_memcpy(&newlist->watchers[1], list->watchers,
+                   count * sizeof(newlist->watchers[0]));
+    }
+    newlist->count = count + 1;
+    newlist->next = table->lists;
+    table->lists = newlist;
+    return newlist;
+}
+
+/* Put (watcher) in front of the lists of the event types it watches, in
+   a table that isn't published yet */
+static int
+SDL_AddEventDispatch(SDL_EventDispatchTable * table,
+                     const SDL_EventWatcher * watcher)
+{
+    SDL_EventDispatch **block;
+    SDL_EventDispatch *list, *prev = NULL, *newlist = NULL;
+    Uint32 type;
+    int i, j;
+
+    if (watcher->minType == SDL_FIRSTEVENT &&
+        watcher->maxType == SDL_LASTEVENT) {
+        /* Types with lists of their own need it too */
+        for (i = 0; i < SDL_arraysize(table->types); ++i) {
+            block = table->types[i];
+            for (j = 0; block && j < 256; ++j) {
+                list = block[j];
+                if (list && list != prev) {
+                    newlist = SDL_PrependEventDispatch(table, list, watcher);
+                    if (!newlist) {
+                        return -1;
+                    }
+                    prev = list;
+                }
+                if (list) {
+                    block[j] = newlist;
+                }
+            }
+        }
+        newlist = SDL_PrependEventDispatch(table, table->all, watcher);
+        if (!newlist) {
+            return -1;
+        }
+        table->all = newlist;
+        return 0;
+    }
+
+    for (type = watcher->minType; type <= watcher->maxType; ++type) {
+        block = table->types[type >> 8];
+        if (!block) {
+            block = (SDL_EventDispatch **) SDL_calloc(256, sizeof(*block));
+            if (!block) {
+                SDL_OutOfMemory();
+                return -1;
+            }
+            table->types[type >> 8] = block;
+        }
+        /* A type's own list starts with the watchers of every type */
+        list = block[type & 0xff];
+        if (!list) {
+            list = table->all;
+        }
+        /* Neighbouring types with the same list share the new one too */
+        if (!newlist || list != prev) {
+            newlist = SDL_PrependEventDispatch(table, list, watcher);
+            if (!newlist) {
+                return -1;
+            }
+            prev = list;
+        }
+        block[type & 0xff] = newlist;
+    }
+    return 0;
+}
+
+/* Add (watcher) and the older watchers after it to (table), oldest first */
+static int
+SDL_RebuildEventDispatch(SDL_EventDispatchTable * table,
+                         const SDL_EventWatcher * watcher)
+{
+    if (!watcher) {
+        return 0;
+    }
+    if (SDL_RebuildEventDispatch(table, watcher->next) < 0) {
+        return -1;
+    }
+    return SDL_AddEventDispatch(table, watcher);
+}
+
+/* Swap in a table for the current watchers and retire the old one.
+   Call with SDL_event_dispatch.lock held. */
+static void
+SDL_UpdateEventDispatch(void)
+{
+    SDL_EventDispatchTable *table = NULL;
+    SDL_EventDispatchTable *old = SDL_event_dispatch.table;
+
+    if (SDL_event_watchers) {
+        /* If this runs out of memory, some types won't call their
+           watchers, but a removed watcher is never called again */
+        table = (SDL_EventDispatchTable *) SDL_calloc(1, sizeof(*table));
+        if (table) {
+            SDL_RebuildEventDispatch(table, SDL_event_watchers);
+        }
+    }
+
+    /* The CAS is a full barrier: the table is complete before it's seen,
+       and the dispatch count is read after the old table is unreachable */
+    SDL_AtomicCASPtr((void **) &SDL_event_dispatch.table, old, table);
+    if (old) {
+        old->next = SDL_event_dispatch.retired;
+        SDL_event_dispatch.retired = old;
+    }
+    SDL_ReclaimEventDispatch();
+}
+
+/* Call the watchers of (event)'s type */
+static void
+SDL_DispatchEvent(SDL_Event * event)
+{
+    SDL_EventDispatchTable *table;
+    SDL_EventDispatch **block;
+    SDL_EventDispatch *list;
+    int i;
+
+    if (!SDL_event_dispatch.table) {
+        return;     /* nobody is watching */
+    }
+
+    SDL_AtomicIncRef(&SDL_event_dispatch.dispatching);
+    table = (SDL_EventDispatchTable *)
+        SDL_AtomicGetPtr((void **) &SDL_event_dispatch.table);
+    if (table) {
+        list = table->all;
+        if (event->type <= SDL_LASTEVENT) {
+            block = table->types[event->type >> 8];
+            if (block && block[event->type & 0xff]) {
+                list = block[event->type & 0xff];
+            }
+        }
+        if (list) {
+            for (i = 0; i < list->count; ++i) {
+                list->watchers[i].callback(list->watchers[i].userdata, event);
+            }
+        }
+    }
+    if (SDL_AtomicDecRef(&SDL_event_dispatch.dispatching) &&
+        SDL_event_dispatch.retired) {
+        /* The last one out frees the tables retired meanwhile */
+        SDL_AtomicLock(&SDL_event_dispatch.lock);
+        SDL_ReclaimEventDispatch();
+        SDL_AtomicUnlock(&SDL_event_dispatch.lock);
+    }
+}
+
 /* Public functions */
 
 void
@@ -86,26 +528,59 @@ SDL_StopEventLoop(void)
 {
     int i;
 
+    SDL_QuitEventRecording();
     SDL_EventQ.active = 0;
 
     if (SDL_EventQ.lock) {
         SDL_DestroyMutex(SDL_EventQ.lock);
         SDL_EventQ.lock = NULL;
     }
+    if (SDL_EventQ.wakeup) {
+        SDL_DestroySemaphore(SDL_EventQ.wakeup);
+        SDL_EventQ.wakeup = NULL;
+    }
 
     /* Clean out EventQ */
-    SDL_EventQ.head = 0;
-    SDL_EventQ.tail = 0;
+    SDL_EventQ.head = NULL;
+    SDL_EventQ.tail = NULL;
+    SDL_EventQ.free = NULL;
+    SDL_EventQ.types = NULL;
+    SDL_EventQ.untyped = 0;
+    SDL_EventQ.serial = 0;
     SDL_EventQ.wmmsg_next = 0;
+    for (i = 0; i < MAXEVENTS; ++i) {
+        SDL_AtomicSet(&SDL_EventQ.inbox[i].sequence, 0);
+    }
+    SDL_AtomicSet(&SDL_EventQ.enqueue_pos, 0);
+    SDL_EventQ.dequeue_pos = 0;
+    SDL_AtomicSet(&SDL_EventQ.count, 0);
+    while (SDL_EventQ.chunks) {
+        SDL_EventChunk *tmp = SDL_EventQ.chunks;
+        SDL_EventQ.chunks = tmp->next;
+        SDL_free(tmp);
+    }
+    SDL_EventQ.allocated = 0;
+    SDL_EventQ.max_events = MAXEVENTS - 1;
+    SDL_EventQ.chunk = MAXEVENTS;
+    for (i = 0; i < SDL_arraysize(SDL_event_types); ++i) {
+        if (SDL_event_types[i]) {
+            SDL_free(SDL_event_types[i]);
+            SDL_event_types[i] = NULL;
+        }
+    }
 
-    /* Clear disabled event state */
-    for (i = 0; i < SDL_arraysize(SDL_disabled_events); ++i) {
-        if (SDL_disabled_events[i]) {
-            SDL_free(SDL_disabled_events[i]);
-            SDL_disabled_events[i] = NULL;
+    /* Clear the dropped event counts */
+    for (i = 0; i < SDL_arraysize(SDL_dropped_events); ++i) {
+        if (SDL_dropped_events[i]) {
+            SDL_free(SDL_dropped_events[i]);
+            SDL_dropped_events[i] = NULL;
         }
     }
 
+    /* Clear disabled event state */
+    SDL_memset(SDL_disabled_events, 0, sizeof(SDL_disabled_events));
+
+    SDL_FreeEventDispatch();
     while (SDL_event_watchers) {
         SDL_EventWatcher *tmp = SDL_event_watchers;
         SDL_event_watchers = tmp->next;
@@ -137,66 +612,355 @@ SDL_StartEventLoop(void)
     if (SDL_EventQ.lock == NULL) {
         return (-1);
     }
+    if (!SDL_EventQ.wakeup) {
+        SDL_EventQ.wakeup = SDL_CreateSemaphore(0);
+    }
+    if (SDL_EventQ.wakeup == NULL) {
+        return (-1);
+    }
 #endif /* !SDL_THREADS_DISABLED */
+    SDL_SetEventQueueSize();
+    SDL_RegisterHintChangedCb(SDL_HINT_EVENT_COALESCE_MOTION,
+                              SDL_CoalesceMotionChanged);
+    SDL_CoalesceMotionChanged(SDL_HINT_EVENT_COALESCE_MOTION, NULL,
+                              SDL_GetHint(SDL_HINT_EVENT_COALESCE_MOTION));
     SDL_EventQ.active = 1;
 
     return (0);
 }
 
 
-/* Add an event to the event queue -- called with the queue locked */
+static void SDL_DrainEventInbox(void);
+
+/* Add an event to the inbox -- safe from any thread, without the lock */
 static int
 SDL_AddEvent(SDL_Event * event)
 {
-    int tail, added;
-
-    tail = (SDL_EventQ.tail + 1) % MAXEVENTS;
-    if (tail == SDL_EventQ.head) {
+    SDL_EventInboxEntry *entry;
+    unsigned queue_pos;
+    unsigned entry_seq;
+    int delta;
+    int drained = 0;
+
+    /* Reserve room first, so the inbox and the queue together never hold
+       more than the queue may */
+    if (SDL_AtomicAdd(&SDL_EventQ.count, 1) >= SDL_EventQ.max_events) {
         /* Overflow, drop event */
-        added = 0;
-    } else {
-        SDL_EventQ.event[SDL_EventQ.tail] = *event;
-        if (event->type == SDL_SYSWMEVENT) {
+        SDL_AtomicAdd(&SDL_EventQ.count, -1);
+        SDL_CountDroppedEvent(event->type);
+        return (0);
+    }
+
+    queue_pos = (unsigned)SDL_AtomicGet(&SDL_EventQ.enqueue_pos);
+    for ( ; ; ) {
+        entry = &SDL_EventQ.inbox[queue_pos & INBOX_MASK];
+        entry_seq = (unsigned)SDL_AtomicGet(&entry->sequence);
+
+        delta = (int)(entry_seq - (queue_pos & ~INBOX_MASK));
+        if (delta == 0) {
+            /* The entry is free for this position, try to claim it */
+            if (SDL_AtomicCAS(&SDL_EventQ.enqueue_pos, (int)queue_pos, (int)(queue_pos+1))) {
+                entry->event = *event;
+                if (event->type == SDL_SYSWMEVENT) {
+                    entry->wmmsg = *event->syswm.msg;
+                }
+                /* The event has to be in place before the slot says so */
+                SDL_MemoryBarrierRelease();
+                SDL_AtomicSet(&entry->sequence, (int)((queue_pos & ~INBOX_MASK) + 1));
+                return (1);
+            }
+        } else if (delta < 0) {
+            /* The inbox is full of events that haven't been moved to the
+               queue yet, which only happens if the queue may hold more
+               than the inbox.  Move them ourselves and try again. */
+            if (!drained &&
+                (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0)) {
+                SDL_DrainEventInbox();
+                SDL_UnlockMutex(SDL_EventQ.lock);
+                drained = 1;
+                queue_pos = (unsigned)SDL_AtomicGet(&SDL_EventQ.enqueue_pos);
+                continue;
+            }
+            SDL_AtomicAdd(&SDL_EventQ.count, -1);
+            SDL_CountDroppedEvent(event->type);
+            return (0);
+        } else {
+            /* Someone else claimed it, get the new queue position */
+            queue_pos = (unsigned)SDL_AtomicGet(&SDL_EventQ.enqueue_pos);
+        }
+    }
+    /* NOTREACHED */
+}
+
+/* Find the list for events of (type), or NULL if it has none
+                             -- called with the queue locked */
+static SDL_EventTypeList *
+SDL_GetEventTypeList(Uint32 type)
+{
+    Uint8 hi = ((type >> 8) & 0xff);
+    int i;
+
+    if (type > SDL_LASTEVENT) {
+        return NULL;
+    }
+    if (!SDL_event_types[hi]) {
+        SDL_event_types[hi] = (SDL_EventTypeList *)
+            SDL_calloc(256, sizeof(SDL_EventTypeList));
+        if (!SDL_event_types[hi]) {
+            return NULL;
+        }
+        for (i = 0; i < 256; ++i) {
+            SDL_event_types[hi][i].type = (hi << 8) | i;
+        }
+    }
+    return &SDL_event_types[hi][type & 0xff];
+}
+
+/* Move the events that have arrived in the inbox onto the end of the queue
+                             -- called with the queue locked */
+static void
+SDL_DrainEventInbox(void)
+{
+    SDL_EventInboxEntry *inbox;
+    SDL_EventEntry *entry;
+    SDL_EventTypeList *list;
+    unsigned queue_pos;
+    int count;
+
+    for ( ; ; ) {
+        queue_pos = SDL_EventQ.dequeue_pos;
+        inbox = &SDL_EventQ.inbox[queue_pos & INBOX_MASK];
+        if ((unsigned)SDL_AtomicGet(&inbox->sequence) != (queue_pos & ~INBOX_MASK) + 1) {
+            /* Empty, or the next event is still being written */
+            break;
+        }
+        SDL_MemoryBarrierAcquire();
+
+        if (!SDL_EventQ.free) {
+            /* The queue is full; grow it by another chunk.  The reservation
+               in SDL_AddEvent() means it's allowed to. */
+            count = SDL_min(SDL_EventQ.chunk,
+                            SDL_EventQ.max_events - SDL_EventQ.allocated);
+            if (count <= 0 || SDL_GrowEventQueue(count) < 0) {
+                /* Leave the rest in the inbox for now */
+                break;
+            }
+        }
+        entry = SDL_EventQ.free;
+        SDL_EventQ.free = entry->next;
+
+        entry->event = inbox->event;
+        if (inbox->event.type == SDL_SYSWMEVENT) {
             /* Note that it's possible to lose an event */
             int next = SDL_EventQ.wmmsg_next;
-            SDL_EventQ.wmmsg[next] = *event->syswm.msg;
-            SDL_EventQ.event[SDL_EventQ.tail].syswm.msg =
-                &SDL_EventQ.wmmsg[next];
+            SDL_EventQ.wmmsg[next] = inbox->wmmsg;
+            entry->event.syswm.msg = &SDL_EventQ.wmmsg[next];
             SDL_EventQ.wmmsg_next = (next + 1) % MAXEVENTS;
         }
-        SDL_EventQ.tail = tail;
-        added = 1;
+        entry->serial = SDL_EventQ.serial++;
+
+        /* Append it to the queue... */
+        entry->prev = SDL_EventQ.tail;
+        entry->next = NULL;
+        if (SDL_EventQ.tail) {
+            SDL_EventQ.tail->next = entry;
+        } else {
+            SDL_EventQ.head = entry;
+        }
+        SDL_EventQ.tail = entry;
+
+        /* ... and to the events of its type */
+        list = SDL_GetEventTypeList(entry->event.type);
+        entry->list = list;
+        if (!list) {
+            SDL_EventQ.untyped++;
+        } else {
+            entry->type_prev = list->tail;
+            entry->type_next = NULL;
+            if (list->tail) {
+                list->tail->type_next = entry;
+            } else {
+                list->head = entry;
+                list->prev = NULL;
+                list->next = SDL_EventQ.types;
+                if (SDL_EventQ.types) {
+                    SDL_EventQ.types->prev = list;
+                }
+                SDL_EventQ.types = list;
+            }
+            list->tail = entry;
+        }
+
+        /* Done reading the slot before handing it back */
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&inbox->sequence, (int)((queue_pos & ~INBOX_MASK) + MAXEVENTS));
+        SDL_EventQ.dequeue_pos = queue_pos + 1;
     }
-    return (added);
 }
 
-/* Cut an event, and return the next valid spot, or the tail */
-/*                           -- called with the queue locked */
-static int
-SDL_CutEvent(int spot)
-{
-    if (spot == SDL_EventQ.head) {
-        SDL_EventQ.head = (SDL_EventQ.head + 1) % MAXEVENTS;
-        return (SDL_EventQ.head);
-    } else if ((spot + 1) % MAXEVENTS == SDL_EventQ.tail) {
-        SDL_EventQ.tail = spot;
-        return (SDL_EventQ.tail);
-    } else
-        /* We cut the middle -- shift everything over */
-    {
-        int here, next;
+/* Cut an event out of the queue -- called with the queue locked */
+static void
+SDL_CutEvent(SDL_EventEntry * entry)
+{
+    SDL_EventTypeList *list = entry->list;
 
-        /* This can probably be optimized with SDL_memcpy() -- careful! */
-        if (--SDL_EventQ.tail < 0) {
-            SDL_EventQ.tail = MAXEVENTS - 1;
+    SDL_AtomicAdd(&SDL_EventQ.count, -1);
+
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        SDL_EventQ.head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        SDL_EventQ.tail = entry->prev;
+    }
+
+    if (!list) {
+        SDL_EventQ.untyped--;
+    } else {
+        if (entry->type_prev) {
+            entry->type_prev->type_next = entry->type_next;
+        } else {
+            list->head = entry->type_next;
         }
-        for (here = spot; here != SDL_EventQ.tail; here = next) {
-            next = (here + 1) % MAXEVENTS;
-            SDL_EventQ.event[here] = SDL_EventQ.event[next];
+        if (entry->type_next) {
+            entry->type_next->type_prev = entry->type_prev;
+        } else {
+            list->tail = entry->type_prev;
+        }
+        if (!list->head) {
+            /* That was the last one of its type */
+            if (list->prev) {
+                list->prev->next = list->next;
+            } else {
+                SDL_EventQ.types = list->next;
+            }
+            if (list->next) {
+                list->next->prev = list->prev;
+            }
         }
-        return (spot);
     }
-    /* NOTREACHED */
+
+    entry->next = SDL_EventQ.free;
+    SDL_EventQ.free = entry;
+}
+
+/* Start walking the events with types in [minType, maxType]
+                             -- called with the queue locked */
+static void
+SDL_StartEventCursor(SDL_EventCursor * cursor, Uint32 minType, Uint32 maxType)
+{
+    SDL_EventTypeList *list = NULL;
+    SDL_bool skipped = SDL_FALSE;
+
+    cursor->minType = minType;
+    cursor->maxType = maxType;
+    cursor->numlists = 0;
+    if (SDL_EventQ.untyped == 0) {
+        for (list = SDL_EventQ.types; list; list = list->next) {
+            if (list->type < minType || list->type > maxType) {
+                skipped = SDL_TRUE;
+            } else if (cursor->numlists == MAX_MERGED_TYPES) {
+                break;
+            } else {
+                cursor->next[cursor->numlists++] = list->head;
+            }
+        }
+    }
+    if (!skipped || list) {
+        /* Every event matches, or there are too many types to merge */
+        cursor->numlists = -1;
+        cursor->next[0] = SDL_EventQ.head;
+    }
+}
+
+/* Return the next event the cursor matches, or NULL.  The cursor has moved
+   past it, so it may be cut. -- called with the queue locked */
+static SDL_EventEntry *
+SDL_NextEvent(SDL_EventCursor * cursor)
+{
+    SDL_EventEntry *entry;
+    int i, oldest;
+
+    if (cursor->numlists < 0) {
+        while ((entry = cursor->next[0]) != NULL) {
+            cursor->next[0] = entry->next;
+            if (cursor->minType <= entry->event.type &&
+                entry->event.type <= cursor->maxType) {
+                return (entry);
+            }
+        }
+        return (NULL);
+    }
+
+    oldest = -1;
+    for (i = 0; i < cursor->numlists; ++i) {
+        entry = cursor->next[i];
+        if (entry && (oldest < 0 ||
+                      (Sint32) (entry->serial - cursor->next[oldest]->serial) < 0)) {
+            oldest = i;
+        }
+    }
+    if (oldest < 0) {
+        return (NULL);
+    }
+    entry = cursor->next[oldest];
+    cursor->next[oldest] = entry->type_next;
+    return (entry);
+}
+
+/* Wake up any thread blocked in SDL_WaitEventTimeout() */
+static void
+SDL_WakeEventWaiters(void)
+{
+    SDL_VideoDevice *_this;
+
+    /* The waiter counts itself before it checks the queue, so either it
+       sees the event we just added or we see it waiting */
+    if (SDL_AtomicGet(&SDL_EventQ.waiters) > 0) {
+        _this = SDL_GetVideoDevice();
+        if (_this && _this->WaitEventTimeout) {
+            _this->SendWakeupEvent(_this);
+        } else if (SDL_EventQ.wakeup) {
+            SDL_SemPost(SDL_EventQ.wakeup);
+        }
+    }
+}
+
+/* Block until an event may have arrived, or (timeout) milliseconds pass;
+   a negative timeout waits forever */
+static void
+SDL_WaitForEvents(int timeout)
+{
+    SDL_VideoDevice *_this = SDL_GetVideoDevice();
+
+    /* Joysticks that need polling have to be pumped every so often */
+    if (SDL_ShouldPollJoystick() && (timeout < 0 || timeout > 10)) {
+        timeout = 10;
+    }
+
+    SDL_AtomicIncRef(&SDL_EventQ.waiters);
+    if (SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) == 0) {
+        if (_this && _this->WaitEventTimeout) {
+            _this->WaitEventTimeout(_this, timeout);
+        } else {
+            /* The video driver still has to be polled, but events pushed
+               by other threads wake us up right away */
+            if (_this && (timeout < 0 || timeout > 10)) {
+                timeout = 10;
+            }
+            if (!SDL_EventQ.wakeup) {
+                SDL_Delay(timeout < 0 ? 10 : timeout);
+            } else if (timeout < 0) {
+                SDL_SemWait(SDL_EventQ.wakeup);
+            } else {
+                SDL_SemWaitTimeout(SDL_EventQ.wakeup, timeout);
+            }
+        }
+    }
+    SDL_AtomicAdd(&SDL_EventQ.waiters, -1);
 }
 
 /* Lock the event queue, take a peep at it, and unlock it */
@@ -204,42 +968,43 @@ int
 SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
                Uint32 minType, Uint32 maxType)
 {
+    SDL_Event tmpevent;
+    SDL_EventCursor cursor;
+    SDL_EventEntry *entry;
     int i, used;
 
     /* Don't look after we've quit */
     if (!SDL_EventQ.active) {
         return (-1);
     }
-    /* Lock the event queue */
+
+    /* Adding events doesn't need the lock */
     used = 0;
+    if (action == SDL_ADDEVENT) {
+        for (i = 0; i < numevents; ++i) {
+            used += SDL_AddEvent(&events[i]);
+        }
+        if (used > 0) {
+            SDL_WakeEventWaiters();
+        }
+        return (used);
+    }
+
+    /* If 'events' is NULL, just see if they exist */
+    if (events == NULL) {
+        action = SDL_PEEKEVENT;
+        numevents = 1;
+        events = &tmpevent;
+    }
+
+    /* Lock the event queue */
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
-        if (action == SDL_ADDEVENT) {
-            for (i = 0; i < numevents; ++i) {
-                used += SDL_AddEvent(&events[i]);
-            }
-        } else {
-            SDL_Event tmpevent;
-            int spot;
-
-            /* If 'events' is NULL, just see if they exist */
-            if (events == NULL) {
-                action = SDL_PEEKEVENT;
-                numevents = 1;
-                events = &tmpevent;
-            }
-            spot = SDL_EventQ.head;
-            while ((used < numevents) && (spot != SDL_EventQ.tail)) {
-                Uint32 type = SDL_EventQ.event[spot].type;
-                if (minType <= type && type <= maxType) {
-                    events[used++] = SDL_EventQ.event[spot];
-                    if (action == SDL_GETEVENT) {
-                        spot = SDL_CutEvent(spot);
-                    } else {
-                        spot = (spot + 1) % MAXEVENTS;
-                    }
-                } else {
-                    spot = (spot + 1) % MAXEVENTS;
-                }
+        SDL_DrainEventInbox();
+        SDL_StartEventCursor(&cursor, minType, maxType);
+        while ((used < numevents) && (entry = SDL_NextEvent(&cursor))) {
+            events[used++] = entry->event;
+            if (action == SDL_GETEVENT) {
+                SDL_CutEvent(entry);
             }
         }
         SDL_UnlockMutex(SDL_EventQ.lock);
@@ -250,6 +1015,13 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
     return (used);
 }
 
+/* Whether the queue could take another event right now */
+SDL_bool
+SDL_EventQueueHasRoom(void)
+{
+    return (SDL_AtomicGet(&SDL_EventQ.count) < SDL_EventQ.max_events);
+}
+
 SDL_bool
 SDL_HasEvent(Uint32 type)
 {
@@ -286,14 +1058,13 @@ SDL_FlushEvents(Uint32 minType, Uint32 maxType)
 
     /* Lock the event queue */
     if (SDL_LockMutex(SDL_EventQ.lock) == 0) {
-        int spot = SDL_EventQ.head;
-        while (spot != SDL_EventQ.tail) {
-            Uint32 type = SDL_EventQ.event[spot].type;
-            if (minType <= type && type <= maxType) {
-                spot = SDL_CutEvent(spot);
-            } else {
-                spot = (spot + 1) % MAXEVENTS;
-            }
+        SDL_EventCursor cursor;
+        SDL_EventEntry *entry;
+
+        SDL_DrainEventInbox();
+        SDL_StartEventCursor(&cursor, minType, maxType);
+        while ((entry = SDL_NextEvent(&cursor)) != NULL) {
+            SDL_CutEvent(entry);
         }
         SDL_UnlockMutex(SDL_EventQ.lock);
     }
@@ -355,27 +1126,89 @@ SDL_WaitEventTimeout(SDL_Event * event, int timeout)
                 /* Timeout expired and no events */
                 return 0;
             }
-            SDL_Delay(10);
+            SDL_WaitForEvents(timeout < 0 ? -1 :
+                              SDL_max((int) (expiration - SDL_GetTicks()), 0));
             break;
         }
     }
 }
 
-int
-SDL_PushEvent(SDL_Event * event)
+/* Merge (event) into (queued) if both are motion from the same mouse or
+   finger, returning whether it did */
+static SDL_bool
+SDL_MergeMotionEvent(SDL_Event * queued, const SDL_Event * event)
+{
+    if (event->type == SDL_MOUSEMOTION) {
+        if (queued->motion.windowID != event->motion.windowID ||
+            queued->motion.which != event->motion.which ||
+            queued->motion.state != event->motion.state) {
+            return SDL_FALSE;
+        }
+        queued->motion.x = event->motion.x;
+        queued->motion.y = event->motion.y;
+        queued->motion.xrel += event->motion.xrel;
+        queued->motion.yrel += event->motion.yrel;
+        queued->motion.coalesced += event->motion.coalesced + 1;
+        queued->motion.timestamp_ns = event->motion.timestamp_ns;
+    } else {
+        if (queued->tfinger.touchId != event->tfinger.touchId ||
+            queued->tfinger.fingerId != event->tfinger.fingerId) {
+            return SDL_FALSE;
+        }
+        queued->tfinger.x = event->tfinger.x;
+        queued->tfinger.y = event->tfinger.y;
+        queued->tfinger.dx += event->tfinger.dx;
+        queued->tfinger.dy += event->tfinger.dy;
+        queued->tfinger.pressure = event->tfinger.pressure;
+        queued->tfinger.coalesced += event->tfinger.coalesced + 1;
+        queued->tfinger.timestamp_ns = event->tfinger.timestamp_ns;
+    }
+    queued->generic.timestamp = event->generic.timestamp;
+    return SDL_TRUE;
+}
+
+/* Merge (event) into motion from the same source at the end of the queue,
+   returning whether it did */
+static SDL_bool
+SDL_CoalesceEvent(SDL_Event * event)
+{
+    SDL_EventEntry *entry;
+    SDL_bool merged = SDL_FALSE;
+
+    if (!SDL_EventQ.active) {
+        return SDL_FALSE;
+    }
+    if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
+        SDL_DrainEventInbox();
+        /* Only look back over the trailing run of motion events, so the
+           merged motion doesn't move past anything else, like a button
+           press.  Each mouse or finger has at most one event in the run. */
+        for (entry = SDL_EventQ.tail;
+             entry && entry->event.type == event->type; entry = entry->prev) {
+            if (SDL_MergeMotionEvent(&entry->event, event)) {
+                merged = SDL_TRUE;
+                break;
+            }
+        }
+        SDL_UnlockMutex(SDL_EventQ.lock);
+    }
+    return merged;
+}
+
+static int
+SDL_PrivatePushEvent(SDL_Event * event, SDL_bool coalesce)
 {
-    SDL_EventWatcher *curr;
     event->generic.timestamp = SDL_GetTicks();
     if (SDL_EventOK && !SDL_EventOK(SDL_EventOKParam, event)) {
         return 0;
     }
 
-    for (curr = SDL_event_watchers; curr; curr = curr->next) {
-        curr->callback(curr->userdata, event);
-    }
+    SDL_DispatchEvent(event);
 
-    if (SDL_PeepEvents(event, 1, SDL_ADDEVENT, 0, 0) <= 0) {
-        return -1;
+    if (!coalesce || !SDL_CoalesceEvent(event)) {
+        if (SDL_PeepEvents(event, 1, SDL_ADDEVENT, 0, 0) <= 0) {
+            return -1;
+        }
     }
 
     SDL_GestureProcessEvent(event);
@@ -383,6 +1216,20 @@ SDL_PushEvent(SDL_Event * event)
     return 1;
 }
 
+int
+SDL_PushEvent(SDL_Event * event)
+{
+    return SDL_PrivatePushEvent(event, SDL_FALSE);
+}
+
+/* Push an SDL_MOUSEMOTION or SDL_FINGERMOTION event, merging it with the
+   queued motion when SDL_HINT_EVENT_COALESCE_MOTION is set */
+int
+SDL_PushMotionEvent(SDL_Event * event)
+{
+    return SDL_PrivatePushEvent(event, SDL_coalesce_motion);
+}
+
 void
 SDL_SetEventFilter(SDL_EventFilter filter, void *userdata)
 {
@@ -406,12 +1253,25 @@ SDL_GetEventFilter(SDL_EventFilter * filter, void **userdata)
     return SDL_EventOK ? SDL_TRUE : SDL_FALSE;
 }
 
-/* FIXME: This is not thread-safe yet */
 void
 SDL_AddEventWatch(SDL_EventFilter filter, void *userdata)
+{
+    SDL_AddEventWatchRange(filter, userdata, SDL_FIRSTEVENT, SDL_LASTEVENT);
+}
+
+void
+SDL_AddEventWatchRange(SDL_EventFilter filter, void *userdata,
+                       Uint32 minType, Uint32 maxType)
 {
     SDL_EventWatcher *watcher;
 
+    if (maxType > SDL_LASTEVENT) {
+        maxType = SDL_LASTEVENT;
+    }
+    if (minType > maxType) {
+        return;
+    }
+
     watcher = (SDL_EventWatcher *)SDL_malloc(sizeof(*watcher));
     if (!watcher) {
         /* Uh oh... */
@@ -419,17 +1279,23 @@ SDL_AddEventWatch(SDL_EventFilter filter, void *userdata)
     }
     watcher->callback = filter;
     watcher->userdata = userdata;
+    watcher->minType = minType;
+    watcher->maxType = maxType;
+
+    SDL_AtomicLock(&SDL_event_dispatch.lock);
     watcher->next = SDL_event_watchers;
     SDL_event_watchers = watcher;
+    SDL_UpdateEventDispatch();
+    SDL_AtomicUnlock(&SDL_event_dispatch.lock);
 }
 
-/* FIXME: This is not thread-safe yet */
 void
 SDL_DelEventWatch(SDL_EventFilter filter, void *userdata)
 {
     SDL_EventWatcher *prev = NULL;
     SDL_EventWatcher *curr;
 
+    SDL_AtomicLock(&SDL_event_dispatch.lock);
     for (curr = SDL_event_watchers; curr; prev = curr, curr = curr->next) {
         if (curr->callback == filter && curr->userdata == userdata) {
             if (prev) {
@@ -438,23 +1304,24 @@ SDL_DelEventWatch(SDL_EventFilter filter, void *userdata)
                 SDL_event_watchers = curr->next;
             }
             SDL_free(curr);
+            SDL_UpdateEventDispatch();
             break;
         }
     }
+    SDL_AtomicUnlock(&SDL_event_dispatch.lock);
 }
 
 void
 SDL_FilterEvents(SDL_EventFilter filter, void *userdata)
 {
     if (SDL_LockMutex(SDL_EventQ.lock) == 0) {
-        int spot;
+        SDL_EventEntry *entry, *next;
 
-        spot = SDL_EventQ.head;
-        while (spot != SDL_EventQ.tail) {
-            if (filter(userdata, &SDL_EventQ.event[spot])) {
-                spot = (spot + 1) % MAXEVENTS;
-            } else {
-                spot = SDL_CutEvent(spot);
+        SDL_DrainEventInbox();
+        for (entry = SDL_EventQ.head; entry; entry = next) {
+            next = entry->next;
+            if (!filter(userdata, &entry->event)) {
+                SDL_CutEvent(entry);
             }
         }
     }
@@ -465,11 +1332,10 @@ Uint8
 SDL_EventState(Uint32 type, int state)
 {
     Uint8 current_state;
-    Uint8 hi = ((type >> 8) & 0xff);
-    Uint8 lo = (type & 0xff);
+    Uint32 *bits = &SDL_disabled_events[(type & 0xffff) / 32];
+    const Uint32 bit = ((Uint32) 1 << (type & 31));
 
-    if (SDL_disabled_events[hi] &&
-        (SDL_disabled_events[hi]->bits[lo/32] & (1 << (lo&31)))) {
+    if (*bits & bit) {
         current_state = SDL_DISABLE;
     } else {
         current_state = SDL_ENABLE;
@@ -480,18 +1346,11 @@ SDL_EventState(Uint32 type, int state)
         switch (state) {
         case SDL_DISABLE:
             /* Disable this event type and discard pending events */
-            if (!SDL_disabled_events[hi]) {
-                SDL_disabled_events[hi] = (SDL_DisabledEventBlock*) SDL_calloc(1, sizeof(SDL_DisabledEventBlock));
-                if (!SDL_disabled_events[hi]) {
-                    /* Out of memory, nothing we can do... */
-                    break;
-                }
-            }
-            SDL_disabled_events[hi]->bits[lo/32] |= (1 << (lo&31));
+            *bits |= bit;
             SDL_FlushEvent(type);
             break;
         case SDL_ENABLE:
-            SDL_disabled_events[hi]->bits[lo/32] &= ~(1 << (lo&31));
+            *bits &= ~bit;
             break;
         default:
             /* Querying state... */
@@ -502,6 +1361,27 @@ SDL_EventState(Uint32 type, int state)
     return current_state;
 }
 
+Uint32
+SDL_GetDroppedEvents(Uint32 minType, Uint32 maxType)
+{
+    Uint32 type, dropped = 0;
+    SDL_atomic_t *block;
+
+    if (maxType > SDL_LASTEVENT) {
+        maxType = SDL_LASTEVENT;
+    }
+    for (type = minType; type <= maxType; ++type) {
+        block = SDL_dropped_events[(type >> 8) & 0xff];
+        if (!block) {
+            /* Nothing of this range was dropped, skip to the next one */
+            type |= 0xff;
+            continue;
+        }
+        dropped += (Uint32) SDL_AtomicGet(&block[type & 0xff]);
+    }
+    return dropped;
+}
+
 Uint32
 SDL_RegisterEvents(int numevents)
 {
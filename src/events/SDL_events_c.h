@@ -37,6 +37,9 @@ extern void SDL_StopEventLoop(void);
 extern void SDL_QuitInterrupt(void);
 
 extern int SDL_SendSysWMEvent(SDL_SysWMmsg * message);
+extern int SDL_PushMotionEvent(SDL_Event * event);
+extern SDL_bool SDL_EventQueueHasRoom(void);
+extern void SDL_QuitEventRecording(void);
 
 extern int SDL_QuitInit(void);
 extern int SDL_SendQuit(void);
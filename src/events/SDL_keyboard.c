@@ -26,6 +26,7 @@
 #include "SDL_events.h"
 #include "SDL_events_c.h"
 #include "../video/SDL_sysvideo.h"
+#include "../timer/SDL_timer_c.h"
 
 
 /*#define DEBUG_KEYBOARD*/
@@ -776,6 +777,7 @@ SDL_SendKeyboardKey(Uint8 state, SDL_Scancode scancode)
         event.key.keysym.mod = modstate;
         event.key.keysym.unicode = 0;
         event.key.windowID = keyboard->focus ? keyboard->focus->id : 0;
+        event.key.timestamp_ns = SDL_GetPerformanceNS();
         posted = (SDL_PushEvent(&event) > 0);
     }
     return (posted);
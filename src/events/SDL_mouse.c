@@ -27,6 +27,7 @@
 #include "SDL_events_c.h"
 #include "default_cursor.h"
 #include "../video/SDL_sysvideo.h"
+#include "../timer/SDL_timer_c.h"
 
 /*#define DEBUG_MOUSE*/
 
@@ -258,7 +259,9 @@ SDL_SendMouseMotion(SDL_Window * window, SDL_MouseID mouseID, int relative, int
         event.motion.y = mouse->y;
         event.motion.xrel = xrel;
         event.motion.yrel = yrel;
-        posted = (SDL_PushEvent(&event) > 0);
+        event.motion.coalesced = 0;
+        event.motion.timestamp_ns = SDL_GetPerformanceNS();
+        posted = (SDL_PushMotionEvent(&event) > 0);
     }
     /* Use unclamped values if we're getting events outside the window */
     mouse->last_x = x;
@@ -311,6 +314,7 @@ SDL_SendMouseButton(SDL_Window * window, SDL_MouseID mouseID, Uint8 state, Uint8
         event.button.button = button;
         event.button.x = mouse->x;
         event.button.y = mouse->y;
+        event.button.timestamp_ns = SDL_GetPerformanceNS();
         posted = (SDL_PushEvent(&event) > 0);
     }
 
@@ -345,6 +349,7 @@ SDL_SendMouseWheel(SDL_Window * window, SDL_MouseID mouseID, int x, int y)
         event.wheel.which = mouseID;
         event.wheel.x = x;
         event.wheel.y = y;
+        event.wheel.timestamp_ns = SDL_GetPerformanceNS();
         posted = (SDL_PushEvent(&event) > 0);
     }
     return posted;
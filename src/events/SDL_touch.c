@@ -25,6 +25,7 @@
 #include "SDL_assert.h"
 #include "SDL_events.h"
 #include "SDL_events_c.h"
+#include "../timer/SDL_timer_c.h"
 
 
 static int SDL_num_touch = 0;
@@ -247,6 +248,8 @@ SDL_SendTouch(SDL_TouchID id, SDL_FingerID fingerid,
             event.tfinger.dx = 0;
             event.tfinger.dy = 0;
             event.tfinger.pressure = pressure;
+            event.tfinger.coalesced = 0;
+            event.tfinger.timestamp_ns = SDL_GetPerformanceNS();
             posted = (SDL_PushEvent(&event) > 0);
         }
     } else {
@@ -267,6 +270,8 @@ SDL_SendTouch(SDL_TouchID id, SDL_FingerID fingerid,
             event.tfinger.dx = 0;
             event.tfinger.dy = 0;
             event.tfinger.pressure = pressure;
+            event.tfinger.coalesced = 0;
+            event.tfinger.timestamp_ns = SDL_GetPerformanceNS();
             posted = (SDL_PushEvent(&event) > 0);
         }
 
@@ -323,7 +328,9 @@ SDL_SendTouchMotion(SDL_TouchID id, SDL_FingerID fingerid,
         event.tfinger.dx = xrel;
         event.tfinger.dy = yrel;            
         event.tfinger.pressure = pressure;
-        posted = (SDL_PushEvent(&event) > 0);
+        event.tfinger.coalesced = 0;
+        event.tfinger.timestamp_ns = SDL_GetPerformanceNS();
+        posted = (SDL_PushMotionEvent(&event) > 0);
     }
     return posted;
 }
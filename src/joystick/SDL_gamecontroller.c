@@ -29,6 +29,7 @@
 
 #if !SDL_EVENTS_DISABLED
 #include "../events/SDL_events_c.h"
+#include "../timer/SDL_timer_c.h"
 #endif
 #define ABS(_x) ((_x) < 0 ? -(_x) : (_x))
 
@@ -817,7 +818,7 @@ SDL_GameControllerInit(void)
     SDL_GameControllerLoadHints();
 
 	/* watch for joy events and fire controller ones if needed */
-	SDL_AddEventWatch( SDL_GameControllerEventWatcher, NULL );
+	SDL_AddEventWatchRange( SDL_GameControllerEventWatcher, NULL, SDL_JOYAXISMOTION, SDL_JOYDEVICEREMOVED );
 
 	return (0);
 }
@@ -1170,6 +1171,7 @@ SDL_PrivateGameControllerAxis(SDL_GameController * gamecontroller, SDL_GameContr
         event.caxis.which = gamecontroller->joystick->instance_id;
         event.caxis.axis = axis;
         event.caxis.value = value;
+        event.caxis.timestamp_ns = SDL_GetPerformanceNS();
 		posted = SDL_PushEvent(&event) == 1;
     }
 #endif /* !SDL_EVENTS_DISABLED */
@@ -1210,6 +1212,7 @@ SDL_PrivateGameControllerButton(SDL_GameController * gamecontroller, SDL_GameCon
         event.cbutton.which = gamecontroller->joystick->instance_id;
         event.cbutton.button = button;
         event.cbutton.state = state;
+        event.cbutton.timestamp_ns = SDL_GetPerformanceNS();
 		posted = SDL_PushEvent(&event) == 1;
     }
 #endif /* !SDL_EVENTS_DISABLED */
@@ -28,6 +28,7 @@
 
 #if !SDL_EVENTS_DISABLED
 #include "../events/SDL_events_c.h"
+#include "../timer/SDL_timer_c.h"
 #endif
 
 static SDL_Joystick *SDL_joysticks = NULL;
@@ -479,6 +480,7 @@ SDL_PrivateJoystickAxis(SDL_Joystick * joystick, Uint8 axis, Sint16 value)
         event.jaxis.which = joystick->instance_id;
         event.jaxis.axis = axis;
         event.jaxis.value = value;
+        event.jaxis.timestamp_ns = SDL_GetPerformanceNS();
         posted = SDL_PushEvent(&event) == 1;
     }
 #endif /* !SDL_EVENTS_DISABLED */
@@ -507,6 +509,7 @@ SDL_PrivateJoystickHat(SDL_Joystick * joystick, Uint8 hat, Uint8 value)
         event.jhat.which = joystick->instance_id;
         event.jhat.hat = hat;
         event.jhat.value = value;
+        event.jhat.timestamp_ns = SDL_GetPerformanceNS();
         posted = SDL_PushEvent(&event) == 1;
     }
 #endif /* !SDL_EVENTS_DISABLED */
@@ -538,6 +541,7 @@ SDL_PrivateJoystickBall(SDL_Joystick * joystick, Uint8 ball,
         event.jball.ball = ball;
         event.jball.xrel = xrel;
         event.jball.yrel = yrel;
+        event.jball.timestamp_ns = SDL_GetPerformanceNS();
         posted = SDL_PushEvent(&event) == 1;
     }
 #endif /* !SDL_EVENTS_DISABLED */
@@ -579,6 +583,7 @@ SDL_PrivateJoystickButton(SDL_Joystick * joystick, Uint8 button, Uint8 state)
         event.jbutton.which = joystick->instance_id;
         event.jbutton.button = button;
         event.jbutton.state = state;
+        event.jbutton.timestamp_ns = SDL_GetPerformanceNS();
         posted = SDL_PushEvent(&event) == 1;
     }
 #endif /* !SDL_EVENTS_DISABLED */
@@ -282,7 +282,8 @@ SDL_CreateRenderer(SDL_Window * window, int index, Uint32 flags)
 
         SDL_RenderSetViewport(renderer, NULL);
 
-        SDL_AddEventWatch(SDL_RendererEventWatch, renderer);
+        SDL_AddEventWatchRange(SDL_RendererEventWatch, renderer,
+                               SDL_WINDOWEVENT, SDL_WINDOWEVENT);
 
         SDL_LogInfo(SDL_LOG_CATEGORY_RENDER,
                     "Created renderer: %s", renderer->info.name);
@@ -383,4 +383,15 @@ SDL_RemoveTimer(SDL_TimerID id)
     return canceled;
 }
 
+/* The performance counter in nanoseconds, for timestamping input events */
+Uint64
+SDL_GetPerformanceNS(void)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const Uint64 now = SDL_GetPerformanceCounter();
+
+    /* Convert the whole seconds separately so this doesn't overflow */
+    return ((now / freq) * 1000000000) + (((now % freq) * 1000000000) / freq);
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
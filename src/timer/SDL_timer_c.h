@@ -28,5 +28,6 @@
 
 extern int SDL_TimerInit(void);
 extern void SDL_TimerQuit(void);
+extern Uint64 SDL_GetPerformanceNS(void);
 
 /* vi: set ts=4 sw=4 expandtab: */
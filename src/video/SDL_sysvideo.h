@@ -232,6 +232,13 @@ struct SDL_VideoDevice
      */
     void (*PumpEvents) (_THIS);
 
+    /* Block until there may be events to pump, SendWakeupEvent() is called
+       from another thread, or (timeout) ms pass (forever if negative).
+       Drivers without this are polled every 10 ms while waiting.  If this
+       is set, SendWakeupEvent() must be too. */
+    int (*WaitEventTimeout) (_THIS, int timeout);
+    void (*SendWakeupEvent) (_THIS);
+
     /* Suspend the screensaver */
     void (*SuspendScreenSaver) (_THIS);
 
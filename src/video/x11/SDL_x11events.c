@@ -848,6 +848,40 @@ X11_HandleFocusChanges(_THIS)
         }
     }
 }
+/* Wait until the X server or (wakeup_fd), if it isn't -1, has something to
+   read, or (timeout) milliseconds pass; a negative timeout waits forever.
+   Returns 1 if the X server is ready to talk. */
+static int
+X11_WaitReadable(Display * display, int wakeup_fd, int timeout)
+{
+    struct timeval tv;
+    int x11_fd;
+    fd_set fdset;
+    char buf[64];
+
+    x11_fd = ConnectionNumber(display);
+    FD_ZERO(&fdset);
+    FD_SET(x11_fd, &fdset);
+    if (wakeup_fd >= 0) {
+        FD_SET(wakeup_fd, &fdset);
+    }
+    if (timeout >= 0) {
+        tv.tv_sec = timeout / 1000;
+        tv.tv_usec = (timeout % 1000) * 1000;
+    }
+    if (select(SDL_max(x11_fd, wakeup_fd) + 1, &fdset, NULL, NULL,
+               (timeout >= 0) ? &tv : NULL) <= 0) {
+        return (0);
+    }
+    if (wakeup_fd >= 0 && FD_ISSET(wakeup_fd, &fdset)) {
+        /* Empty the pipe; one wakeup is as good as many */
+        while (read(wakeup_fd, buf, sizeof (buf)) > 0) {
+            continue;
+        }
+    }
+    return FD_ISSET(x11_fd, &fdset) ? 1 : 0;
+}
+
 /* Ack!  XPending() actually performs a blocking read if no events available */
 static int
 X11_Pending(Display * display)
@@ -859,23 +893,64 @@ X11_Pending(Display * display)
     }
 
     /* More drastic measures are required -- see if X is ready to talk */
-    {
-        static struct timeval zero_time;        /* static == 0 */
-        int x11_fd;
-        fd_set fdset;
-
-        x11_fd = ConnectionNumber(display);
-        FD_ZERO(&fdset);
-        FD_SET(x11_fd, &fdset);
-        if (select(x11_fd + 1, &fdset, NULL, NULL, &zero_time) == 1) {
-            return (XPending(display));
-        }
+    if (X11_WaitReadable(display, -1, 0)) {
+        return (XPending(display));
     }
 
     /* Oh well, nothing is ready .. */
     return (0);
 }
 
+int
+X11_WaitEventTimeout(_THIS, int timeout)
+{
+    SDL_VideoData *videodata = (SDL_VideoData *) _this->driverdata;
+    Display *display = videodata->display;
+    Uint32 now;
+    int i, left;
+
+    /* Send our requests before sleeping, and don't sleep on events Xlib
+       has already read */
+    XFlush(display);
+    if (XEventsQueued(display, QueuedAlready)) {
+        return (1);
+    }
+
+    /* Wake up in time for delayed focus changes and the screensaver */
+    now = SDL_GetTicks();
+    for (i = 0; i < videodata->numwindows; ++i) {
+        SDL_WindowData *data = videodata->windowlist[i];
+        if (data && data->pending_focus != PENDING_FOCUS_NONE) {
+            left = SDL_max((int) (data->pending_focus_time - now), 0);
+            if (timeout < 0 || left < timeout) {
+                timeout = left;
+            }
+        }
+    }
+    if (_this->suspend_screensaver && (timeout < 0 || timeout > 30000)) {
+        timeout = 30000;
+    }
+    if (videodata->wakeup_pipe[0] < 0 && (timeout < 0 || timeout > 10)) {
+        /* Nothing can wake us up early, poll */
+        timeout = 10;
+    }
+
+    return X11_WaitReadable(display, videodata->wakeup_pipe[0], timeout);
+}
+
+void
+X11_SendWakeupEvent(_THIS)
+{
+    SDL_VideoData *data = (SDL_VideoData *) _this->driverdata;
+    const char wakeup = 0;
+
+    if (data->wakeup_pipe[1] >= 0) {
+        if (write(data->wakeup_pipe[1], &wakeup, 1) < 0) {
+            /* The pipe is full, so the waiter will wake up anyway */
+        }
+    }
+}
+
 
 /* !!! FIXME: this should be exposed in a header, or something. */
 int SDL_GetNumTouch(void);
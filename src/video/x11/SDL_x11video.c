@@ -22,7 +22,8 @@
 
 #if SDL_VIDEO_DRIVER_X11
 
-#include <unistd.h> /* For getpid() and readlink() */
+#include <unistd.h> /* For getpid(), readlink() and pipe() */
+#include <fcntl.h>
 
 #include "SDL_video.h"
 #include "SDL_mouse.h"
@@ -355,6 +356,8 @@ X11_CreateDevice(int devindex)
     device->SetDisplayMode = X11_SetDisplayMode;
     device->SuspendScreenSaver = X11_SuspendScreenSaver;
     device->PumpEvents = X11_PumpEvents;
+    device->WaitEventTimeout = X11_WaitEventTimeout;
+    device->SendWakeupEvent = X11_SendWakeupEvent;
 
     device->CreateWindow = X11_CreateWindow;
     device->CreateWindowFrom = X11_CreateWindowFrom;
@@ -498,6 +501,14 @@ X11_VideoInit(_THIS)
     /* Get the process PID to be associated to the window */
     data->pid = getpid();
 
+    /* A pipe to interrupt X11_WaitEventTimeout() with */
+    if (pipe(data->wakeup_pipe) == 0) {
+        fcntl(data->wakeup_pipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(data->wakeup_pipe[1], F_SETFL, O_NONBLOCK);
+    } else {
+        data->wakeup_pipe[0] = data->wakeup_pipe[1] = -1;
+    }
+
     /* Open a connection to the X input manager */
 #ifdef X_HAVE_UTF8_STRING
     if (SDL_X11_HAVE_UTF8) {
@@ -571,6 +582,12 @@ X11_VideoQuit(_THIS)
     }
 #endif
 
+    if (data->wakeup_pipe[0] >= 0) {
+        close(data->wakeup_pipe[0]);
+        close(data->wakeup_pipe[1]);
+        data->wakeup_pipe[0] = data->wakeup_pipe[1] = -1;
+    }
+
     X11_QuitModes(_this);
     X11_QuitKeyboard(_this);
     X11_QuitMouse(_this);
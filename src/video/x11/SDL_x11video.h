@@ -114,6 +114,9 @@ typedef struct SDL_VideoData
     SDL_Scancode key_layout[256];
     SDL_bool selection_waiting;    
 
+    /* Written to by X11_SendWakeupEvent() to interrupt a wait */
+    int wakeup_pipe[2];
+
 #if SDL_USE_LIBDBUS
     DBusConnection *dbus;
 #endif
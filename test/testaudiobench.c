@@ -0,0 +1,530 @@
+/*
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Benchmark the audio conversion paths: data types, channel remixing,
+   rate conversion, mixing and audio streams, over a sweep of formats and
+   buffer sizes.  Each case prints one tab separated line:
+
+     group src_format src_channels src_rate dst_format dst_channels dst_rate
+     frames ns_per_frame bytes_per_sec
+
+   The first eight fields identify the case.  Given the output of an earlier
+   run with --baseline, cases that got slower than the tolerance allows are
+   reported on stderr and the exit code is 1.  --max-ns does the same for
+   any case slower than a fixed ns_per_frame, to catch gross regressions
+   without a baseline.
+
+   No audio device is needed, except for the "device" group, which renders
+   through the disk driver in freewheel mode. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SDL.h"
+
+#define MAX_BASELINE 4096
+
+typedef struct
+{
+    char key[128];
+    double ns_per_frame;
+} BaselineEntry;
+
+static BaselineEntry *baseline = NULL;
+static int baseline_count = 0;
+static double tolerance = 10.0;     /* percent */
+static double max_ns = 0.0;         /* ns/frame, 0 for no limit */
+static double target_seconds = 0.05;
+static int regressions = 0;
+static int quick = 0;
+
+static const SDL_AudioFormat formats[] = {
+    AUDIO_U8, AUDIO_S8, AUDIO_U16LSB, AUDIO_S16LSB, AUDIO_S16MSB,
+    AUDIO_S32LSB, AUDIO_F32LSB, AUDIO_F32MSB
+};
+
+static const char *
+format_name(SDL_AudioFormat format)
+{
+    switch (format) {
+    case AUDIO_U8: return "U8";
+    case AUDIO_S8: return "S8";
+    case AUDIO_U16LSB: return "U16LSB";
+    case AUDIO_S16LSB: return "S16LSB";
+    case AUDIO_U16MSB: return "U16MSB";
+    case AUDIO_S16MSB: return "S16MSB";
+    case AUDIO_S32LSB: return "S32LSB";
+    case AUDIO_S32MSB: return "S32MSB";
+    case AUDIO_F32LSB: return "F32LSB";
+    case AUDIO_F32MSB: return "F32MSB";
+    }
+    return "unknown";
+}
+
+static int
+frame_size(SDL_AudioFormat format, int channels)
+{
+    return (SDL_AUDIO_BITSIZE(format) / 8) * channels;
+}
+
+/* Fill (buf) with something that looks like audio in (format) */
+static void
+fill_buffer(Uint8 * buf, int len, SDL_AudioFormat format)
+{
+    const int bytes = SDL_AUDIO_BITSIZE(format) / 8;
+    int i;
+
+    for (i = 0; (i + bytes) <= len; i += bytes) {
+        const double value = SDL_sin(i * 0.01) * 0.5;
+        if (SDL_AUDIO_ISFLOAT(format)) {
+            float f = (float) value;
+            Uint32 bits;
+            SDL_memcpy(&bits, &f, sizeof (bits));
+            if (SDL_AUDIO_ISBIGENDIAN(format)) {
+                bits = SDL_SwapBE32(bits);
+            } else {
+                bits = SDL_SwapLE32(bits);
+            }
+            SDL_memcpy(buf + i, &bits, sizeof (bits));
+        } else if (bytes == 1) {
+            buf[i] = (Uint8) ((Sint8) (value * 127.0) +
+                              (SDL_AUDIO_ISSIGNED(format) ? 0 : 128));
+        } else if (bytes == 2) {
+            Uint16 s = (Uint16) ((Sint16) (value * 32767.0) +
+                                 (SDL_AUDIO_ISSIGNED(format) ? 0 : 32768));
+            s = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapBE16(s) : SDL_SwapLE16(s);
+            SDL_memcpy(buf + i, &s, sizeof (s));
+        } else {
+            Uint32 s = (Uint32) (Sint32) (value * 2147483647.0);
+            s = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapBE32(s) : SDL_SwapLE32(s);
+            SDL_memcpy(buf + i, &s, sizeof (s));
+        }
+    }
+}
+
+static void
+load_baseline(const char *path)
+{
+    char line[512];
+    FILE *fp = fopen(path, "r");
+
+    if (fp == NULL) {
+        fprintf(stderr, "Couldn't open baseline %s\n", path);
+        exit(2);
+    }
+    baseline = (BaselineEntry *) SDL_calloc(MAX_BASELINE, sizeof (BaselineEntry));
+    if (baseline == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(2);
+    }
+    while ((baseline_count < MAX_BASELINE) && fgets(line, sizeof (line), fp)) {
+        char *tab = line;
+        int fields = 0;
+        if (line[0] == '#') {
+            continue;
+        }
+        /* The key is everything up to the eighth tab */
+        while (*tab && (fields < 8)) {
+            if (*tab == '\t') {
+                fields++;
+            }
+            tab++;
+        }
+        if ((fields < 8) || ((size_t) (tab - line) > sizeof (baseline[0].key))) {
+            continue;
+        }
+        SDL_strlcpy(baseline[baseline_count].key, line, tab - line);
+        baseline[baseline_count].ns_per_frame = SDL_atof(tab);
+        baseline_count++;
+    }
+    fclose(fp);
+}
+
+static void
+report(const char *group, SDL_AudioFormat src_fmt, int src_channels,
+       int src_rate, SDL_AudioFormat dst_fmt, int dst_channels, int dst_rate,
+       int frames, Uint64 ticks, Uint64 total_frames)
+{
+    const double seconds = (double) ticks / (double) SDL_GetPerformanceFrequency();
+    const double ns = (seconds * 1e9) / (double) total_frames;
+    const double bytes = (double) total_frames * frame_size(src_fmt, src_channels);
+    char key[128];
+    int i;
+
+    SDL_snprintf(key, sizeof (key), "%s\t%s\t%d\t%d\t%s\t%d\t%d\t%d",
+                 group, format_name(src_fmt), src_channels, src_rate,
+                 format_name(dst_fmt), dst_channels, dst_rate, frames);
+    printf("%s\t%.3f\t%.0f\n", key, ns, bytes / seconds);
+    fflush(stdout);
+
+    if ((max_ns > 0.0) && (ns > max_ns)) {
+        fprintf(stderr, "REGRESSION\t%s\t%.3f ns/frame, limit %.3f\n",
+                key, ns, max_ns);
+        regressions++;
+        return;
+    }
+
+    for (i = 0; i < baseline_count; i++) {
+        if (SDL_strcmp(baseline[i].key, key) == 0) {
+            const double limit = baseline[i].ns_per_frame * (1.0 + tolerance / 100.0);
+            if (ns > limit) {
+                fprintf(stderr, "REGRESSION\t%s\t%.3f ns/frame, was %.3f (+%.1f%%)\n",
+                        key, ns, baseline[i].ns_per_frame,
+                        ((ns / baseline[i].ns_per_frame) - 1.0) * 100.0);
+                regressions++;
+            }
+            break;
+        }
+    }
+}
+
+/* Time SDL_ConvertAudio() on buffers of (frames) frames.  Runs in five
+   rounds and keeps the fastest, which is the least disturbed by noise. */
+static void
+bench_convert(const char *group, SDL_AudioFormat src_fmt, int src_channels,
+              int src_rate, SDL_AudioFormat dst_fmt, int dst_channels,
+              int dst_rate, int frames)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const int len = frames * frame_size(src_fmt, src_channels);
+    SDL_AudioCVT cvt;
+    Uint8 *source, *work;
+    Uint64 best = 0, best_frames = 1;
+    int round;
+
+    if (SDL_BuildAudioCVT(&cvt, src_fmt, (Uint8) src_channels, src_rate,
+                          dst_fmt, (Uint8) dst_channels, dst_rate) < 0) {
+        fprintf(stderr, "# %s: couldn't build conversion: %s\n", group, SDL_GetError());
+        return;
+    }
+
+    source = (Uint8 *) SDL_malloc(len);
+    work = (Uint8 *) SDL_malloc(len * cvt.len_mult);
+    if (!source || !work) {
+        fprintf(stderr, "Out of memory\n");
+        exit(2);
+    }
+    fill_buffer(source, len, src_fmt);
+
+    for (round = 0; round < 5; round++) {
+        const Uint64 deadline = SDL_GetPerformanceCounter() +
+            (Uint64) (target_seconds * freq / 5);
+        Uint64 ticks = 0, done = 0;
+        do {
+            Uint64 start;
+            SDL_memcpy(work, source, len);
+            cvt.buf = work;
+            cvt.len = len;
+            start = SDL_GetPerformanceCounter();
+            SDL_ConvertAudio(&cvt);
+            ticks += SDL_GetPerformanceCounter() - start;
+            done += frames;
+        } while (SDL_GetPerformanceCounter() < deadline);
+        if ((round == 0) || ((double) ticks / done < (double) best / best_frames)) {
+            best = ticks;
+            best_frames = done;
+        }
+    }
+
+    report(group, src_fmt, src_channels, src_rate, dst_fmt, dst_channels,
+           dst_rate, frames, best, best_frames);
+    SDL_free(source);
+    SDL_free(work);
+}
+
+static void
+bench_mix(SDL_AudioFormat format, int channels, int volume, int frames)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const int len = frames * frame_size(format, channels);
+    Uint8 *src = (Uint8 *) SDL_malloc(len);
+    Uint8 *dst = (Uint8 *) SDL_malloc(len);
+    Uint64 best = 0, best_frames = 1;
+    int round;
+
+    if (!src || !dst) {
+        fprintf(stderr, "Out of memory\n");
+        exit(2);
+    }
+    fill_buffer(src, len, format);
+
+    for (round = 0; round < 5; round++) {
+        const Uint64 deadline = SDL_GetPerformanceCounter() +
+            (Uint64) (target_seconds * freq / 5);
+        Uint64 ticks = 0, done = 0;
+        do {
+            Uint64 start;
+            SDL_memset(dst, 0, len);
+            start = SDL_GetPerformanceCounter();
+            SDL_MixAudioFormat(dst, src, format, len, volume);
+            ticks += SDL_GetPerformanceCounter() - start;
+            done += frames;
+        } while (SDL_GetPerformanceCounter() < deadline);
+        if ((round == 0) || ((double) ticks / done < (double) best / best_frames)) {
+            best = ticks;
+            best_frames = done;
+        }
+    }
+
+    /* The volume goes in the destination rate column */
+    report("mix", format, channels, 0, format, channels, volume, frames,
+           best, best_frames);
+    SDL_free(src);
+    SDL_free(dst);
+}
+
+static void
+bench_stream(SDL_AudioFormat src_fmt, int src_channels, int src_rate,
+             SDL_AudioFormat dst_fmt, int dst_channels, int dst_rate,
+             int frames)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const int len = frames * frame_size(src_fmt, src_channels);
+    const int outlen = 4096 * frame_size(dst_fmt, dst_channels);
+    SDL_AudioStream *stream;
+    Uint8 *src = (Uint8 *) SDL_malloc(len);
+    Uint8 *out = (Uint8 *) SDL_malloc(outlen);
+    Uint64 best = 0, best_frames = 1;
+    int round;
+
+    if (!src || !out) {
+        fprintf(stderr, "Out of memory\n");
+        exit(2);
+    }
+    stream = SDL_NewAudioStream(src_fmt, (Uint8) src_channels, src_rate,
+                                dst_fmt, (Uint8) dst_channels, dst_rate);
+    if (stream == NULL) {
+        fprintf(stderr, "# stream: couldn't create stream: %s\n", SDL_GetError());
+        SDL_free(src);
+        SDL_free(out);
+        return;
+    }
+    fill_buffer(src, len, src_fmt);
+
+    for (round = 0; round < 5; round++) {
+        const Uint64 deadline = SDL_GetPerformanceCounter() +
+            (Uint64) (target_seconds * freq / 5);
+        Uint64 start = SDL_GetPerformanceCounter();
+        Uint64 done = 0;
+        do {
+            SDL_AudioStreamPut(stream, src, len);
+            while (SDL_AudioStreamGet(stream, out, outlen) > 0) {
+                /* drain */
+            }
+            done += frames;
+        } while (SDL_GetPerformanceCounter() < deadline);
+        start = SDL_GetPerformanceCounter() - start;
+        if ((round == 0) || ((double) start / done < (double) best / best_frames)) {
+            best = start;
+            best_frames = done;
+        }
+    }
+
+    report("stream", src_fmt, src_channels, src_rate, dst_fmt, dst_channels,
+           dst_rate, frames, best, best_frames);
+    SDL_FreeAudioStream(stream);
+    SDL_free(src);
+    SDL_free(out);
+}
+
+static void SDLCALL
+device_callback(void *userdata, Uint8 * stream, int len)
+{
+    SDL_AudioSpec *spec = (SDL_AudioSpec *) userdata;
+    fill_buffer(stream, len, spec->format);
+}
+
+/* Render through the disk driver as fast as it will go; this covers the
+   whole device thread, including conversion into the device format */
+static void
+bench_device(SDL_AudioFormat format, int channels, int rate, int frames)
+{
+    const char *filename = "testaudiobench.wav";
+    SDL_AudioSpec desired, obtained;
+    SDL_AudioDeviceID id;
+    SDL_AudioDeviceStats stats;
+    Uint64 start, ticks;
+
+    SDL_zero(desired);
+    desired.freq = rate;
+    desired.format = format;
+    desired.channels = (Uint8) channels;
+    desired.samples = (Uint16) frames;
+    desired.callback = device_callback;
+    desired.userdata = &desired;
+    id = SDL_OpenAudioDevice(filename, 0, &desired, &obtained, 0);
+    if (id == 0) {
+        fprintf(stderr, "# device: couldn't open: %s\n", SDL_GetError());
+        return;
+    }
+
+    start = SDL_GetPerformanceCounter();
+    SDL_PauseAudioDevice(id, 0);
+    SDL_Delay((Uint32) (target_seconds * 1000.0 * 2));
+    SDL_PauseAudioDevice(id, 1);
+    SDL_GetAudioDeviceStats(id, &stats);
+    ticks = SDL_GetPerformanceCounter() - start;
+    SDL_CloseAudioDevice(id);
+    remove(filename);
+
+    if (stats.callbacks > 0) {
+        report("device", format, channels, rate, obtained.format,
+               obtained.channels, obtained.freq, frames, ticks,
+               (Uint64) stats.callbacks * frames);
+    }
+}
+
+static int
+wants(const char *group, const char *which)
+{
+    return (SDL_strcmp(which, "all") == 0) || (SDL_strcmp(which, group) == 0);
+}
+
+int
+main(int argc, char **argv)
+{
+    static const int channel_counts[] = { 1, 2, 4, 6 };
+    static const int rate_pairs[][2] = {
+        { 44100, 48000 }, { 48000, 44100 }, { 22050, 44100 },
+        { 44100, 22050 }, { 48000, 16000 }, { 11025, 48000 }
+    };
+    static const int rate_channels[] = { 1, 2, 6 };
+    int sizes[] = { 256, 4096 };
+    int numsizes = SDL_arraysize(sizes);
+    const char *group = "all";
+    int i, j, k, s;
+
+    for (i = 1; i < argc; i++) {
+        if (SDL_strcmp(argv[i], "--quick") == 0) {
+            quick = 1;
+            target_seconds = 0.005;
+        } else if ((SDL_strcmp(argv[i], "--group") == 0) && (i + 1 < argc)) {
+            group = argv[++i];
+        } else if ((SDL_strcmp(argv[i], "--seconds") == 0) && (i + 1 < argc)) {
+            target_seconds = SDL_atof(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--frames") == 0) && (i + 1 < argc)) {
+            sizes[0] = SDL_atoi(argv[++i]);
+            numsizes = 1;
+        } else if ((SDL_strcmp(argv[i], "--baseline") == 0) && (i + 1 < argc)) {
+            load_baseline(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--tolerance") == 0) && (i + 1 < argc)) {
+            tolerance = SDL_atof(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--max-ns") == 0) && (i + 1 < argc)) {
+            max_ns = SDL_atof(argv[++i]);
+        } else {
+            fprintf(stderr,
+                    "USAGE: %s [--quick] [--group type|channels|rate|mix|stream|device|all]\n"
+                    "       [--frames N] [--seconds S] [--baseline FILE] [--tolerance PERCENT]\n"
+                    "       [--max-ns NS_PER_FRAME]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if ((target_seconds <= 0.0) || (sizes[0] <= 0)) {
+        fprintf(stderr, "Invalid --seconds or --frames\n");
+        return 2;
+    }
+    if (quick && (numsizes > 1)) {
+        sizes[0] = sizes[1];
+        numsizes = 1;
+    }
+
+    /* Only the device group needs an audio driver; it uses the disk one */
+    if (wants("device", group)) {
+        SDL_setenv("SDL_AUDIODRIVER", "disk", 1);
+        SDL_setenv("SDL_DISKAUDIOFREEWHEEL", "1", 1);
+        if (SDL_Init(SDL_INIT_AUDIO) < 0) {
+            fprintf(stderr, "SDL_Init() failed: %s\n", SDL_GetError());
+            return 2;
+        }
+    } else if (SDL_Init(0) < 0) {
+        fprintf(stderr, "SDL_Init() failed: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    printf("# group\tsrc_format\tsrc_channels\tsrc_rate\tdst_format\tdst_channels\tdst_rate\tframes\tns_per_frame\tbytes_per_sec\n");
+
+    for (s = 0; s < numsizes; s++) {
+        const int frames = sizes[s];
+
+        if (wants("type", group)) {
+            for (i = 0; i < SDL_arraysize(formats); i++) {
+                for (j = 0; j < SDL_arraysize(formats); j++) {
+                    if (i != j) {
+                        bench_convert("type", formats[i], 2, 48000,
+                                      formats[j], 2, 48000, frames);
+                    }
+                }
+            }
+        }
+
+        if (wants("channels", group)) {
+            static const SDL_AudioFormat fmts[][2] = {
+                { AUDIO_S16SYS, AUDIO_S16SYS }, { AUDIO_F32SYS, AUDIO_F32SYS },
+                { AUDIO_S16SYS, AUDIO_F32SYS }, { AUDIO_F32SYS, AUDIO_S16SYS }
+            };
+            for (k = 0; k < SDL_arraysize(fmts); k++) {
+                for (i = 0; i < SDL_arraysize(channel_counts); i++) {
+                    for (j = 0; j < SDL_arraysize(channel_counts); j++) {
+                        if (i != j) {
+                            bench_convert("channels", fmts[k][0], channel_counts[i], 48000,
+                                          fmts[k][1], channel_counts[j], 48000, frames);
+                        }
+                    }
+                }
+            }
+        }
+
+        if (wants("rate", group)) {
+            static const SDL_AudioFormat fmts[] = { AUDIO_S16SYS, AUDIO_F32SYS };
+            for (k = 0; k < SDL_arraysize(fmts); k++) {
+                for (i = 0; i < SDL_arraysize(rate_channels); i++) {
+                    for (j = 0; j < SDL_arraysize(rate_pairs); j++) {
+                        bench_convert("rate", fmts[k], rate_channels[i], rate_pairs[j][0],
+                                      fmts[k], rate_channels[i], rate_pairs[j][1], frames);
+                    }
+                }
+            }
+        }
+
+        if (wants("mix", group)) {
+            for (i = 0; i < SDL_arraysize(formats); i++) {
+                bench_mix(formats[i], 2, SDL_MIX_MAXVOLUME, frames);
+                bench_mix(formats[i], 2, SDL_MIX_MAXVOLUME / 2, frames);
+            }
+        }
+
+        if (wants("stream", group)) {
+            bench_stream(AUDIO_S16SYS, 2, 44100, AUDIO_F32SYS, 2, 44100, frames);
+            bench_stream(AUDIO_S16SYS, 2, 44100, AUDIO_F32SYS, 2, 48000, frames);
+            bench_stream(AUDIO_F32SYS, 6, 48000, AUDIO_S16SYS, 2, 48000, frames);
+            bench_stream(AUDIO_F32SYS, 2, 48000, AUDIO_S16SYS, 2, 44100, frames);
+        }
+
+        if (wants("device", group)) {
+            bench_device(AUDIO_S16MSB, 2, 48000, frames);
+            bench_device(AUDIO_F32SYS, 2, 48000, frames);
+        }
+    }
+
+    SDL_Quit();
+    SDL_free(baseline);
+
+    if (regressions > 0) {
+        fprintf(stderr, "%d case(s) slower than the baseline or the limit\n",
+                regressions);
+        return 1;
+    }
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
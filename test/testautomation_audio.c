@@ -667,6 +667,1445 @@ int audio_openCloseAudioDeviceConnected()
 
 
 
+/**
+ * \brief Resample a sine tone and check length and level of the result
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_BuildAudioCVT
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_ConvertAudio
+ */
+int audio_resampleAudio()
+{
+  const int src_rate[] = { 44100, 48000, 22050, 8000 };
+  const int dst_rate[] = { 48000, 44100, 44100, 11025 };
+  const double pi = 3.14159265358979323846;
+  const double tone = 440.0;
+  const double level = 16384.0;
+  SDL_AudioCVT cvt;
+  Sint16 *samples;
+  int result, frames, expected, i, t;
+  double sample, maxdiff;
+
+  for (t = 0; t < SDL_arraysize(src_rate); t++) {
+    result = SDL_BuildAudioCVT(&cvt, AUDIO_S16SYS, 1, src_rate[t], AUDIO_S16SYS, 1, dst_rate[t]);
+    SDLTest_AssertPass("Call to SDL_BuildAudioCVT(AUDIO_S16SYS,1,%i ==> AUDIO_S16SYS,1,%i)", src_rate[t], dst_rate[t]);
+    SDLTest_AssertCheck(result == 1, "Verify result value; expected: 1, got: %i", result);
+    if (result != 1) return TEST_ABORTED;
+
+    /* A tenth of a second of a sine tone */
+    frames = src_rate[t] / 10;
+    cvt.len = frames * sizeof(Sint16);
+    cvt.buf = (Uint8 *)SDL_malloc(cvt.len * cvt.len_mult);
+    SDLTest_AssertCheck(cvt.buf != NULL, "Check data buffer to convert is not NULL");
+    if (cvt.buf == NULL) return TEST_ABORTED;
+    samples = (Sint16 *)cvt.buf;
+    for (i = 0; i < frames; i++) {
+      samples[i] = (Sint16)(level * SDL_sin(2.0 * pi * tone * i / src_rate[t]));
+    }
+
+    result = SDL_ConvertAudio(&cvt);
+    SDLTest_AssertPass("Call to SDL_ConvertAudio()");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0; got: %i", result);
+
+    /* Every started output frame is produced */
+    expected = (frames * dst_rate[t] + src_rate[t] - 1) / src_rate[t];
+    SDLTest_AssertCheck(cvt.len_cvt == expected * (int)sizeof(Sint16), "Verify converted length; expected: %i; got: %i", expected * (int)sizeof(Sint16), cvt.len_cvt);
+
+    /* Away from the edges the output should follow the tone closely */
+    maxdiff = 0.0;
+    samples = (Sint16 *)cvt.buf;
+    for (i = 64; i < (cvt.len_cvt / (int)sizeof(Sint16)) - 64; i++) {
+      sample = level * SDL_sin(2.0 * pi * tone * i / dst_rate[t]);
+      if (SDL_fabs(samples[i] - sample) > maxdiff) {
+        maxdiff = SDL_fabs(samples[i] - sample);
+      }
+    }
+    SDLTest_AssertCheck(maxdiff < 16.0, "Verify deviation from the ideal tone; expected: <16; got: %f", maxdiff);
+
+    SDL_free(cvt.buf);
+    cvt.buf = NULL;
+  }
+
+  return TEST_COMPLETED;
+}
+
+
+/**
+ * \brief Feed an audio stream in odd sized pieces and compare against a single put
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_NewAudioStream
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_AudioStreamPut
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_AudioStreamGet
+ */
+int audio_audioStream()
+{
+  const int frames = 4410;
+  const int len = frames * 2 * sizeof(Sint16);
+  SDL_AudioStream *whole;
+  SDL_AudioStream *pieces;
+  Sint16 *input;
+  Uint8 *output1;
+  Uint8 *output2;
+  int result, pos, chunk, got1, got2, i;
+
+  whole = SDL_NewAudioStream(AUDIO_S16SYS, 2, 44100, AUDIO_F32SYS, 1, 48000);
+  SDLTest_AssertPass("Call to SDL_NewAudioStream(AUDIO_S16SYS,2,44100 ==> AUDIO_F32SYS,1,48000)");
+  SDLTest_AssertCheck(whole != NULL, "Verify stream is not NULL");
+  pieces = SDL_NewAudioStream(AUDIO_S16SYS, 2, 44100, AUDIO_F32SYS, 1, 48000);
+  SDLTest_AssertCheck(pieces != NULL, "Verify second stream is not NULL");
+  if (whole == NULL || pieces == NULL) return TEST_ABORTED;
+
+  input = (Sint16 *)SDL_malloc(len);
+  output1 = (Uint8 *)SDL_malloc(len * 2);
+  output2 = (Uint8 *)SDL_malloc(len * 2);
+  SDLTest_AssertCheck(input != NULL && output1 != NULL && output2 != NULL, "Check buffers are not NULL");
+  if (input == NULL || output1 == NULL || output2 == NULL) return TEST_ABORTED;
+  for (i = 0; i < frames * 2; i++) {
+    input[i] = (Sint16)SDLTest_RandomSint16();
+  }
+
+  result = SDL_AudioStreamPut(whole, input, len);
+  SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0; got: %i", result);
+  result = SDL_AudioStreamFlush(whole);
+  SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0; got: %i", result);
+  got1 = SDL_AudioStreamGet(whole, output1, len * 2);
+  SDLTest_AssertPass("Call to SDL_AudioStreamGet()");
+
+  /* Pieces that cut sample frames in half, read back while writing */
+  got2 = 0;
+  for (pos = 0; pos < len; pos += chunk) {
+    chunk = SDLTest_RandomIntegerInRange(1, 777);
+    if (chunk > len - pos) {
+      chunk = len - pos;
+    }
+    result = SDL_AudioStreamPut(pieces, (Uint8 *)input + pos, chunk);
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0; got: %i", result);
+    got2 += SDL_AudioStreamGet(pieces, output2 + got2, SDLTest_RandomIntegerInRange(0, 500));
+  }
+  SDL_AudioStreamFlush(pieces);
+  got2 += SDL_AudioStreamGet(pieces, output2 + got2, len * 2 - got2);
+
+  SDLTest_AssertCheck(got1 == 4800 * (int)sizeof(float), "Verify converted length; expected: %i; got: %i", 4800 * (int)sizeof(float), got1);
+  SDLTest_AssertCheck(got1 == got2, "Verify both streams produced the same length; expected: %i; got: %i", got1, got2);
+  SDLTest_AssertCheck(SDL_memcmp(output1, output2, SDL_min(got1, got2)) == 0, "Verify both streams produced the same data");
+  SDLTest_AssertCheck(SDL_AudioStreamAvailable(pieces) == 0, "Verify stream is empty");
+
+  SDL_FreeAudioStream(whole);
+  SDL_FreeAudioStream(pieces);
+  SDL_free(input);
+  SDL_free(output1);
+  SDL_free(output2);
+
+  return TEST_COMPLETED;
+}
+
+
+/**
+ * \brief Queue audio on a device opened without a callback
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_QueueAudio
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_GetQueuedAudioSize
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_ClearQueuedAudio
+ */
+int audio_queueAudio()
+{
+   SDL_AudioDeviceID id;
+   SDL_AudioSpec desired, obtained;
+   Uint8 data[20000];
+   Uint32 queued;
+   int result;
+
+   SDL_memset(data, 0, sizeof(data));
+
+   /* A device with a callback can't queue */
+   SDL_zero(desired);
+   desired.freq=22050;
+   desired.format=AUDIO_S16SYS;
+   desired.channels=2;
+   desired.samples=4096;
+   desired.callback=_audio_testCallback;
+   id = SDL_OpenAudioDevice(NULL, 0, &desired, &obtained, 0);
+   SDLTest_AssertPass("SDL_OpenAudioDevice() with a callback");
+   if (id > 1) {
+     result = SDL_QueueAudio(id, data, sizeof(data));
+     SDLTest_AssertCheck(result == -1, "Verify SDL_QueueAudio() fails; expected: -1, got: %i", result);
+     SDL_CloseAudioDevice(id);
+   }
+
+   /* No callback: the device plays what is queued */
+   desired.callback=NULL;
+   id = SDL_OpenAudioDevice(NULL, 0, &desired, &obtained, 0);
+   SDLTest_AssertPass("SDL_OpenAudioDevice() without a callback");
+   SDLTest_AssertCheck(id > 1, "Validate device ID; expected: >=2, got: %i", id);
+   if (id <= 1) return TEST_ABORTED;
+
+   /* Spans several packets */
+   result = SDL_QueueAudio(id, data, sizeof(data));
+   SDLTest_AssertPass("Call to SDL_QueueAudio()");
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   result = SDL_QueueAudio(id, data, 1000);
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   queued = SDL_GetQueuedAudioSize(id);
+   SDLTest_AssertPass("Call to SDL_GetQueuedAudioSize()");
+   SDLTest_AssertCheck(queued == sizeof(data) + 1000, "Verify queued size; expected: %i, got: %i", (int)sizeof(data) + 1000, (int)queued);
+
+   SDL_ClearQueuedAudio(id);
+   SDLTest_AssertPass("Call to SDL_ClearQueuedAudio()");
+   queued = SDL_GetQueuedAudioSize(id);
+   SDLTest_AssertCheck(queued == 0, "Verify queued size; expected: 0, got: %i", (int)queued);
+
+   /* Playback drains the queue */
+   result = SDL_QueueAudio(id, data, sizeof(data));
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   SDL_PauseAudioDevice(id, 0);
+   SDL_Delay(500);
+   queued = SDL_GetQueuedAudioSize(id);
+   SDLTest_AssertCheck(queued < sizeof(data), "Verify queue drains while playing; expected: <%i, got: %i", (int)sizeof(data), (int)queued);
+
+   SDL_CloseAudioDevice(id);
+   SDLTest_AssertPass("Call to SDL_CloseAudioDevice()");
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * \brief Mix with the vector kernels and check them against the scalar code
+ *
+ * Integer formats must match bit for bit.  The scalar float code may run
+ * on the x87 (see SSEMATH in CMakeLists.txt), so floats get a tolerance.
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_MixAudioFormat
+ */
+int audio_mixAudioFormat()
+{
+   const SDL_AudioFormat formats[] = { AUDIO_U8, AUDIO_S8, AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_S32LSB, AUDIO_S32MSB, AUDIO_F32LSB, AUDIO_F32MSB };
+   const char *formatNames[] = { "AUDIO_U8", "AUDIO_S8", "AUDIO_S16LSB", "AUDIO_S16MSB", "AUDIO_S32LSB", "AUDIO_S32MSB", "AUDIO_F32LSB", "AUDIO_F32MSB" };
+   const int volumes[] = { 1, 37, 64, 100, 127, SDL_MIX_MAXVOLUME };
+   const int len = 1028;   /* whole samples for every format, not whole vectors */
+   Uint8 src[1028], dst[1028], whole[1028], single[1028];
+   int i, j, k, samplesize, swapped, matches;
+   float a, b;
+
+   for (i = 0; i < SDL_arraysize(formats); i++) {
+     samplesize = SDL_AUDIO_BITSIZE(formats[i]) / 8;
+     swapped = (SDL_AUDIO_ISBIGENDIAN(formats[i]) != 0) != (SDL_BYTEORDER == SDL_BIG_ENDIAN);
+     for (j = 0; j < SDL_arraysize(volumes); j++) {
+       if (SDL_AUDIO_ISFLOAT(formats[i])) {
+         float *fsrc = (float *) src;
+         float *fdst = (float *) dst;
+         for (k = 0; k < len / 4; k++) {
+           /* mostly audio range, some sums big enough to clamp */
+           if ((k % 16) == 0) {
+             fsrc[k] = (k % 32) ? 3.4e+38f : -3.4e+38f;
+             fdst[k] = fsrc[k];
+           } else {
+             fsrc[k] = SDLTest_RandomUnitFloat() * 4.0f - 2.0f;
+             fdst[k] = SDLTest_RandomUnitFloat() * 4.0f - 2.0f;
+           }
+           if (swapped) {
+             fsrc[k] = SDL_SwapFloat(fsrc[k]);
+             fdst[k] = SDL_SwapFloat(fdst[k]);
+           }
+         }
+       } else {
+         for (k = 0; k < len; k++) {
+           src[k] = SDLTest_RandomUint8();
+           dst[k] = SDLTest_RandomUint8();
+         }
+       }
+
+       SDL_memcpy(whole, dst, len);
+       SDL_MixAudioFormat(whole, src, formats[i], len, volumes[j]);
+
+       /* One sample at a time is too short for any vector kernel */
+       SDL_memcpy(single, dst, len);
+       for (k = 0; k < len; k += samplesize) {
+         SDL_MixAudioFormat(single + k, src + k, formats[i], samplesize, volumes[j]);
+       }
+
+       if (SDL_AUDIO_ISFLOAT(formats[i])) {
+         matches = 1;
+         for (k = 0; k < len / 4; k++) {
+           a = ((float *) whole)[k];
+           b = ((float *) single)[k];
+           if (swapped) {
+             a = SDL_SwapFloat(a);
+             b = SDL_SwapFloat(b);
+           }
+           if (SDL_fabs(a - b) > 1e-6 * (1.0 + SDL_fabs(b))) {
+             matches = 0;
+           }
+         }
+       } else {
+         matches = (SDL_memcmp(whole, single, len) == 0);
+       }
+       SDLTest_AssertCheck(matches,
+            "Verify mix of %s at volume %i matches sample by sample mix", formatNames[i], volumes[j]);
+     }
+   }
+
+   return TEST_COMPLETED;
+}
+/* Reads sample (i) of a buffer in (format) as a double in -1..1 */
+static double
+_audio_sampleValue(const Uint8 *buf, SDL_AudioFormat format, int i)
+{
+   Uint32 bits;
+   float f;
+
+   switch (SDL_AUDIO_BITSIZE(format)) {
+     case 8:
+       return (format == AUDIO_U8) ? (buf[i] - 128) / 128.0 : ((Sint8) buf[i]) / 128.0;
+     case 16:
+       bits = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapBE16(((Uint16 *) buf)[i]) : SDL_SwapLE16(((Uint16 *) buf)[i]);
+       return ((Sint16) bits) / 32768.0;
+     default:
+       bits = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapBE32(((Uint32 *) buf)[i]) : SDL_SwapLE32(((Uint32 *) buf)[i]);
+       if (SDL_AUDIO_ISFLOAT(format)) {
+         SDL_memcpy(&f, &bits, sizeof (f));
+         return f;
+       }
+       return ((Sint32) bits) / 2147483648.0;
+   }
+}
+
+/**
+ * \brief Convert between the sample types that have vectorized converters
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_BuildAudioCVT
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_ConvertAudio
+ */
+int audio_convertAudioTypes()
+{
+   const SDL_AudioFormat pairs[][2] = {
+       { AUDIO_S16LSB, AUDIO_F32LSB }, { AUDIO_S16MSB, AUDIO_F32LSB }, { AUDIO_S16LSB, AUDIO_F32MSB }, { AUDIO_S16MSB, AUDIO_F32MSB },
+       { AUDIO_F32LSB, AUDIO_S16LSB }, { AUDIO_F32MSB, AUDIO_S16LSB }, { AUDIO_F32LSB, AUDIO_S16MSB }, { AUDIO_F32MSB, AUDIO_S16MSB },
+       { AUDIO_S32LSB, AUDIO_F32LSB }, { AUDIO_S32MSB, AUDIO_F32LSB }, { AUDIO_S32LSB, AUDIO_F32MSB }, { AUDIO_S32MSB, AUDIO_F32MSB },
+       { AUDIO_F32LSB, AUDIO_S32LSB }, { AUDIO_F32MSB, AUDIO_S32LSB }, { AUDIO_F32LSB, AUDIO_S32MSB }, { AUDIO_F32MSB, AUDIO_S32MSB },
+       { AUDIO_U8, AUDIO_S16LSB }, { AUDIO_U8, AUDIO_S16MSB }, { AUDIO_S16LSB, AUDIO_U8 }, { AUDIO_S16MSB, AUDIO_U8 } };
+   const int samples = 1003;   /* leaves a scalar tail for every vector width */
+   SDL_AudioCVT cvt;
+   Uint8 *input = NULL;
+   int i, k, result, src_size, dst_size, matches;
+   double in, out, tolerance;
+   float f;
+   Uint32 bits;
+
+   for (i = 0; i < SDL_arraysize(pairs); i++) {
+     src_size = SDL_AUDIO_BITSIZE(pairs[i][0]) / 8;
+     dst_size = SDL_AUDIO_BITSIZE(pairs[i][1]) / 8;
+     result = SDL_BuildAudioCVT(&cvt, pairs[i][0], 1, 22050, pairs[i][1], 1, 22050);
+     SDLTest_AssertCheck(result == 1, "Verify SDL_BuildAudioCVT() result for 0x%x to 0x%x; expected: 1, got: %i", pairs[i][0], pairs[i][1], result);
+     if (result != 1) continue;
+
+     cvt.len = samples * src_size;
+     cvt.buf = (Uint8 *)SDL_malloc(cvt.len * cvt.len_mult);
+     input = (Uint8 *)SDL_malloc(cvt.len);
+     SDLTest_AssertCheck(cvt.buf != NULL && input != NULL, "Check buffers are not NULL");
+     if (cvt.buf == NULL || input == NULL) {
+       SDL_free(cvt.buf);
+       SDL_free(input);
+       return TEST_ABORTED;
+     }
+
+     for (k = 0; k < samples; k++) {
+       if (SDL_AUDIO_ISFLOAT(pairs[i][0])) {
+         f = SDLTest_RandomUnitFloat() * 2.0f - 1.0f;
+         SDL_memcpy(&bits, &f, sizeof (bits));
+         ((Uint32 *) input)[k] = SDL_AUDIO_ISBIGENDIAN(pairs[i][0]) ? SDL_SwapBE32(bits) : SDL_SwapLE32(bits);
+       } else if (src_size == 4) {
+         ((Uint32 *) input)[k] = SDLTest_RandomUint32();
+       } else if (src_size == 2) {
+         ((Uint16 *) input)[k] = SDLTest_RandomUint16();
+       } else {
+         input[k] = SDLTest_RandomUint8();
+       }
+     }
+     SDL_memcpy(cvt.buf, input, cvt.len);
+
+     result = SDL_ConvertAudio(&cvt);
+     SDLTest_AssertCheck(result == 0, "Verify SDL_ConvertAudio() result; expected: 0, got: %i", result);
+     SDLTest_AssertCheck(cvt.len_cvt == samples * dst_size, "Verify converted length; expected: %i, got: %i", samples * dst_size, cvt.len_cvt);
+
+     /* Allow for rounding and the 32767 vs 32768 scale factors */
+     tolerance = 1.0 / 16384.0;
+     if (dst_size == 1) {
+       tolerance = 1.0 / 64.0;
+     }
+     matches = 1;
+     for (k = 0; k < samples; k++) {
+       in = _audio_sampleValue(input, pairs[i][0], k);
+       out = _audio_sampleValue(cvt.buf, pairs[i][1], k);
+       if (SDL_fabs(in - out) > tolerance) {
+         matches = 0;
+       }
+     }
+     SDLTest_AssertCheck(matches, "Verify converted samples for 0x%x to 0x%x", pairs[i][0], pairs[i][1]);
+
+     SDL_free(cvt.buf);
+     SDL_free(input);
+   }
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * \brief Convert type and channels at once; same as doing one after the other
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_BuildAudioCVT
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_ConvertAudio
+ */
+int audio_convertAudioChannels()
+{
+   const struct {
+       SDL_AudioFormat src_fmt;
+       Uint8 src_channels;
+       SDL_AudioFormat dst_fmt;
+       Uint8 dst_channels;
+   } pairs[] = {
+       { AUDIO_S16SYS, 1, AUDIO_F32SYS, 2 }, { AUDIO_S16SYS, 2, AUDIO_F32SYS, 1 },
+       { AUDIO_F32SYS, 1, AUDIO_S16SYS, 2 }, { AUDIO_F32SYS, 2, AUDIO_S16SYS, 1 } };
+   const int frames = 1003;    /* leaves a scalar tail */
+   SDL_AudioCVT cvt, first, second;
+   Uint8 *fused, *twopass;
+   int i, k, result, src_len;
+
+   fused = (Uint8 *)SDL_malloc(frames * 8 * 4);
+   twopass = (Uint8 *)SDL_malloc(frames * 8 * 4);
+   SDLTest_AssertCheck(fused != NULL && twopass != NULL, "Check buffers are not NULL");
+   if (fused == NULL || twopass == NULL) {
+     SDL_free(fused);
+     SDL_free(twopass);
+     return TEST_ABORTED;
+   }
+
+   for (i = 0; i < SDL_arraysize(pairs); i++) {
+     src_len = frames * pairs[i].src_channels * (SDL_AUDIO_BITSIZE(pairs[i].src_fmt) / 8);
+     for (k = 0; k < frames * pairs[i].src_channels; k++) {
+       if (SDL_AUDIO_ISFLOAT(pairs[i].src_fmt)) {
+         ((float *) fused)[k] = SDLTest_RandomUnitFloat() * 2.0f - 1.0f;
+       } else {
+         ((Uint16 *) fused)[k] = SDLTest_RandomUint16();
+       }
+     }
+     SDL_memcpy(twopass, fused, src_len);
+
+     result = SDL_BuildAudioCVT(&cvt, pairs[i].src_fmt, pairs[i].src_channels, 44100,
+                                pairs[i].dst_fmt, pairs[i].dst_channels, 44100);
+     SDLTest_AssertCheck(result == 1, "Verify SDL_BuildAudioCVT() result; expected: 1, got: %i", result);
+     result = SDL_BuildAudioCVT(&first, pairs[i].src_fmt, pairs[i].src_channels, 44100,
+                                pairs[i].dst_fmt, pairs[i].dst_channels, 44100);
+     SDLTest_AssertCheck(result == 1 && SDL_memcmp(&cvt, &first, sizeof (cvt)) == 0, "Verify building it again gives the same conversion");
+
+     /* Without the fused converter, the type is converted first */
+     SDL_BuildAudioCVT(&first, pairs[i].src_fmt, pairs[i].src_channels, 44100,
+                       pairs[i].dst_fmt, pairs[i].src_channels, 44100);
+     SDL_BuildAudioCVT(&second, pairs[i].dst_fmt, pairs[i].src_channels, 44100,
+                       pairs[i].dst_fmt, pairs[i].dst_channels, 44100);
+
+     cvt.buf = fused;
+     cvt.len = src_len;
+     result = SDL_ConvertAudio(&cvt);
+     SDLTest_AssertCheck(result == 0, "Verify SDL_ConvertAudio() result; expected: 0, got: %i", result);
+     first.buf = twopass;
+     first.len = src_len;
+     SDL_ConvertAudio(&first);
+     second.buf = twopass;
+     second.len = first.len_cvt;
+     SDL_ConvertAudio(&second);
+     SDLTest_AssertCheck(cvt.len_cvt == second.len_cvt, "Verify converted length; expected: %i, got: %i", second.len_cvt, cvt.len_cvt);
+     SDLTest_AssertCheck(SDL_memcmp(fused, twopass, second.len_cvt) == 0, "Verify samples for %i channel 0x%x to %i channel 0x%x",
+       pairs[i].src_channels, pairs[i].src_fmt, pairs[i].dst_channels, pairs[i].dst_fmt);
+   }
+
+   SDL_free(fused);
+   SDL_free(twopass);
+   return TEST_COMPLETED;
+}
+
+/**
+ * \brief Remix channels with a matrix, converting the sample type as well
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_RemixAudio
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_BuildAudioCVT
+ */
+int audio_remixAudio()
+{
+   const float difference[] = { 1.0f, -1.0f };
+   const int frames = 37;      /* not a whole number of vectors */
+   Sint16 stereo[37 * 2];
+   float mono[37];
+   float clip[37];
+   Sint16 clipped[37];
+   Uint8 *buf;
+   SDL_AudioCVT cvt;
+   int i, result, errors;
+
+   SDL_zero(stereo);
+
+   /* Invalid parameters */
+   result = SDL_RemixAudio(AUDIO_U8, 1, stereo, AUDIO_S16SYS, 2, stereo, NULL, 1);
+   SDLTest_AssertCheck(result == -1, "Verify unsupported format fails; got: %i", result);
+   result = SDL_RemixAudio(AUDIO_S16SYS, 0, stereo, AUDIO_S16SYS, 2, stereo, NULL, 1);
+   SDLTest_AssertCheck(result == -1, "Verify zero channels fails; got: %i", result);
+   result = SDL_RemixAudio(AUDIO_S16SYS, 9, stereo, AUDIO_S16SYS, 2, stereo, NULL, 1);
+   SDLTest_AssertCheck(result == -1, "Verify 9 channels fails; got: %i", result);
+   result = SDL_RemixAudio(AUDIO_S16SYS, 3, stereo, AUDIO_S16SYS, 5, stereo, NULL, 1);
+   SDLTest_AssertCheck(result == -1, "Verify missing default matrix fails; got: %i", result);
+
+   /* Custom matrix, S16 stereo to F32 mono */
+   for (i = 0; i < frames; i++) {
+     stereo[i * 2] = (Sint16)(i * 800);
+     stereo[i * 2 + 1] = (Sint16)(-i * 100);
+   }
+   result = SDL_RemixAudio(AUDIO_S16SYS, 2, stereo, AUDIO_F32SYS, 1, mono, difference, frames);
+   SDLTest_AssertCheck(result == 0, "Verify SDL_RemixAudio() result; expected: 0, got: %i", result);
+   errors = 0;
+   for (i = 0; i < frames; i++) {
+     if (SDL_fabs(mono[i] - (i * 900) / 32767.0) > 1e-5) {
+       errors++;
+     }
+   }
+   SDLTest_AssertCheck(errors == 0, "Verify left minus right; got %i wrong samples", errors);
+
+   /* F32 to S16 is clipped */
+   for (i = 0; i < frames; i++) {
+     clip[i] = (i & 1) ? 1.5f : -1.5f;
+   }
+   SDL_RemixAudio(AUDIO_F32SYS, 1, clip, AUDIO_S16SYS, 1, clipped, difference, frames);
+   errors = 0;
+   for (i = 0; i < frames; i++) {
+     if (clipped[i] != ((i & 1) ? 32767 : -32768)) {
+       errors++;
+     }
+   }
+   SDLTest_AssertCheck(errors == 0, "Verify clipping; got %i wrong samples", errors);
+
+   /* Default stereo to 5.1 upmix, in place */
+   buf = (Uint8 *)SDL_malloc(frames * 6 * sizeof (float));
+   SDLTest_AssertCheck(buf != NULL, "Check buffer is not NULL");
+   if (buf == NULL) {
+     return TEST_ABORTED;
+   }
+   SDL_memcpy(buf, stereo, sizeof (stereo));
+   result = SDL_RemixAudio(AUDIO_S16SYS, 2, buf, AUDIO_F32SYS, 6, buf, NULL, frames);
+   SDLTest_AssertCheck(result == 0, "Verify in place SDL_RemixAudio() result; expected: 0, got: %i", result);
+   errors = 0;
+   for (i = 0; i < frames; i++) {
+     const float *frame = (const float *)buf + i * 6;
+     if ((SDL_fabs(frame[0] - stereo[i * 2] / 32767.0) > 1e-5) ||
+         (SDL_fabs(frame[1] - stereo[i * 2 + 1] / 32767.0) > 1e-5) ||
+         (frame[2] != 0.0f) || (frame[3] != 0.0f) || (frame[4] != 0.0f) || (frame[5] != 0.0f)) {
+       errors++;
+     }
+   }
+   SDLTest_AssertCheck(errors == 0, "Verify stereo lands on the front channels; got %i wrong frames", errors);
+
+   /* 5.1 to stereo through SDL_BuildAudioCVT folds in the center, not the LFE */
+   result = SDL_BuildAudioCVT(&cvt, AUDIO_S16SYS, 6, 48000, AUDIO_S16SYS, 2, 48000);
+   SDLTest_AssertCheck(result == 1, "Verify SDL_BuildAudioCVT() result; expected: 1, got: %i", result);
+   for (i = 0; i < frames * 6; i++) {
+     ((Sint16 *)buf)[i] = ((i % 6) == 2) ? 10000 : (((i % 6) == 3) ? 30000 : 0);
+   }
+   cvt.buf = buf;
+   cvt.len = frames * 6 * sizeof (Sint16);
+   result = SDL_ConvertAudio(&cvt);
+   SDLTest_AssertCheck(result == 0, "Verify SDL_ConvertAudio() result; expected: 0, got: %i", result);
+   SDLTest_AssertCheck(cvt.len_cvt == frames * 2 * (int)sizeof (Sint16), "Verify converted length; got: %i", cvt.len_cvt);
+   errors = 0;
+   for (i = 0; i < frames * 2; i++) {
+     if (((Sint16 *)buf)[i] != 2928) {
+       errors++;
+     }
+   }
+   SDLTest_AssertCheck(errors == 0, "Verify center at -3dB, scaled; got %i wrong samples, first %i", errors, ((Sint16 *)buf)[0]);
+
+   SDL_free(buf);
+   return TEST_COMPLETED;
+}
+
+/**
+ * \brief Mix several voices through an audio bus
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_NewAudioBus
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_AudioBusMix
+ */
+int audio_audioBus()
+{
+   SDL_AudioBus *bus;
+   Sint16 voice[2048], output[2048];
+   float fvoice[1024];
+   int a, b, c, result, i, matches;
+
+   bus = SDL_NewAudioBus(AUDIO_S16SYS, 2, 44100);
+   SDLTest_AssertPass("Call to SDL_NewAudioBus()");
+   SDLTest_AssertCheck(bus != NULL, "Verify bus is not NULL");
+   if (bus == NULL) return TEST_ABORTED;
+
+   /* Three loud voices; only the final sum may clip */
+   for (i = 0; i < SDL_arraysize(voice); i++) {
+     voice[i] = 30000;
+   }
+   a = SDL_AudioBusAddVoice(bus, AUDIO_S16SYS, 2, 44100);
+   b = SDL_AudioBusAddVoice(bus, AUDIO_S16SYS, 2, 44100);
+   SDLTest_AssertCheck(a >= 0 && b >= 0 && a != b, "Verify voice indices; got: %i, %i", a, b);
+   for (i = 0; i < SDL_arraysize(fvoice); i++) {
+     fvoice[i] = -30000.0f / 32767.0f;
+   }
+   c = SDL_AudioBusAddVoice(bus, AUDIO_F32SYS, 1, 44100);
+   SDLTest_AssertCheck(c >= 0, "Verify voice index; got: %i", c);
+   if (a < 0 || b < 0 || c < 0) {
+     SDL_FreeAudioBus(bus);
+     return TEST_ABORTED;
+   }
+
+   SDL_AudioBusPutVoice(bus, a, voice, sizeof(voice));
+   SDL_AudioBusPutVoice(bus, b, voice, sizeof(voice));
+   SDL_AudioBusPutVoice(bus, c, fvoice, sizeof(fvoice));
+   result = SDL_AudioBusVoiceAvailable(bus, c);
+   SDLTest_AssertCheck(result == sizeof(output), "Verify voice available; expected: %i, got: %i", (int)sizeof(output), result);
+
+   result = SDL_AudioBusMix(bus, output, sizeof(output), SDL_FALSE);
+   SDLTest_AssertPass("Call to SDL_AudioBusMix()");
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   matches = 1;
+   for (i = 0; i < SDL_arraysize(output); i++) {
+     if (output[i] < 29999 || output[i] > 30001) matches = 0;
+   }
+   SDLTest_AssertCheck(matches, "Verify 30000 + 30000 - 30000 mixes to 30000, got: %i", output[0]);
+
+   /* Final clipping, gain and pan */
+   SDL_AudioBusRemoveVoice(bus, c);
+   result = SDL_AudioBusPutVoice(bus, c, fvoice, sizeof(fvoice));
+   SDLTest_AssertCheck(result == -1, "Verify removed voice can't be used; expected: -1, got: %i", result);
+   SDL_AudioBusPutVoice(bus, a, voice, sizeof(voice));
+   SDL_AudioBusPutVoice(bus, b, voice, sizeof(voice));
+   SDL_AudioBusMix(bus, output, sizeof(output), SDL_FALSE);
+   SDLTest_AssertCheck(output[0] == 32767 && output[1] == 32767, "Verify sum clips to 32767, got: %i, %i", output[0], output[1]);
+
+   SDL_AudioBusSetVoiceGain(bus, a, 0.5f, -1.0f);
+   SDL_AudioBusSetVoiceGain(bus, b, 0.5f, -1.0f);
+   SDL_AudioBusPutVoice(bus, a, voice, sizeof(voice));
+   SDL_AudioBusPutVoice(bus, b, voice, sizeof(voice));
+   SDL_AudioBusMix(bus, output, sizeof(output), SDL_TRUE);
+   matches = 1;
+   for (i = 0; i < SDL_arraysize(output); i += 2) {
+     if (output[i] < 29999 || output[i] > 30001 || output[i + 1] < -1 || output[i + 1] > 1) matches = 0;
+   }
+   SDLTest_AssertCheck(matches, "Verify panned, dithered mix is within 1 LSB; got: %i, %i", output[0], output[1]);
+
+   /* Everything was consumed, so the bus is silent now */
+   SDL_AudioBusMix(bus, output, sizeof(output), SDL_FALSE);
+   SDLTest_AssertCheck(output[0] == 0 && output[SDL_arraysize(output) - 1] == 0, "Verify silence after voices run dry");
+
+   SDL_FreeAudioBus(bus);
+   SDLTest_AssertPass("Call to SDL_FreeAudioBus()");
+
+   return TEST_COMPLETED;
+}
+
+/* Callback that fills the buffer with a ramp */
+void SDLCALL _audio_rampCallback(void *userdata, Uint8 *stream, int len)
+{
+   int *calls = (int *)userdata;
+   int i;
+   for (i = 0; i < len; i++) {
+     stream[i] = (Uint8)i;
+   }
+   (*calls)++;
+}
+
+/**
+ * \brief Render to a WAV file with the disk driver, faster than real time
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_AudioInit
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_LoadWAV
+ */
+int audio_diskAudioWave()
+{
+   const char *filename = "sdl_audio_disk_test.wav";
+   SDL_AudioSpec desired, obtained, loaded;
+   Uint8 *data = NULL;
+   Uint32 len = 0;
+   int calls = 0;
+   Uint32 start, elapsed;
+   int result;
+
+   /* SDL_AudioInit() shuts down the running driver first */
+   SDL_setenv("SDL_DISKAUDIOFILE", filename, 1);
+   SDL_setenv("SDL_DISKAUDIOFREEWHEEL", "1", 1);
+   result = SDL_AudioInit("disk");
+   SDLTest_AssertPass("Call to SDL_AudioInit('disk')");
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   if (result != 0) {
+     SDL_setenv("SDL_DISKAUDIOFREEWHEEL", "0", 1);
+     SDL_AudioInit(NULL);
+     return TEST_ABORTED;
+   }
+
+   SDL_zero(desired);
+   desired.freq = 8000;
+   desired.format = AUDIO_S16MSB;
+   desired.channels = 2;
+   desired.samples = 512;
+   desired.callback = _audio_rampCallback;
+   desired.userdata = &calls;
+   result = SDL_OpenAudio(&desired, &obtained);
+   SDLTest_AssertCheck(result == 0, "Verify SDL_OpenAudio() result; expected: 0, got: %i", result);
+   if (result == 0) {
+     SDLTest_AssertCheck(obtained.format == AUDIO_S16LSB, "Verify WAV output is little endian; expected: AUDIO_S16LSB, got: 0x%x", obtained.format);
+     /* In real time, each buffer at this rate lasts 64 ms */
+     start = SDL_GetTicks();
+     SDL_PauseAudio(0);
+     while ((calls < 8) && ((SDL_GetTicks() - start) < 5000)) {
+       SDL_Delay(1);
+     }
+     SDL_PauseAudio(1);
+     elapsed = SDL_GetTicks() - start;
+     SDL_CloseAudio();
+     SDLTest_AssertCheck(calls >= 8 && elapsed < 8 * 64, "Verify freewheeling runs faster than real time; got %i callbacks in %i ms", calls, (int)elapsed);
+   }
+   SDL_setenv("SDL_DISKAUDIOFREEWHEEL", "0", 1);
+
+   if (SDL_LoadWAV(filename, &loaded, &data, &len) != NULL) {
+     SDLTest_AssertPass("Call to SDL_LoadWAV()");
+     SDLTest_AssertCheck(loaded.freq == 8000 && loaded.channels == 2 && loaded.format == AUDIO_S16LSB,
+         "Verify WAV header; got %i Hz, %i channels, format 0x%x", loaded.freq, loaded.channels, loaded.format);
+     SDLTest_AssertCheck(len > 0 && (len % (512 * 4)) == 0, "Verify WAV holds whole buffers; got %i bytes", (int)len);
+     SDL_FreeWAV(data);
+   } else {
+     SDLTest_AssertCheck(0, "Verify SDL_LoadWAV() reads the file back: %s", SDL_GetError());
+   }
+   remove(filename);
+
+   SDL_AudioInit(NULL);
+   return TEST_COMPLETED;
+}
+
+
+/* Output callback that fills each buffer with its own sequence number */
+void SDLCALL _audio_sequenceCallback(void *userdata, Uint8 *stream, int len)
+{
+   int *calls = (int *)userdata;
+   (*calls)++;
+   SDL_memset(stream, (Uint8)*calls, len);
+}
+
+typedef struct
+{
+   SDL_AudioDeviceID id;
+   int buffers;         /* non-silent buffers received */
+   int ordered;         /* every buffer uniform and in sequence */
+   int last;
+   Uint64 timestamp;
+   Uint64 latency;
+} _audio_captureState;
+
+/* Capture callback that checks the sequence played on the loopback */
+void SDLCALL _audio_captureCallback(void *userdata, Uint8 *stream, int len)
+{
+   _audio_captureState *state = (_audio_captureState *)userdata;
+   int i;
+   if (stream[0] == 0) {
+     return;
+   }
+   for (i = 1; i < len; i++) {
+     if (stream[i] != stream[0]) state->ordered = 0;
+   }
+   if (stream[0] <= state->last) state->ordered = 0;
+   state->last = stream[0];
+   state->timestamp = SDL_GetAudioDeviceTimestamp(state->id);
+   state->latency = SDL_GetPerformanceCounter() - state->timestamp;
+   state->buffers++;
+}
+
+/**
+ * \brief Play on the loopback output device and record it on the capture device
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_OpenAudioDevice
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_GetAudioDeviceTimestamp
+ */
+int audio_loopbackCapture()
+{
+   SDL_AudioSpec desired, obtained;
+   SDL_AudioDeviceID output;
+   _audio_captureState state;
+   int calls = 0;
+   Uint32 start;
+   Uint64 now;
+   int result;
+
+   result = SDL_AudioInit("loopback");
+   SDLTest_AssertPass("Call to SDL_AudioInit('loopback')");
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   if (result != 0) {
+     SDL_AudioInit(NULL);
+     return TEST_ABORTED;
+   }
+
+   SDL_zero(desired);
+   desired.freq = 8000;
+   desired.format = AUDIO_S16SYS;
+   desired.channels = 2;
+   desired.samples = 256;
+   desired.callback = _audio_sequenceCallback;
+   desired.userdata = &calls;
+   output = SDL_OpenAudioDevice(NULL, 0, &desired, &obtained, 0);
+   SDLTest_AssertCheck(output > 0, "Verify output device opened; got: %i", (int)output);
+
+   SDL_zero(state);
+   state.ordered = 1;
+   desired.callback = _audio_captureCallback;
+   desired.userdata = &state;
+   state.id = SDL_OpenAudioDevice(NULL, 1, &desired, &obtained, 0);
+   SDLTest_AssertCheck(state.id > 0, "Verify capture device opened; got: %i", (int)state.id);
+
+   if (output > 0 && state.id > 0) {
+     SDLTest_AssertCheck(SDL_GetAudioDeviceTimestamp(state.id) == 0, "Verify no timestamp before capturing");
+     SDL_PauseAudioDevice(state.id, 0);
+     SDL_PauseAudioDevice(output, 0);
+     start = SDL_GetTicks();
+     while ((state.buffers < 4) && ((SDL_GetTicks() - start) < 5000)) {
+       SDL_Delay(10);
+     }
+     SDL_PauseAudioDevice(output, 1);
+     SDL_PauseAudioDevice(state.id, 1);
+
+     now = SDL_GetPerformanceCounter();
+     SDLTest_AssertCheck(state.buffers >= 4, "Verify captured buffers; expected: >= 4, got: %i", state.buffers);
+     SDLTest_AssertCheck(state.ordered, "Verify captured buffers match what was played, in order");
+     SDLTest_AssertCheck(state.timestamp != 0 && state.timestamp <= now, "Verify capture timestamp is in the past");
+     SDLTest_AssertCheck(SDL_GetAudioDeviceTimestamp(output) != 0, "Verify output device has a timestamp");
+     SDLTest_AssertCheck(state.latency < SDL_GetPerformanceFrequency(), "Verify round-trip latency is under a second; got %i ms",
+         (int)((state.latency * 1000) / SDL_GetPerformanceFrequency()));
+   }
+
+   if (state.id > 0) {
+     SDL_CloseAudioDevice(state.id);
+   }
+   if (output > 0) {
+     SDL_CloseAudioDevice(output);
+   }
+
+   SDL_AudioInit(NULL);
+   return TEST_COMPLETED;
+}
+
+
+/* Callback that runs long on its first call */
+void SDLCALL _audio_slowCallback(void *userdata, Uint8 *stream, int len)
+{
+   int *calls = (int *)userdata;
+   if ((*calls)++ == 0) {
+     SDL_Delay(50);
+   }
+   SDL_memset(stream, 0, len);
+}
+
+/**
+ * \brief Checks the per-device counters kept by the audio thread
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_GetAudioDeviceStats
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_ResetAudioDeviceStats
+ */
+int audio_audioDeviceStats()
+{
+   SDL_AudioSpec desired, obtained;
+   SDL_AudioDeviceStats stats;
+   SDL_AudioDeviceID id;
+   Uint32 start, total;
+   int calls = 0;
+   int result;
+   int i;
+
+   result = SDL_AudioInit("loopback");
+   SDLTest_AssertPass("Call to SDL_AudioInit('loopback')");
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   if (result != 0) {
+     SDL_AudioInit(NULL);
+     return TEST_ABORTED;
+   }
+
+   /* Each buffer lasts 32 ms */
+   SDL_zero(desired);
+   desired.freq = 8000;
+   desired.format = AUDIO_S16SYS;
+   desired.channels = 2;
+   desired.samples = 256;
+   desired.callback = _audio_slowCallback;
+   desired.userdata = &calls;
+   id = SDL_OpenAudioDevice(NULL, 0, &desired, &obtained, 0);
+   SDLTest_AssertCheck(id > 0, "Verify device opened; got: %i", (int)id);
+   if (id == 0) {
+     SDL_AudioInit(NULL);
+     return TEST_ABORTED;
+   }
+
+   result = SDL_GetAudioDeviceStats(id, NULL);
+   SDLTest_AssertCheck(result == -1, "Verify NULL stats is rejected; expected: -1, got: %i", result);
+   result = SDL_GetAudioDeviceStats(id + 1, &stats);
+   SDLTest_AssertCheck(result == -1, "Verify invalid device is rejected; expected: -1, got: %i", result);
+
+   SDL_PauseAudioDevice(id, 0);
+   start = SDL_GetTicks();
+   do {
+     SDL_Delay(10);
+     SDL_GetAudioDeviceStats(id, &stats);
+   } while ((stats.periods < 4) && ((SDL_GetTicks() - start) < 5000));
+   SDL_PauseAudioDevice(id, 1);
+   SDL_Delay(100);  /* let the period in flight finish */
+
+   result = SDL_GetAudioDeviceStats(id, &stats);
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   SDLTest_AssertCheck(stats.periods >= 4, "Verify periods were counted; got: %i", (int)stats.periods);
+   SDLTest_AssertCheck(stats.callbacks >= stats.periods, "Verify a callback per period; got %i callbacks for %i periods", (int)stats.callbacks, (int)stats.periods);
+   total = 0;
+   for (i = 0; i < SDL_AUDIO_HISTOGRAM_BUCKETS; i++) {
+     total += stats.callback_histogram[i];
+   }
+   SDLTest_AssertCheck(total == stats.callbacks, "Verify histogram covers every callback; expected: %i, got: %i", (int)stats.callbacks, (int)total);
+   SDLTest_AssertCheck(stats.late_callbacks >= 1, "Verify the slow callback was late; got: %i", (int)stats.late_callbacks);
+   SDLTest_AssertCheck(stats.callback_max_us >= 32000, "Verify longest callback; expected: >= 32000 us, got: %i us", (int)stats.callback_max_us);
+   SDLTest_AssertCheck(stats.callback_us >= stats.callback_max_us, "Verify total callback time includes the longest");
+   SDLTest_AssertCheck(stats.wait_us >= stats.wait_min_us, "Verify total wait includes the shortest");
+   SDLTest_AssertCheck(stats.fake_buffers == 0, "Verify no buffers were lost; got: %i", (int)stats.fake_buffers);
+
+   SDL_ResetAudioDeviceStats(id);
+   SDL_GetAudioDeviceStats(id, &stats);
+   SDLTest_AssertCheck(stats.periods == 0 && stats.callbacks == 0 && stats.callback_max_us == 0 && stats.wait_min_us == 0,
+       "Verify counters were reset");
+
+   SDL_CloseAudioDevice(id);
+   SDL_AudioInit(NULL);
+   return TEST_COMPLETED;
+}
+
+
+/* Counts callbacks and remembers when the first one ran */
+typedef struct
+{
+   SDL_atomic_t calls;
+   Uint64 first;
+} _audio_callbackTimes;
+
+void SDLCALL _audio_timedCallback(void *userdata, Uint8 *stream, int len)
+{
+   _audio_callbackTimes *times = (_audio_callbackTimes *)userdata;
+   if (SDL_AtomicGet(&times->calls) == 0) {
+     times->first = SDL_GetPerformanceCounter();
+   }
+   SDL_AtomicIncRef(&times->calls);
+   SDL_memset(stream, 0, len);
+}
+
+/**
+ * \brief Resuming and closing a paused device doesn't wait out a period
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_PauseAudioDevice
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_CloseAudioDevice
+ */
+int audio_pauseResumeLatency()
+{
+   SDL_AudioSpec desired, obtained;
+   SDL_AudioDeviceID id;
+   _audio_callbackTimes times;
+   Uint64 resumed, closing;
+   Uint32 start;
+   double latency;
+   int calls;
+   int result;
+
+   result = SDL_AudioInit("loopback");
+   SDLTest_AssertPass("Call to SDL_AudioInit('loopback')");
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   if (result != 0) {
+     SDL_AudioInit(NULL);
+     return TEST_ABORTED;
+   }
+
+   /* Each buffer lasts 371 ms, far longer than a wakeup should take */
+   SDL_zero(times);
+   SDL_zero(desired);
+   desired.freq = 11025;
+   desired.format = AUDIO_S16SYS;
+   desired.channels = 1;
+   desired.samples = 4096;
+   desired.callback = _audio_timedCallback;
+   desired.userdata = &times;
+   id = SDL_OpenAudioDevice(NULL, 0, &desired, &obtained, 0);
+   SDLTest_AssertCheck(id > 0, "Verify device opened; got: %i", (int)id);
+   if (id == 0) {
+     SDL_AudioInit(NULL);
+     return TEST_ABORTED;
+   }
+
+   /* Let the audio thread settle into its paused wait */
+   SDL_Delay(100);
+   SDLTest_AssertCheck(SDL_AtomicGet(&times.calls) == 0, "Verify no callbacks while paused; got: %i", SDL_AtomicGet(&times.calls));
+
+   resumed = SDL_GetPerformanceCounter();
+   SDL_PauseAudioDevice(id, 0);
+   start = SDL_GetTicks();
+   while ((SDL_AtomicGet(&times.calls) == 0) && ((SDL_GetTicks() - start) < 5000)) {
+     SDL_Delay(1);
+   }
+   SDLTest_AssertCheck(SDL_AtomicGet(&times.calls) > 0, "Verify the callback ran after resuming");
+   latency = (double)(times.first - resumed) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+   SDLTest_Log("Resume latency: %.3f ms", latency);
+   SDLTest_AssertCheck(latency < 100.0, "Verify resume latency; expected: < 100 ms, got: %.3f ms", latency);
+
+   /* Paused again, the thread stays asleep */
+   SDL_PauseAudioDevice(id, 1);
+   SDL_Delay(500);     /* let the period in flight finish */
+   calls = SDL_AtomicGet(&times.calls);
+   SDL_Delay(500);
+   SDLTest_AssertCheck(SDL_AtomicGet(&times.calls) == calls, "Verify no callbacks while paused; expected: %i, got: %i", calls, SDL_AtomicGet(&times.calls));
+
+   closing = SDL_GetPerformanceCounter();
+   SDL_CloseAudioDevice(id);
+   latency = (double)(SDL_GetPerformanceCounter() - closing) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+   SDLTest_Log("Close latency: %.3f ms", latency);
+   SDLTest_AssertCheck(latency < 100.0, "Verify closing a paused device; expected: < 100 ms, got: %.3f ms", latency);
+
+   SDL_AudioInit(NULL);
+   return TEST_COMPLETED;
+}
+
+/* Remembers which threads ran the callback of one device */
+typedef struct
+{
+   SDL_atomic_t calls;
+   SDL_threadID threads[8];
+   int numthreads;
+   Uint32 delay;     /* ms the callback takes, to play a slow device */
+} _audio_threadLog;
+
+void SDLCALL _audio_threadCallback(void *userdata, Uint8 *stream, int len)
+{
+   _audio_threadLog *log = (_audio_threadLog *)userdata;
+   const SDL_threadID self = SDL_ThreadID();
+   int i;
+   for (i = 0; i < log->numthreads; i++) {
+     if (log->threads[i] == self) {
+       break;
+     }
+   }
+   if ((i == log->numthreads) && (i < SDL_arraysize(log->threads))) {
+     log->threads[log->numthreads++] = self;
+   }
+   SDL_AtomicIncRef(&log->calls);
+   SDL_memset(stream, 0, len);
+   if (log->delay) {
+     SDL_Delay(log->delay);
+   }
+}
+
+/**
+ * \brief Several devices fed by the shared scheduler keep time on two threads
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_OpenAudioDevice
+ */
+int audio_sharedScheduler()
+{
+   const int numdevices = 6;
+   SDL_AudioSpec desired, obtained;
+   SDL_AudioDeviceID ids[6];
+   _audio_threadLog logs[6];
+   SDL_threadID threads[16];
+   char filename[64];
+   int numthreads = 0;
+   int calls;
+   int i, j, k;
+   int result;
+
+   SDL_SetHint(SDL_HINT_AUDIO_SHARED_THREADS, "2");
+   result = SDL_AudioInit("disk");
+   SDLTest_AssertPass("Call to SDL_AudioInit('disk')");
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   if (result != 0) {
+     SDL_SetHint(SDL_HINT_AUDIO_SHARED_THREADS, "0");
+     SDL_AudioInit(NULL);
+     return TEST_ABORTED;
+   }
+
+   /* Each buffer lasts 32 ms, so 400 ms is about 12 of them per device */
+   SDL_zero(logs);
+   SDL_zero(desired);
+   desired.freq = 8000;
+   desired.format = AUDIO_S16SYS;
+   desired.channels = 1;
+   desired.samples = 256;
+   desired.callback = _audio_threadCallback;
+   for (i = 0; i < numdevices; i++) {
+     SDL_snprintf(filename, sizeof(filename), "sdl_audio_sched_test%d.raw", i);
+     desired.userdata = &logs[i];
+     ids[i] = SDL_OpenAudioDevice(filename, 0, &desired, &obtained, 0);
+     SDLTest_AssertCheck(ids[i] > 0, "Verify device %i opened; got: %i", i, (int)ids[i]);
+   }
+   for (i = 0; i < numdevices; i++) {
+     if (ids[i] > 0) {
+       SDL_PauseAudioDevice(ids[i], 0);
+     }
+   }
+   SDL_Delay(400);
+   for (i = 0; i < numdevices; i++) {
+     if (ids[i] > 0) {
+       SDL_CloseAudioDevice(ids[i]);
+     }
+   }
+
+   for (i = 0; i < numdevices; i++) {
+     if (ids[i] == 0) {
+       continue;
+     }
+     calls = SDL_AtomicGet(&logs[i].calls);
+     SDLTest_AssertCheck(calls >= 4 && calls <= 20, "Verify device %i keeps real time; expected: 4 to 20 callbacks, got: %i", i, calls);
+     for (j = 0; j < logs[i].numthreads; j++) {
+       for (k = 0; k < numthreads; k++) {
+         if (threads[k] == logs[i].threads[j]) {
+           break;
+         }
+       }
+       if ((k == numthreads) && (k < SDL_arraysize(threads))) {
+         threads[numthreads++] = logs[i].threads[j];
+       }
+     }
+   }
+   SDLTest_AssertCheck(numthreads >= 1 && numthreads <= 2, "Verify callbacks ran on the shared threads; expected: 1 or 2, got: %i", numthreads);
+
+   for (i = 0; i < numdevices; i++) {
+     SDL_snprintf(filename, sizeof(filename), "sdl_audio_sched_test%d.raw", i);
+     remove(filename);
+   }
+
+   SDL_SetHint(SDL_HINT_AUDIO_SHARED_THREADS, "0");
+   SDL_AudioInit(NULL);
+   return TEST_COMPLETED;
+}
+
+/**
+ * \brief A slow callback on the shared scheduler only holds up its own device
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_OpenAudioDevice
+ */
+int audio_sharedSchedulerSlowDevice()
+{
+   const int numdevices = 3;
+   SDL_AudioSpec desired, obtained;
+   SDL_AudioDeviceID ids[3];
+   _audio_threadLog logs[3];
+   char filename[64];
+   int calls;
+   int i;
+   int result;
+
+   SDL_SetHint(SDL_HINT_AUDIO_SHARED_THREADS, "3");
+   result = SDL_AudioInit("disk");
+   SDLTest_AssertPass("Call to SDL_AudioInit('disk')");
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %i", result);
+   if (result != 0) {
+     SDL_SetHint(SDL_HINT_AUDIO_SHARED_THREADS, "0");
+     SDL_AudioInit(NULL);
+     return TEST_ABORTED;
+   }
+
+   /* Device 0 takes 200 ms per 32 ms buffer; the others have to keep up */
+   SDL_zero(logs);
+   logs[0].delay = 200;
+   SDL_zero(desired);
+   desired.freq = 8000;
+   desired.format = AUDIO_S16SYS;
+   desired.channels = 1;
+   desired.samples = 256;
+   desired.callback = _audio_threadCallback;
+   for (i = 0; i < numdevices; i++) {
+     SDL_snprintf(filename, sizeof(filename), "sdl_audio_slow_test%d.raw", i);
+     desired.userdata = &logs[i];
+     ids[i] = SDL_OpenAudioDevice(filename, 0, &desired, &obtained, 0);
+     SDLTest_AssertCheck(ids[i] > 0, "Verify device %i opened; got: %i", i, (int)ids[i]);
+   }
+   for (i = 0; i < numdevices; i++) {
+     if (ids[i] > 0) {
+       SDL_PauseAudioDevice(ids[i], 0);
+     }
+   }
+   SDL_Delay(400);
+   for (i = 0; i < numdevices; i++) {
+     if (ids[i] > 0) {
+       SDL_CloseAudioDevice(ids[i]);
+     }
+   }
+
+   for (i = 1; i < numdevices; i++) {
+     if (ids[i] == 0) {
+       continue;
+     }
+     calls = SDL_AtomicGet(&logs[i].calls);
+     SDLTest_AssertCheck(calls >= 6, "Verify device %i isn't held up by the slow one; expected: at least 6 callbacks, got: %i", i, calls);
+   }
+
+   for (i = 0; i < numdevices; i++) {
+     SDL_snprintf(filename, sizeof(filename), "sdl_audio_slow_test%d.raw", i);
+     remove(filename);
+   }
+
+   SDL_SetHint(SDL_HINT_AUDIO_SHARED_THREADS, "0");
+   SDL_AudioInit(NULL);
+   return TEST_COMPLETED;
+}
+
+/* Append a little endian value to a buffer being built */
+static Uint8 *_audio_putLE(Uint8 *dst, Uint32 value, int bytes)
+{
+   int i;
+   for (i = 0; i < bytes; i++) {
+     *dst++ = (Uint8)(value >> (8 * i));
+   }
+   return dst;
+}
+
+/* Build a WAVE file in (dst) around (datalen) bytes of data, returns its length */
+static int _audio_buildWave(Uint8 *dst, Uint16 encoding, Uint16 channels, Uint16 blockalign, Uint16 bits, Uint16 samplesperblock, const Uint8 *data, Uint32 datalen)
+{
+   Uint8 *p = dst;
+   const Uint32 fmtlen = (encoding == 1) ? 16 : 20;
+   p = _audio_putLE(p, 0x46464952, 4);  /* "RIFF" */
+   p = _audio_putLE(p, 4 + 8 + fmtlen + 12 + 8 + datalen, 4);
+   p = _audio_putLE(p, 0x45564157, 4);  /* "WAVE" */
+   p = _audio_putLE(p, 0x20746D66, 4);  /* "fmt " */
+   p = _audio_putLE(p, fmtlen, 4);
+   p = _audio_putLE(p, encoding, 2);
+   p = _audio_putLE(p, channels, 2);
+   p = _audio_putLE(p, 8000, 4);
+   p = _audio_putLE(p, 8000 * blockalign, 4);
+   p = _audio_putLE(p, blockalign, 2);
+   p = _audio_putLE(p, bits, 2);
+   if (encoding != 1) {
+     p = _audio_putLE(p, 2, 2);
+     p = _audio_putLE(p, samplesperblock, 2);
+   }
+   p = _audio_putLE(p, 0x5453494c, 4);  /* "LIST", skipped by the reader */
+   p = _audio_putLE(p, 4, 4);
+   p = _audio_putLE(p, 0, 4);
+   p = _audio_putLE(p, 0x61746164, 4);  /* "data" */
+   p = _audio_putLE(p, datalen, 4);
+   SDL_memcpy(p, data, datalen);
+   return (int)(p - dst) + datalen;
+}
+
+/**
+ * \brief Reads PCM and IMA ADPCM WAVE data incrementally
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_OpenWAVReader
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_LoadWAV_RW
+ */
+int audio_wavReader()
+{
+   Uint8 data[2000];
+   Uint8 file[2100];
+   Uint8 *bigdata, *bigfile;
+   Sint16 frames[400];
+   Sint16 *all;
+   SDL_AudioSpec spec;
+   SDL_WAVReader *reader;
+   const Sint16 *mapped;
+   Uint8 *loaded;
+   Uint32 loadedlen;
+   int filelen, got, total, n, i, matches;
+
+   /* 16-bit stereo PCM: 500 frames counting up */
+   for (i = 0; i < 1000; i++) {
+     _audio_putLE(data + 2 * i, (Uint16)i, 2);
+   }
+   filelen = _audio_buildWave(file, 1, 2, 4, 16, 0, data, 2000);
+
+   reader = SDL_OpenWAVReader(SDL_RWFromConstMem(file, filelen), 1, &spec);
+   SDLTest_AssertPass("Call to SDL_OpenWAVReader()");
+   SDLTest_AssertCheck(reader != NULL, "Verify reader is not NULL");
+   if (reader == NULL) {
+     return TEST_ABORTED;
+   }
+   SDLTest_AssertCheck(spec.format == AUDIO_S16 && spec.channels == 2 && spec.freq == 8000, "Verify spec; got format 0x%x, %i channels, %i Hz", spec.format, spec.channels, spec.freq);
+   SDLTest_AssertCheck(SDL_GetWAVFrames(reader) == 500, "Verify frame count; expected: 500, got: %i", (int)SDL_GetWAVFrames(reader));
+
+   got = SDL_ReadWAVFrames(reader, frames, 7);
+   SDLTest_AssertCheck(got == 7 && SDL_SwapLE16(frames[13]) == 13, "Verify first read; got %i frames", got);
+
+   /* Memory sources are handed out in place */
+   n = 100;
+   mapped = (const Sint16 *)SDL_MapWAVFrames(reader, &n);
+   SDLTest_AssertCheck(mapped != NULL && n == 100, "Verify SDL_MapWAVFrames() returns frames in place; got %i", n);
+   if (mapped != NULL) {
+     SDLTest_AssertCheck(SDL_SwapLE16(mapped[0]) == 14 && SDL_SwapLE16(mapped[199]) == 213, "Verify mapped frames follow the read ones");
+   }
+   got = SDL_ReadWAVFrames(reader, frames, 1);
+   SDLTest_AssertCheck(got == 1 && SDL_SwapLE16(frames[0]) == 214, "Verify reading continues after the mapped frames");
+
+   SDLTest_AssertCheck(SDL_SeekWAVFrame(reader, 490) == 0, "Verify seek succeeds");
+   got = SDL_ReadWAVFrames(reader, frames, 100);
+   SDLTest_AssertCheck(got == 10 && SDL_SwapLE16(frames[0]) == 980, "Verify read is clipped at the end; got %i frames", got);
+   got = SDL_ReadWAVFrames(reader, frames, 100);
+   SDLTest_AssertCheck(got == 0, "Verify end of data; expected: 0, got: %i", got);
+   SDLTest_AssertCheck(SDL_SeekWAVFrame(reader, 501) == -1, "Verify seek past the end fails");
+   SDL_CloseWAVReader(reader);
+
+   /* Two IMA ADPCM blocks of 65 mono samples; zero nibbles hold the level */
+   SDL_memset(data, 0, 72);
+   _audio_putLE(data, 1000, 2);
+   _audio_putLE(data + 36, (Uint16)-500, 2);
+   filelen = _audio_buildWave(file, 0x11, 1, 36, 4, 65, data, 72);
+
+   reader = SDL_OpenWAVReader(SDL_RWFromConstMem(file, filelen), 1, &spec);
+   SDLTest_AssertCheck(reader != NULL, "Verify IMA ADPCM reader is not NULL");
+   if (reader == NULL) {
+     return TEST_ABORTED;
+   }
+   SDLTest_AssertCheck(spec.format == AUDIO_S16 && spec.channels == 1, "Verify ADPCM decodes to 16-bit; got format 0x%x", spec.format);
+   SDLTest_AssertCheck(SDL_GetWAVFrames(reader) == 130, "Verify frame count; expected: 130, got: %i", (int)SDL_GetWAVFrames(reader));
+   n = 10;
+   SDLTest_AssertCheck(SDL_MapWAVFrames(reader, &n) == NULL && n == 0, "Verify ADPCM can't be mapped");
+
+   /* Reads that straddle the block boundary */
+   total = 0;
+   matches = 1;
+   while ((got = SDL_ReadWAVFrames(reader, frames, 40)) > 0) {
+     for (i = 0; i < got; i++) {
+       if (SDL_SwapLE16(frames[i]) != ((total + i < 65) ? 1000 : -500)) matches = 0;
+     }
+     total += got;
+   }
+   SDLTest_AssertCheck(total == 130 && matches, "Verify decoded blocks; got %i frames", total);
+
+   SDLTest_AssertCheck(SDL_SeekWAVFrame(reader, 60) == 0, "Verify ADPCM seek succeeds");
+   got = SDL_ReadWAVFrames(reader, frames, 10);
+   SDLTest_AssertCheck(got == 10 && SDL_SwapLE16(frames[4]) == 1000 && SDL_SwapLE16(frames[5]) == -500, "Verify read after seek crosses blocks");
+   SDL_CloseWAVReader(reader);
+
+   /* SDL_LoadWAV_RW() returns the same frames */
+   if (SDL_LoadWAV_RW(SDL_RWFromConstMem(file, filelen), 1, &spec, &loaded, &loadedlen) != NULL) {
+     all = (Sint16 *)loaded;
+     SDLTest_AssertCheck(loadedlen == 260 && SDL_SwapLE16(all[64]) == 1000 && SDL_SwapLE16(all[65]) == -500, "Verify SDL_LoadWAV_RW() decodes both blocks; got %i bytes", (int)loadedlen);
+     SDL_FreeWAV(loaded);
+   } else {
+     SDLTest_AssertCheck(0, "Verify SDL_LoadWAV_RW() succeeds: %s", SDL_GetError());
+   }
+
+   /* A reader needs somewhere to put the format */
+   reader = SDL_OpenWAVReader(SDL_RWFromConstMem(file, filelen), 1, NULL);
+   SDLTest_AssertCheck(reader == NULL, "Verify SDL_OpenWAVReader() refuses a NULL spec");
+
+   /* Big ADPCM reads are decoded in batches; they match block sized reads */
+   bigdata = (Uint8 *)SDL_malloc(200 * 36 + 100);
+   bigfile = (Uint8 *)SDL_malloc(200 * 36 + 200);
+   SDLTest_AssertCheck(bigdata != NULL && bigfile != NULL, "Verify buffers were allocated");
+   if (bigdata == NULL || bigfile == NULL) {
+     SDL_free(bigdata);
+     SDL_free(bigfile);
+     return TEST_ABORTED;
+   }
+   for (i = 0; i < 200 * 36; i++) {
+     bigdata[i] = (Uint8)SDLTest_RandomUint8();
+   }
+   for (i = 0; i < 200; i++) {
+     bigdata[i * 36 + 2] = (Uint8)SDLTest_RandomIntegerInRange(0, 88);
+     bigdata[i * 36 + 3] = 0;
+   }
+   filelen = _audio_buildWave(bigfile, 0x11, 1, 36, 4, 65, bigdata, 200 * 36);
+   if (SDL_LoadWAV_RW(SDL_RWFromConstMem(bigfile, filelen), 1, &spec, &loaded, &loadedlen) != NULL) {
+     all = (Sint16 *)loaded;
+     reader = SDL_OpenWAVReader(SDL_RWFromConstMem(bigfile, filelen), 1, &spec);
+     SDLTest_AssertCheck(reader != NULL, "Verify IMA ADPCM reader is not NULL");
+     total = 0;
+     matches = (loadedlen == 200 * 65 * 2);
+     while (reader != NULL && (got = SDL_ReadWAVFrames(reader, frames, 65)) > 0) {
+       if (SDL_memcmp(frames, all + total, got * 2) != 0) matches = 0;
+       total += got;
+     }
+     SDLTest_AssertCheck(total == 200 * 65 && matches, "Verify batch decoding matches block decoding; got %i frames", total);
+     SDL_CloseWAVReader(reader);
+     SDL_FreeWAV(loaded);
+   } else {
+     SDLTest_AssertCheck(0, "Verify SDL_LoadWAV_RW() succeeds: %s", SDL_GetError());
+   }
+   SDL_free(bigdata);
+   SDL_free(bigfile);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * \brief Time the common conversions and mixing and log ns/frame; the
+ *        timings aren't checked, testaudiobench does that
+ *
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_ConvertAudio
+ * \sa http://wiki.libsdl.org/moin.cgi/SDL_MixAudioFormat
+ */
+int audio_convertThroughput()
+{
+   const struct {
+     SDL_AudioFormat src_fmt; Uint8 src_channels; int src_rate;
+     SDL_AudioFormat dst_fmt; Uint8 dst_channels; int dst_rate;
+   } cases[] = {
+     { AUDIO_S16SYS, 2, 48000, AUDIO_F32SYS, 2, 48000 },
+     { AUDIO_F32SYS, 2, 48000, AUDIO_S16SYS, 2, 48000 },
+     { AUDIO_S16SYS, 6, 48000, AUDIO_S16SYS, 2, 48000 },
+     { AUDIO_F32SYS, 2, 44100, AUDIO_F32SYS, 2, 48000 },
+   };
+   const int frames = 4096;
+   const int iterations = 20;
+   const Uint64 freq = SDL_GetPerformanceFrequency();
+   SDL_AudioCVT cvt;
+   Uint8 *buffer;
+   Uint8 *mixed;
+   Uint64 ticks, start;
+   double ns;
+   int i, j, result, expected;
+
+   buffer = (Uint8 *)SDL_calloc(frames * 6 * 4, 4);
+   mixed = (Uint8 *)SDL_calloc(frames * 2, 2);
+   SDLTest_AssertCheck(buffer != NULL && mixed != NULL, "Verify buffers are not NULL");
+   if (buffer == NULL || mixed == NULL) {
+     SDL_free(buffer);
+     SDL_free(mixed);
+     return TEST_ABORTED;
+   }
+
+   for (i = 0; i < SDL_arraysize(cases); i++) {
+     result = SDL_BuildAudioCVT(&cvt, cases[i].src_fmt, cases[i].src_channels, cases[i].src_rate,
+                                cases[i].dst_fmt, cases[i].dst_channels, cases[i].dst_rate);
+     SDLTest_AssertCheck(result == 1, "Verify SDL_BuildAudioCVT() result; expected: 1, got: %i", result);
+     ticks = 0;
+     for (j = 0; j < iterations; j++) {
+       cvt.buf = buffer;
+       cvt.len = frames * cases[i].src_channels * (SDL_AUDIO_BITSIZE(cases[i].src_fmt) / 8);
+       start = SDL_GetPerformanceCounter();
+       SDL_ConvertAudio(&cvt);
+       ticks += SDL_GetPerformanceCounter() - start;
+     }
+     expected = (int)((double)frames * cases[i].dst_rate / cases[i].src_rate) *
+                cases[i].dst_channels * (SDL_AUDIO_BITSIZE(cases[i].dst_fmt) / 8);
+     SDLTest_AssertCheck(SDL_abs(cvt.len_cvt - expected) <= 16 * cases[i].dst_channels * 4,
+       "Verify converted length; expected: about %i, got: %i", expected, cvt.len_cvt);
+     ns = ((double)ticks * 1e9 / freq) / ((double)frames * iterations);
+     SDLTest_Log("%i channel 0x%x at %i to %i channel 0x%x at %i: %.3f ns/frame",
+       cases[i].src_channels, cases[i].src_fmt, cases[i].src_rate,
+       cases[i].dst_channels, cases[i].dst_fmt, cases[i].dst_rate, ns);
+   }
+
+   ticks = 0;
+   for (j = 0; j < iterations; j++) {
+     start = SDL_GetPerformanceCounter();
+     SDL_MixAudioFormat(mixed, buffer, AUDIO_S16SYS, frames * 4, SDL_MIX_MAXVOLUME / 2);
+     ticks += SDL_GetPerformanceCounter() - start;
+   }
+   ns = ((double)ticks * 1e9 / freq) / ((double)frames * iterations);
+   SDLTest_Log("Mixing 2 channel 0x%x: %.3f ns/frame", AUDIO_S16SYS, ns);
+
+   SDL_free(buffer);
+   SDL_free(mixed);
+   return TEST_COMPLETED;
+}
+
+
 /* ================= Test Case References ================== */
 
 /* Audio test cases */
@@ -708,10 +2147,58 @@ static const SDLTest_TestCaseReference audioTest10 =
 static const SDLTest_TestCaseReference audioTest11 =
 		{ (SDLTest_TestCaseFp)audio_openCloseAudioDeviceConnected, "audio_openCloseAudioDeviceConnected", "Opens and closes audio device and get connected status.", TEST_DISABLED };
 
+static const SDLTest_TestCaseReference audioTest12 =
+		{ (SDLTest_TestCaseFp)audio_resampleAudio, "audio_resampleAudio", "Resample a sine tone between common rates.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest13 =
+		{ (SDLTest_TestCaseFp)audio_audioStream, "audio_audioStream", "Convert audio in pieces through an audio stream.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest14 =
+		{ (SDLTest_TestCaseFp)audio_queueAudio, "audio_queueAudio", "Queue audio on a device without a callback.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest15 =
+		{ (SDLTest_TestCaseFp)audio_mixAudioFormat, "audio_mixAudioFormat", "Checks vector and scalar audio mixing give identical results.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest16 =
+		{ (SDLTest_TestCaseFp)audio_convertAudioTypes, "audio_convertAudioTypes", "Converts between sample types with vectorized converters.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest17 =
+		{ (SDLTest_TestCaseFp)audio_audioBus, "audio_audioBus", "Mixes several voices through an audio bus.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest18 =
+		{ (SDLTest_TestCaseFp)audio_diskAudioWave, "audio_diskAudioWave", "Renders a WAV file with the disk driver in freewheel mode.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest19 =
+		{ (SDLTest_TestCaseFp)audio_loopbackCapture, "audio_loopbackCapture", "Records what is played on the loopback driver.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest20 =
+		{ (SDLTest_TestCaseFp)audio_audioDeviceStats, "audio_audioDeviceStats", "Checks the per-device latency and underrun counters.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest21 =
+		{ (SDLTest_TestCaseFp)audio_wavReader, "audio_wavReader", "Reads PCM and ADPCM WAVE data a piece at a time.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest22 =
+		{ (SDLTest_TestCaseFp)audio_convertAudioChannels, "audio_convertAudioChannels", "Converts sample type and mono/stereo in one conversion.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest23 =
+		{ (SDLTest_TestCaseFp)audio_pauseResumeLatency, "audio_pauseResumeLatency", "Measures how fast a paused device resumes and closes.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest24 =
+		{ (SDLTest_TestCaseFp)audio_sharedScheduler, "audio_sharedScheduler", "Feeds several devices from the shared scheduler threads.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest25 =
+		{ (SDLTest_TestCaseFp)audio_remixAudio, "audio_remixAudio", "Remixes channels with a matrix and converts the sample type.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest26 =
+		{ (SDLTest_TestCaseFp)audio_convertThroughput, "audio_convertThroughput", "Times common conversions and mixing, and logs ns/frame.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest27 =
+		{ (SDLTest_TestCaseFp)audio_sharedSchedulerSlowDevice, "audio_sharedSchedulerSlowDevice", "Checks a slow device doesn't hold up the other scheduled devices.", TEST_ENABLED };
+
 /* Sequence of Audio test cases */
 static const SDLTest_TestCaseReference *audioTests[] =  {
 	&audioTest1, &audioTest2, &audioTest3, &audioTest4, &audioTest5, &audioTest6, 
-	&audioTest7, &audioTest8, &audioTest9, &audioTest10, &audioTest11, NULL
+	&audioTest7, &audioTest8, &audioTest9, &audioTest10, &audioTest11, &audioTest12, &audioTest13, &audioTest14, &audioTest15, &audioTest16, &audioTest17, &audioTest18, &audioTest19, &audioTest20, &audioTest21, &audioTest22, &audioTest23, &audioTest24, &audioTest25, &audioTest26, &audioTest27, NULL
 };
 
 /* Audio test suite (global) */
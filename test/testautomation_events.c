@@ -174,6 +174,506 @@ events_addDelEventWatchWithUserdata(void *arg)
    return TEST_COMPLETED;
 }
 
+/* Number of events each push thread sends */
+int _pushCount = 0;
+
+/* Pushes user events tagged with the thread index and a sequence number */
+int _events_pushThread(void *data)
+{
+   SDL_Event event;
+   int i;
+
+   SDL_zero(event);
+   event.type = SDL_USEREVENT;
+   event.user.code = *(int *)data;
+   for (i = 0; i < _pushCount; i++) {
+     event.user.data1 = (void *)(size_t)i;
+     while (SDL_PushEvent(&event) < 0) {
+       SDL_Delay(0);
+     }
+   }
+   return 0;
+}
+
+/* Event filter that only lets even user event codes through */
+int _events_evenCodeFilter(void *userdata, SDL_Event *event)
+{
+   return (event->type != SDL_USEREVENT) || ((event->user.code & 1) == 0);
+}
+
+/**
+ * @brief Pushes events from several threads while draining them, and checks
+ *        the queue limit and the event filter.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_PushEvent
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_PeepEvents
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_SetEventFilter
+ */
+int
+events_threadedPush(void *arg)
+{
+   SDL_Thread *threads[4];
+   int indices[4];
+   int expected[4];
+   SDL_Event events[16];
+   SDL_Event event;
+   int i, n, received, errors, pushed;
+
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   /* The queue holds 127 events and drops the rest */
+   SDL_zero(event);
+   event.type = SDL_USEREVENT;
+   pushed = 0;
+   for (i = 0; i < 200; i++) {
+     if (SDL_PushEvent(&event) == 1) pushed++;
+   }
+   SDLTest_AssertCheck(pushed == 127, "Check number of events queued, expected: 127, got: %d", pushed);
+   SDL_FlushEvent(SDL_USEREVENT);
+   n = SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, SDL_USEREVENT, SDL_USEREVENT);
+   SDLTest_AssertCheck(n == 0, "Check queue is empty after SDL_FlushEvent, got: %d", n);
+
+   /* Every thread's events arrive, in the order that thread pushed them */
+   _pushCount = 500;
+   for (i = 0; i < 4; i++) {
+     indices[i] = i;
+     expected[i] = 0;
+     threads[i] = SDL_CreateThread(_events_pushThread, "EventPush", &indices[i]);
+     SDLTest_AssertCheck(threads[i] != NULL, "Check SDL_CreateThread() result");
+   }
+   received = 0;
+   errors = 0;
+   while (received < 4 * 500) {
+     n = SDL_PeepEvents(events, 16, SDL_GETEVENT, SDL_USEREVENT, SDL_USEREVENT);
+     if (n < 0) break;
+     for (i = 0; i < n; i++) {
+       int code = events[i].user.code;
+       if (code < 0 || code >= 4 || (int)(size_t)events[i].user.data1 != expected[code]) {
+         errors++;
+       } else {
+         expected[code]++;
+       }
+     }
+     received += n;
+   }
+   for (i = 0; i < 4; i++) {
+     SDL_WaitThread(threads[i], NULL);
+   }
+   SDLTest_AssertCheck(received == 4 * 500, "Check events received, expected: %d, got: %d", 4 * 500, received);
+   SDLTest_AssertCheck(errors == 0, "Check events arrived in order, got %d out of order", errors);
+
+   /* The filter still runs on the pushing thread; the odd threads' events
+      are dropped, and the even threads' fit in the queue */
+   _pushCount = 20;
+   SDL_SetEventFilter(_events_evenCodeFilter, NULL);
+   for (i = 0; i < 4; i++) {
+     threads[i] = SDL_CreateThread(_events_pushThread, "EventPush", &indices[i]);
+   }
+   for (i = 0; i < 4; i++) {
+     SDL_WaitThread(threads[i], NULL);
+   }
+   received = 0;
+   errors = 0;
+   while ((n = SDL_PeepEvents(events, 16, SDL_GETEVENT, SDL_USEREVENT, SDL_USEREVENT)) > 0) {
+     for (i = 0; i < n; i++) {
+       if (events[i].user.code & 1) errors++;
+     }
+     received += n;
+   }
+   SDL_SetEventFilter(NULL, NULL);
+   SDLTest_AssertPass("Call to SDL_SetEventFilter()");
+   SDLTest_AssertCheck(received == 2 * 20, "Check events received, expected: %d, got: %d", 2 * 20, received);
+   SDLTest_AssertCheck(errors == 0, "Check filtered events were dropped, got %d", errors);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Checks that events dropped on a full queue are counted by type.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_GetDroppedEvents
+ */
+int
+events_droppedEvents(void *arg)
+{
+   SDL_Event event;
+   Uint32 before, user_before, after, user_after;
+   int i, pushed;
+
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+   before = SDL_GetDroppedEvents(SDL_USEREVENT + 1, SDL_USEREVENT + 1);
+   user_before = SDL_GetDroppedEvents(SDL_USEREVENT, SDL_USEREVENT);
+   SDLTest_AssertPass("Call to SDL_GetDroppedEvents()");
+
+   /* Fill the queue with one type, then overflow it with another */
+   SDL_zero(event);
+   event.type = SDL_USEREVENT;
+   pushed = 0;
+   while (SDL_PushEvent(&event) == 1) {
+     pushed++;
+   }
+   event.type = SDL_USEREVENT + 1;
+   for (i = 0; i < 10; i++) {
+     SDL_PushEvent(&event);
+   }
+
+   after = SDL_GetDroppedEvents(SDL_USEREVENT + 1, SDL_USEREVENT + 1);
+   user_after = SDL_GetDroppedEvents(SDL_USEREVENT, SDL_USEREVENT);
+   SDLTest_AssertCheck(pushed > 0, "Check events were queued, got: %d", pushed);
+   SDLTest_AssertCheck(after - before == 10, "Check dropped count of the second type, expected: 10, got: %u", after - before);
+   SDLTest_AssertCheck(user_after - user_before == 1, "Check dropped count of the first type, expected: 1, got: %u", user_after - user_before);
+   after = SDL_GetDroppedEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDLTest_AssertCheck(after >= 11, "Check dropped count of all types, expected at least 11, got: %u", after);
+
+   SDL_FlushEvents(SDL_USEREVENT, SDL_USEREVENT + 1);
+   return TEST_COMPLETED;
+}
+
+/* Pushes one user event after a short delay */
+int _events_delayedPushThread(void *data)
+{
+   SDL_Event event;
+
+   SDL_Delay(100);
+   SDL_zero(event);
+   event.type = SDL_USEREVENT;
+   event.user.code = 42;
+   SDL_PushEvent(&event);
+   return 0;
+}
+
+/**
+ * @brief Checks that SDL_WaitEventTimeout returns as soon as another thread pushes an event, and times out on an empty queue.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_WaitEventTimeout
+ */
+int
+events_waitEventTimeout(void *arg)
+{
+   SDL_Thread *thread;
+   SDL_Event event;
+   Uint32 start, elapsed;
+   int result;
+
+   SDL_FlushEvents(SDL_USEREVENT, SDL_USEREVENT);
+
+   /* Nothing arrives: the wait runs out */
+   start = SDL_GetTicks();
+   result = SDL_WaitEventTimeout(&event, 50);
+   elapsed = SDL_GetTicks() - start;
+   SDLTest_AssertPass("Call to SDL_WaitEventTimeout() with an empty queue");
+   SDLTest_AssertCheck(result == 0 || event.type != SDL_USEREVENT, "Check that no user event was returned, got: %i", result);
+   SDLTest_AssertCheck(result != 0 || elapsed >= 50, "Check that the wait lasted the whole timeout, expected: >=50, got: %u", elapsed);
+
+   /* A pushed event wakes the waiter long before the timeout */
+   thread = SDL_CreateThread(_events_delayedPushThread, "EventsDelayedPush", NULL);
+   SDLTest_AssertCheck(thread != NULL, "Check thread creation: %s", thread ? "ok" : SDL_GetError());
+   if (thread == NULL) {
+      return TEST_ABORTED;
+   }
+   start = SDL_GetTicks();
+   do {
+      result = SDL_WaitEventTimeout(&event, 5000);
+   } while (result == 1 && event.type != SDL_USEREVENT);
+   elapsed = SDL_GetTicks() - start;
+   SDL_WaitThread(thread, NULL);
+   SDLTest_AssertPass("Call to SDL_WaitEventTimeout() while another thread pushes");
+   SDLTest_AssertCheck(result == 1, "Check result, expected: 1, got: %i", result);
+   SDLTest_AssertCheck(event.user.code == 42, "Check event code, expected: 42, got: %i", event.user.code);
+   SDLTest_AssertCheck(elapsed < 2000, "Check that the waiter woke up early, expected: <2000, got: %u", elapsed);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Reads and flushes ranges of types out of a queue that mixes several types, and checks what's left keeps its order.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_PeepEvents
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_FlushEvents
+ */
+int
+events_peepTypeRanges(void *arg)
+{
+   SDL_Event event;
+   SDL_Event events[64];
+   Uint32 base;
+   int i, n, expected, mismatches;
+
+   base = SDL_RegisterEvents(4);
+   SDLTest_AssertCheck(base != (Uint32)-1, "Check SDL_RegisterEvents(4) result");
+   if (base == (Uint32)-1) {
+      return TEST_ABORTED;
+   }
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   /* 100 events cycling through the four types, in order */
+   SDL_zero(event);
+   for (i = 0; i < 100; i++) {
+      event.type = base + (i % 4);
+      event.user.code = i;
+      SDL_PushEvent(&event);
+   }
+
+   /* Take the second type: codes 1, 5, 9, ... */
+   n = SDL_PeepEvents(events, 64, SDL_GETEVENT, base + 1, base + 1);
+   SDLTest_AssertPass("Call to SDL_PeepEvents() for one type");
+   SDLTest_AssertCheck(n == 25, "Check number of events, expected: 25, got: %i", n);
+   mismatches = 0;
+   for (i = 0; i < n; i++) {
+      if (events[i].type != base + 1 || events[i].user.code != 1 + i * 4) {
+         mismatches++;
+      }
+   }
+   SDLTest_AssertCheck(mismatches == 0, "Check events are of the type and in order, mismatches: %i", mismatches);
+
+   /* Peek the third and fourth types together: codes 2, 3, 6, 7, ... */
+   n = SDL_PeepEvents(events, 64, SDL_PEEKEVENT, base + 2, base + 3);
+   SDLTest_AssertPass("Call to SDL_PeepEvents() for two types");
+   SDLTest_AssertCheck(n == 50, "Check number of events, expected: 50, got: %i", n);
+   mismatches = 0;
+   for (i = 0; i < n; i++) {
+      if (events[i].user.code != 2 + (i / 2) * 4 + (i % 2)) {
+         mismatches++;
+      }
+   }
+   SDLTest_AssertCheck(mismatches == 0, "Check events of both types are interleaved in order, mismatches: %i", mismatches);
+
+   /* Flush the third type; the first and fourth are left, in order */
+   SDL_FlushEvent(base + 2);
+   SDLTest_AssertPass("Call to SDL_FlushEvent()");
+   SDLTest_AssertCheck(SDL_HasEvent(base + 2) == SDL_FALSE, "Check the flushed type is gone");
+   expected = 0;
+   mismatches = 0;
+   while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, base, base + 3) == 1) {
+      if (event.user.code != expected) {
+         mismatches++;
+      }
+      expected += (expected % 4 == 0) ? 3 : 1;
+   }
+   SDLTest_AssertCheck(expected == 100, "Check all remaining events were read, expected: 100, got: %i", expected);
+   SDLTest_AssertCheck(mismatches == 0, "Check remaining events are in order, mismatches: %i", mismatches);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Records events to memory and replays them
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_StartEventRecording
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_ReplayEvents
+ */
+int
+events_recordReplay(void *arg)
+{
+   static Uint8 buffer[16384];
+   SDL_RWops *rw;
+   SDL_Event event;
+   Uint64 start;
+   Uint32 base, elapsed;
+   int i, n, queued, result, size, mismatches;
+
+   base = SDL_RegisterEvents(1);
+   SDLTest_AssertCheck(base != (Uint32)-1, "Check SDL_RegisterEvents(1) result");
+   if (base == (Uint32)-1) {
+      return TEST_ABORTED;
+   }
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   /* Record ten user events and a key press */
+   rw = SDL_RWFromMem(buffer, sizeof(buffer));
+   SDLTest_AssertCheck(rw != NULL, "Check SDL_RWFromMem() result");
+   if (rw == NULL) {
+      return TEST_ABORTED;
+   }
+   result = SDL_StartEventRecording(rw);
+   SDLTest_AssertPass("Call to SDL_StartEventRecording()");
+   SDLTest_AssertCheck(result == 0, "Check result, expected: 0, got: %i", result);
+   result = SDL_StartEventRecording(rw);
+   SDLTest_AssertCheck(result == -1, "Check a second recording is refused, expected: -1, got: %i", result);
+
+   SDL_zero(event);
+   event.type = base;
+   for (i = 0; i < 10; i++) {
+      event.user.code = i;
+      SDL_PushEvent(&event);
+   }
+   SDL_zero(event);
+   event.type = SDL_KEYDOWN;
+   event.key.keysym.scancode = SDL_SCANCODE_A;
+   event.key.keysym.sym = SDLK_a;
+   SDL_PushEvent(&event);
+
+   result = SDL_StopEventRecording();
+   SDLTest_AssertPass("Call to SDL_StopEventRecording()");
+   SDLTest_AssertCheck(result == 0, "Check result, expected: 0, got: %i", result);
+   size = (int)SDL_RWtell(rw);
+   SDL_RWclose(rw);
+   SDLTest_AssertCheck(size > 0 && size < (int)(11 * sizeof(SDL_Event)), "Check the recording is compact, got: %i bytes", size);
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   /* Replay as fast as possible */
+   rw = SDL_RWFromConstMem(buffer, size);
+   n = SDL_ReplayEvents(rw, SDL_FALSE);
+   SDL_RWclose(rw);
+   SDLTest_AssertPass("Call to SDL_ReplayEvents(), not in real time");
+   SDLTest_AssertCheck(n == 11, "Check number of events replayed, expected: 11, got: %i", n);
+   mismatches = 0;
+   for (i = 0; i < 10; i++) {
+      if (SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) != 1 ||
+          event.type != base || event.user.code != i) {
+         mismatches++;
+      }
+   }
+   SDLTest_AssertCheck(mismatches == 0, "Check user events are replayed in order, mismatches: %i", mismatches);
+   n = SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDLTest_AssertCheck(n == 1 && event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_a,
+                       "Check the key press is replayed last");
+   SDLTest_AssertCheck(event.key.timestamp_ns != 0, "Check the key press has a new timestamp_ns");
+
+   /* Record two events 50 ms apart and replay them in real time */
+   rw = SDL_RWFromMem(buffer, sizeof(buffer));
+   SDL_StartEventRecording(rw);
+   SDL_zero(event);
+   event.type = base;
+   SDL_PushEvent(&event);
+   SDL_Delay(50);
+   SDL_PushEvent(&event);
+   SDL_StopEventRecording();
+   size = (int)SDL_RWtell(rw);
+   SDL_RWclose(rw);
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   rw = SDL_RWFromConstMem(buffer, size);
+   start = SDL_GetPerformanceCounter();
+   n = SDL_ReplayEvents(rw, SDL_TRUE);
+   elapsed = (Uint32)((SDL_GetPerformanceCounter() - start) * 1000 / SDL_GetPerformanceFrequency());
+   SDL_RWclose(rw);
+   SDLTest_AssertPass("Call to SDL_ReplayEvents(), in real time");
+   SDLTest_AssertCheck(n == 2, "Check number of events replayed, expected: 2, got: %i", n);
+   SDLTest_AssertCheck(elapsed >= 45, "Check the replay kept the recorded pace, expected: >= 45 ms, got: %u ms", elapsed);
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   /* More events than the queue holds, with nobody else reading it */
+   rw = SDL_RWFromMem(buffer, sizeof(buffer));
+   SDL_StartEventRecording(rw);
+   SDL_zero(event);
+   event.type = base;
+   for (i = 0; i < 300; i++) {
+      SDL_PushEvent(&event);
+   }
+   result = SDL_StopEventRecording();
+   SDLTest_AssertCheck(result == 0, "Check recording 300 events, expected: 0, got: %i", result);
+   size = (int)SDL_RWtell(rw);
+   SDL_RWclose(rw);
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   rw = SDL_RWFromConstMem(buffer, size);
+   n = SDL_ReplayEvents(rw, SDL_FALSE);
+   SDL_RWclose(rw);
+   SDLTest_AssertPass("Call to SDL_ReplayEvents() with a full queue returned");
+   SDLTest_AssertCheck(n == -1, "Check SDL_ReplayEvents() reports the full queue, expected: -1, got: %i", n);
+   queued = 0;
+   while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, base, base) == 1) {
+      queued++;
+   }
+   SDLTest_AssertCheck(queued > 0 && queued < 300, "Check the events replayed before that are queued, expected: 1..299, got: %i", queued);
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   /* Anything else isn't a recording */
+   rw = SDL_RWFromConstMem("not a recording", 15);
+   n = SDL_ReplayEvents(rw, SDL_FALSE);
+   SDL_RWclose(rw);
+   SDLTest_AssertCheck(n == -1, "Check SDL_ReplayEvents() refuses other data, expected: -1, got: %i", n);
+
+   return TEST_COMPLETED;
+}
+
+/* Watcher that logs its userdata, to check which watchers ran and in what order */
+static char _watchOrder[16];
+
+int _events_orderEventWatch(void *userdata, SDL_Event *event)
+{
+   size_t len = SDL_strlen(_watchOrder);
+   if (len + 1 < sizeof(_watchOrder)) {
+      _watchOrder[len] = *(const char *)userdata;
+      _watchOrder[len + 1] = '\0';
+   }
+   return 0;
+}
+
+static void
+_events_pushAndLogWatchers(Uint32 type, const char *expected)
+{
+   SDL_Event event;
+
+   SDL_zero(event);
+   event.type = type;
+   _watchOrder[0] = '\0';
+   SDL_PushEvent(&event);
+   SDLTest_AssertCheck(SDL_strcmp(_watchOrder, expected) == 0,
+      "Check watchers called for type 0x%x, expected: '%s', got: '%s'", type, expected, _watchOrder);
+}
+
+/**
+ * @brief Adds and deletes event watches for type ranges, and disables event types
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_AddEventWatchRange
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_DelEventWatch
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_EventState
+ */
+int
+events_addDelEventWatchRange(void *arg)
+{
+   static const char a = 'a', b = 'b', c = 'c';
+   Uint32 base;
+   Uint8 state;
+
+   base = SDL_RegisterEvents(3);
+   SDLTest_AssertCheck(base != (Uint32)-1, "Check SDL_RegisterEvents(3) result");
+   if (base == (Uint32)-1) {
+      return TEST_ABORTED;
+   }
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   SDL_AddEventWatchRange(_events_orderEventWatch, (void *)&a, base + 1, base + 2);
+   SDL_AddEventWatch(_events_orderEventWatch, (void *)&b);
+   SDL_AddEventWatchRange(_events_orderEventWatch, (void *)&c, base + 1, base + 1);
+   SDLTest_AssertPass("Call to SDL_AddEventWatchRange()");
+
+   /* Newest first, whether they watch every type or a range */
+   _events_pushAndLogWatchers(base, "b");
+   _events_pushAndLogWatchers(base + 1, "cba");
+   _events_pushAndLogWatchers(base + 2, "ba");
+
+   SDL_DelEventWatch(_events_orderEventWatch, (void *)&a);
+   SDLTest_AssertPass("Call to SDL_DelEventWatch()");
+   _events_pushAndLogWatchers(base + 1, "cb");
+   _events_pushAndLogWatchers(base + 2, "b");
+
+   SDL_DelEventWatch(_events_orderEventWatch, (void *)&b);
+   SDL_DelEventWatch(_events_orderEventWatch, (void *)&c);
+   _events_pushAndLogWatchers(base + 1, "");
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   /* Disabling a type drops it and doesn't touch its neighbours */
+   state = SDL_EventState(base + 1, SDL_DISABLE);
+   SDLTest_AssertCheck(state == SDL_ENABLE, "Check previous state, expected: %i, got: %i", SDL_ENABLE, state);
+   state = SDL_GetEventState(base + 1);
+   SDLTest_AssertCheck(state == SDL_DISABLE, "Check state, expected: %i, got: %i", SDL_DISABLE, state);
+   state = SDL_GetEventState(base);
+   SDLTest_AssertCheck(state == SDL_ENABLE, "Check neighbouring state, expected: %i, got: %i", SDL_ENABLE, state);
+   state = SDL_EventState(SDL_LASTEVENT, SDL_DISABLE);
+   SDLTest_AssertCheck(state == SDL_ENABLE, "Check SDL_LASTEVENT state, expected: %i, got: %i", SDL_ENABLE, state);
+   state = SDL_EventState(SDL_LASTEVENT, SDL_ENABLE);
+   SDLTest_AssertCheck(state == SDL_DISABLE, "Check SDL_LASTEVENT state, expected: %i, got: %i", SDL_DISABLE, state);
+   state = SDL_EventState(base + 1, SDL_ENABLE);
+   SDLTest_AssertCheck(state == SDL_DISABLE, "Check previous state, expected: %i, got: %i", SDL_DISABLE, state);
+   state = SDL_GetEventState(base + 1);
+   SDLTest_AssertCheck(state == SDL_ENABLE, "Check state, expected: %i, got: %i", SDL_ENABLE, state);
+
+   return TEST_COMPLETED;
+}
+
 
 /* ================= Test References ================== */
 
@@ -187,9 +687,27 @@ static const SDLTest_TestCaseReference eventsTest2 =
 static const SDLTest_TestCaseReference eventsTest3 =
 		{ (SDLTest_TestCaseFp)events_addDelEventWatchWithUserdata, "events_addDelEventWatchWithUserdata", "Adds and deletes an event watch function with userdata", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference eventsTest4 =
+		{ (SDLTest_TestCaseFp)events_threadedPush, "events_threadedPush", "Pushes events from several threads and checks ordering, the queue limit and the filter", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference eventsTest5 =
+		{ (SDLTest_TestCaseFp)events_droppedEvents, "events_droppedEvents", "Overflows the event queue and checks the dropped event counts", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference eventsTest6 =
+		{ (SDLTest_TestCaseFp)events_waitEventTimeout, "events_waitEventTimeout", "Waits for an event pushed from another thread and for a timeout", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference eventsTest7 =
+		{ (SDLTest_TestCaseFp)events_peepTypeRanges, "events_peepTypeRanges", "Reads and flushes type ranges out of a queue of mixed types", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference eventsTest8 =
+		{ (SDLTest_TestCaseFp)events_recordReplay, "events_recordReplay", "Records events to memory and replays them as fast as possible and in real time", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference eventsTest9 =
+		{ (SDLTest_TestCaseFp)events_addDelEventWatchRange, "events_addDelEventWatchRange", "Adds and deletes event watches for type ranges and disables event types", TEST_ENABLED };
+
 /* Sequence of Events test cases */
 static const SDLTest_TestCaseReference *eventsTests[] =  {
-	&eventsTest1, &eventsTest2, &eventsTest3, NULL
+	&eventsTest1, &eventsTest2, &eventsTest3, &eventsTest4, &eventsTest5, &eventsTest6, &eventsTest7, &eventsTest8, &eventsTest9, NULL
 };
 
 /* Events test suite (global) */
@@ -546,6 +546,106 @@ mouse_getMouseFocus(void *arg)
 	return TEST_COMPLETED;
 }
 
+/**
+ * @brief Check that mouse motion waiting in the queue is merged when SDL_HINT_EVENT_COALESCE_MOTION is set
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_HINT_EVENT_COALESCE_MOTION
+ */
+int
+mouse_coalesceMotion(void *arg)
+{
+	SDL_Event events[16];
+	SDL_Window *window;
+	int i, n;
+
+	/* Create test window */
+	window = _createMouseSuiteTestWindow();
+	if (window == NULL) return TEST_ABORTED;
+
+	/* Start with an empty queue, so nothing is dropped */
+	SDL_WarpMouseInWindow(window, 10, 10);
+	SDL_PumpEvents();
+	SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+	/* Ten moves to the right end up as one event */
+	SDL_SetHint(SDL_HINT_EVENT_COALESCE_MOTION, "1");
+	for (i = 11; i <= 20; i++) {
+	  SDL_WarpMouseInWindow(window, i, 10);
+	}
+	SDLTest_AssertPass("SDL_WarpMouseInWindow() ten times with coalescing");
+	n = SDL_PeepEvents(events, 16, SDL_GETEVENT, SDL_MOUSEMOTION, SDL_MOUSEMOTION);
+	SDLTest_AssertCheck(n == 1, "Check number of motion events, expected: 1, got: %i", n);
+	if (n == 1) {
+	  SDLTest_AssertCheck(events[0].motion.x == 20 && events[0].motion.y == 10, "Check position, expected: 20,10, got: %i,%i", events[0].motion.x, events[0].motion.y);
+	  SDLTest_AssertCheck(events[0].motion.xrel == 10 && events[0].motion.yrel == 0, "Check relative motion, expected: 10,0, got: %i,%i", events[0].motion.xrel, events[0].motion.yrel);
+	  SDLTest_AssertCheck(events[0].motion.coalesced == 9, "Check coalesced count, expected: 9, got: %u", events[0].motion.coalesced);
+	}
+
+	/* Without the hint every move is queued */
+	SDL_SetHint(SDL_HINT_EVENT_COALESCE_MOTION, "0");
+	for (i = 21; i <= 25; i++) {
+	  SDL_WarpMouseInWindow(window, i, 10);
+	}
+	SDLTest_AssertPass("SDL_WarpMouseInWindow() five times without coalescing");
+	n = SDL_PeepEvents(events, 16, SDL_GETEVENT, SDL_MOUSEMOTION, SDL_MOUSEMOTION);
+	SDLTest_AssertCheck(n == 5, "Check number of motion events, expected: 5, got: %i", n);
+	for (i = 0; i < n; i++) {
+	  SDLTest_AssertCheck(events[i].motion.x == 21 + i && events[i].motion.coalesced == 0, "Check event %i, expected: x=%i coalesced=0, got: x=%i coalesced=%u", i, 21 + i, events[i].motion.x, events[i].motion.coalesced);
+	}
+
+	/* Clean up test window */
+	_destroyMouseSuiteTestWindow(window);
+
+	return TEST_COMPLETED;
+}
+
+/* Helper to read the performance counter in nanoseconds */
+Uint64 _mousePerformanceNS()
+{
+  Uint64 freq = SDL_GetPerformanceFrequency();
+  Uint64 now = SDL_GetPerformanceCounter();
+  return ((now / freq) * 1000000000) + (((now % freq) * 1000000000) / freq);
+}
+
+/**
+ * @brief Check that mouse motion events carry a nanosecond timestamp taken when the motion arrived
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_MouseMotionEvent
+ */
+int
+mouse_motionTimestamp(void *arg)
+{
+	SDL_Event event;
+	SDL_Window *window;
+	Uint64 before, after;
+	int n;
+
+	/* Create test window */
+	window = _createMouseSuiteTestWindow();
+	if (window == NULL) return TEST_ABORTED;
+
+	SDL_WarpMouseInWindow(window, 10, 10);
+	SDL_PumpEvents();
+	SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+	before = _mousePerformanceNS();
+	SDL_WarpMouseInWindow(window, 20, 20);
+	after = _mousePerformanceNS();
+	SDLTest_AssertPass("SDL_WarpMouseInWindow(...,20,20)");
+
+	n = SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_MOUSEMOTION, SDL_MOUSEMOTION);
+	SDLTest_AssertCheck(n == 1, "Check number of motion events, expected: 1, got: %i", n);
+	if (n == 1) {
+	  SDLTest_AssertCheck(event.motion.timestamp_ns >= before && event.motion.timestamp_ns <= after,
+	    "Check timestamp_ns is between %llu and %llu, got: %llu", before, after, event.motion.timestamp_ns);
+	}
+
+	/* Clean up test window */
+	_destroyMouseSuiteTestWindow(window);
+
+	return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Mouse test cases */
@@ -579,10 +679,16 @@ static const SDLTest_TestCaseReference mouseTest9 =
 static const SDLTest_TestCaseReference mouseTest10 =
 		{ (SDLTest_TestCaseFp)mouse_getSetRelativeMouseMode, "mouse_getSetRelativeMouseMode", "Check call to SDL_GetRelativeMouseMode and SDL_SetRelativeMouseMode", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference mouseTest11 =
+		{ (SDLTest_TestCaseFp)mouse_coalesceMotion, "mouse_coalesceMotion", "Check that queued mouse motion is merged with SDL_HINT_EVENT_COALESCE_MOTION", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference mouseTest12 =
+		{ (SDLTest_TestCaseFp)mouse_motionTimestamp, "mouse_motionTimestamp", "Check the nanosecond timestamp of mouse motion events", TEST_ENABLED };
+
 /* Sequence of Mouse test cases */
 static const SDLTest_TestCaseReference *mouseTests[] =  {
 	&mouseTest1, &mouseTest2, &mouseTest3, &mouseTest4, &mouseTest5, &mouseTest6, 
-	&mouseTest7, &mouseTest8, &mouseTest9, &mouseTest10, NULL
+	&mouseTest7, &mouseTest8, &mouseTest9, &mouseTest10, &mouseTest11, &mouseTest12, NULL
 };
 
 /* Mouse test suite (global) */
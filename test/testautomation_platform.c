@@ -163,6 +163,8 @@ int platform_testGetFunctions (void *arg)
  * http://wiki.libsdl.org/moin.cgi/SDL_HasSSE3
  * http://wiki.libsdl.org/moin.cgi/SDL_HasSSE41
  * http://wiki.libsdl.org/moin.cgi/SDL_HasSSE42
+ * http://wiki.libsdl.org/moin.cgi/SDL_HasAVX
+ * http://wiki.libsdl.org/moin.cgi/SDL_HasAVX2
  */
 int platform_testHasFunctions (void *arg)
 {
@@ -197,6 +199,12 @@ int platform_testHasFunctions (void *arg)
    ret = SDL_HasSSE42();
    SDLTest_AssertPass("SDL_HasSSE42()");
 
+   ret = SDL_HasAVX();
+   SDLTest_AssertPass("SDL_HasAVX()");
+
+   ret = SDL_HasAVX2();
+   SDLTest_AssertPass("SDL_HasAVX2()");
+
    return TEST_COMPLETED;
 }
 
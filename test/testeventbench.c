@@ -0,0 +1,255 @@
+/*
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Measure SDL_PushEvent() throughput with 1..N threads pushing user events
+   while the main thread drains them with SDL_PeepEvents().  Each run prints
+   one tab separated line:
+
+     threads events seconds ns_per_event events_per_sec push_ns full_retries
+
+   push_ns is the average time spent inside a successful SDL_PushEvent(),
+   and full_retries counts pushes that found the queue full and had to be
+   retried.  The run also checks that no event was lost and that each
+   thread's events arrived in the order it pushed them.
+
+   --queue-size and --max-size set SDL_HINT_EVENT_QUEUE_SIZE and
+   SDL_HINT_EVENT_QUEUE_MAX_SIZE.  --watchers N adds N event watches for
+   another event type, which shouldn't change push_ns.
+
+   Finally it measures how long SDL_WaitEvent() takes to return after
+   another thread pushes an event, and prints the average and worst case. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "SDL.h"
+
+#define MAX_THREADS 64
+
+typedef struct
+{
+    int index;
+    int count;
+    Uint64 push_ticks;
+    int retries;
+} PushData;
+
+static SDL_atomic_t go;
+static Uint32 event_type;
+
+static int SDLCALL
+other_watch(void *userdata, SDL_Event * event)
+{
+    return 0;
+}
+
+static int SDLCALL
+push_thread(void *arg)
+{
+    PushData *data = (PushData *) arg;
+    SDL_Event event;
+    Uint64 start;
+    int i;
+
+    while (!SDL_AtomicGet(&go)) {
+        /* spin until everyone is ready */
+    }
+
+    SDL_zero(event);
+    event.type = event_type;
+    event.user.code = data->index;
+    for (i = 0; i < data->count; ++i) {
+        event.user.data1 = (void *) (size_t) i;
+        start = SDL_GetPerformanceCounter();
+        while (SDL_PushEvent(&event) <= 0) {
+            data->retries++;
+            SDL_Delay(0);
+            start = SDL_GetPerformanceCounter();
+        }
+        data->push_ticks += SDL_GetPerformanceCounter() - start;
+    }
+    return 0;
+}
+
+static int
+run(int numthreads, int count)
+{
+    SDL_Thread *threads[MAX_THREADS];
+    PushData data[MAX_THREADS];
+    int expected[MAX_THREADS];
+    SDL_Event events[64];
+    Uint64 start, ticks, push_ticks = 0;
+    double seconds;
+    int i, n, received = 0, retries = 0, errors = 0;
+    const int total = numthreads * count;
+
+    SDL_AtomicSet(&go, 0);
+    for (i = 0; i < numthreads; ++i) {
+        char name[32];
+        SDL_snprintf(name, sizeof (name), "EventPush%d", i);
+        SDL_zero(data[i]);
+        data[i].index = i;
+        data[i].count = count;
+        expected[i] = 0;
+        threads[i] = SDL_CreateThread(push_thread, name, &data[i]);
+        if (threads[i] == NULL) {
+            fprintf(stderr, "Couldn't create thread: %s\n", SDL_GetError());
+            exit(2);
+        }
+    }
+
+    start = SDL_GetPerformanceCounter();
+    SDL_AtomicSet(&go, 1);
+    while (received < total) {
+        n = SDL_PeepEvents(events, SDL_arraysize(events), SDL_GETEVENT,
+                           event_type, event_type);
+        if (n < 0) {
+            fprintf(stderr, "SDL_PeepEvents() failed: %s\n", SDL_GetError());
+            exit(2);
+        }
+        for (i = 0; i < n; ++i) {
+            const int thread = events[i].user.code;
+            const int seq = (int) (size_t) events[i].user.data1;
+            if ((thread < 0) || (thread >= numthreads) ||
+                (seq != expected[thread])) {
+                errors++;
+            } else {
+                expected[thread]++;
+            }
+        }
+        received += n;
+    }
+    ticks = SDL_GetPerformanceCounter() - start;
+
+    for (i = 0; i < numthreads; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+        push_ticks += data[i].push_ticks;
+        retries += data[i].retries;
+    }
+
+    seconds = (double) ticks / SDL_GetPerformanceFrequency();
+    printf("%d\t%d\t%.4f\t%.1f\t%.0f\t%.1f\t%d\n", numthreads, total, seconds,
+           seconds * 1e9 / total, total / seconds,
+           (double) push_ticks * 1e9 / SDL_GetPerformanceFrequency() / total,
+           retries);
+    fflush(stdout);
+
+    if (errors) {
+        fprintf(stderr, "%d thread(s): %d event(s) lost or out of order\n",
+                numthreads, errors);
+    }
+    return errors;
+}
+
+static Uint64 pushed_at;
+
+static int SDLCALL
+wake_thread(void *arg)
+{
+    const int rounds = *(int *) arg;
+    SDL_Event event;
+    int i;
+
+    SDL_zero(event);
+    event.type = event_type;
+    for (i = 0; i < rounds; ++i) {
+        SDL_Delay(2);
+        pushed_at = SDL_GetPerformanceCounter();
+        SDL_PushEvent(&event);
+        while (SDL_AtomicGet(&go) == i) {
+            SDL_Delay(0);   /* wait for the main thread to see it */
+        }
+    }
+    return 0;
+}
+
+static void
+run_latency(int rounds)
+{
+    const double freq = (double) SDL_GetPerformanceFrequency();
+    SDL_Thread *thread;
+    SDL_Event event;
+    double us, total = 0.0, worst = 0.0;
+    int i;
+
+    SDL_AtomicSet(&go, 0);
+    thread = SDL_CreateThread(wake_thread, "EventWake", &rounds);
+    for (i = 0; i < rounds; ++i) {
+        do {
+            SDL_WaitEvent(&event);
+        } while (event.type != event_type);
+        us = (SDL_GetPerformanceCounter() - pushed_at) * 1e6 / freq;
+        total += us;
+        if (us > worst) {
+            worst = us;
+        }
+        SDL_AtomicSet(&go, i + 1);
+    }
+    SDL_WaitThread(thread, NULL);
+
+    printf("# wakeups\tavg_us\tmax_us\n");
+    printf("%d\t%.1f\t%.1f\n", rounds, total / rounds, worst);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int maxthreads = SDL_min(SDL_GetCPUCount() * 2, 16);
+    int count = 200000;
+    int watchers = 0;
+    int i, errors = 0;
+
+    for (i = 1; i < argc; ++i) {
+        if ((SDL_strcmp(argv[i], "--threads") == 0) && (i + 1 < argc)) {
+            maxthreads = SDL_atoi(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--events") == 0) && (i + 1 < argc)) {
+            count = SDL_atoi(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--queue-size") == 0) && (i + 1 < argc)) {
+            SDL_SetHint(SDL_HINT_EVENT_QUEUE_SIZE, argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--max-size") == 0) && (i + 1 < argc)) {
+            SDL_SetHint(SDL_HINT_EVENT_QUEUE_MAX_SIZE, argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--watchers") == 0) && (i + 1 < argc)) {
+            watchers = SDL_atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "USAGE: %s [--threads N] [--events PER_THREAD] [--queue-size N] [--max-size N] [--watchers N]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if ((maxthreads < 1) || (maxthreads > MAX_THREADS) || (count < 1)) {
+        fprintf(stderr, "Invalid --threads or --events\n");
+        return 2;
+    }
+
+    /* The event queue comes with the video subsystem; no window is needed */
+    if (!SDL_getenv("SDL_VIDEODRIVER")) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    }
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 2;
+    }
+    event_type = SDL_RegisterEvents(2);
+    for (i = 0; i < watchers; ++i) {
+        SDL_AddEventWatchRange(other_watch, NULL, event_type + 1, event_type + 1);
+    }
+
+    printf("# threads\tevents\tseconds\tns_per_event\tevents_per_sec\tpush_ns\tfull_retries\n");
+    for (i = 1; i <= maxthreads; ++i) {
+        errors += run(i, count);
+    }
+    run_latency(200);
+
+    SDL_Quit();
+    return errors ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,146 @@
+/*
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Measure taking one event type out of a queue holding several types.
+   For each queue length the queue is filled with events cycling through
+   --types user event types, and then all events of one type are read with
+   SDL_PeepEvents(SDL_GETEVENT), 64 at a time.  The queue is refilled and
+   the same type is thrown away with SDL_FlushEvent().  Each length prints
+   one tab separated line:
+
+     queued types matched get_us get_ns_per_event flush_us
+
+   The queue is allowed to grow as large as the longest run needs. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "SDL.h"
+
+static Uint32 event_base;
+
+static int
+fill(int queued, int types)
+{
+    SDL_Event event;
+    int i;
+
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+    SDL_zero(event);
+    for (i = 0; i < queued; ++i) {
+        event.type = event_base + (i % types);
+        event.user.code = i;
+        if (SDL_PushEvent(&event) <= 0) {
+            fprintf(stderr, "Couldn't queue event %d: %s\n", i, SDL_GetError());
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int
+run(int queued, int types)
+{
+    const double freq = (double) SDL_GetPerformanceFrequency();
+    const Uint32 type = event_base + types / 2;
+    SDL_Event events[64];
+    Uint64 start, get_ticks, flush_ticks;
+    int i, n, matched = 0, expected = types / 2, errors = 0;
+
+    if (fill(queued, types) < 0) {
+        return 1;
+    }
+    start = SDL_GetPerformanceCounter();
+    while ((n = SDL_PeepEvents(events, SDL_arraysize(events), SDL_GETEVENT,
+                               type, type)) > 0) {
+        for (i = 0; i < n; ++i) {
+            if (events[i].user.code != expected) {
+                errors++;
+            }
+            expected += types;
+        }
+        matched += n;
+    }
+    get_ticks = SDL_GetPerformanceCounter() - start;
+
+    if (fill(queued, types) < 0) {
+        return 1;
+    }
+    start = SDL_GetPerformanceCounter();
+    SDL_FlushEvent(type);
+    flush_ticks = SDL_GetPerformanceCounter() - start;
+
+    if (SDL_HasEvent(type) ||
+        SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, SDL_FIRSTEVENT,
+                       SDL_LASTEVENT) == 0) {
+        errors++;
+    }
+
+    printf("%d\t%d\t%d\t%.1f\t%.1f\t%.1f\n", queued, types, matched,
+           get_ticks * 1e6 / freq, matched ? get_ticks * 1e9 / freq / matched : 0.0,
+           flush_ticks * 1e6 / freq);
+    fflush(stdout);
+
+    if (errors) {
+        fprintf(stderr, "%d events: %d event(s) lost or out of order\n",
+                queued, errors);
+    }
+    return errors;
+}
+
+int
+main(int argc, char *argv[])
+{
+    char hint[32];
+    int maxqueued = 64000;
+    int types = 8;
+    int queued, i, errors = 0;
+
+    for (i = 1; i < argc; ++i) {
+        if ((SDL_strcmp(argv[i], "--events") == 0) && (i + 1 < argc)) {
+            maxqueued = SDL_atoi(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--types") == 0) && (i + 1 < argc)) {
+            types = SDL_atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "USAGE: %s [--events MAX_QUEUED] [--types N]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if ((maxqueued < 1) || (types < 1) || (types > 1000)) {
+        fprintf(stderr, "Invalid --events or --types\n");
+        return 2;
+    }
+
+    SDL_snprintf(hint, sizeof (hint), "%d", maxqueued);
+    SDL_SetHint(SDL_HINT_EVENT_QUEUE_MAX_SIZE, hint);
+
+    /* The event queue comes with the video subsystem; no window is needed */
+    if (!SDL_getenv("SDL_VIDEODRIVER")) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    }
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 2;
+    }
+    event_base = SDL_RegisterEvents(types);
+
+    printf("# queued\ttypes\tmatched\tget_us\tget_ns_per_event\tflush_us\n");
+    for (queued = SDL_min(1000, maxqueued); queued < maxqueued; queued *= 4) {
+        errors += run(queued, types);
+    }
+    errors += run(maxqueued, types);
+
+    SDL_Quit();
+    return errors ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
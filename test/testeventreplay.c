@@ -0,0 +1,186 @@
+/*
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Record input to a file, or replay a recording and time reading it back.
+
+     testeventreplay --record FILE
+       opens a window and records every event until it's closed.
+
+     testeventreplay [--realtime] FILE
+       replays FILE on another thread while the main thread reads the
+       events, on the dummy video driver unless SDL_VIDEODRIVER is set, and
+       prints one tab separated line:
+
+     events seconds events_per_sec */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "SDL.h"
+
+static SDL_atomic_t done;
+
+typedef struct
+{
+    SDL_RWops *src;
+    SDL_bool realtime;
+    int pushed;
+} ReplayData;
+
+static int SDLCALL
+replay_thread(void *arg)
+{
+    ReplayData *data = (ReplayData *) arg;
+
+    data->pushed = SDL_ReplayEvents(data->src, data->realtime);
+    SDL_AtomicSet(&done, 1);
+    return 0;
+}
+
+static int
+record(const char *file)
+{
+    SDL_Window *window;
+    SDL_RWops *dst;
+    SDL_Event event;
+    int quit = 0, result;
+
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER) < 0) {
+        fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 2;
+    }
+    window = SDL_CreateWindow("Recording events", SDL_WINDOWPOS_CENTERED,
+                              SDL_WINDOWPOS_CENTERED, 640, 480, 0);
+    if (!window) {
+        fprintf(stderr, "Couldn't create window: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 2;
+    }
+    dst = SDL_RWFromFile(file, "wb");
+    if (!dst || SDL_StartEventRecording(dst) < 0) {
+        fprintf(stderr, "Couldn't record to %s: %s\n", file, SDL_GetError());
+        if (dst) {
+            SDL_RWclose(dst);
+        }
+        SDL_Quit();
+        return 2;
+    }
+
+    while (!quit && SDL_WaitEvent(&event)) {
+        if (event.type == SDL_QUIT) {
+            quit = 1;
+        }
+    }
+
+    result = SDL_StopEventRecording();
+    if (result < 0) {
+        fprintf(stderr, "Recording is incomplete: %s\n", SDL_GetError());
+    }
+    SDL_RWclose(dst);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return (result < 0) ? 1 : 0;
+}
+
+static int
+replay(const char *file, SDL_bool realtime)
+{
+    ReplayData data;
+    SDL_Thread *thread;
+    SDL_Event event;
+    Uint64 start, ticks;
+    double seconds;
+    int received = 0;
+
+    if (!SDL_getenv("SDL_VIDEODRIVER")) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    }
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 2;
+    }
+    SDL_zero(data);
+    data.src = SDL_RWFromFile(file, "rb");
+    data.realtime = realtime;
+    if (!data.src) {
+        fprintf(stderr, "Couldn't open %s: %s\n", file, SDL_GetError());
+        SDL_Quit();
+        return 2;
+    }
+
+    SDL_AtomicSet(&done, 0);
+    start = SDL_GetPerformanceCounter();
+    thread = SDL_CreateThread(replay_thread, "EventReplay", &data);
+    if (!thread) {
+        fprintf(stderr, "Couldn't create thread: %s\n", SDL_GetError());
+        SDL_RWclose(data.src);
+        SDL_Quit();
+        return 2;
+    }
+    for (;;) {
+        if (SDL_WaitEventTimeout(&event, 10)) {
+            if (event.type == SDL_DROPFILE) {
+                SDL_free(event.drop.file);
+            }
+            received++;
+        } else if (SDL_AtomicGet(&done)) {
+            break;
+        }
+    }
+    ticks = SDL_GetPerformanceCounter() - start;
+    SDL_WaitThread(thread, NULL);
+    SDL_RWclose(data.src);
+
+    if (data.pushed < 0) {
+        fprintf(stderr, "Couldn't replay %s: %s\n", file, SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    seconds = (double) ticks / SDL_GetPerformanceFrequency();
+    printf("# events\tseconds\tevents_per_sec\n");
+    printf("%d\t%.4f\t%.0f\n", received, seconds,
+           seconds > 0.0 ? received / seconds : 0.0);
+
+    SDL_Quit();
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_bool realtime = SDL_FALSE;
+    const char *file = NULL;
+    int recording = 0;
+    int i;
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--record") == 0) {
+            recording = 1;
+        } else if (SDL_strcmp(argv[i], "--realtime") == 0) {
+            realtime = SDL_TRUE;
+        } else if (!file && argv[i][0] != '-') {
+            file = argv[i];
+        } else {
+            file = NULL;
+            break;
+        }
+    }
+    if (!file) {
+        fprintf(stderr, "USAGE: %s --record FILE\n"
+                        "       %s [--realtime] FILE\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    return recording ? record(file) : replay(file, realtime);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -153,6 +153,8 @@ TestCPUInfo(SDL_bool verbose)
         printf("SSE3 %s\n", SDL_HasSSE3()? "detected" : "not detected");
         printf("SSE4.1 %s\n", SDL_HasSSE41()? "detected" : "not detected");
         printf("SSE4.2 %s\n", SDL_HasSSE42()? "detected" : "not detected");
+        printf("AVX %s\n", SDL_HasAVX()? "detected" : "not detected");
+        printf("AVX2 %s\n", SDL_HasAVX2()? "detected" : "not detected");
     }
     return (0);
 }